@@ -537,9 +537,6 @@ void animate()
 {
   Float time = (Float) glutGet( GLUT_ELAPSED_TIME ) * 0.001f;
   Kernel::GetInstance()->tick( time );
-  
-  if (skinMeshActor != NULL)
-    skinMeshActor->tick();
 
   ctrl->tick();
   animCtrl->tick();
@@ -160,14 +160,15 @@ namespace GE
 
   void SkinMeshActor::setAnimRotations()
   {
-    //Load transformations from animation tracks
+    //Sample animation into the controller's pose
+    animCtrl.samplePose();
+    AnimPose *animPose = animCtrl.getPose();
+
+    //Load transformations from the sampled pose
     for (UintSize j=0; j < character->pose->joints.size(); ++j)
     {
-      QuatAnimTrack *trackR = (QuatAnimTrack*) anim->getTrack( 2 * j + 0 );
-      Vec3AnimTrack *trackT = (Vec3AnimTrack*) anim->getTrack( 2 * j + 1 );
-
-      jointRotations[ j ] = trackR->getValue();
-      jointTranslations[ j ] = trackT->getValue();
+      jointRotations[ j ] = *((Quat*) animPose->getValue( 2 * j + 0 ));
+      jointTranslations[ j ] = *((Vector3*) animPose->getValue( 2 * j + 1 ));
     }
 
     //Mark changes
@@ -182,7 +183,7 @@ namespace GE
     if (!jointChange) return;
 
     SkinPose *pose = character->pose;
-    ArrayList <Matrix4x4> fkMats;
+    fkMats.clear();
     skinMats.clear();
     int cindex = 1;
     
@@ -298,13 +299,51 @@ namespace GE
 
   void SkinMeshActor::tick ()
   {
-    animCtrl.tick();
-    if (animCtrl.isPlaying())
-    {
-      //Update model
+    tick( Kernel::GetInstance()->getInterval() );
+  }
+
+  void SkinMeshActor::tick (Float interval)
+  {
+    animCtrl.tick( interval );
+    updateAnimation();
+  }
+
+  void SkinMeshActor::updateAnimation ()
+  {
+    if (anim != NULL && animCtrl.isPlaying())
       setAnimRotations();
-      updateSkin();
-    }
+
+    updateSkin();
+  }
+
+  void SkinMeshActor::UpdateAnimationJob (UintSize index, void *param)
+  {
+    SkinMeshActor **actors = (SkinMeshActor**) param;
+    actors[ index ]->updateAnimation();
+  }
+
+  /*
+  -------------------------------------------------------------
+  Animation update stage for many skinned actors at once. The
+  controllers are advanced serially since they may invoke end
+  callbacks and observers. Each actor then samples the shared
+  Animation into its own pose and builds FK and skin matrices
+  as an independent job on the thread pool.
+  -------------------------------------------------------------*/
+
+  void SkinMeshActor::TickAll (const ArrayList <SkinMeshActor*> &actors,
+                               Float interval, ThreadPool *pool)
+  {
+    //Advance animation time
+    for (UintSize a=0; a<actors.size(); ++a)
+      actors[ a ]->animCtrl.tick( interval );
+
+    //Sample poses and build joint matrices
+    if (pool != NULL)
+      pool->parallelFor( actors.size(), UpdateAnimationJob, actors.buffer() );
+    else
+      for (UintSize a=0; a<actors.size(); ++a)
+        actors[ a ]->updateAnimation();
   }
 
   void SkinMeshActor::composeShader( Shader *shader )
@@ -343,9 +382,9 @@ namespace GE
     shader->composeNodeEnd();
   }
 
-  void SkinMeshActor::bindFormat (Shader *shader, VertexFormat *format)
+  void SkinMeshActor::bindFormat (Shader *shader, TriMesh *lod, VertexFormat *format)
   {
-    TriMeshActor::bindFormat (shader, format);
+    TriMeshActor::bindFormat (shader, lod, format);
 
     //Construct a mesh-specific array of joint matrices
     Matrix4x4 meshMats[24];
@@ -379,6 +418,16 @@ namespace GE
     }
   }
 
+  /*
+  Skinned sub meshes bind their own joint matrices so the
+  actor renders itself rather than per group. */
+
+  void SkinMeshActor::enqueue (RenderQueue *queue, RenderTarget::Enum target,
+                               const Matrix4x4 &world, Float depth)
+  {
+    Actor3D::enqueue( queue, target, world, depth );
+  }
+
   BoundingBox SkinMeshActor::getBoundingBox()
   {
     Matrix4x4 rootWorld;
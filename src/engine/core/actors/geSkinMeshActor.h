@@ -41,6 +41,7 @@ namespace GE
     Vector3 *skinNormals;
     Vector3 *jointTranslations;
     Quat    *jointRotations;
+    ArrayList <Matrix4x4> fkMats;
     ArrayList <Matrix4x4> skinMats;
     VertexBinding <SkinVertex> vertexBinding;
     bool jointChange;
@@ -49,7 +50,9 @@ namespace GE
     void initAnimData();
     void setPoseRotations();
     void setAnimRotations();
+    void updateAnimation();
     void updateSkin();
+    static void UpdateAnimationJob (UintSize index, void *param);
 
     Animation *anim;
     AnimController animCtrl;
@@ -58,7 +61,7 @@ namespace GE
     Int32 boneIndexAttrib;
     Int32 boneWeightAttrib;
     SkinTriMesh *curSubMesh;
-    virtual void bindFormat (Shader *shader, VertexFormat *format);
+    virtual void bindFormat (Shader *shader, TriMesh *lod, VertexFormat *format);
 
   public:
     virtual Class getShaderComposingClass() { return ClassName( SkinMeshActor ); }
@@ -77,11 +80,17 @@ namespace GE
     void setJointTranslation (int jointIndex, Vector3 rotation);
 
     virtual void render (RenderTarget::Enum target);
+    virtual void enqueue (RenderQueue *queue, RenderTarget::Enum target,
+                          const Matrix4x4 &world, Float depth);
 
     void loadPose ();
     void loadAnimation (const CharString &name);
     AnimController *getAnimController () { return &animCtrl; }
     void tick ();
+    void tick (Float interval);
+
+    static void TickAll (const ArrayList <SkinMeshActor*> &actors,
+                         Float interval, ThreadPool *pool = NULL);
 
     virtual BoundingBox getBoundingBox();
   };
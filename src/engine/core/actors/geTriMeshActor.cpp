@@ -4,6 +4,7 @@
 #include "core/geShader.h"
 #include "core/geKernel.h"
 #include "core/geRenderer.h"
+#include "core/geRenderQueue.h"
 #include "core/geShader.h"
 
 namespace GE
@@ -12,27 +13,28 @@ namespace GE
   TriMeshActor::TriMeshActor()
   {
     mesh = NULL;
+    drawMesh = NULL;
     meshVAO = 0;
     meshVAOInit = false;
   }
 
   TriMeshActor::~TriMeshActor()
   {
-    if (mesh != NULL)
-      mesh->dereference();
   }
 
   void TriMeshActor::setMesh (const CharString &name) {
     mesh = name;
+    drawMesh = mesh;
+    markBoundsChanged();
   }
 
   void TriMeshActor::setMesh (TriMesh *newMesh)
   {
-    if (mesh != NULL)
-      mesh->dereference();
-    
+    //Reference keeps the count on the mesh, levels are
+    //picked again once it's drawn
     mesh = newMesh;
-    mesh->reference();
+    drawMesh = mesh;
+    markBoundsChanged();
   }
 
   TriMesh* TriMeshActor::getMesh()
@@ -46,6 +48,34 @@ namespace GE
     return mesh->getBoundingBox();
   }
 
+  bool TriMeshActor::isBoundsPending()
+  {
+    return mesh.state == ResourceState::Loading;
+  }
+
+  /*
+  Picks the coarsest level whose error, seen from the
+  nearest point of the bounding sphere, stays under the
+  pixel error of the renderer. */
+
+  TriMesh* TriMeshActor::selectLod (const Matrix4x4 &world)
+  {
+    if (mesh->lods.empty()) return mesh;
+
+    //Largest axis scale takes mesh units into world units
+    Float scale = Util::Max( world.getColumn(0).xyz().norm(),
+      Util::Max( world.getColumn(1).xyz().norm(), world.getColumn(2).xyz().norm() ));
+
+    Renderer *renderer = Kernel::GetInstance()->getRenderer();
+    BoundingBox bbox = mesh->getBoundingBox();
+    Vector3 center = world * ((bbox.min + bbox.max) * 0.5f);
+    Float radius = (bbox.max - bbox.min).norm() * 0.5f * scale;
+    Float distance = (center - renderer->getCameraEye()).norm() - radius;
+
+    Float pixels = renderer->getPixelSize( scale, distance );
+    return mesh->getLod( renderer->getLodPixelError() / pixels );
+  }
+
   void TriMeshActor::composeShader( Shader *shader )
   {
     if (mesh == NULL) return;
@@ -62,19 +92,19 @@ namespace GE
     }
   }
 
-  void TriMeshActor::bindBuffers()
+  void TriMeshActor::bindBuffers (TriMesh *lod)
   {
-    if (mesh->isOnGpu)
+    if (lod->isOnGpu)
     {
       //Render using on-GPU arrays
-      glBindBuffer( GL_ARRAY_BUFFER, mesh->dataVBO );
-      glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, mesh->indexVBO );
+      glBindBuffer( GL_ARRAY_BUFFER, lod->dataVBO );
+      glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, lod->indexVBO );
     }
   }
 
-  void TriMeshActor::unbindBuffers()
+  void TriMeshActor::unbindBuffers (TriMesh *lod)
   {
-    if (mesh->isOnGpu)
+    if (lod->isOnGpu)
     {
       //Restore arrays
       glBindBuffer( GL_ARRAY_BUFFER, 0 );
@@ -82,15 +112,15 @@ namespace GE
     }
   }
 
-  void TriMeshActor::bindFormat (Shader *shader, VertexFormat *format)
+  void TriMeshActor::bindFormat (Shader *shader, TriMesh *lod, VertexFormat *format)
   {
     if (shader == NULL)
       return;
 
     //Get data pointer
     void *data = NULL;
-    if (!mesh->isOnGpu)
-      data = mesh->data.buffer();
+    if (!lod->isOnGpu)
+      data = lod->data.buffer();
     
     //Walk the vertex data members
     for (UintSize m=0; m<format->getMembers()->size(); ++m)
@@ -140,10 +170,10 @@ namespace GE
     }
   }
 
-  void TriMeshActor::renderGroup (const TriMesh::IndexGroup &grp)
+  void TriMeshActor::renderGroup (TriMesh *lod, const TriMesh::IndexGroup &grp)
   {
     //Pass the geometry to OpenGL
-    if (mesh->isOnGpu) {
+    if (lod->isOnGpu) {
 
       //Render using on-GPU indices
       glDrawElements( GL_TRIANGLES, grp.count, GL_UNSIGNED_INT,
@@ -152,29 +182,29 @@ namespace GE
 
       //Render using off-GPU indices
       glDrawElements( GL_TRIANGLES, grp.count, GL_UNSIGNED_INT,
-                      mesh->indices.buffer() + grp.start);
+                      lod->indices.buffer() + grp.start);
     }
   }
 
   void TriMeshActor::renderShadowSingle ()
   {
     Material *material = getMaterial();
-    VertexFormat *format = (VertexFormat*) mesh->getFormat();
+    VertexFormat *format = (VertexFormat*) drawMesh->getFormat();
     Renderer *renderer = Kernel::GetInstance()->getRenderer();
     Shader *shader = renderer->getShader( RenderTarget::ShadowMap, this, NULL );
 
     shader->use();
-    bindBuffers();
-    bindFormat( shader, format );
+    bindBuffers( drawMesh );
+    bindFormat( shader, drawMesh, format );
 
     material->beginShadow();
 
     //Walk material index groups
-    for (UintSize g=0; g<mesh->groups.size(); ++g)
+    for (UintSize g=0; g<drawMesh->groups.size(); ++g)
     {
       //Render current group
-      TriMesh::IndexGroup &grp = mesh->groups[ g ];
-      renderGroup( grp );
+      TriMesh::IndexGroup &grp = drawMesh->groups[ g ];
+      renderGroup( drawMesh, grp );
     }
 
     material->endShadow();
@@ -185,18 +215,18 @@ namespace GE
   void TriMeshActor::renderShadowMulti()
   {
     Material *material = getMaterial();
-    VertexFormat *format = (VertexFormat*) mesh->getFormat();
+    VertexFormat *format = (VertexFormat*) drawMesh->getFormat();
     MultiMaterial *multiMat = (MultiMaterial*) material;
     Renderer *renderer = Kernel::GetInstance()->getRenderer();
     Shader *shader = NULL;
 
-    bindBuffers();
+    bindBuffers( drawMesh );
 
     //Walk material index groups
-    for (UintSize g=0; g<mesh->groups.size(); ++g)
+    for (UintSize g=0; g<drawMesh->groups.size(); ++g)
     {
       //Get sub-material of this group
-      TriMesh::IndexGroup &grp = mesh->groups[ g ];
+      TriMesh::IndexGroup &grp = drawMesh->groups[ g ];
       Material *subMat = multiMat->getSubMaterial( grp.materialID );
       if (subMat == NULL) continue;
 
@@ -207,23 +237,23 @@ namespace GE
         //If different, resend format data
         shader = subShader;
         shader->use();
-        bindFormat( shader, format );
+        bindFormat( shader, drawMesh, format );
       }
       
       //Render current group
       subMat->beginShadow();
-      renderGroup( grp );
+      renderGroup( drawMesh, grp );
       subMat->endShadow();
     }
     
     unbindFormat( shader, format );
-    unbindBuffers();
+    unbindBuffers( drawMesh );
   }
 
   void TriMeshActor::renderSingleMat ()
   {
     Material *material = getMaterial();
-    VertexFormat *format = (VertexFormat*) mesh->getFormat();
+    VertexFormat *format = (VertexFormat*) drawMesh->getFormat();
     Renderer *renderer = Kernel::GetInstance()->getRenderer();
     Shader *shader = renderer->getShader( RenderTarget::GBuffer, this, material );
 
@@ -235,8 +265,8 @@ namespace GE
     {
       glGenVertexArrays( 1, &meshVAO );
       glBindVertexArray( meshVAO );
-      bindBuffers();
-      bindFormat( shader, format );
+      bindBuffers( drawMesh );
+      bindFormat( shader, drawMesh, format );
       meshVAOInit = true;
     }
     else
@@ -244,19 +274,19 @@ namespace GE
 
 #else
 
-    bindBuffers();
-    bindFormat( shader, format );
+    bindBuffers( drawMesh );
+    bindFormat( shader, drawMesh, format );
 
 #endif
 
     material->begin();
 
     //Walk material index groups
-    for (UintSize g=0; g<mesh->groups.size(); ++g)
+    for (UintSize g=0; g<drawMesh->groups.size(); ++g)
     {
       //Render current group
-      TriMesh::IndexGroup &grp = mesh->groups[ g ];
-      renderGroup( grp );
+      TriMesh::IndexGroup &grp = drawMesh->groups[ g ];
+      renderGroup( drawMesh, grp );
     }
 
     material->end();
@@ -267,18 +297,18 @@ namespace GE
   void TriMeshActor::renderMultiMat ()
   {
     Material *material = getMaterial();
-    VertexFormat *format = (VertexFormat*) mesh->getFormat();
+    VertexFormat *format = (VertexFormat*) drawMesh->getFormat();
     MultiMaterial *multiMat = (MultiMaterial*) material;
     Renderer *renderer = Kernel::GetInstance()->getRenderer();
     Shader *shader = NULL;
 
-    bindBuffers();
+    bindBuffers( drawMesh );
 
     //Walk material index groups
-    for (UintSize g=0; g<mesh->groups.size(); ++g)
+    for (UintSize g=0; g<drawMesh->groups.size(); ++g)
     {
       //Get sub-material of this group
-      TriMesh::IndexGroup &grp = mesh->groups[ g ];
+      TriMesh::IndexGroup &grp = drawMesh->groups[ g ];
       Material *subMat = multiMat->getSubMaterial( grp.materialID );
       if (subMat == NULL) continue;
 
@@ -289,17 +319,17 @@ namespace GE
         //If different, resend format data
         shader = subShader;
         shader->use();
-        bindFormat( shader, format );
+        bindFormat( shader, drawMesh, format );
       }
       
       //Render current group
       subMat->begin();
-      renderGroup( grp );
+      renderGroup( drawMesh, grp );
       subMat->end();
     }
     
     unbindFormat( shader, format );
-    unbindBuffers();
+    unbindBuffers( drawMesh );
   }
 
   void TriMeshActor::render (RenderTarget::Enum target)
@@ -307,6 +337,8 @@ namespace GE
     Material *material = getMaterial();
     if (mesh == NULL) return;
     if (material == NULL) return;
+
+    drawMesh = selectLod( getGlobalMatrix() );
     if (target == RenderTarget::ShadowMap)
     {
       MultiMaterial *multiMat = Class::SafeCast< MultiMaterial >( material );
@@ -321,4 +353,45 @@ namespace GE
     }
   }
 
+  /*
+  Emits one item per index group so the queue can sort
+  the groups of all actors by shader and material. */
+
+  void TriMeshActor::enqueue (RenderQueue *queue, RenderTarget::Enum target,
+                              const Matrix4x4 &world, Float depth)
+  {
+    Material *material = getMaterial();
+    if (mesh == NULL) return;
+    if (material == NULL) return;
+    if (target != RenderTarget::GBuffer && target != RenderTarget::ShadowMap) return;
+
+    //Shadow passes pick by the camera too, so both draw the same level
+    drawMesh = selectLod( world );
+
+    Renderer *renderer = Kernel::GetInstance()->getRenderer();
+    MultiMaterial *multiMat = Class::SafeCast< MultiMaterial >( material );
+    if (multiMat == NULL)
+    {
+      //Single material shadow shader is material-independent
+      Material *shaderMat = (target == RenderTarget::ShadowMap) ? NULL : material;
+      Shader *shader = renderer->getShader( target, this, shaderMat );
+
+      for (UintSize g=0; g<drawMesh->groups.size(); ++g)
+        queue->add( this, shader, material, drawMesh, (Int) g, world, depth );
+    }
+    else
+    {
+      //Walk material index groups
+      for (UintSize g=0; g<drawMesh->groups.size(); ++g)
+      {
+        TriMesh::IndexGroup &grp = drawMesh->groups[ g ];
+        Material *subMat = multiMat->getSubMaterial( grp.materialID );
+        if (subMat == NULL) continue;
+
+        Shader *shader = renderer->getShader( target, this, subMat );
+        queue->add( this, shader, subMat, drawMesh, (Int) g, world, depth );
+      }
+    }
+  }
+
 }//namespace GE
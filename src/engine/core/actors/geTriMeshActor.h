@@ -35,18 +35,24 @@ namespace GE
   protected:
     
     friend class Renderer;
+    friend class GLRenderBackend;
     friend class SaverObj;
 
     MeshRef mesh;
+
+    //Level of detail bound and drawn, the mesh or one of its LODs
+    TriMesh *drawMesh;
     
     Uint meshVAO;
     bool meshVAOInit;
     
-    virtual void bindBuffers();
-    virtual void bindFormat (Shader *shader, VertexFormat *format);
-    virtual void renderGroup (const TriMesh::IndexGroup &grp);
+    TriMesh* selectLod (const Matrix4x4 &world);
+
+    virtual void bindBuffers (TriMesh *lod);
+    virtual void bindFormat (Shader *shader, TriMesh *lod, VertexFormat *format);
+    virtual void renderGroup (TriMesh *lod, const TriMesh::IndexGroup &grp);
     virtual void unbindFormat (Shader *shader, VertexFormat *format);
-    virtual void unbindBuffers();
+    virtual void unbindBuffers (TriMesh *lod);
 
     void renderSingleMat ();
     void renderMultiMat ();
@@ -66,7 +72,10 @@ namespace GE
     TriMesh* getMesh();
 
     virtual BoundingBox getBoundingBox();
+    virtual bool isBoundsPending ();
     virtual void render (RenderTarget::Enum target);
+    virtual void enqueue (RenderQueue *queue, RenderTarget::Enum target,
+                          const Matrix4x4 &world, Float depth);
   };
 
 
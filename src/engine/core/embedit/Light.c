@@ -13,9 +13,6 @@ void main (void)
 
 #begin SpotLight_Func
 
-uniform float attStart;
-uniform float attEnd;
-
 float getLightCoeff (vec3 P, vec3 lightP, vec3 L)
 {
   //Attenuation falloff
@@ -45,9 +42,6 @@ float getLightCoeff (vec3 P, vec3 lightP, vec3 L)
 
 #begin PyramidLight_Func
 
-uniform float attStart;
-uniform float attEnd;
-
 float getLightCoeff (vec3 P, vec3 lightP, vec3 L)
 {
   //Attenuation falloff
@@ -68,6 +62,7 @@ uniform sampler2D samplerSpec;
 uniform sampler2D samplerParams;
 uniform sampler2D samplerShadow;
 
+uniform float attStart;
 uniform float attEnd;
 uniform int castShadow;
 uniform vec2 winSize;
@@ -1,5 +1,6 @@
 #include "geActor.h"
 #include "geScene.h"
+#include "geRenderQueue.h"
 #include "geGLHeaders.h"
 
 namespace GE
@@ -10,6 +11,7 @@ namespace GE
     renderable = true;
     castShadow = true;
     maxDrawDistance = -1.0f;
+    cullSlot = 0;
   }
 
   Actor3D::~Actor3D ()
@@ -41,18 +43,21 @@ namespace GE
   void Actor3D::mulMatrixLeft (const Matrix4x4 &m)
   {
     mat = m * mat;
+    markMatrixChanged();
     onMatrixChanged();
   }
   
   void Actor3D::mulMatrixRight (const Matrix4x4 &m)
   {
     mat *= m;
+    markMatrixChanged();
     onMatrixChanged();
   }
 
   void Actor3D::setMatrix (const Matrix4x4 &m)
   {
     mat = m;
+    markMatrixChanged();
     onMatrixChanged();
   }
 
@@ -69,6 +74,7 @@ namespace GE
     mat.setColumn( 1, yAxis.xyz(0.0f) );
     mat.setColumn( 2, look.xyz(0.0f) );
     mat.affineNormalize();
+    markMatrixChanged();
     onMatrixChanged();
   }
 
@@ -133,4 +139,14 @@ namespace GE
     return renderable;
   }
 
+  /*
+  Adds the draw items of this actor to the render queue.
+  By default the actor gets to render itself. */
+
+  void Actor3D::enqueue (RenderQueue *queue, RenderTarget::Enum target,
+                         const Matrix4x4 &world, Float depth)
+  {
+    queue->addCustom( this, world, depth );
+  }
+
 }//namespace GE
@@ -18,6 +18,7 @@ namespace GE
   class Scene3D;
   class Kernel;
   class Renderer;
+  class RenderQueue;
   class Material;
 
   /*
@@ -45,6 +46,7 @@ namespace GE
     
     friend class Kernel;
     friend class Renderer;
+    friend class Scene3D;
     
   private:
 
@@ -52,6 +54,7 @@ namespace GE
     bool castShadow;
     Float maxDrawDistance;
     Material *material;
+    UintSize cullSlot;
 
   public:
 
@@ -62,6 +65,9 @@ namespace GE
     Float getMaxDrawDistance ();
     virtual BoundingBox getBoundingBox() { return BoundingBox(); }
 
+    //True while the bounds wait on a resource being loaded
+    virtual bool isBoundsPending () { return false; }
+
     void setCastShadow (bool cast);
     bool getCastShadow ();
 
@@ -97,6 +103,8 @@ namespace GE
     virtual void begin () {}
     virtual void render (RenderTarget::Enum target) {}
     virtual void end () {}
+    virtual void enqueue (RenderQueue *queue, RenderTarget::Enum target,
+                          const Matrix4x4 &world, Float depth);
 
     //Invoked when loading after referenced resources are loaded
     virtual void onResourcesLoaded() {}
@@ -0,0 +1,457 @@
+#include "core/geAnimCompress.h"
+
+namespace GE
+{
+  /*
+  -----------------------------------------------------
+  Helpers
+  -----------------------------------------------------*/
+
+  //Smallest three components of a unit quaternion
+  //lie within [-1/sqrt(2), 1/sqrt(2)]
+  static const Float QuatRange = 0.70710678f;
+  static const Float QuatScale = 32767.0f;
+  static const Float QuatStep = 2.0f * QuatRange / 32767.0f;
+  static const Float Vec3Scale = 65535.0f;
+  static const Float Vec3Step = 1.0f / 65535.0f;
+
+  //Positions of the three stored components
+  //for each index of the dropped one
+  static const Uint QuatSmall[4][3] = {
+    {1,2,3}, {0,2,3}, {0,1,3}, {0,1,2} };
+
+  static Uint16 QuantizeUnit (Float v, Float scale)
+  {
+    //Map [0,1] to integer range with rounding
+    return (Uint16) (Util::Clamp( v, 0.0f, 1.0f ) * scale + 0.5f);
+  }
+
+  static UintSize FindSegment (const ArrayList <Uint16> &frames, Int frame)
+  {
+    //Stored keys are spread fairly evenly over the frames, so
+    //guess proportionally and walk to the last key at or
+    //before the frame
+    UintSize n = frames.size();
+    Float lastFrame = (Float) Util::Max( (Int) frames.last(), 1 );
+    Int guess = (Int) ((Float) frame * (Float) (n-1) / lastFrame);
+    UintSize k = (UintSize) Util::Clamp( guess, 0, (Int) n-1 );
+
+    while (k > 0 && (Int) frames[ k ] > frame) --k;
+    while (k+1 < n && (Int) frames[ k+1 ] <= frame) ++k;
+    return k;
+  }
+
+  static bool FindSegmentT (const ArrayList <Uint16> &frames,
+                            Int key1, Int key2, Float keyT,
+                            UintSize *outK, Float *outT)
+  {
+    //Find stored key before the sampled frame
+    UintSize k = FindSegment( frames, key1 );
+    *outK = k;
+    *outT = 0.0f;
+
+    //Past the last stored key
+    if (k + 1 >= frames.size())
+      return false;
+
+    //Fractional frame within the stored segment
+    Float frame = (Float) key1 + (key1 == key2 ? 0.0f : keyT);
+    Float f1 = (Float) frames[ k ];
+    Float f2 = (Float) frames[ k+1 ];
+    *outT = (frame - f1) / (f2 - f1);
+    return true;
+  }
+
+  static Float QuatError (const Quat &q1, const Quat &q2)
+  {
+    //Angle of the rotation between the two, from the chord
+    //length since the cosine of small angles rounds to 1
+    Float s = (Quat::Dot( q1, q2 ) < 0.0f) ? -1.0f : 1.0f;
+    Float dx = q1.x - s * q2.x, dy = q1.y - s * q2.y;
+    Float dz = q1.z - s * q2.z, dw = q1.w - s * q2.w;
+    Float chord = SQRT( dx*dx + dy*dy + dz*dz + dw*dw );
+    return 4.0f * ASIN( Util::Min( 0.5f * chord, 1.0f ));
+  }
+
+  static Float Vec3Error (const Vector3 &v1, const Vector3 &v2)
+  {
+    return (v1 - v2).norm();
+  }
+
+  /*
+  -----------------------------------------------------
+  CompactQuatAnimTrack
+  -----------------------------------------------------*/
+
+  void CompactQuatAnimTrack::Encode (const Quat &q, Uint16 *out)
+  {
+    const Float *c = &q.x;
+
+    //Find the largest component
+    Uint largest = 0;
+    for (Uint i=1; i<4; ++i)
+      if (fabsf( c[i] ) > fabsf( c[largest] ))
+        largest = i;
+
+    //q and -q are the same rotation so make it positive
+    Float sign = (c[largest] < 0.0f) ? -1.0f : 1.0f;
+
+    //Quantize the other three
+    Uint16 small[3]; Uint n = 0;
+    for (Uint i=0; i<4; ++i)
+    {
+      if (i == largest) continue;
+      Float unit = (sign * c[i] / QuatRange) * 0.5f + 0.5f;
+      small[ n++ ] = QuantizeUnit( unit, QuatScale );
+    }
+
+    //Pack index of the dropped component into the high bits
+    out[0] = small[0] | (Uint16) ((largest & 2) << 14);
+    out[1] = small[1] | (Uint16) ((largest & 1) << 15);
+    out[2] = small[2];
+  }
+
+  Quat CompactQuatAnimTrack::Decode (const Uint16 *in)
+  {
+    //Unpack index of the dropped component
+    Uint largest = ((in[0] >> 14) & 2) | ((in[1] >> 15) & 1);
+
+    //Dequantize the other three
+    Quat q; Float *c = &q.x;
+    const Uint *small = QuatSmall[ largest ];
+    Float a = (Float) (in[0] & 0x7FFF) * QuatStep - QuatRange;
+    Float b = (Float) (in[1] & 0x7FFF) * QuatStep - QuatRange;
+    Float d = (Float) (in[2] & 0x7FFF) * QuatStep - QuatRange;
+    c[ small[0] ] = a;
+    c[ small[1] ] = b;
+    c[ small[2] ] = d;
+
+    //Recover the dropped one from unit length
+    c[ largest ] = SQRT( Util::Max( 1.0f - a*a - b*b - d*d, 0.0f ));
+    return q;
+  }
+
+  Quat CompactQuatAnimTrack::decodeKey (UintSize k)
+  {
+    return Decode( keys.buffer() + k * 3 );
+  }
+
+  void CompactQuatAnimTrack::addKey (Int frame, const Quat &q)
+  {
+    Uint16 packed[3];
+    Encode( q, packed );
+
+    frames.pushBack( (Uint16) frame );
+    keys.pushBack( packed[0] );
+    keys.pushBack( packed[1] );
+    keys.pushBack( packed[2] );
+    numFrames = Util::Max( numFrames, frame + 1 );
+  }
+
+  void CompactQuatAnimTrack::setNumFrames (Int n)
+  {
+    numFrames = n;
+  }
+
+  UintSize CompactQuatAnimTrack::getNumStoredKeys ()
+  {
+    return frames.size();
+  }
+
+  UintSize CompactQuatAnimTrack::getMemorySize ()
+  {
+    return (frames.size() + keys.size()) * sizeof( Uint16 );
+  }
+
+  Int CompactQuatAnimTrack::getNumKeys ()
+  {
+    return numFrames;
+  }
+
+  UintSize CompactQuatAnimTrack::getValueSize ()
+  {
+    return sizeof( Quat );
+  }
+
+  void CompactQuatAnimTrack::sampleAt (Int key1, Int key2, Float keyT, void *outValue)
+  {
+    //Must have at least one key
+    if (frames.empty()) return;
+
+    //Decode just the two stored keys around the frame
+    UintSize k; Float t;
+    Quat *out = (Quat*) outValue;
+
+    if (FindSegmentT( frames, key1, key2, keyT, &k, &t ))
+      *out = QuatTrackTraits::Interpolate( decodeKey( k ), decodeKey( k+1 ), t );
+    else
+      *out = decodeKey( k );
+  }
+
+  void CompactQuatAnimTrack::evalAt (Int key1, Int key2, Float keyT)
+  {
+    sampleAt( key1, key2, keyT, &value );
+  }
+
+  void CompactQuatAnimTrack::getValue (void *outValue)
+  {
+    *((Quat*) outValue) = value;
+  }
+
+  Quat CompactQuatAnimTrack::getValue ()
+  {
+    return value;
+  }
+
+  /*
+  -----------------------------------------------------
+  CompactVec3AnimTrack
+  -----------------------------------------------------*/
+
+  void CompactVec3AnimTrack::setRange (const Vector3 &min, const Vector3 &max)
+  {
+    rangeMin = min;
+    rangeSize = max - min;
+  }
+
+  void CompactVec3AnimTrack::encode (const Vector3 &v, Uint16 *out)
+  {
+    const Float *c = &v.x;
+    const Float *cmin = &rangeMin.x;
+    const Float *csize = &rangeSize.x;
+
+    for (Uint i=0; i<3; ++i)
+    {
+      //Flat components are stored as zero
+      if (csize[i] <= 0.0f) out[i] = 0;
+      else out[i] = QuantizeUnit( (c[i] - cmin[i]) / csize[i], Vec3Scale );
+    }
+  }
+
+  Vector3 CompactVec3AnimTrack::decode (const Uint16 *in)
+  {
+    return Vector3(
+      rangeMin.x + rangeSize.x * ((Float) in[0] * Vec3Step),
+      rangeMin.y + rangeSize.y * ((Float) in[1] * Vec3Step),
+      rangeMin.z + rangeSize.z * ((Float) in[2] * Vec3Step) );
+  }
+
+  Vector3 CompactVec3AnimTrack::decodeKey (UintSize k)
+  {
+    return decode( keys.buffer() + k * 3 );
+  }
+
+  void CompactVec3AnimTrack::addKey (Int frame, const Vector3 &v)
+  {
+    Uint16 packed[3];
+    encode( v, packed );
+
+    frames.pushBack( (Uint16) frame );
+    keys.pushBack( packed[0] );
+    keys.pushBack( packed[1] );
+    keys.pushBack( packed[2] );
+    numFrames = Util::Max( numFrames, frame + 1 );
+  }
+
+  void CompactVec3AnimTrack::setNumFrames (Int n)
+  {
+    numFrames = n;
+  }
+
+  UintSize CompactVec3AnimTrack::getNumStoredKeys ()
+  {
+    return frames.size();
+  }
+
+  UintSize CompactVec3AnimTrack::getMemorySize ()
+  {
+    return (frames.size() + keys.size()) * sizeof( Uint16 ) + 2 * sizeof( Vector3 );
+  }
+
+  Int CompactVec3AnimTrack::getNumKeys ()
+  {
+    return numFrames;
+  }
+
+  UintSize CompactVec3AnimTrack::getValueSize ()
+  {
+    return sizeof( Vector3 );
+  }
+
+  void CompactVec3AnimTrack::sampleAt (Int key1, Int key2, Float keyT, void *outValue)
+  {
+    //Must have at least one key
+    if (frames.empty()) return;
+
+    //Decode just the two stored keys around the frame
+    UintSize k; Float t;
+    Vector3 *out = (Vector3*) outValue;
+
+    if (FindSegmentT( frames, key1, key2, keyT, &k, &t ))
+      *out = Vec3TrackTraits::Interpolate( decodeKey( k ), decodeKey( k+1 ), t );
+    else
+      *out = decodeKey( k );
+  }
+
+  void CompactVec3AnimTrack::evalAt (Int key1, Int key2, Float keyT)
+  {
+    sampleAt( key1, key2, keyT, &value );
+  }
+
+  void CompactVec3AnimTrack::getValue (void *outValue)
+  {
+    *((Vector3*) outValue) = value;
+  }
+
+  Vector3 CompactVec3AnimTrack::getValue ()
+  {
+    return value;
+  }
+
+  /*
+  -----------------------------------------------------
+  Key reduction. Starting from a kept key, the segment
+  is grown greedily for as long as interpolating the
+  quantized end keys reproduces every skipped frame
+  within tolerance. Kept keys are stored quantized as
+  well, so a track whose quantization alone misses the
+  tolerance is left at full precision.
+  -----------------------------------------------------*/
+
+  CompactQuatAnimTrack* AnimCompress::CompressTrack (QuatAnimTrack *track, Float tolerance)
+  {
+    Int numKeys = track->getNumKeys();
+    if (numKeys > GE_ANIM_COMPACT_MAX_KEYS) return NULL;
+
+    CompactQuatAnimTrack *outTrack = new CompactQuatAnimTrack;
+    if (numKeys == 0) return outTrack;
+
+    //Round-trip every key through quantization once
+    ArrayList <Quat> quantized;
+    for (Int k=0; k<numKeys; ++k)
+    {
+      Uint16 packed[3];
+      CompactQuatAnimTrack::Encode( track->getKey( k ), packed );
+      quantized.pushBack( CompactQuatAnimTrack::Decode( packed ));
+
+      if (QuatError( quantized.last(), track->getKey( k )) > tolerance) {
+        delete outTrack;
+        return NULL; }
+    }
+
+    Int start = 0;
+    outTrack->addKey( 0, track->getKey( 0 ));
+
+    while (start < numKeys - 1)
+    {
+      //Try to reach as far as possible from the last kept key
+      Int end = start + 1;
+      while (end + 1 < numKeys)
+      {
+        Int next = end + 1;
+        bool fits = true;
+
+        for (Int k=start+1; k<next && fits; ++k)
+        {
+          Float t = (Float) (k - start) / (Float) (next - start);
+          Quat q = QuatTrackTraits::Interpolate( quantized[ start ], quantized[ next ], t );
+          fits = QuatError( q, track->getKey( k )) <= tolerance;
+        }
+
+        if (!fits) break;
+        end = next;
+      }
+
+      outTrack->addKey( end, track->getKey( end ));
+      start = end;
+    }
+
+    outTrack->setNumFrames( numKeys );
+    return outTrack;
+  }
+
+  CompactVec3AnimTrack* AnimCompress::CompressTrack (Vec3AnimTrack *track, Float tolerance)
+  {
+    Int numKeys = track->getNumKeys();
+    if (numKeys > GE_ANIM_COMPACT_MAX_KEYS) return NULL;
+
+    CompactVec3AnimTrack *outTrack = new CompactVec3AnimTrack;
+    if (numKeys == 0) return outTrack;
+
+    //Find the range of the track
+    Vector3 min = track->getKey( 0 );
+    Vector3 max = track->getKey( 0 );
+    for (Int k=1; k<numKeys; ++k)
+    {
+      Vector3 v = track->getKey( k );
+      min.x = Util::Min( min.x, v.x ); max.x = Util::Max( max.x, v.x );
+      min.y = Util::Min( min.y, v.y ); max.y = Util::Max( max.y, v.y );
+      min.z = Util::Min( min.z, v.z ); max.z = Util::Max( max.z, v.z );
+    }
+    outTrack->setRange( min, max );
+
+    //Round-trip every key through quantization once
+    ArrayList <Vector3> quantized;
+    for (Int k=0; k<numKeys; ++k)
+    {
+      Uint16 packed[3];
+      outTrack->encode( track->getKey( k ), packed );
+      quantized.pushBack( outTrack->decode( packed ));
+
+      if (Vec3Error( quantized.last(), track->getKey( k )) > tolerance) {
+        delete outTrack;
+        return NULL; }
+    }
+
+    Int start = 0;
+    outTrack->addKey( 0, track->getKey( 0 ));
+
+    while (start < numKeys - 1)
+    {
+      //Try to reach as far as possible from the last kept key
+      Int end = start + 1;
+      while (end + 1 < numKeys)
+      {
+        Int next = end + 1;
+        bool fits = true;
+
+        for (Int k=start+1; k<next && fits; ++k)
+        {
+          Float t = (Float) (k - start) / (Float) (next - start);
+          Vector3 v = Vec3TrackTraits::Interpolate( quantized[ start ], quantized[ next ], t );
+          fits = Vec3Error( v, track->getKey( k )) <= tolerance;
+        }
+
+        if (!fits) break;
+        end = next;
+      }
+
+      outTrack->addKey( end, track->getKey( end ));
+      start = end;
+    }
+
+    outTrack->setNumFrames( numKeys );
+    return outTrack;
+  }
+
+  void AnimCompress::CompressAnimation (Animation *anim, Float toleranceR, Float toleranceT)
+  {
+    //Replace every full-precision track with a compact one
+    for (UintSize t=0; t<anim->getNumTracks(); ++t)
+    {
+      AnimTrack *track = anim->getTrack( t );
+      AnimTrack *outTrack = NULL;
+
+      if (ClassOf( track ) == ClassName( QuatAnimTrack ))
+        outTrack = CompressTrack( (QuatAnimTrack*) track, toleranceR );
+
+      else if (ClassOf( track ) == ClassName( Vec3AnimTrack ))
+        outTrack = CompressTrack( (Vec3AnimTrack*) track, toleranceT );
+
+      //Keep the original if it can't be compressed
+      if (outTrack != NULL)
+        anim->setTrack( t, outTrack );
+    }
+  }
+
+}//namespace GE
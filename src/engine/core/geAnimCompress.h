@@ -0,0 +1,144 @@
+#ifndef __GEANIMCOMPRESS_H
+#define __GEANIMCOMPRESS_H
+
+#include "util/geUtil.h"
+#include "math/geVectors.h"
+#include "core/geAnimation.h"
+
+#define GE_ANIM_COMPACT_MAX_KEYS 0xFFFF //Frame indices are stored in 16 bits
+
+namespace GE
+{
+
+  /*
+  ----------------------------------------------------------
+  Compact rotation track. Keys are stored sparsely with
+  their frame index and quantized to 48 bits using the
+  "smallest three" encoding: the largest component is
+  dropped and recovered from the unit length, the other
+  three are stored in 15 bits each and the 2-bit index of
+  the dropped component goes into the spare high bits.
+  ----------------------------------------------------------*/
+
+  class CompactQuatAnimTrack : public AnimTrack
+  {
+    CLASS( CompactQuatAnimTrack, AnimTrack,
+      5d0c8a43,1f7e,4b92,a6e13c58d0f4b271 );
+
+    virtual void serialize( Serializer *s, Uint v )
+    {
+      AnimTrack::serialize( s,v );
+      s->data( &numFrames );
+      s->dataArray( &frames );
+      s->dataArray( &keys );
+    }
+
+  private:
+
+    Quat value;
+    Int numFrames;
+    ArrayList <Uint16> frames;
+    ArrayList <Uint16> keys;
+
+    Quat decodeKey (UintSize k);
+
+  public:
+
+    CompactQuatAnimTrack () : numFrames (0) {}
+
+    static void Encode (const Quat &q, Uint16 *out);
+    static Quat Decode (const Uint16 *in);
+
+    void addKey (Int frame, const Quat &q);
+    void setNumFrames (Int n);
+    UintSize getNumStoredKeys ();
+    UintSize getMemorySize ();
+
+    virtual Int getNumKeys ();
+    virtual UintSize getValueSize ();
+    virtual void sampleAt (Int key1, Int key2, Float keyT, void *outValue);
+    virtual void evalAt (Int key1, Int key2, Float keyT);
+    virtual void getValue (void *outValue);
+    Quat getValue ();
+  };
+
+  /*
+  ----------------------------------------------------------
+  Compact translation track. Keys are stored sparsely with
+  their frame index and quantized to 16 bits per component
+  within the bounding range of the track.
+  ----------------------------------------------------------*/
+
+  class CompactVec3AnimTrack : public AnimTrack
+  {
+    CLASS( CompactVec3AnimTrack, AnimTrack,
+      a87e31f5,64c2,4d08,9b5f27e0c1a4d386 );
+
+    virtual void serialize( Serializer *s, Uint v )
+    {
+      AnimTrack::serialize( s,v );
+      s->data( &numFrames );
+      s->data( &rangeMin );
+      s->data( &rangeSize );
+      s->dataArray( &frames );
+      s->dataArray( &keys );
+    }
+
+  private:
+
+    Vector3 value;
+    Int numFrames;
+    Vector3 rangeMin;
+    Vector3 rangeSize;
+    ArrayList <Uint16> frames;
+    ArrayList <Uint16> keys;
+
+    Vector3 decodeKey (UintSize k);
+
+  public:
+
+    CompactVec3AnimTrack () : numFrames (0) {}
+
+    void setRange (const Vector3 &min, const Vector3 &max);
+    void encode (const Vector3 &v, Uint16 *out);
+    Vector3 decode (const Uint16 *in);
+
+    void addKey (Int frame, const Vector3 &v);
+    void setNumFrames (Int n);
+    UintSize getNumStoredKeys ();
+    UintSize getMemorySize ();
+
+    virtual Int getNumKeys ();
+    virtual UintSize getValueSize ();
+    virtual void sampleAt (Int key1, Int key2, Float keyT, void *outValue);
+    virtual void evalAt (Int key1, Int key2, Float keyT);
+    virtual void getValue (void *outValue);
+    Vector3 getValue ();
+  };
+
+  /*
+  ----------------------------------------------------------
+  Offline key reduction. Baked tracks are converted to the
+  compact format, dropping every key that can be recovered
+  by interpolating its neighbours within the given error
+  tolerance (radians for rotations, units for translations).
+  The error check covers the quantization of both kept and
+  skipped keys, so the bound holds for the data that is
+  actually stored. Tracks longer than
+  GE_ANIM_COMPACT_MAX_KEYS can't be indexed and tracks
+  whose keys don't quantize within tolerance are left at
+  full precision (CompressTrack returns NULL).
+  ----------------------------------------------------------*/
+
+  class AnimCompress
+  {
+  public:
+
+    static CompactQuatAnimTrack* CompressTrack (QuatAnimTrack *track, Float tolerance);
+    static CompactVec3AnimTrack* CompressTrack (Vec3AnimTrack *track, Float tolerance);
+    static void CompressAnimation (Animation *anim, Float toleranceR, Float toleranceT);
+  };
+
+
+}//namespace GE
+#endif//__GEANIMCOMPRESS_H
@@ -21,6 +21,14 @@ namespace GE
     tracks.pushBack( track );
   }
 
+  void Animation::setTrack (UintSize t, AnimTrack *track)
+  {
+    //Replacement starts at the same key
+    track->firstKey = tracks[ t ]->firstKey;
+    delete tracks[ t ];
+    tracks[ t ] = track;
+  }
+
   UintSize Animation::getNumTracks ()
   {
     return tracks.size();
@@ -42,6 +50,86 @@ namespace GE
     events.pushBack( e );
   }
 
+  void Animation::timeToKeys (Float t, Int *k1, Int *k2, Float *kt)
+  {
+    //Find 2 keys and interpolation coeff
+    Float fk = t * kps;
+    *k1 = (Int) FLOOR( fk );
+    *k2 = (Int) CEIL( fk );
+    *kt = fk - (Float) *k1;
+  }
+
+  void Animation::sample (Float time, AnimPose *pose)
+  {
+    //Make sure pose is laid out for these tracks
+    if (!pose->fits( this ))
+      pose->init( this );
+
+    //Find 2 keys and interpolation coeff
+    Int key1, key2; Float keyT;
+    timeToKeys( time, &key1, &key2, &keyT );
+
+    //Sample every track into the pose
+    for (UintSize t=0; t<tracks.size(); ++t)
+    {
+      Int localKey1, localKey2;
+      AnimTrack *track = tracks[ t ];
+      track->localizeKeys( key1, key2, &localKey1, &localKey2 );
+      track->sampleAt( localKey1, localKey2, keyT, pose->getValue( t ));
+    }
+  }
+
+
+  void AnimTrack::localizeKeys (Int k1, Int k2, Int *outK1, Int *outK2)
+  {
+    //Localize keys relative to animation track and clamp to range
+    *outK1 = Util::Clamp( k1 - firstKey, 0, (Int) getNumKeys()-1 );
+    *outK2 = Util::Clamp( k2 - firstKey, 0, (Int) getNumKeys()-1 );
+  }
+
+
+  void AnimPose::init (Animation *anim)
+  {
+    //Assign each track a 4-byte aligned slot
+    UintSize size = 0;
+    offsets.clear();
+
+    for (UintSize t=0; t<anim->getNumTracks(); ++t)
+    {
+      offsets.pushBack( size );
+      size += (anim->getTrack( t )->getValueSize() + 3) & ~((UintSize) 3);
+    }
+
+    values.clear();
+    values.resize( size );
+  }
+
+  bool AnimPose::fits (Animation *anim)
+  {
+    if (offsets.size() != anim->getNumTracks())
+      return false;
+
+    //Same track count can still mean other value types
+    UintSize size = 0;
+    for (UintSize t=0; t<offsets.size(); ++t)
+    {
+      if (offsets[ t ] != size) return false;
+      size += (anim->getTrack( t )->getValueSize() + 3) & ~((UintSize) 3);
+    }
+
+    return size == values.size();
+  }
+
+  UintSize AnimPose::getNumValues ()
+  {
+    return offsets.size();
+  }
+
+  void* AnimPose::getValue (UintSize track)
+  {
+    return values.buffer() + offsets[ track ];
+  }
+
 
   void AnimObserver::bindTrack (Animation *anim, UintSize track, Int param)
   {
@@ -123,6 +211,7 @@ namespace GE
 
     anim = a;
     maxTime = anim->duration;
+    pose.init( anim );
 
     freeBindings();
     createBindings();
@@ -225,12 +314,17 @@ namespace GE
   }
 
   void AnimController::tick ()
+  {
+    tick( Kernel::GetInstance()->getInterval() );
+  }
+
+  void AnimController::tick (Float interval)
   {
     if (!playing || paused)
       return;
 
     //Update animation time
-    animTime += Kernel::GetInstance()->getInterval() * playSpeed;
+    animTime += interval * playSpeed;
     
     //Check if animation has ended
     if (animTime > maxTime)
@@ -279,30 +373,19 @@ namespace GE
     evaluateAnimation();
   }
 
-  void AnimController::timeToKeys (Animation *a, Float t, Int *k1, Int *k2, Float *kt)
-  {
-    //Find 2 keys and interpolation coeff
-    Float fk = t * anim->kps;
-    *k1 = (Int) FLOOR( fk );
-    *k2 = (Int) CEIL( fk );
-    *kt = fk - (Float) *k1;
-  }
-
-  void AnimController::localizeKeys (AnimTrack *t, Int k1, Int k2, Int *outK1, Int *outK2)
-  {
-    //Localize keys relative to animation track and clamp to range
-    *outK1 = Util::Clamp( k1 - t->firstKey, 0, (Int) t->getNumKeys()-1 );
-    *outK2 = Util::Clamp( k2 - t->firstKey, 0, (Int) t->getNumKeys()-1 );
-  }
-
   void AnimController::evaluateAnimation ()
   {
     //Must have an animation bound
     if (anim == NULL) return;
+
+    //Track values are only needed by observers. Without any,
+    //leave the shared tracks alone and let the owner sample
+    //into its own pose instead.
+    if (observers.empty()) return;
     
     //Find 2 keys and interpolation coeff
     Int key1, key2; Float keyT;
-    timeToKeys( anim, animTime, &key1, &key2, &keyT );
+    anim->timeToKeys( animTime, &key1, &key2, &keyT );
 
     //Walk the list of tracks under current key
     for (TrackIter ti = tracksOnKey.begin(); ti != tracksOnKey.end(); )
@@ -361,7 +444,7 @@ namespace GE
     //Evaluate track at current time
     Int localKey1, localKey2;
     AnimTrack *track = anim->tracks[ t ];
-    localizeKeys( track, key1, key2, &localKey1, &localKey2 );
+    track->localizeKeys( key1, key2, &localKey1, &localKey2 );
     track->evalAt( localKey1, localKey2, keyT );
 
     //Get the observer of this track
@@ -385,7 +468,7 @@ namespace GE
 
     //Get two keys 
     Int k1, k2; Float kt;
-    timeToKeys( anim, time, &k1, &k2, &kt );
+    anim->timeToKeys( time, &k1, &k2, &kt );
 
     //Evaluate all tracks at given time
     for (UintSize t=0; t<anim->tracks.size(); ++t)
@@ -396,4 +479,17 @@ namespace GE
       observers[ o ]->onAnyValueChanged();
   }
 
+  void AnimController::samplePose ()
+  {
+    if (anim == NULL) return;
+
+    //Sample at current time into the controller's own pose
+    anim->sample( animTime, &pose );
+  }
+
+  AnimPose* AnimController::getPose ()
+  {
+    return &pose;
+  }
+
 }//namespace GE
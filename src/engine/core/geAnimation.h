@@ -13,6 +13,7 @@ namespace GE
   -----------------------------------*/
 
   class Animation;
+  class AnimPose;
   class AnimTrack;
   class AnimEvent;
   class AnimObserver;
@@ -104,8 +105,12 @@ namespace GE
 
     AnimTrack () : firstKey (0) {}
     virtual Int getNumKeys () = 0;
+    virtual UintSize getValueSize () = 0;
+    virtual void sampleAt (Int key1, Int key2, Float keyT, void *outValue) = 0;
     virtual void evalAt (Int key1, Int key2, Float keyT) = 0;
     virtual void getValue (void *value) {}
+
+    void localizeKeys (Int k1, Int k2, Int *outK1, Int *outK2);
   };
 
   /*
@@ -133,8 +138,11 @@ namespace GE
   public:
 
     void addKey( typename Traits::Value value );
+    typename Traits::Value getKey (Int key);
     virtual Int getNumKeys ();
+    virtual UintSize getValueSize ();
 
+    virtual void sampleAt (Int key1, Int key2, Float keyT, void *outValue);
     virtual void evalAt (Int key1, Int key2, Float keyT);
     virtual void getValue (void *value);
     virtual typename Traits::Value getValue ();
@@ -146,33 +154,48 @@ namespace GE
   ----------------------------------------------------------*/
 
   template <class Traits>
-  typename void AnimTrackT<Traits>::evalAt (Int key1, Int key2, Float keyT)
+  void AnimTrackT<Traits>::sampleAt (Int key1, Int key2, Float keyT, void *outValue)
   {
     //Must have at least one key
     if (keys.empty()) return;
 
+    //Output goes to caller's storage, track is left untouched
+    typename Traits::Value *out = (typename Traits::Value*) outValue;
+
     //Check if keys the same
     if (key1 == key2)
     {
       //Return exact key value
-      value = keys[ key1 ];
+      *out = keys[ key1 ];
     }
     else
     {
       //Interpolate between two key values
-      value = Traits::Interpolate(
+      *out = Traits::Interpolate(
         keys[ key1 ],
         keys[ key2 ],
         keyT );
     }
   }
 
+  template <class Traits>
+  typename void AnimTrackT<Traits>::evalAt (Int key1, Int key2, Float keyT)
+  {
+    sampleAt( key1, key2, keyT, &value );
+  }
+
   template <class Traits>
   void AnimTrackT< Traits >::addKey (typename Traits::Value value)
   {
     keys.pushBack( value );
   }
 
+  template <class Traits>
+  typename Traits::Value AnimTrackT< Traits >::getKey (Int key)
+  {
+    return keys[ key ];
+  }
+
   template <class Traits>
   void AnimTrackT< Traits >::getValue (void *outValue)
   {
@@ -191,6 +214,12 @@ namespace GE
     return (Int) keys.size();
   }
 
+  template <class Traits>
+  UintSize AnimTrackT< Traits >::getValueSize ()
+  {
+    return sizeof( typename Traits::Value );
+  }
+
 
   /*
   -------------------------------------------
@@ -263,6 +292,29 @@ namespace GE
   TEMPLATE_CLASS( FloatAnimTrack, AnimTrack, 3412ea4f,2111,481b,bded7f3c19a3b1f1 );
   TEMPLATE_CLASS( BoolAnimTrack,  AnimTrack, 9430611b,8001,47fe,8f4045e94c48b1ad );
 
+  /*
+  --------------------------------------------------------
+  Pose holds one sampled value per animation track. It is
+  owned by whoever samples the animation (normally the
+  controller), so any number of instances can sample the
+  same Animation at different times from any thread.
+  --------------------------------------------------------*/
+
+  class AnimPose
+  {
+  private:
+    ArrayList <Uint8> values;
+    ArrayList <UintSize> offsets;
+
+  public:
+    void init (Animation *anim);
+
+    //Whether the slots match the value sizes of the tracks
+    bool fits (Animation *anim);
+    UintSize getNumValues ();
+    void* getValue (UintSize track);
+  };
+
   /*
   --------------------------------------------------
   Animation is a collection of tracks.
@@ -302,11 +354,15 @@ namespace GE
     virtual ~Animation ();
 
     void addTrack (AnimTrack *track, Int atKey = 0);
+    void setTrack (UintSize t, AnimTrack *track);
     AnimTrack* getTrack (UintSize t);
     UintSize getNumTracks ();
 
     void addObserver (AnimObserver *o);
     void addEvent (AnimEvent *e);
+
+    void timeToKeys (Float time, Int *k1, Int *k2, Float *kt);
+    void sample (Float time, AnimPose *pose);
   };
 
   /*
@@ -486,11 +542,12 @@ namespace GE
     ArrayList< AnimObserver* > observersOnKey;
     ArrayList< AnimObserver* > observers;
 
-    void timeToKeys (Animation *a, Float t, Int *k1, Int *k2, Float *kt);
-    void localizeKeys (AnimTrack *t, Int k1, Int k2, Int *outK1, Int *outK2);
     void evaluateAnimation ();
     void evaluateTrack (UintSize track, Int key1, Int key2, Float keyT);
 
+    //Sampled values
+    AnimPose pose;
+
     //Callbacks
     AnimCallbackFunc endFunc;
     void *endParam;
@@ -503,6 +560,8 @@ namespace GE
     void bindAnimation (Animation *a);
     void bindObserver (AnimObserver *o);
     void observeAt (Float time);
+    void samplePose ();
+    AnimPose* getPose ();
 
     void play (Int nloops = 0, Float speed = 1.0f, Float from = 0.0);
     void pause ();
@@ -510,6 +569,7 @@ namespace GE
     void toggle ();
     void stop ();
     void tick ();
+    void tick (Float interval);
 
     void setTime (Float time);
     void setSpeed (Float speed);
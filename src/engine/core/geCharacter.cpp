@@ -23,6 +23,14 @@ namespace GE
       delete anims[ a ];
   }
 
+  UintSize Character::getByteSize ()
+  {
+    UintSize size = sizeof( Character );
+    for (UintSize m=0; m<meshes.size(); ++m)
+      size += meshes[ m ]->getByteSize();
+    return size;
+  }
+
   Animation* Character::findAnimByName (const CharString &name)
   {
     for (UintSize a=0; a < anims.size(); ++a)
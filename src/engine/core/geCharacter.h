@@ -44,6 +44,7 @@ namespace GE
     ~Character ();
 
     Animation* findAnimByName (const CharString &name);
+    virtual UintSize getByteSize ();
   };
 
 
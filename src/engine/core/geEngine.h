@@ -13,6 +13,7 @@
 #include "geSkinMesh.h"
 #include "geSkinPose.h"
 #include "geSkinAnim.h"
+#include "geAnimCompress.h"
 #include "geCharacter.h"
 
 #include "geTexture.h"
@@ -23,7 +24,10 @@
 #include "gePolyMesh.h"
 #include "geTexMesh.h"
 #include "geTriMesh.h"
+#include "geMeshSimplify.h"
+#include "geMeshOptimize.h"
 #include "gePrimitives.h"
+#include "geObjReader.h"
 
 //Actors
 #include "geActor.h"
@@ -42,8 +46,13 @@
 
 //Loading & rendering
 #include "geRenderer.h"
+#include "geRenderQueue.h"
+#include "geShaderCache.h"
+#include "geShaderComposer.h"
 #include "geShaders.h"
 #include "geKernel.h"
+#include "geResourceLoader.h"
+#include "geScenePackage.h"
 
 //Controllers
 #include "geController.h"
@@ -112,6 +112,10 @@ typedef void
   (APIENTRY *GE_PFGLGENBUFFERS)
   (GLsizei n, GLuint * buffers);
 
+typedef void
+  (APIENTRY *GE_PFGLDELETEBUFFERS)
+  (GLsizei n, const GLuint * buffers);
+
 typedef void
   (APIENTRY *GE_PFGLBINDBUFFER)
   (GLenum target, GLuint buffer);
@@ -515,6 +519,7 @@ extern GE_PFGLMULTITEXCOORD2F           GE_glMultiTexCoord2f;
 
 #ifndef GL_VERSION_1_5
 extern GE_PFGLGENBUFFERS                GE_glGenBuffers;
+extern GE_PFGLDELETEBUFFERS             GE_glDeleteBuffers;
 extern GE_PFGLBINDBUFFER                GE_glBindBuffer;
 extern GE_PFGLBUFFERDATA                GE_glBufferData;
 extern GE_PFGLBUFFERSUBDATA             GE_glBufferSubData;
@@ -612,6 +617,7 @@ Function re-routing
 
 #ifndef GL_VERSION_1_5
 #define glGenBuffers                GE_glGenBuffers
+#define glDeleteBuffers             GE_glDeleteBuffers
 #define glBindBuffer                GE_glBindBuffer
 #define glBufferData                GE_glBufferData
 #define glBufferSubData             GE_glBufferSubData
@@ -144,71 +144,98 @@ namespace GE
   void HMesh::setClasses (Class cnVertex, Class cnHedge,
                           Class cnEdge, Class cnFace)
   {
-    classVertex = cnVertex;
-    classHalfEdge = cnHedge;
-    classEdge = cnEdge;
-    classFace = cnFace;
+    verts.setClass( cnVertex );
+    hedges.setClass( cnHedge );
+    edges.setClass( cnEdge );
+    faces.setClass( cnFace );
+  }
+
+  UintSize HMesh::getByteSize()
+  {
+    return verts.getByteSize() + hedges.getByteSize() +
+      edges.getByteSize() + faces.getByteSize();
   }
 
   /*
   ---------------------------------------------
-  Entity insertion and removal functions.
-  These make sure that entities have proper
-  handles to list nodes for removal and
-  store them into invalidation lists when
-  removed by mesh operations.
+  Entity construction, insertion and removal
+  functions. New entities are constructed in
+  a free slot and join the mesh once inserted.
+  Removed ones are marked invalid and keep
+  their slot until clearInvalid.
   ---------------------------------------------*/
 
+  Vertex* HMesh::newVertex() {
+    Uint32 index = 0;
+    Vertex *v = (Vertex*) verts.alloc( &index );
+    v->index = index;
+    return v;
+  }
+
+  HalfEdge* HMesh::newHalfEdge() {
+    Uint32 index = 0;
+    HalfEdge *he = (HalfEdge*) hedges.alloc( &index );
+    he->index = index;
+    return he;
+  }
+
+  Edge* HMesh::newEdge() {
+    Uint32 index = 0;
+    Edge *e = (Edge*) edges.alloc( &index );
+    e->index = index;
+    return e;
+  }
+
+  Face* HMesh::newFace() {
+    Uint32 index = 0;
+    Face *f = (Face*) faces.alloc( &index );
+    f->index = index;
+    return f;
+  }
+
   void HMesh::insertVert(Vertex *v) {
-    v->handle = verts.pushBack(v);
+    verts.insert(v->index);
   }
   
   void HMesh::insertHalfEdge(HalfEdge *he) {
-    he->handle = hedges.pushBack(he);
+    hedges.insert(he->index);
   }
   
   void HMesh::insertEdge(Edge *e) {
-    e->handle = edges.pushBack(e);
+    edges.insert(e->index);
   }
   
   void HMesh::insertFace(Face *f) {
-    f->handle = faces.pushBack(f);
+    faces.insert(f->index);
   }
   
-  ListHandle HMesh::deleteVert(Vertex *v) {
+  void HMesh::deleteVert(Vertex *v) {
     v->valid = false;
-    invalid_verts.pushBack(v);
-    return verts.removeAt(v->handle);
+    verts.remove(v->index);
   }
   
-  ListHandle HMesh::deleteHalfEdge(HalfEdge *he) {
+  void HMesh::deleteHalfEdge(HalfEdge *he) {
     he->valid = false;
-    invalid_hedges.pushBack(he);
-    return hedges.removeAt(he->handle);
+    hedges.remove(he->index);
   }
   
-  ListHandle HMesh::deleteEdge(Edge *e) {
+  void HMesh::deleteEdge(Edge *e) {
     e->valid = false;
-    invalid_edges.pushBack(e);
-    return edges.removeAt(e->handle);
+    edges.remove(e->index);
   }
   
-  ListHandle HMesh::deleteFace(Face *f) {
+  void HMesh::deleteFace(Face *f) {
     f->valid = false;
-    invalid_faces.pushBack(f);
-    return faces.removeAt(f->handle);
+    faces.remove(f->index);
   }
   
   void HMesh::deleteEdgeWhole(Edge *e) {
     e->valid = false;
     e->hedge->valid = false;
     e->hedge->twin->valid = false;
-    edges.removeAt(e->handle);
-    hedges.removeAt(e->hedge->handle);
-    hedges.removeAt(e->hedge->twin->handle);
-    invalid_edges.pushBack(e);
-    invalid_hedges.pushBack(e->hedge);
-    invalid_hedges.pushBack(e->hedge->twin);
+    edges.remove(e->index);
+    hedges.remove(e->hedge->index);
+    hedges.remove(e->hedge->twin->index);
   }
 
   /*
@@ -219,22 +246,10 @@ namespace GE
 
   void HMesh::clearInvalid()
   {
-    for (ListHandle v=invalid_verts.begin();
-        v!=invalid_verts.end(); ++v) delete (Vertex*)*v;
-    
-    for (ListHandle he=invalid_hedges.begin();
-        he!=invalid_hedges.end(); ++he) delete (HalfEdge*)*he;
-    
-    for (ListHandle e=invalid_edges.begin();
-        e!=invalid_edges.end(); ++e) delete (Edge*)*e;
-    
-    for (ListHandle f=invalid_faces.begin();
-        f!=invalid_faces.end(); ++f) delete (Face*)*f;
-    
-    invalid_verts.clear();
-    invalid_hedges.clear();
-    invalid_edges.clear();
-    invalid_faces.clear();
+    verts.destroyRemoved();
+    hedges.destroyRemoved();
+    edges.destroyRemoved();
+    faces.destroyRemoved();
   }
 
   /*
@@ -245,20 +260,6 @@ namespace GE
 
   void HMesh::clear()
   {
-    clearInvalid();
-    
-    for (ListHandle v=verts.begin();
-        v!=verts.end(); ++v) delete (Vertex*)*v;
-    
-    for (ListHandle he=hedges.begin();
-        he!=hedges.end(); ++he) delete (HalfEdge*)*he;
-    
-    for (ListHandle e=edges.begin();
-        e!=edges.end(); ++e) delete (Edge*)*e;
-    
-    for (ListHandle f=faces.begin();
-        f!=faces.end(); ++f) delete (Face*)*f;
-    
     verts.clear();
     hedges.clear();
     edges.clear();
@@ -268,33 +269,31 @@ namespace GE
   /*
   -------------------------------------------------------------
   Transfers the mesh entities from given HMesh to this one
-  adding them to existing mesh structure. Just the pointers
-  to entities are transfered without actually copying their
-  data. The given mesh structured is empty after the function
-  returns. This is the fastest way to merge two meshes.
+  adding them to existing mesh structure. The storage blocks
+  are handed over without actually copying the entities, so
+  both meshes must be of the same type. The given mesh
+  structure is empty after the function returns. This is
+  the fastest way to merge two meshes.
   -------------------------------------------------------------*/
 
   void HMesh::mergeWith(HMesh *mesh)
   {
-    //transfer data from [mesh] to [this] and readjust handles
-    for (ListHandle v=mesh->verts.begin(); v!=mesh->verts.end(); ++v) {
-      ((Vertex*)(*v))->handle = verts.pushBack(*v);
-    }
-    for (ListHandle h=mesh->hedges.begin(); h!=mesh->hedges.end(); ++h) {
-      ((HalfEdge*)(*h))->handle = hedges.pushBack(*h);;
-    }
-    for (ListHandle e=mesh->edges.begin(); e!=mesh->edges.end(); ++e) {
-      ((Edge*)(*e))->handle = edges.pushBack(*e);;
-    }
-    for (ListHandle f=mesh->faces.begin(); f!=mesh->faces.end(); ++f) {
-      ((Face*)(*f))->handle = faces.pushBack(*f);
-    }
-    
-    //clear [mesh]
-    mesh->verts.clear();
-    mesh->hedges.clear();
-    mesh->edges.clear();
-    mesh->faces.clear();
+    //transfer blocks from [mesh] to [this] and readjust indices
+    Uint32 offset = verts.moveFrom( &mesh->verts );
+    for (Uint32 v=offset; v<verts.end(); ++v)
+      if (verts.isUsed(v)) ((Vertex*) verts.at(v))->index = v;
+
+    offset = hedges.moveFrom( &mesh->hedges );
+    for (Uint32 h=offset; h<hedges.end(); ++h)
+      if (hedges.isUsed(h)) ((HalfEdge*) hedges.at(h))->index = h;
+
+    offset = edges.moveFrom( &mesh->edges );
+    for (Uint32 e=offset; e<edges.end(); ++e)
+      if (edges.isUsed(e)) ((Edge*) edges.at(e))->index = e;
+
+    offset = faces.moveFrom( &mesh->faces );
+    for (Uint32 f=offset; f<faces.end(); ++f)
+      if (faces.isUsed(f)) ((Face*) faces.at(f))->index = f;
   }
 
   /*
@@ -414,28 +413,28 @@ namespace GE
     //generate vertices
     Vertex **pointerVert = new Vertex*[countVert];
     for (v=0; v<countVert; ++v) {
-      pointerVert[v] = (Vertex*)classVertex->instantiate();
+      pointerVert[v] = newVertex();
       insertVert(pointerVert[v]);
     }
     
     //generate half-edges
     HalfEdge **pointerHedge = new HalfEdge*[countHedge];
     for (he=0; he<countHedge; ++he) {
-      pointerHedge[he] = (HalfEdge*)classHalfEdge->instantiate();
+      pointerHedge[he] = newHalfEdge();
       insertHalfEdge(pointerHedge[he]);
     }
     
     //generate edges
     Edge **pointerEdge = new Edge*[countEdge];
     for (e=0; e<countEdge; ++e) {
-      pointerEdge[e] = (Edge*)classEdge->instantiate();
+      pointerEdge[e] = newEdge();
       insertEdge(pointerEdge[e]);
     }
     
     //generate faces
     Face **pointerFace = new Face*[countFace];
     for (f=0; f<countFace; ++f) {
-      pointerFace[f] = (Face*)classFace->instantiate();
+      pointerFace[f] = newFace();
       insertFace(pointerFace[f]);
     }
     
@@ -530,7 +529,7 @@ namespace GE
 
   Vertex* HMesh::addVertex()
   {
-    Vertex *vert = (Vertex*)classVertex->instantiate();
+    Vertex *vert = newVertex();
     vert->hedge = NULL;
     insertVert(vert);
     return vert;
@@ -719,7 +718,7 @@ namespace GE
     }
     
     //Create new face of specified class
-    Face *face = (Face*)classFace->instantiate();
+    Face *face = newFace();
         
     //these lists hold outgoing adjacent edges with no face
     //for each vertex after generation of new edges
@@ -760,8 +759,8 @@ namespace GE
       }else{
         
         //create two half-edges
-        HalfEdge *eIn = (HalfEdge*)classHalfEdge->instantiate();
-        HalfEdge *eOut = (HalfEdge*)classHalfEdge->instantiate();
+        HalfEdge *eIn = newHalfEdge();
+        HalfEdge *eOut = newHalfEdge();
         eIn->vert = vertices[i1];
         eOut->vert = vertices[i2];
         eIn->twin = eOut;
@@ -771,7 +770,7 @@ namespace GE
         insertHalfEdge(eIn);
         insertHalfEdge(eOut);
         //create full-edge
-        Edge *edge = (Edge*)classEdge->instantiate();
+        Edge *edge = newEdge();
         edge->hedge = eOut;
         eIn->edge = edge;
         eOut->edge = edge;
@@ -854,10 +853,10 @@ namespace GE
       return false;
 
     //Create new entities
-    HalfEdge *newHedge1 = (HalfEdge*) classHalfEdge->instantiate();
-    HalfEdge *newHedge2 = (HalfEdge*) classHalfEdge->instantiate();
-    Edge *newEdge = (Edge*) classEdge->instantiate();
-    Face *newFace = (Face*) classFace->instantiate();
+    HalfEdge *newHedge1 = newHalfEdge();
+    HalfEdge *newHedge2 = newHalfEdge();
+    Edge *newEdge = this->newEdge();
+    Face *newFace = this->newFace();
 
     //Setup new entities
     newHedge1->vert = vert1;
@@ -3,6 +3,7 @@
 
 #include "util/geUtil.h"
 #include "geResource.h"
+#include "geHmeshStorage.h"
 
 #pragma warning(push)
 #pragma warning(disable:4251)
@@ -10,8 +11,6 @@
 namespace GE
 {
 
-  typedef LinkedList<void*>::Iterator ListHandle;
-
   //a helper for various operations
   union ItemTag {
     void* ptr;
@@ -41,9 +40,9 @@ namespace GE
 
     public:
       ItemTag tag;
-      ListHandle handle;
-      HalfEdge *hedge;
+      Uint32 index;
       bool valid;
+      HalfEdge *hedge;
       
       Vertex(): valid(true), hedge(NULL) {}
       virtual ~Vertex() {}
@@ -67,14 +66,14 @@ namespace GE
 
     public:
       ItemTag tag;
-      ListHandle handle;
+      Uint32 index;
+      bool valid;
       HalfEdge *twin;
       HalfEdge *next;
       HalfEdge *prev;
       Vertex *vert;
       Edge *edge;
       Face *face;
-      bool valid;
       
       HalfEdge(): valid(true),
         twin(NULL), next(NULL), prev(NULL),
@@ -107,9 +106,9 @@ namespace GE
 
     public:
       ItemTag tag;
-      ListHandle handle;
-      HalfEdge *hedge;
+      Uint32 index;
       bool valid;
+      HalfEdge *hedge;
       
       Edge(): valid(true),
         hedge(NULL) {}
@@ -133,9 +132,9 @@ namespace GE
       
     public:
       ItemTag tag;
-      ListHandle handle;
-      HalfEdge *hedge;
+      Uint32 index;
       bool valid;
+      HalfEdge *hedge;
 
       Face(): valid(true),
         hedge(NULL) {}
@@ -174,12 +173,6 @@ namespace GE
     Classes to be used when entities are constructed
     ------------------------------------------------*/
     
-  private:
-    Class classVertex;
-    Class classHalfEdge;
-    Class classEdge;
-    Class classFace;
-    
   public:
     void setClasses(Class cnVertex, Class cnHedge,
                     Class cnEdge, Class cnFace);
@@ -187,29 +180,16 @@ namespace GE
     /*
     -------------------------------------------------
     Main data collections, holding all the entities
-    that define the mesh structure.
+    that define the mesh structure. Each type lives
+    in contiguous blocks and an entity knows its slot
+    by the index member.
     -------------------------------------------------*/
 
-    LinkedList<void*> verts;
-    LinkedList<void*> hedges;
-    LinkedList<void*> edges;
-    LinkedList<void*> faces;
+    HMeshArray verts;
+    HMeshArray hedges;
+    HMeshArray edges;
+    HMeshArray faces;
     
-    /*
-    ----------------------------------------------------
-    The entities removed as a result of certain mesh
-    operations (e.g. WeldVertices) are marked invalid
-    and temporarily stored into invalidation collections
-    rather then being immediately deleted from memory.
-    This allows user to get rid of its own pointers to
-    invalid entities after invoking mesh operations
-    ----------------------------------------------------*/
-
-    LinkedList<void*> invalid_verts;
-    LinkedList<void*> invalid_hedges;
-    LinkedList<void*> invalid_edges;
-    LinkedList<void*> invalid_faces;
-
     /*
     ---------------------------------------------
     Constructor
@@ -219,10 +199,11 @@ namespace GE
 
     HMesh()
     {
-      classVertex = ClassName( Vertex );
-      classHalfEdge = ClassName( HalfEdge );
-      classEdge = ClassName( Edge );
-      classFace = ClassName( Face );
+      setClasses(
+        ClassName( Vertex ),
+        ClassName( HalfEdge ),
+        ClassName( Edge ),
+        ClassName( Face ));
     }
     
     /*
@@ -231,37 +212,48 @@ namespace GE
     currently in the mesh structure.
     ---------------------------------------------*/
 
-    INLINE int vertexCount() {return verts.size();}
-    INLINE int hedgeCount() {return hedges.size();}
-    INLINE int edgeCount() {return edges.size();}
-    INLINE int faceCount() {return faces.size();}
+    INLINE int vertexCount() {return (int) verts.size();}
+    INLINE int hedgeCount() {return (int) hedges.size();}
+    INLINE int edgeCount() {return (int) edges.size();}
+    INLINE int faceCount() {return (int) faces.size();}
+
+    //Bytes held by the entity storage
+    UintSize getByteSize();
     
     /*
     ---------------------------------------------
-    Entity insertion and removal functions.
-    These make sure that entities have proper
-    handles to list nodes for removal and
-    store them into invalidation lists when
-    removed by mesh operations.
+    Entity construction, insertion and removal
+    functions. New entities are constructed in
+    a free slot and join the mesh once inserted.
+    Removed ones are marked invalid and keep
+    their slot until clearInvalid.
     ---------------------------------------------*/
 
   protected:
 
+    Vertex* newVertex();
+    HalfEdge* newHalfEdge();
+    Edge* newEdge();
+    Face* newFace();
+
     virtual void insertVert(Vertex *v);
     virtual void insertHalfEdge(HalfEdge *he);
     virtual void insertEdge(Edge *e);
     virtual void insertFace(Face *f);
     
-    virtual ListHandle deleteVert(Vertex *v);
-    virtual ListHandle deleteHalfEdge(HalfEdge *he);
-    virtual ListHandle deleteEdge(Edge *e);
-    virtual ListHandle deleteFace(Face *f);
+    virtual void deleteVert(Vertex *v);
+    virtual void deleteHalfEdge(HalfEdge *he);
+    virtual void deleteEdge(Edge *e);
+    virtual void deleteFace(Face *f);
     virtual void deleteEdgeWhole(Edge *e);
 
     /*
     -----------------------------------------------
     Finally deletes the invalidated mesh entities
-    which were removed by mesh operations
+    which were removed by mesh operations (e.g.
+    WeldVertices). Until then they stay in memory
+    so the user can get rid of its own pointers
+    to them, and their slots aren't reused.
     -----------------------------------------------*/
 
   public:    
@@ -287,10 +279,11 @@ namespace GE
     /*
     -------------------------------------------------------------
     Transfers the mesh entities from given HMesh to this one
-    adding them to existing mesh structure. Just the pointers
-    to entities are transfered without actually copying their
-    data. The given mesh structured is empty after the function
-    returns. This is the fastest way to merge two meshes.
+    adding them to existing mesh structure. The storage blocks
+    are handed over without actually copying the entities, so
+    both meshes must be of the same type. The given mesh
+    structure is empty after the function returns. This is
+    the fastest way to merge two meshes.
     -------------------------------------------------------------*/
 
     void mergeWith (HMesh *mesh);
@@ -2,7 +2,7 @@ class VertIter
 {
 private:
   HMesh *mesh;
-  ListHandle it;
+  Uint32 it;
   
 public:
 
@@ -14,42 +14,42 @@ public:
     begin(mesh);
   };
   
-  VertIter(HMesh *mesh, const ListHandle &it) {
+  VertIter(HMesh *mesh, Uint32 it) {
     begin(mesh, it);
   }
 
   void begin(HMesh *mesh) {
     this->mesh = mesh;
     if (mesh != NULL)
-      this->it = mesh->verts.begin();
+      this->it = mesh->verts.first();
   }
 
-  void begin(HMesh *mesh, const ListHandle &it) {
+  void begin(HMesh *mesh, Uint32 it) {
     this->mesh = mesh;
     this->it = it;
   }
   
   VertIter& operator++() {
     if (mesh != NULL)
-      if (it != mesh->verts.end())
-        ++it;
+      if (it < mesh->verts.end())
+        it = mesh->verts.next( it );
     return *this;
   }
 
   bool end() {
     if (mesh == NULL) return true;
-    return (it == mesh->verts.end());
+    return (it >= mesh->verts.end());
   }
 
   Vertex* operator*() const {
     if (mesh != NULL)
-      if (it != mesh->verts.end())
-        return (Vertex*)*it;
+      if (it < mesh->verts.end())
+        return (Vertex*) mesh->verts.at( it );
     return NULL;
   }
 
   Vertex* operator->() const {
-    return (Vertex*)*it;
+    return (Vertex*) mesh->verts.at( it );
   }
 };
 
@@ -58,7 +58,7 @@ class HedgeIter
 {
 private:
   HMesh *mesh;
-  ListHandle it;
+  Uint32 it;
   
 public:
 
@@ -70,42 +70,42 @@ public:
     begin(mesh);
   };
   
-  HedgeIter(HMesh *mesh, const ListHandle &it) {
+  HedgeIter(HMesh *mesh, Uint32 it) {
     begin(mesh, it);
   }
 
   void begin(HMesh *mesh) {
     this->mesh = mesh;
     if (mesh != NULL)
-      this->it = mesh->hedges.begin();
+      this->it = mesh->hedges.first();
   }
 
-  void begin(HMesh *mesh, const ListHandle &it) {
+  void begin(HMesh *mesh, Uint32 it) {
     this->mesh = mesh;
     this->it = it;
   }
   
   HedgeIter& operator++() {
     if (mesh != NULL)
-      if (it != mesh->hedges.end())
-        ++it;
+      if (it < mesh->hedges.end())
+        it = mesh->hedges.next( it );
     return *this;
   }
 
   bool end() {
     if (mesh == NULL) return true;
-    return (it == mesh->hedges.end());
+    return (it >= mesh->hedges.end());
   }
 
   HalfEdge* operator*() const {
     if (mesh != NULL)
-      if (it != mesh->hedges.end())
-        return (HalfEdge*)*it;
+      if (it < mesh->hedges.end())
+        return (HalfEdge*) mesh->hedges.at( it );
     return NULL;
   }
 
   HalfEdge* operator->() const {
-    return (HalfEdge*)*it;
+    return (HalfEdge*) mesh->hedges.at( it );
   }
 };
 
@@ -114,7 +114,7 @@ class EdgeIter
 {
 private:
   HMesh *mesh;
-  ListHandle it;
+  Uint32 it;
   
 public:
 
@@ -126,42 +126,42 @@ public:
     begin(mesh);
   }
   
-  EdgeIter(HMesh *mesh, const ListHandle &it) {
+  EdgeIter(HMesh *mesh, Uint32 it) {
     begin(mesh, it);
   }
 
   void begin(HMesh *mesh) {
     this->mesh = mesh;
     if (mesh != NULL)
-      this->it = mesh->edges.begin();
+      this->it = mesh->edges.first();
   }
 
-  void begin(HMesh *mesh, const ListHandle &it) {
+  void begin(HMesh *mesh, Uint32 it) {
     this->mesh = mesh;
     this->it = it;
   }
   
   EdgeIter& operator++() {
     if (mesh != NULL)
-      if (it != mesh->edges.end())
-        ++it;
+      if (it < mesh->edges.end())
+        it = mesh->edges.next( it );
     return *this;
   }
 
   bool end() {
     if (mesh == NULL) return true;
-    return (it == mesh->edges.end());
+    return (it >= mesh->edges.end());
   }
 
   Edge* operator*() const {
     if (mesh != NULL)
-      if (it != mesh->edges.end())
-        return (Edge*)*it;
+      if (it < mesh->edges.end())
+        return (Edge*) mesh->edges.at( it );
     return NULL;
   }
 
   Edge* operator->() const {
-    return (Edge*)*it;
+    return (Edge*) mesh->edges.at( it );
   }
 };
 
@@ -170,7 +170,7 @@ class FaceIter
 {
 private:
   HMesh *mesh;
-  ListHandle it;
+  Uint32 it;
   
 public:
 
@@ -182,41 +182,41 @@ public:
     begin(mesh);
   };
   
-  FaceIter(HMesh *mesh, const ListHandle &it) {
+  FaceIter(HMesh *mesh, Uint32 it) {
     begin(mesh, it);
   }
 
   void begin(HMesh *mesh) {
     this->mesh = mesh;
     if (mesh != NULL)
-      this->it = mesh->faces.begin();
+      this->it = mesh->faces.first();
   };
   
-  void begin(HMesh *mesh, const ListHandle &it) {
+  void begin(HMesh *mesh, Uint32 it) {
     this->mesh = mesh;
     this->it = it;
   }
   
   FaceIter& operator++() {
     if (mesh != NULL)
-      if (it != mesh->faces.end())
-        ++it;
+      if (it < mesh->faces.end())
+        it = mesh->faces.next( it );
     return *this;
   }
 
   bool end() {
     if (mesh == NULL) return true;
-    return (it == mesh->faces.end());
+    return (it >= mesh->faces.end());
   }
 
   Face* operator*() const {
     if (mesh != NULL)
-      if (it != mesh->faces.end())
-        return (Face*)*it;
+      if (it < mesh->faces.end())
+        return (Face*) mesh->faces.at( it );
     return NULL;
   }
 
   Face* operator->() const {
-    return (Face*)*it;
+    return (Face*) mesh->faces.at( it );
   }
 };
@@ -0,0 +1,154 @@
+#include <iostream>
+#include "geHmeshStorage.h"
+
+namespace GE
+{
+  HMeshArray::HMeshArray ()
+  {
+    slotSize = 0;
+    count = 0;
+  }
+
+  HMeshArray::~HMeshArray ()
+  {
+    clear();
+  }
+
+  /*
+  Slots are rounded up to keep the pointers in the
+  entities aligned. */
+
+  void HMeshArray::setClass (Class c)
+  {
+    if (!states.empty()) {
+      std::cout << "HMeshArray: class changed while not empty" << std::endl;
+      return; }
+
+    cls = c;
+    slotSize = (c->size() + 7) & ~((UintSize) 7);
+  }
+
+  Object* HMeshArray::alloc (Uint32 *outIndex)
+  {
+    Uint32 index = 0;
+    if (!freeSlots.empty())
+    {
+      index = freeSlots.last();
+      freeSlots.popBack();
+      states[ index ] = Detached;
+    }
+    else
+    {
+      index = (Uint32) states.size();
+      if (index == blocks.size() * GE_HMESH_BLOCK)
+        blocks.pushBack( (Uint8*) std::malloc( GE_HMESH_BLOCK * slotSize ));
+      states.pushBack( (Uint8) Detached );
+    }
+
+    *outIndex = index;
+    return cls->instantiate( at( index ));
+  }
+
+  void HMeshArray::insert (Uint32 index)
+  {
+    if (states[ index ] == Live) return;
+    states[ index ] = Live;
+    count++;
+  }
+
+  void HMeshArray::remove (Uint32 index)
+  {
+    if (states[ index ] != Live) return;
+    states[ index ] = Detached;
+    removed.pushBack( index );
+    count--;
+  }
+
+  void HMeshArray::destroy (Uint32 index)
+  {
+    cls->destroy( at( index ));
+    states[ index ] = Free;
+    freeSlots.pushBack( index );
+  }
+
+  /*
+  An entity put back into the mesh after removal is
+  still listed, it is skipped here by its state. */
+
+  void HMeshArray::destroyRemoved ()
+  {
+    for (UintSize r=0; r<removed.size(); ++r)
+      if (states[ removed[r] ] == Detached)
+        destroy( removed[r] );
+
+    removed.clear();
+  }
+
+  void HMeshArray::clear ()
+  {
+    for (Uint32 s=0; s<(Uint32)states.size(); ++s)
+      if (states[ s ] != Free)
+        cls->destroy( at( s ));
+
+    for (UintSize b=0; b<blocks.size(); ++b)
+      std::free( blocks[ b ] );
+
+    blocks.clear();
+    states.clear();
+    freeSlots.clear();
+    removed.clear();
+    count = 0;
+  }
+
+  /*
+  The unused rest of the last block is skipped over and
+  put on the free list, so the blocks of the other array
+  can be appended as they are. */
+
+  Uint32 HMeshArray::moveFrom (HMeshArray *other)
+  {
+    if (other == this || other->states.empty())
+      return end();
+
+    if (slotSize != other->slotSize || cls != other->cls) {
+      std::cout << "HMeshArray: cannot move entities of a different class" << std::endl;
+      return end(); }
+
+    Uint32 offset = (Uint32) (blocks.size() * GE_HMESH_BLOCK);
+    for (Uint32 s=(Uint32)states.size(); s<offset; ++s) {
+      states.pushBack( (Uint8) Free );
+      freeSlots.pushBack( s ); }
+
+    for (UintSize b=0; b<other->blocks.size(); ++b)
+      blocks.pushBack( other->blocks[ b ] );
+
+    for (UintSize s=0; s<other->states.size(); ++s)
+      states.pushBack( other->states[ s ] );
+
+    for (UintSize f=0; f<other->freeSlots.size(); ++f)
+      freeSlots.pushBack( other->freeSlots[ f ] + offset );
+
+    for (UintSize r=0; r<other->removed.size(); ++r)
+      removed.pushBack( other->removed[ r ] + offset );
+
+    count += other->count;
+
+    other->blocks.clear();
+    other->states.clear();
+    other->freeSlots.clear();
+    other->removed.clear();
+    other->count = 0;
+
+    return offset;
+  }
+
+  UintSize HMeshArray::getByteSize () const
+  {
+    return blocks.size() * GE_HMESH_BLOCK * slotSize +
+      blocks.capacity() * sizeof( Uint8* ) +
+      states.capacity() * sizeof( Uint8 ) +
+      freeSlots.capacity() * sizeof( Uint32 ) +
+      removed.capacity() * sizeof( Uint32 );
+  }
+
+}//namespace GE
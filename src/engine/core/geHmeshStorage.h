@@ -0,0 +1,103 @@
+#ifndef __GEHMESHSTORAGE_H
+#define __GEHMESHSTORAGE_H
+
+#include "util/geUtil.h"
+
+#pragma warning(push)
+#pragma warning(disable:4251)
+
+//Number of entity slots in every block of an HMeshArray
+#define GE_HMESH_BLOCK 4096
+
+namespace GE
+{
+  /*
+  ----------------------------------------------------------
+  Contiguous storage for one type of half-edge mesh entity.
+  Entities are constructed in place into blocks of equal
+  slots and addressed by a 32-bit slot index. Blocks never
+  move, so pointers to entities stay valid as the array
+  grows. A slot goes through three states: allocated and
+  constructed, inserted into the mesh, and removed from the
+  mesh but not yet destroyed, so the owner can still look
+  at it. Destroyed slots go on a free list for reuse.
+  ----------------------------------------------------------*/
+
+  class HMeshArray
+  {
+    enum SlotState
+    {
+      Free     = 0,
+      Detached = 1,
+      Live     = 2
+    };
+
+    Class cls;
+    UintSize slotSize;
+    ArrayList< Uint8* > blocks;
+    ArrayList< Uint8 > states;
+    ArrayList< Uint32 > freeSlots;
+    ArrayList< Uint32 > removed;
+    UintSize count;
+
+    void destroy (Uint32 index);
+
+  public:
+    HMeshArray ();
+    ~HMeshArray ();
+
+    //Must be set while the array is empty
+    void setClass (Class c);
+
+    //Constructs a detached entity and returns it along with its slot
+    Object* alloc (Uint32 *outIndex);
+
+    //Moves an entity into the mesh and back out, removed
+    //entities are kept until destroyRemoved is called
+    void insert (Uint32 index);
+    void remove (Uint32 index);
+    void destroyRemoved ();
+    void clear ();
+
+    /*
+    Takes over all the blocks of the given array, which is
+    left empty. Its slots follow the ones of this array, so
+    an entity moved from slot i is at slot i + the returned
+    offset. Both arrays must hold the same class, if there is
+    nothing to move end() is returned. */
+
+    Uint32 moveFrom (HMeshArray *other);
+
+    INLINE Object* at (Uint32 index) const {
+      return (Object*) (blocks[ index / GE_HMESH_BLOCK ] +
+        (index % GE_HMESH_BLOCK) * slotSize); }
+
+    INLINE bool isLive (Uint32 index) const {
+      return states[ index ] == Live; }
+
+    INLINE bool isUsed (Uint32 index) const {
+      return states[ index ] != Free; }
+
+    //Slots in the mesh in slot order, end() is one past the last slot
+    INLINE Uint32 next (Uint32 index) const {
+      Uint32 last = (Uint32) states.size();
+      for (++index; index < last; ++index)
+        if (states[ index ] == Live) break;
+      return index; }
+
+    INLINE Uint32 first () const {
+      if (states.empty() || states[0] == Live) return 0;
+      return next( 0 ); }
+
+    INLINE Uint32 end () const {
+      return (Uint32) states.size(); }
+
+    INLINE UintSize size () const {
+      return count; }
+
+    UintSize getByteSize () const;
+  };
+
+}//namespace GE
+#pragma warning(pop)
+#endif//__GEHMESHSTORAGE_H
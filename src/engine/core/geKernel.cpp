@@ -1,6 +1,7 @@
 #include <iostream>
 #include "util/geUtil.h"
 #include "io/geFile.h"
+#include "io/geFileMap.h"
 #include "image/geImage.h"
 #include "core/geTexture.h"
 #include "core/geTriMesh.h"
@@ -8,6 +9,9 @@
 #include "core/geSkinPose.h"
 #include "core/geCharacter.h"
 #include "core/geKernel.h"
+#include "core/geResourceLoader.h"
+#include "core/geScenePackage.h"
+#include "core/geShaderCache.h"
 #include "core/geRenderer.h"
 #include "core/geScene.h"
 #include "core/actors/geTriMeshActor.h"
@@ -63,6 +67,7 @@ GE_PFGLMULTITEXCOORD2F           GE_glMultiTexCoord2f = NULL;
 
 #ifndef GL_VERSION_1_5
 GE_PFGLGENBUFFERS                GE_glGenBuffers = NULL;
+GE_PFGLDELETEBUFFERS             GE_glDeleteBuffers = NULL;
 GE_PFGLBINDBUFFER                GE_glBindBuffer = NULL;
 GE_PFGLBUFFERDATA                GE_glBufferData = NULL;
 GE_PFGLBUFFERSUBDATA             GE_glBufferSubData = NULL;
@@ -346,6 +351,8 @@ namespace GE
       #ifndef GL_VERSION_1_5
       GE_glGenBuffers = (GE_PFGLGENBUFFERS)
         getProcAddress("glGenBuffersARB");
+      GE_glDeleteBuffers = (GE_PFGLDELETEBUFFERS)
+        getProcAddress("glDeleteBuffersARB");
       GE_glBindBuffer = (GE_PFGLBINDBUFFER)
         getProcAddress("glBindBufferARB");
       GE_glBufferData = (GE_PFGLBUFFERDATA)
@@ -353,7 +360,7 @@ namespace GE
       GE_glBufferSubData = (GE_PFGLBUFFERSUBDATA)
         getProcAddress("glBufferSubDataARB");
 
-      if (GE_glGenBuffers==NULL || GE_glBindBuffer==NULL ||
+      if (GE_glGenBuffers==NULL || GE_glDeleteBuffers==NULL || GE_glBindBuffer==NULL ||
           GE_glBufferData==NULL || GE_glBufferSubData==NULL)
         hasVertexBufferObjects = false;
       #endif
@@ -620,6 +627,22 @@ namespace GE
     printf( "maxOcclusionBits: %d\n", maxOcclusionBits);
   }
   
+  /*
+  --------------------------------------------------
+  Finishes streamed resources through the kernel
+  --------------------------------------------------*/
+
+  class KernelFinalizer : public ResourceFinalizer
+  {
+    Kernel *kernel;
+
+  public:
+    KernelFinalizer (Kernel *k) : kernel(k) {}
+
+    virtual Resource* finalize (LoadRequest *req)
+    { return kernel->finishResource( req ); }
+  };
+
   /*
   --------------------------------------------------
   Constructor for the single instance
@@ -634,8 +657,19 @@ namespace GE
     //Load extensions
     this->loadExtensions();
     
-    //Create renderer
+    //Create renderer with the sources composed on previous runs
     renderer = new Renderer;
+    shaderCacheFile = File::GetModule().getRelativeFile( GE_SHADER_CACHE_FILE ).getPathName();
+    renderer->loadShaderSources( shaderCacheFile );
+
+    //Create worker threads
+    threadPool = new ThreadPool;
+
+    //Stream resources in the background
+    finalizer = new KernelFinalizer( this );
+    loader = new ResourceLoader( finalizer );
+    streamBudget = GE_STREAM_BUDGET_MS;
+    objectArenas = false;
 
     //Time
     timeInit = false;
@@ -645,7 +679,21 @@ namespace GE
   
   Kernel::~Kernel()
   {
+    //Keep sources composed during this run
+    if (renderer->hasNewShaderSources())
+      renderer->saveShaderSources( shaderCacheFile );
+
+    delete loader;
+    delete finalizer;
+    delete threadPool;
+
+    //Unused resources free their GL objects with the context alive
+    cache.clear();
     delete renderer;
+
+    //Unmap packages
+    for (UintSize p=0; p<packages.size(); ++p)
+      delete packages[ p ];
   }
   /*
   void* Kernel::spawnFromPackage (ClassPtr cn)
@@ -680,6 +728,31 @@ namespace GE
     return renderer;
   }
 
+  ThreadPool* Kernel::getThreadPool ()
+  {
+    return threadPool;
+  }
+
+  /*
+  Moves the shader source cache, e.g. into a writable data
+  folder. Sources stored in the new file are added and new
+  ones get saved there at shutdown. */
+
+  void Kernel::setShaderCacheFile (const CharString &filename)
+  {
+    bool changed = renderer->hasNewShaderSources();
+    shaderCacheFile = filename;
+    renderer->loadShaderSources( filename );
+
+    //Loading resets the changed state
+    if (changed) renderer->saveShaderSources( filename );
+  }
+
+  const CharString& Kernel::getShaderCacheFile ()
+  {
+    return shaderCacheFile;
+  }
+
   void Kernel::tick (Float t)
   {
     if (timeInit)
@@ -687,6 +760,13 @@ namespace GE
 
     time = t;
     timeInit = true;
+
+    //Finish resources loaded in the background
+    loader->finalize( streamBudget );
+
+    //Drop unused resources once over budget
+    if (cache.isOverBudget())
+      cache.trim();
   }
 
   Float Kernel::getTime ()
@@ -705,99 +785,198 @@ namespace GE
   Scene handling
   --------------------------------------------------*/
 
-  bool loadPackageFile (ByteString &data, const CharString &filename)
+  void Kernel::keepPackage (FileMap *package, UintSize borrowedSize)
   {
-    //Open the file
-    File file( filename );
-    if (!file.open( FileAccess::Read, FileCondition::MustExist )) {
-      std::cout << "Failed opening file " << filename.buffer() << "!" << std::endl;
-      return false; }
-
-    //Check the file signature
-    Serializer s;
-    if (file.getSize() < s.getSignatureSize()) {
-      file.close(); std::cout << "Invalid file " << filename.buffer() << "!" << std::endl;
-      return false; }
-
-    ByteString sig = file.read( s.getSignatureSize() );
-    if ((UintSize) sig.length() < s.getSignatureSize()) {
-      file.close(); std::cout << "Invalid file " << filename.buffer() << "!" << std::endl;
-      return false; }
-
-    if ( ! s.checkSignature( sig.buffer() )) {
-      file.close(); std::cout << "Invalid file " << filename.buffer() << "!" << std::endl;
-      return false; }
-
-    //Read the rest of the file
-    file.read( data, file.getSize() - s.getSignatureSize() );
-    if (data.length() == 0) {
-      file.close(); std::cout << "Invalid file " << filename.buffer() << "!" << std::endl;
-      return false; }
+    //Unmap right away if nothing was borrowed
+    if (borrowedSize == 0) {
+      delete package;
+      return;
+    }
 
-    //Close the file
-    file.close();
-    return true;
+    //Loaded objects use the mapping from now on
+    packages.pushBack( package );
   }
 
   void Kernel::cacheResource (Resource *res, const CharString &name)
   {
-    resources[ name.buffer() ] = res;
-    res->setResourceName( name );
+    cache.insert( res, name );
   }
   
-  Resource* Kernel::getResource (const CharString &name)
+  void sendResourceToGpu (Resource *res)
   {
-    //Search for the resource in the cache
-    ResourceIter iter = resources.find( name );
-    if (iter != resources.end()) return iter->second;
+    //Send meshes to GPU
+    TriMesh *mesh = Class::SafeCast< TriMesh >( res );
+    if (mesh != NULL) mesh->sendToGpu();
+
+    //Send character meshes to GPU
+    Character *character = Class::SafeCast< Character >( res );
+    if (character != NULL) {
+      for (UintSize m=0; m<character->meshes.size(); ++m)
+        character->meshes[ m ]->sendToGpu();
+    }
+  }
 
-    //Load missing resource
-    std::cout << "Loading resource " << name.buffer() << "..." << std::endl;
+  /*
+  Main thread part of loading a resource. Takes the decoded
+  image or the deserialized resource from the request. */
 
-    if (name.right(3) == "jpg" ||
-        name.right(3) == "png")
-    {
-      //Load image
-      Image img;
-      if (img.readFile( name ) != IMAGE_NO_ERROR) {
-        std::cout << "Failed loading texture '" << name.buffer() << "'!" << std::endl;
-        return NULL;
-      }
+  Resource* Kernel::finishResource (LoadRequest *req)
+  {
+    //Another load of the same name may have finished first
+    Resource *cached = cache.find( req->name );
+    if (cached != NULL) return cached;
 
+    if (req->image != NULL)
+    {
       //Create texture resource
       Texture *tex = new Texture;
-      tex->fromImage( &img );
+      tex->fromImage( req->image );
 
       //Store resource in cache
-      cacheResource( tex, name );
+      cache.insert( tex, req->name );
       return tex;
     }
-    else
+    else if (req->resource != NULL)
     {
-      //Load file
-      ByteString data;
-      if (!loadPackageFile( data, "Meshes\\" + name ))
-        return NULL;
-
-      //Deserialize resource
-      Serializer s;
-      Resource *res = (Resource*) s.deserialize( data.buffer(), data.length() );
-
-      //Send meshes to GPU
-      TriMesh *mesh = Class::SafeCast< TriMesh >( res );
-      if (mesh != NULL) mesh->sendToGpu();
-
-      //Send character meshes to GPU
-      Character *character = Class::SafeCast< Character >( res );
-      if (character != NULL) {
-        for (UintSize m=0; m<character->meshes.size(); ++m)
-          character->meshes[ m ]->sendToGpu();
-      }
-
-      //Store resource in cache
-      cacheResource( res, name );
+      //Cache entry owns the mapping the resource borrows from
+      Resource *res = req->resource;
+      sendResourceToGpu( res );
+      cache.insert( res, req->name, req->package );
+      req->resource = NULL;
+      req->package = NULL;
       return res;
     }
+
+    return NULL;
+  }
+
+  Resource* Kernel::loadResource (const CharString &name, Uint64 hash)
+  {
+    //Search for the resource in the cache
+    Resource *cached = cache.lookup( name, hash );
+    if (cached != NULL) return cached;
+
+    //Load missing resource on the calling thread
+    std::cout << "Loading resource " << name.buffer() << "..." << std::endl;
+
+    LoadRequest req;
+    req.name = name;
+    if (!ResourceLoader::LoadFile( &req ))
+      return NULL;
+
+    return finishResource( &req );
+  }
+
+  /*
+  Resolves the reference right away, loading the resource on
+  the calling thread if it's not cached. The reference holds
+  a count, so the cache won't trim the resource while it's
+  in use. Returns false if the resource failed to load. */
+
+  bool Kernel::getResource (ResourceRef *ref)
+  {
+    ref->detach();
+    ref->set( loadResource( ref->name, ref->nameHash ));
+    ref->state = (ref->ptr != NULL) ? ResourceState::Ready : ResourceState::Failed;
+    return (ref->ptr != NULL);
+  }
+
+  /*
+  Non-blocking variant of getResource. The reference stays
+  a placeholder until the resource is loaded in the
+  background and finished during a later tick. */
+
+  void Kernel::requestResource (ResourceRef *ref, Int priority)
+  {
+    //Resolve right away if already cached
+    Resource *cached = cache.lookup( ref->name, ref->nameHash );
+    if (cached != NULL) {
+      ref->set( cached );
+      ref->state = ResourceState::Ready;
+      return; }
+
+    loader->request( ref, priority );
+  }
+
+  void Kernel::cancelResource (ResourceRef *ref)
+  {
+    loader->cancel( ref );
+  }
+
+  void Kernel::setStreamingBudget (Float ms)
+  {
+    streamBudget = ms;
+  }
+
+  Float Kernel::getStreamingBudget ()
+  {
+    return streamBudget;
+  }
+
+  void Kernel::setObjectArenas (bool enable)
+  {
+    objectArenas = enable;
+  }
+
+  bool Kernel::getObjectArenas ()
+  {
+    return objectArenas;
+  }
+
+  ResourceLoader* Kernel::getResourceLoader ()
+  {
+    return loader;
+  }
+
+  ResourceCache* Kernel::getResourceCache ()
+  {
+    return &cache;
+  }
+
+  /*
+  A reference going away or being reassigned must not be
+  patched by a load that's still in flight. */
+
+  void ResourceRef::detach ()
+  {
+    if (state == ResourceState::Loading && Kernel::GetInstance() != NULL)
+      Kernel::GetInstance()->cancelResource( this );
+  }
+
+  ResourceRef::ResourceRef (const ResourceRef &r)
+  {
+    ptr = NULL;
+    name = r.name;
+    nameHash = r.nameHash;
+    set( (Resource*) r.ptr );
+    state = (ptr != NULL) ? ResourceState::Ready : ResourceState::Placeholder;
+  }
+
+  ResourceRef& ResourceRef::operator= (const ResourceRef &r)
+  {
+    detach();
+    name = r.name;
+    nameHash = r.nameHash;
+    set( (Resource*) r.ptr );
+    state = (ptr != NULL) ? ResourceState::Ready : ResourceState::Placeholder;
+    return *this;
+  }
+
+  /*
+  Counts are taken before they're released, so setting the
+  same resource again doesn't drop it to zero on the way. */
+
+  void ResourceRef::set (Resource *res)
+  {
+    if (res != NULL) res->reference();
+    if (ptr != NULL) ((Resource*) ptr)->dereference();
+    ptr = res;
+  }
+
+  ResourceRef::~ResourceRef ()
+  {
+    detach();
+    set( NULL );
   }
 
 
@@ -937,8 +1116,14 @@ namespace GE
 
   Scene3D* Kernel::loadSceneData (const void *data, UintSize size)
   {
-    //Deserialize data
+    //Data is owned by the caller, so copy it
     Serializer s;
+    return loadScene( s, data, size );
+  }
+
+  Scene3D* Kernel::loadScene (Serializer &s, const void *data, UintSize size)
+  {
+    //Deserialize data
     Object *obj = s.deserialize( data, size );
     
     //Check if Scene3D loaded
@@ -947,6 +1132,16 @@ namespace GE
       std::cout << "Invalid file content!" << std::endl;
       return NULL;
     }
+
+    return finishScene( scene, s.getObjects() );
+  }
+
+  /*
+  Main thread part of loading a scene, once all of its
+  objects are deserialized. */
+
+  Scene3D* Kernel::finishScene (Scene3D *scene, const ArrayList< Object* > &objects)
+  {
 /*
     //DEBUG: Replace textured materials with simple ones
     ArrayList< Actor* > actors;
@@ -961,35 +1156,22 @@ namespace GE
       meshActor->setMaterial( m );
     }
 */
-    //Cache resources loaded with the scene
+    //Cache resources loaded with the scene, which keeps them
+    scene->referenceResources();
     for (UintSize r=0; r<scene->resources.size(); ++r)
     {
       //Store resource in cache
       Resource *res = scene->resources[ r ];
       cacheResource( res, res->getResourceName() );
-
-      //Send meshes to GPU
-      TriMesh *mesh = Class::SafeCast< TriMesh >( res );
-      if (mesh != NULL) mesh->sendToGpu();
-
-      //Send character meshes to GPU
-      Character *character = Class::SafeCast< Character >( res );
-      if (character != NULL) {
-        for (UintSize m=0; m<character->meshes.size(); ++m)
-          character->meshes[ m ]->sendToGpu();
-      }
+      sendResourceToGpu( res );
     }
 
     //Assign resources / load missing
-    const ArrayList< Object* > &objects = s.getObjects();
     for (UintSize o=0; o<objects.size(); ++o)
     {
       Object *obj = objects.at(o);
       if (ClassOf( obj ) == ClassName( ResourceRef ))
-      {
-        ResourceRef *ref = (ResourceRef*) obj;
-        ref->ptr = getResource( ref->name );
-      }
+        getResource( (ResourceRef*) obj );
     }
 
     //Invoke loaded events
@@ -1002,18 +1184,66 @@ namespace GE
 
     //Update the scene
     scene->updateChanges();
+
+    //Compose the shaders the scene needs before the first frame
+    ArrayList< ShaderPermutation > perms;
+    renderer->findShaderPermutations( scene, perms );
+    renderer->warmShaders( perms );
+
     return scene;
   }
 
-  Scene3D* Kernel::loadSceneFile (const CharString &filename)
+  /*
+  Resources stored apart from the scene are deserialized
+  on the thread pool, then joined on the main thread. */
+
+  Scene3D* Kernel::loadScenePackage (FileMap *package)
   {
-    //Load from file
-    ByteString data;
-    if (!loadPackageFile( data, filename ))
+    ScenePackage scenePackage;
+    scenePackage.setObjectArenas( objectArenas );
+    if (!scenePackage.read( package->getData(), package->getSize(), threadPool, true )) {
+      std::cout << "Invalid file content!" << std::endl;
+      delete package;
       return NULL;
-    
-    //Process data
-    return loadSceneData( data.buffer(), data.length() );
+    }
+
+    Scene3D *scene = finishScene( scenePackage.getScene(), scenePackage.getObjects() );
+    keepPackage( package, scenePackage.getBorrowedSize() );
+    return scene;
+  }
+
+  /*
+  The package is mapped rather than read, so data arrays can
+  be borrowed from the mapping instead of copied. Checking
+  the signature sets the serializer up for its layout. */
+
+  Scene3D* Kernel::loadSceneFile (const CharString &filename)
+  {
+    //Map the file
+    FileMap *package = new FileMap;
+    if (!package->open( File( filename ).getPathName() )) {
+      delete package; std::cout << "Failed opening file " << filename.buffer() << "!" << std::endl;
+      return NULL; }
+
+    //Scene and resources in separate blobs
+    if (ScenePackage::CheckSignature( package->getData(), package->getSize() ))
+      return loadScenePackage( package );
+
+    //Check the file signature
+    Serializer s;
+    if (package->getSize() <= s.getSignatureSize() ||
+        ! s.checkSignature( package->getData() )) {
+      delete package; std::cout << "Invalid file " << filename.buffer() << "!" << std::endl;
+      return NULL; }
+
+    //Process data using arrays in place
+    s.setArrayBorrowing( true );
+    if (objectArenas) s.setObjectArena( new ObjectArena );
+    UintSize sigSize = s.getSignatureSize();
+    Scene3D *scene = loadScene( s, package->getData() + sigSize, package->getSize() - sigSize );
+    if (objectArenas) s.getObjectArena()->release();
+    keepPackage( package, s.getBorrowedSize() );
+    return scene;
   }
 
 }//namespace GE
@@ -2,6 +2,7 @@
 #define __GEKERNEL_H
 
 #include "util/geUtil.h"
+#include "core/geResourceCache.h"
 //#include <string>
 #include <map>
 
@@ -24,6 +25,10 @@ namespace GE
   class Character;
   class ResourceRef;
   class Scene3D;
+  class FileMap;
+  class LoadRequest;
+  class ResourceLoader;
+  class ResourceFinalizer;
   
   /*
   -------------------------------------
@@ -50,13 +55,11 @@ namespace GE
   Kernel interface (singleton!)
   --------------------------------------------*/
   
-  typedef std::map <CharString, Resource*> ResourceMap;
-  typedef ResourceMap::iterator ResourceIter;
-
   class Kernel
   {
     friend class Renderer;
     friend class TriMesh;
+    friend class KernelFinalizer;
     
   private:
     
@@ -84,12 +87,26 @@ namespace GE
     ArrayList<Object*> objects;
     ArraySet<KernelBuffer*> buffers;
 
-    ResourceMap resources;
+    ResourceCache cache;
+    ArrayList< FileMap* > packages;
     Renderer *renderer;
+    ThreadPool *threadPool;
+    ResourceLoader *loader;
+    ResourceFinalizer *finalizer;
+    Float streamBudget;
+    CharString shaderCacheFile;
+    bool objectArenas;
 
     bool timeInit;
     Float time;
     Float dtime;
+
+    void keepPackage (FileMap *package, UintSize borrowedSize);
+    Resource* finishResource (LoadRequest *req);
+    Resource* loadResource (const CharString &name, Uint64 hash);
+    Scene3D* loadScene (Serializer &s, const void *data, UintSize size);
+    Scene3D* finishScene (Scene3D *scene, const ArrayList< Object* > &objects);
+    Scene3D* loadScenePackage (FileMap *package);
     
   public:
     
@@ -111,18 +128,46 @@ namespace GE
     { return Kernel::Instance; }
 
     Renderer* getRenderer ();
+    ThreadPool* getThreadPool ();
+
+    void setShaderCacheFile (const CharString &filename);
+    const CharString& getShaderCacheFile ();
 
     void cacheResource (Resource *res, const CharString &name);
-    Resource* getResource (const CharString &name);
+    bool getResource (ResourceRef *ref);
+    void requestResource (ResourceRef *ref, Int priority = 0);
+    void cancelResource (ResourceRef *ref);
+    void setStreamingBudget (Float ms);
+    Float getStreamingBudget ();
+    ResourceLoader* getResourceLoader ();
+    ResourceCache* getResourceCache ();
     Scene3D* loadSceneFile (const CharString &filename);
     Scene3D* loadSceneData (const void *data, UintSize size);
+
+    //Places the objects of loaded scene files in arenas
+    void setObjectArenas (bool enable);
+    bool getObjectArenas ();
   };
 
   /*
   ---------------------------------------
-  Reference to resources
+  Reference to resources. Holds a count on
+  the resource so the cache keeps it. A
+  streamed one stays a placeholder with a
+  NULL pointer until the resource is ready.
   ---------------------------------------*/
 
+  namespace ResourceState
+  {
+    enum Enum
+    {
+      Placeholder,
+      Loading,
+      Ready,
+      Failed
+    };
+  }
+
   class ResourceRef : public Object
   {
     CLASS( ResourceRef, Object,
@@ -132,13 +177,25 @@ namespace GE
     {
       Object::serialize( s,v );
       s->string( &name );
+      if (s->loading()) nameHash = name.hash();
     }
 
   public:
 
     void *ptr;
     CharString name;
-    ResourceRef() : ptr(NULL) {}
+    Uint64 nameHash;
+    ResourceState::Enum state;
+
+    ResourceRef() : ptr(NULL), nameHash(0), state(ResourceState::Placeholder) {}
+    ResourceRef (const ResourceRef &r);
+    ~ResourceRef();
+
+    ResourceRef& operator= (const ResourceRef &r);
+    void set (Resource *res);
+    void setName (const CharString &n) { name = n; nameHash = n.hash(); }
+    void detach();
+    bool isReady() { return state == ResourceState::Ready; }
   };
 
   template <class T> class TResourceRef : public ResourceRef
@@ -146,8 +203,9 @@ namespace GE
   public:
     T* operator-> () { return (T*) ptr; }
     T& operator* () { return *( operator->() ); }
-    void operator= (T *t) { ptr = t; name = (t != NULL) ? t->getResourceName() : ""; }
-    void operator= (const CharString &n) { ptr = NULL; name = n; }
+    void operator= (T *t) { detach(); set( t ); setName( (t != NULL) ? t->getResourceName() : "" );
+      state = (t != NULL) ? ResourceState::Ready : ResourceState::Placeholder; }
+    void operator= (const CharString &n) { detach(); set( NULL ); setName( n ); state = ResourceState::Placeholder; }
     bool operator== (T *t) { return (T*)ptr == t; }
     operator T* () { return (T*) ptr; }
   };
@@ -206,6 +206,11 @@ namespace GE
     volumeChanged = true;
   }
 
+  /*
+  Registers the uniforms, the code is generated separately by
+  composeSource as one vertex and fragment pair. The shared part
+  declares the uniforms and the light function follows it. */
+
   void Light::composeShader (Shader *shader)
   {
     shader->registerUniform( ShaderType::Fragment, DataUnit::Sampler2D, "samplerNormal" );
@@ -217,21 +222,24 @@ namespace GE
     shader->registerUniform( ShaderType::Fragment, DataUnit::Vec2, "winSize" );
     shader->registerUniform( ShaderType::Fragment, DataUnit::Float, "attStart" );
     shader->registerUniform( ShaderType::Fragment, DataUnit::Float, "attEnd" );
+  }
 
-    shader->compile( ShaderType::Vertex, Light_VS );
-    shader->compile( ShaderType::Fragment, Light_FS );
+  void Light::composeSource (CharString &vertex, CharString &fragment)
+  {
+    vertex = Light_VS;
+    fragment = Light_FS;
   }
 
-  void SpotLight::composeShader (Shader *shader)
+  void SpotLight::composeSource (CharString &vertex, CharString &fragment)
   {
-    shader->compile( ShaderType::Fragment, SpotLight_Func );
-    Light::composeShader( shader );
+    Light::composeSource( vertex, fragment );
+    fragment += SpotLight_Func;
   }
 
-  void PyramidLight::composeShader (Shader *shader)
+  void PyramidLight::composeSource (CharString &vertex, CharString &fragment)
   {
-    shader->compile( ShaderType::Fragment, PyramidLight_Func );
-    Light::composeShader( shader );
+    Light::composeSource( vertex, fragment );
+    fragment += PyramidLight_Func;
   }
 
   void Light::begin (Shader *shader, Vector2 winSize, Uint32 *deferredMaps, Uint32 shadowMap)
@@ -75,6 +75,7 @@ namespace GE
     void renderVolume ();
 
     virtual void composeShader (Shader *shader);
+    virtual void composeSource (CharString &vertex, CharString &fragment);
     virtual void enable (int index);
     virtual void begin (Shader *shader, Vector2 winSize, Uint32 *deferredMaps, Uint32 shadowMap);
     virtual void end();
@@ -120,7 +121,7 @@ namespace GE
     virtual Matrix4x4 getProjection ();
     virtual bool isPointInVolume (const Vector3 &p, Float threshold=0.0f);
 
-    virtual void composeShader (Shader *shader);
+    virtual void composeSource (CharString &vertex, CharString &fragment);
   };
 
   class PyramidLight : public Light
@@ -151,7 +152,7 @@ namespace GE
     virtual Matrix4x4 getProjection ();
     virtual bool isPointInVolume (const Vector3 &p, Float threshold=0.0f);
 
-    virtual void composeShader (Shader *shader);
+    virtual void composeSource (CharString &vertex, CharString &fragment);
   };
 
   class PointLight : public Light
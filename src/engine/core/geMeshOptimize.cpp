@@ -0,0 +1,432 @@
+#include "geMeshOptimize.h"
+#include <cmath>
+
+//Triangle that isn't picked yet
+#define GE_VCACHE_NO_TRI 0xFFFFFFFF
+
+namespace GE
+{
+  /*
+  ------------------------------------------------------
+  Cache simulation
+  ------------------------------------------------------*/
+
+  VertexCacheStats::VertexCacheStats ()
+  {
+    time = 0;
+    pass = 0;
+    reset();
+  }
+
+  void VertexCacheStats::reset ()
+  {
+    numTriangles = 0;
+    numVertices = 0;
+    numMisses = 0;
+  }
+
+  /*
+  A vertex is still in the cache if fewer than [cacheSize]
+  misses came after it went in, so the time only counts
+  misses and moving it past the cache size flushes it. */
+
+  void VertexCacheStats::simulate (const VertexID *indices, UintSize count, UintSize numVerts,
+                                   UintSize cacheSize)
+  {
+    while (stamps.size() < numVerts) {
+      stamps.pushBack( 0 );
+      seen.pushBack( 0 ); }
+
+    time += (Uint32) cacheSize + 1;
+    pass++;
+
+    for (UintSize i=0; i<count; ++i)
+    {
+      VertexID v = indices[i];
+      if (seen[v] != pass) {
+        seen[v] = pass;
+        numVertices++; }
+
+      if (time - stamps[v] > (Uint32) cacheSize) {
+        stamps[v] = time++;
+        numMisses++; }
+    }
+
+    numTriangles += count / 3;
+  }
+
+  void VertexCacheStats::simulate (TriMesh *mesh, UintSize cacheSize)
+  {
+    for (UintSize g=0; g<mesh->groups.size(); ++g)
+    {
+      TriMesh::IndexGroup &grp = mesh->groups[ g ];
+      simulate( mesh->indices.buffer() + grp.start, grp.count,
+                mesh->getVertexCount(), cacheSize );
+    }
+  }
+
+  Float VertexCacheStats::getAcmr ()
+  {
+    if (numTriangles == 0) return 0.0f;
+    return (Float) numMisses / (Float) numTriangles;
+  }
+
+  Float VertexCacheStats::getAtvr ()
+  {
+    if (numVertices == 0) return 0.0f;
+    return (Float) numMisses / (Float) numVertices;
+  }
+
+  /*
+  ------------------------------------------------------
+  Vertex cache order
+  ------------------------------------------------------*/
+
+  /*
+  The last triangle's vertices score the same whichever
+  order they went in, so the next triangle doesn't just
+  run along a strip. Older entries score less the further
+  back they are. Vertices with few triangles left get a
+  boost, so lone triangles don't get left behind. */
+
+  MeshOptimizer::MeshOptimizer ()
+  {
+    pass = 0;
+
+    for (int p=0; p<GE_VCACHE_SIZE; ++p)
+    {
+      if (p < 3) cacheScores[p] = 0.75f;
+      else cacheScores[p] = std::pow( 1.0f - (Float) (p - 3) / (Float) (GE_VCACHE_SIZE - 3), 1.5f );
+    }
+
+    valenceScores[0] = 0.0f;
+    for (int v=1; v<=GE_VCACHE_MAX_VALENCE; ++v)
+      valenceScores[v] = 2.0f / std::sqrt( (Float) v );
+  }
+
+  void MeshOptimizer::prepare (UintSize numVerts)
+  {
+    UintSize oldSize = marks.size();
+    if (oldSize >= numVerts) return;
+
+    valences.resize( numVerts );
+    triStarts.resize( numVerts );
+    cachePos.resize( numVerts );
+    vertScores.resize( numVerts );
+    stamps.resize( numVerts );
+    marks.resize( numVerts );
+    for (UintSize v=oldSize; v<numVerts; ++v)
+      marks[v] = 0;
+  }
+
+  Float MeshOptimizer::scoreVertex (Uint32 v)
+  {
+    Uint32 valence = valences[v];
+    if (valence == 0) return -1.0f;
+
+    Float score = (cachePos[v] < 0) ? 0.0f : cacheScores[ cachePos[v] ];
+    return score + valenceScores[ Util::Min( valence, (Uint32) GE_VCACHE_MAX_VALENCE ) ];
+  }
+
+  void MeshOptimizer::optimizeCache (VertexID *indices, UintSize count, UintSize numVerts)
+  {
+    UintSize numTris = count / 3;
+    if (numTris < 2) return;
+    count = numTris * 3;
+    prepare( numVerts );
+
+    //Count the triangles of every vertex used
+    pass++;
+    for (UintSize i=0; i<count; ++i)
+    {
+      VertexID v = indices[i];
+      if (marks[v] != pass) {
+        marks[v] = pass;
+        valences[v] = 0;
+        cachePos[v] = -1; }
+      valences[v]++;
+    }
+
+    //Triangles of every vertex in one block
+    adjacency.clear();
+    adjacency.resize( count );
+    UintSize offset = 0;
+    pass++;
+    for (UintSize i=0; i<count; ++i)
+    {
+      VertexID v = indices[i];
+      if (marks[v] != pass) {
+        marks[v] = pass;
+        triStarts[v] = (Uint32) offset;
+        offset += valences[v];
+        valences[v] = 0; }
+      adjacency[ triStarts[v] + valences[v]++ ] = (Uint32) (i / 3);
+    }
+
+    for (UintSize i=0; i<count; ++i)
+      vertScores[ indices[i] ] = scoreVertex( indices[i] );
+
+    //Start with the best triangle of all
+    triScores.clear();
+    triScores.resize( numTris );
+    emitted.clear();
+    emitted.resize( numTris );
+    Uint32 best = 0;
+    for (UintSize t=0; t<numTris; ++t)
+    {
+      VertexID *tri = indices + t*3;
+      triScores[t] = vertScores[ tri[0] ] + vertScores[ tri[1] ] + vertScores[ tri[2] ];
+      emitted[t] = 0;
+      if (triScores[t] > triScores[ best ]) best = (Uint32) t;
+    }
+
+    Uint32 cache[ GE_VCACHE_SIZE + 3 ];
+    Uint32 newCache[ GE_VCACHE_SIZE + 3 ];
+    UintSize cacheCount = 0;
+    UintSize cursor = 0;
+    output.clear();
+
+    for (UintSize n=0; n<numTris; ++n)
+    {
+      //Nothing in the cache has triangles left, go on in order
+      if (best == GE_VCACHE_NO_TRI) {
+        while (emitted[ cursor ]) ++cursor;
+        best = (Uint32) cursor; }
+
+      VertexID *tri = indices + best * 3;
+      emitted[ best ] = 1;
+
+      //Take the triangle off its vertices
+      for (int k=0; k<3; ++k)
+      {
+        VertexID v = tri[k];
+        output.pushBack( v );
+
+        Uint32 *tris = adjacency.buffer() + triStarts[v];
+        for (Uint32 j=0; j<valences[v]; ++j)
+          if (tris[j] == best) {
+            tris[j] = tris[ valences[v]-1 ];
+            valences[v]--;
+            break; }
+      }
+
+      //Triangle vertices go to the front, the rest move back
+      UintSize newCount = 0;
+      for (int k=0; k<3; ++k)
+        if (k == 0 || (tri[k] != tri[0] && (k == 1 || tri[k] != tri[1])))
+          newCache[ newCount++ ] = tri[k];
+
+      for (UintSize c=0; c<cacheCount; ++c) {
+        Uint32 v = cache[c];
+        if (v != tri[0] && v != tri[1] && v != tri[2])
+          newCache[ newCount++ ] = v; }
+
+      //Rescore what moved, the last ones fall out of the cache
+      for (UintSize c=0; c<newCount; ++c)
+      {
+        Uint32 v = newCache[c];
+        cachePos[v] = (c < GE_VCACHE_SIZE) ? (Int32) c : -1;
+        Float score = scoreVertex( v );
+        Float delta = score - vertScores[v];
+        vertScores[v] = score;
+
+        Uint32 *tris = adjacency.buffer() + triStarts[v];
+        for (Uint32 j=0; j<valences[v]; ++j)
+          triScores[ tris[j] ] += delta;
+      }
+
+      //Next is the best triangle with a vertex in the cache
+      cacheCount = Util::Min( newCount, (UintSize) GE_VCACHE_SIZE );
+      best = GE_VCACHE_NO_TRI;
+      Float bestScore = 0.0f;
+      for (UintSize c=0; c<cacheCount; ++c)
+      {
+        Uint32 v = newCache[c];
+        cache[c] = v;
+
+        Uint32 *tris = adjacency.buffer() + triStarts[v];
+        for (Uint32 j=0; j<valences[v]; ++j)
+          if (triScores[ tris[j] ] > bestScore) {
+            bestScore = triScores[ tris[j] ];
+            best = tris[j]; }
+      }
+    }
+
+    std::memcpy( indices, output.buffer(), count * sizeof( VertexID ));
+  }
+
+  /*
+  ------------------------------------------------------
+  Overdraw order
+  ------------------------------------------------------*/
+
+  /*
+  Floats flipped to keys that sort the same way as
+  unsigned integers. */
+
+  static Uint32 FloatKey (Float f)
+  {
+    Uint32 u;
+    std::memcpy( &u, &f, sizeof( Uint32 ));
+    return (u & 0x80000000) ? ~u : (u | 0x80000000);
+  }
+
+  /*
+  Misses of a triangle in a FIFO cache of the simulation
+  size, moving the time past the size flushes it. */
+
+  Uint32 MeshOptimizer::countMisses (const VertexID *tri, Uint32 &time)
+  {
+    Uint32 misses = 0;
+    for (int k=0; k<3; ++k)
+    {
+      VertexID v = tri[k];
+      if (marks[v] != pass) {
+        marks[v] = pass;
+        stamps[v] = time - GE_VCACHE_SIM_SIZE - 1; }
+
+      if (time - stamps[v] > GE_VCACHE_SIM_SIZE) {
+        stamps[v] = time++;
+        misses++; }
+    }
+    return misses;
+  }
+
+  void MeshOptimizer::optimizeOverdraw (VertexID *indices, UintSize count,
+                                        const ArrayList< Vector3 > &points, Float threshold)
+  {
+    UintSize numTris = count / 3;
+    if (numTris < 2) return;
+    count = numTris * 3;
+    prepare( points.size() );
+
+    //Hard cuts where every vertex of a triangle misses anyway
+    pass++;
+    Uint32 time = 0;
+    ArrayList< Uint32 > hardStarts;
+    hardStarts.pushBack( 0 );
+    countMisses( indices, time );
+    for (UintSize t=1; t<numTris; ++t)
+      if (countMisses( indices + t*3, time ) == 3)
+        hardStarts.pushBack( (Uint32) t );
+    hardStarts.pushBack( (Uint32) numTris );
+
+    //Soft cuts where the misses since the last cut, with the cache
+    //starting over there, come near the average of the hard cluster
+    ArrayList< Uint32 > starts;
+    for (UintSize h=0; h+1<hardStarts.size(); ++h)
+    {
+      UintSize start = hardStarts[h], end = hardStarts[h+1];
+      UintSize clusterMisses = 0;
+      time += GE_VCACHE_SIM_SIZE + 1;
+      for (UintSize t=start; t<end; ++t)
+        clusterMisses += countMisses( indices + t*3, time );
+      Float limit = threshold * (Float) clusterMisses / (Float) (end - start);
+
+      starts.pushBack( (Uint32) start );
+      UintSize runMisses = 0, runTris = 0;
+      time += GE_VCACHE_SIM_SIZE + 1;
+      for (UintSize t=start; t+1<end; ++t)
+      {
+        runMisses += countMisses( indices + t*3, time );
+        runTris++;
+        if ((Float) runMisses <= limit * (Float) runTris) {
+          starts.pushBack( (Uint32) (t+1) );
+          time += GE_VCACHE_SIM_SIZE + 1;
+          runMisses = 0;
+          runTris = 0; }
+      }
+    }
+
+    UintSize numClusters = starts.size();
+    starts.pushBack( (Uint32) numTris );
+
+    //Area weighted centers and normals
+    ArrayList< Vector3 > centers;
+    ArrayList< Vector3 > normals;
+    centers.resize( numClusters );
+    normals.resize( numClusters );
+    ArrayList< Float > areas;
+    areas.resize( numClusters );
+
+    Vector3 meshCenter( 0.0f, 0.0f, 0.0f );
+    Float meshArea = 0.0f;
+    for (UintSize c=0; c<numClusters; ++c)
+    {
+      Vector3 center( 0.0f, 0.0f, 0.0f );
+      Vector3 normal( 0.0f, 0.0f, 0.0f );
+      Float area = 0.0f;
+      for (UintSize t=starts[c]; t<starts[c+1]; ++t)
+      {
+        const Vector3 &p0 = points[ indices[ t*3+0 ]];
+        const Vector3 &p1 = points[ indices[ t*3+1 ]];
+        const Vector3 &p2 = points[ indices[ t*3+2 ]];
+        Vector3 cross = Vector::Cross( p1 - p0, p2 - p0 );
+        Float triArea = cross.norm() * 0.5f;
+        center += (p0 + p1 + p2) * (triArea / 3.0f);
+        normal += cross;
+        area += triArea;
+      }
+
+      centers[c] = center;
+      normals[c] = normal;
+      areas[c] = area;
+      meshCenter += center;
+      meshArea += area;
+    }
+
+    if (meshArea > 0.0f)
+      meshCenter /= meshArea;
+
+    //Clusters facing out from the center draw first
+    ArrayList< Uint32 > keys, tmpKeys, order, tmpOrder;
+    keys.resize( numClusters ); tmpKeys.resize( numClusters );
+    order.resize( numClusters ); tmpOrder.resize( numClusters );
+    for (UintSize c=0; c<numClusters; ++c)
+    {
+      Float dot = 0.0f;
+      Float len = normals[c].norm();
+      if (areas[c] > 0.0f && len > 0.0f)
+        dot = Vector::Dot( centers[c] / areas[c] - meshCenter, normals[c] ) / len;
+
+      keys[c] = ~FloatKey( dot );
+      order[c] = (Uint32) c;
+    }
+
+    //Radix sort by bytes keeps equal clusters in order
+    Uint32 *srcKeys = keys.buffer(), *dstKeys = tmpKeys.buffer();
+    Uint32 *srcOrder = order.buffer(), *dstOrder = tmpOrder.buffer();
+    for (Uint shift=0; shift<32; shift+=8)
+    {
+      UintSize offsets[256];
+      for (int b=0; b<256; ++b) offsets[b] = 0;
+      for (UintSize i=0; i<numClusters; ++i)
+        offsets[ (srcKeys[i] >> shift) & 0xFF ]++;
+
+      UintSize sum = 0;
+      for (int b=0; b<256; ++b) {
+        UintSize n = offsets[b];
+        offsets[b] = sum;
+        sum += n; }
+
+      for (UintSize i=0; i<numClusters; ++i) {
+        UintSize d = offsets[ (srcKeys[i] >> shift) & 0xFF ]++;
+        dstKeys[d] = srcKeys[i];
+        dstOrder[d] = srcOrder[i]; }
+
+      Uint32 *swapKeys = srcKeys; srcKeys = dstKeys; dstKeys = swapKeys;
+      Uint32 *swapOrder = srcOrder; srcOrder = dstOrder; dstOrder = swapOrder;
+    }
+
+    output.clear();
+    for (UintSize i=0; i<numClusters; ++i)
+    {
+      Uint32 c = srcOrder[i];
+      for (UintSize j=starts[c]*3; j<starts[c+1]*3; ++j)
+        output.pushBack( indices[j] );
+    }
+
+    std::memcpy( indices, output.buffer(), count * sizeof( VertexID ));
+  }
+
+}//namespace GE
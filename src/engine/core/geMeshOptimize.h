@@ -0,0 +1,111 @@
+#ifndef __GEMESHOPTIMIZE_H
+#define __GEMESHOPTIMIZE_H
+
+#include "util/geUtil.h"
+#include "math/geVectors.h"
+#include "geTriMesh.h"
+
+#pragma warning(push)
+#pragma warning(disable:4251)
+
+//Size of the LRU cache the triangle order is scored against
+#define GE_VCACHE_SIZE 32
+
+//Vertices with more triangles left than this share one valence score
+#define GE_VCACHE_MAX_VALENCE 64
+
+//Size of the FIFO cache the statistics are simulated with
+#define GE_VCACHE_SIM_SIZE 16
+
+//Clusters split where the misses per triangle so far drop to
+//this part of the average of the cluster
+#define GE_OVERDRAW_THRESHOLD 1.05f
+
+namespace GE
+{
+  /*
+  -----------------------------------------------------------
+  Offline simulation of a FIFO post-transform vertex cache,
+  flushed at the start of every face group. ACMR is the
+  average number of misses per triangle, from 3 down to
+  about 0.5 for a regular grid. ATVR is the number of misses
+  per vertex used, 1 at best.
+  -----------------------------------------------------------*/
+
+  class VertexCacheStats
+  {
+    ArrayList< Uint32 > stamps;
+    ArrayList< Uint32 > seen;
+    Uint32 time;
+    Uint32 pass;
+
+  public:
+    UintSize numTriangles;
+    UintSize numVertices;
+    UintSize numMisses;
+
+    VertexCacheStats ();
+    void reset ();
+
+    //Adds the misses of an index list, the cache starts empty
+    void simulate (const VertexID *indices, UintSize count, UintSize numVerts,
+                   UintSize cacheSize = GE_VCACHE_SIM_SIZE);
+
+    //Adds every face group of the mesh
+    void simulate (TriMesh *mesh, UintSize cacheSize = GE_VCACHE_SIM_SIZE);
+
+    Float getAcmr ();
+    Float getAtvr ();
+  };
+
+  /*
+  -----------------------------------------------------------
+  Reorders the triangles of an index list for the vertex
+  cache, after Forsyth's linear-speed optimization. The next
+  triangle is the one whose vertices score the highest by
+  how recently they went into a simulated LRU cache and how
+  few triangles they have left to draw.
+
+  The overdraw pass cuts that order into clusters where the
+  cache would be flushed anyway, or where a cut costs little
+  against the misses of the cluster, and draws the clusters
+  facing away from the center of the mesh first.
+  -----------------------------------------------------------*/
+
+  class MeshOptimizer
+  {
+    //Per vertex, sized to the largest vertex count seen
+    ArrayList< Uint32 > valences;
+    ArrayList< Uint32 > triStarts;
+    ArrayList< Int32 > cachePos;
+    ArrayList< Float > vertScores;
+    ArrayList< Uint32 > stamps;
+    ArrayList< Uint32 > marks;
+    Uint32 pass;
+
+    //Per triangle
+    ArrayList< Uint32 > adjacency;
+    ArrayList< Float > triScores;
+    ArrayList< Uint8 > emitted;
+
+    ArrayList< VertexID > output;
+    Float cacheScores[ GE_VCACHE_SIZE ];
+    Float valenceScores[ GE_VCACHE_MAX_VALENCE + 1 ];
+
+    void prepare (UintSize numVerts);
+    Float scoreVertex (Uint32 v);
+    Uint32 countMisses (const VertexID *tri, Uint32 &time);
+
+  public:
+
+    MeshOptimizer ();
+
+    //Indices refer to [numVerts] vertices, [count] is a multiple of 3
+    void optimizeCache (VertexID *indices, UintSize count, UintSize numVerts);
+    void optimizeOverdraw (VertexID *indices, UintSize count, const ArrayList< Vector3 > &points,
+                           Float threshold = GE_OVERDRAW_THRESHOLD);
+  };
+
+}//namespace GE
+#pragma warning(pop)
+#endif//__GEMESHOPTIMIZE_H
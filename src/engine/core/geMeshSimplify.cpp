@@ -0,0 +1,729 @@
+#include "geMeshSimplify.h"
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+
+//Heap position of a vertex that isn't queued
+#define GE_SIMPLIFY_NO_POS 0xFFFFFFFF
+
+namespace GE
+{
+  /*
+  ------------------------------------------------------
+  Quadric
+  ------------------------------------------------------*/
+
+  MeshQuadric::MeshQuadric ()
+  {
+    a00 = a01 = a02 = a11 = a12 = a22 = 0.0f;
+    b0 = b1 = b2 = 0.0f;
+    c = 0.0f;
+    area = 0.0f;
+  }
+
+  void MeshQuadric::addPlane (const Vector3 &n, Float d, Float w, Float planeArea)
+  {
+    a00 += w * n.x * n.x;
+    a01 += w * n.x * n.y;
+    a02 += w * n.x * n.z;
+    a11 += w * n.y * n.y;
+    a12 += w * n.y * n.z;
+    a22 += w * n.z * n.z;
+    b0 += w * d * n.x;
+    b1 += w * d * n.y;
+    b2 += w * d * n.z;
+    c += w * d * d;
+    area += planeArea;
+  }
+
+  void MeshQuadric::add (const MeshQuadric &q)
+  {
+    a00 += q.a00; a01 += q.a01; a02 += q.a02;
+    a11 += q.a11; a12 += q.a12; a22 += q.a22;
+    b0 += q.b0; b1 += q.b1; b2 += q.b2;
+    c += q.c;
+    area += q.area;
+  }
+
+  Float MeshQuadric::eval (const Vector3 &p) const
+  {
+    return
+      a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z +
+      2.0f * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z) +
+      2.0f * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+  }
+
+  SimplifyOptions::SimplifyOptions ()
+  {
+    metric = SmoothMetric::None;
+    uvWeight = 1.0f;
+    normalWeight = 0.05f;
+  }
+
+  /*
+  ------------------------------------------------------
+  Simplifier
+  ------------------------------------------------------*/
+
+  MeshSimplifier::MeshSimplifier ()
+  {
+    mesh = NULL;
+    texMesh = NULL;
+    scale = 1.0f;
+    stamp = 0;
+    error = 0.0f;
+    uvError = 0.0f;
+    numCollapses = 0;
+    numRefused = 0;
+  }
+
+  MeshSimplifier::~MeshSimplifier ()
+  {
+    end();
+  }
+
+  Vector3 MeshSimplifier::local (const Vector3 &p)
+  {
+    return (p - origin) * scale;
+  }
+
+  /*
+  Borders, material borders, texture seams and edges the
+  smooth metric keeps hard. */
+
+  bool MeshSimplifier::isFeature (PolyMesh::HalfEdge *h)
+  {
+    PolyMesh::HalfEdge *t = h->twinHedge();
+    PolyMesh::Face *f1 = h->parentFace();
+    PolyMesh::Face *f2 = t->parentFace();
+    if (f1 == NULL || f2 == NULL) return true;
+    if (f1->materialID() != f2->materialID()) return true;
+
+    if (options.metric == SmoothMetric::Edge && !h->fullEdge()->isSmooth) return true;
+    if (options.metric == SmoothMetric::Face && (f1->smoothGroups & f2->smoothGroups) == 0) return true;
+
+    //Corners at either end differ across the edge
+    if (texMesh != NULL)
+      if (cornerWedge[ h->prevHedge()->index ] != cornerWedge[ t->index ] ||
+          cornerWedge[ h->index ] != cornerWedge[ t->prevHedge()->index ])
+        return true;
+
+    return false;
+  }
+
+  int MeshSimplifier::countFeatures (PolyMesh::Vertex *v)
+  {
+    int count = 0;
+    PolyMesh::HalfEdge *first = v->outHedge();
+    PolyMesh::HalfEdge *h = first;
+    do {
+      if (isFeature( h )) count++;
+      h = h->twinHedge()->nextHedge();
+    } while (h != first);
+    return count;
+  }
+
+  /*
+  The ends of the edge may only share the vertices opposite
+  to it in its faces, else the collapse would fold the mesh
+  onto itself. */
+
+  bool MeshSimplifier::checkLink (PolyMesh::HalfEdge *h)
+  {
+    PolyMesh::Vertex *a = h->srcVertex();
+    PolyMesh::Vertex *b = h->dstVertex();
+    stamp++;
+
+    PolyMesh::HalfEdge *first = a->outHedge();
+    PolyMesh::HalfEdge *o = first;
+    do {
+      stamps[ o->dstVertex()->index ] = stamp;
+      o = o->twinHedge()->nextHedge();
+    } while (o != first);
+
+    int common = 0;
+    first = b->outHedge();
+    o = first;
+    do {
+      if (stamps[ o->dstVertex()->index ] == stamp) common++;
+      o = o->twinHedge()->nextHedge();
+    } while (o != first);
+
+    int expected = (h->face != NULL ? 1 : 0) + (h->twin->face != NULL ? 1 : 0);
+    return common == expected;
+  }
+
+  /*
+  The faces of the edge pair up the texture vertices at its
+  ends. A corner of the removed vertex with a texture vertex
+  that has no pair would tear the texture map. */
+
+  bool MeshSimplifier::mapWedge (PolyMesh::HalfEdge *h, Uint32 from, Uint32 *to)
+  {
+    PolyMesh::HalfEdge *t = h->twinHedge();
+
+    if (h->face != NULL && cornerWedge[ h->prevHedge()->index ] == from) {
+      *to = cornerWedge[ h->index ];
+      return true; }
+
+    if (t->face != NULL && cornerWedge[ t->index ] == from) {
+      *to = cornerWedge[ t->prevHedge()->index ];
+      return true; }
+
+    return false;
+  }
+
+  /*
+  Cost of moving the source vertex of the half-edge onto its
+  destination: the quadric error of both at the destination
+  plus how far the texture coordinates the remaining faces
+  would take there are from the ones of the destination, and
+  how much the faces would turn. Refused collapses cost
+  FLT_MAX. */
+
+  Float MeshSimplifier::evalCollapse (PolyMesh::HalfEdge *h, Float *outGeo, Float *outUv)
+  {
+    PolyMesh::Vertex *a = h->srcVertex();
+    PolyMesh::Vertex *b = h->dstVertex();
+    if (!checkLink( h )) return FLT_MAX;
+
+    Vector3 pa = local( a->point );
+    Vector3 pb = local( b->point );
+    Float areaSum = 0.0f, uvSum = 0.0f, turnSum = 0.0f;
+
+    for (PolyMesh::VertFaceIter vf( a ); !vf.end(); ++vf)
+    {
+      //Corner of a and the rest of the triangle in order
+      PolyMesh::HalfEdge *c = vf.hedgeToVertex();
+      PolyMesh::HalfEdge *cx = c->nextHedge();
+      PolyMesh::HalfEdge *cy = c->prevHedge();
+      PolyMesh::Vertex *x = cx->dstVertex();
+      PolyMesh::Vertex *y = cy->dstVertex();
+      if (x == b || y == b) continue;
+
+      Vector3 px = local( x->point );
+      Vector3 py = local( y->point );
+      Vector3 e1 = px - pa, e2 = py - pa;
+      Vector3 nOld = Vector::Cross( e1, e2 );
+      Vector3 nNew = Vector::Cross( px - pb, py - pb );
+      Float lenOld = nOld.norm();
+      Float lenNew = nNew.norm();
+      Float dot = Vector::Dot( nOld, nNew );
+
+      //Refuse flipped, folded and degenerate results
+      if (lenNew <= 0.0f) return FLT_MAX;
+      if (lenOld > 0.0f && dot < GE_SIMPLIFY_MIN_TURN * lenOld * lenNew) return FLT_MAX;
+
+      Float area = lenOld * 0.5f;
+      Float cosTurn = (lenOld > 0.0f) ? dot / (lenOld * lenNew) : 1.0f;
+      turnSum += area * (1.0f - cosTurn);
+      areaSum += area;
+
+      if (texMesh != NULL)
+      {
+        Uint32 wa = cornerWedge[ c->index ], wb = 0;
+        if (!mapWedge( h, wa, &wb )) return FLT_MAX;
+        if (lenOld <= 0.0f) continue;
+
+        //Texture coordinates the old face had at the destination
+        Vector3 d = pb - pa;
+        Float lenSq = lenOld * lenOld;
+        Float s = Vector::Dot( Vector::Cross( e2, nOld ), d ) / lenSq;
+        Float r = Vector::Dot( Vector::Cross( nOld, e1 ), d ) / lenSq;
+        Vector2 ua = wedgeUV[ wa ];
+        Vector2 ux = wedgeUV[ cornerWedge[ cx->index ]];
+        Vector2 uy = wedgeUV[ cornerWedge[ cy->index ]];
+        Vector2 expect = ua + (ux - ua) * s + (uy - ua) * r;
+        uvSum += area * (expect - wedgeUV[ wb ]).normSq();
+      }
+    }
+
+    MeshQuadric q = quadrics[ a->index ];
+    q.add( quadrics[ b->index ] );
+    Float geo = Util::Max( q.eval( pb ), 0.0f );
+    if (q.area > 0.0f) geo /= q.area;
+
+    Float uv = (areaSum > 0.0f) ? uvSum / areaSum : 0.0f;
+    Float turn = (areaSum > 0.0f) ? turnSum / areaSum : 0.0f;
+
+    *outGeo = geo;
+    *outUv = uv;
+    return geo + options.uvWeight * uv + options.normalWeight * turn;
+  }
+
+  /*
+  Finds the cheapest collapse of the vertex. Vertices on a
+  single line of features may only slide along it, those
+  where features end or branch are kept. */
+
+  void MeshSimplifier::updateVertex (PolyMesh::Vertex *v)
+  {
+    Uint32 slot = v->index;
+    best[ slot ] = NULL;
+    costs[ slot ] = FLT_MAX;
+
+    if (v->valid && v->outHedge() != NULL)
+    {
+      int numFeatures = countFeatures( v );
+      if (numFeatures == 0 || numFeatures == 2)
+      {
+        PolyMesh::HalfEdge *first = v->outHedge();
+        PolyMesh::HalfEdge *h = first;
+        do {
+          if (numFeatures == 0 || isFeature( h ))
+          {
+            Float geo = 0.0f, uv = 0.0f;
+            Float cost = evalCollapse( h, &geo, &uv );
+            if (cost < costs[ slot ]) {
+              costs[ slot ] = cost;
+              geoErrors[ slot ] = geo;
+              uvErrors[ slot ] = uv;
+              best[ slot ] = h; }
+          }
+          h = h->twinHedge()->nextHedge();
+        } while (h != first);
+      }
+    }
+
+    heapUpdate( slot );
+  }
+
+  bool MeshSimplifier::collapseHedge (PolyMesh::HalfEdge *h)
+  {
+    PolyMesh::Vertex *a = h->srcVertex();
+    PolyMesh::Vertex *b = h->dstVertex();
+    PolyMesh::HalfEdge *t = h->twinHedge();
+
+    //Corners of a on the faces that stay and their new texture vertex
+    corners.clear();
+    cornerTo.clear();
+    for (PolyMesh::VertFaceIter vf( a ); !vf.end(); ++vf)
+    {
+      PolyMesh::HalfEdge *c = vf.hedgeToVertex();
+      if (c->nextHedge()->dstVertex() == b || c->prevHedge()->dstVertex() == b) continue;
+
+      Uint32 to = 0;
+      if (texMesh != NULL) mapWedge( h, cornerWedge[ c->index ], &to );
+      corners.pushBack( c );
+      cornerTo.pushBack( to );
+    }
+
+    //Side edges of each face merge, a hard one keeps the result hard
+    PolyMesh::Edge *sides[4] = { NULL, NULL, NULL, NULL };
+    if (h->face != NULL) {
+      sides[0] = h->nextHedge()->fullEdge();
+      sides[1] = h->prevHedge()->fullEdge(); }
+    if (t->face != NULL) {
+      sides[2] = t->nextHedge()->fullEdge();
+      sides[3] = t->prevHedge()->fullEdge(); }
+
+    bool smooth[2] = {
+      sides[0] == NULL || (sides[0]->isSmooth && sides[1]->isSmooth),
+      sides[2] == NULL || (sides[2]->isSmooth && sides[3]->isSmooth) };
+
+    //The edge collapses into the vertex its first half-edge leaves
+    PolyMesh::Edge *edge = h->fullEdge();
+    edge->hedge = t;
+    if (!mesh->collapseEdge( edge ))
+      return false;
+
+    for (int s=0; s<4; ++s)
+      if (sides[s] != NULL) sides[s]->isSmooth = smooth[ s/2 ];
+
+    if (texMesh != NULL)
+      for (UintSize c=0; c<corners.size(); ++c)
+        cornerWedge[ corners[c]->index ] = cornerTo[c];
+
+    quadrics[ b->index ].add( quadrics[ a->index ] );
+    error = Util::Max( error, std::sqrt( geoErrors[ a->index ] ) / scale );
+    uvError = Util::Max( uvError, std::sqrt( uvErrors[ a->index ] ));
+    numCollapses++;
+    return true;
+  }
+
+  /*
+  ------------------------------------------------------
+  Min-heap of vertex slots keyed by the collapse cost
+  ------------------------------------------------------*/
+
+  void MeshSimplifier::heapUp (Uint32 pos)
+  {
+    Uint32 slot = heap[ pos ];
+    while (pos > 0)
+    {
+      Uint32 parent = (pos - 1) / 2;
+      if (costs[ heap[ parent ]] <= costs[ slot ]) break;
+      heap[ pos ] = heap[ parent ];
+      heapPos[ heap[ pos ]] = pos;
+      pos = parent;
+    }
+    heap[ pos ] = slot;
+    heapPos[ slot ] = pos;
+  }
+
+  void MeshSimplifier::heapDown (Uint32 pos)
+  {
+    Uint32 slot = heap[ pos ];
+    Uint32 count = (Uint32) heap.size();
+    while (true)
+    {
+      Uint32 child = pos * 2 + 1;
+      if (child >= count) break;
+      if (child + 1 < count && costs[ heap[ child+1 ]] < costs[ heap[ child ]]) child++;
+      if (costs[ slot ] <= costs[ heap[ child ]]) break;
+      heap[ pos ] = heap[ child ];
+      heapPos[ heap[ pos ]] = pos;
+      pos = child;
+    }
+    heap[ pos ] = slot;
+    heapPos[ slot ] = pos;
+  }
+
+  void MeshSimplifier::heapUpdate (Uint32 slot)
+  {
+    if (costs[ slot ] == FLT_MAX) {
+      heapRemove( slot );
+      return; }
+
+    if (heapPos[ slot ] == GE_SIMPLIFY_NO_POS) {
+      heap.pushBack( slot );
+      heapUp( (Uint32) heap.size() - 1 );
+      return; }
+
+    heapUp( heapPos[ slot ] );
+    heapDown( heapPos[ slot ] );
+  }
+
+  void MeshSimplifier::heapRemove (Uint32 slot)
+  {
+    Uint32 pos = heapPos[ slot ];
+    if (pos == GE_SIMPLIFY_NO_POS) return;
+    heapPos[ slot ] = GE_SIMPLIFY_NO_POS;
+
+    Uint32 last = heap.last();
+    heap.popBack();
+    if (last == slot) return;
+
+    heap[ pos ] = last;
+    heapPos[ last ] = pos;
+    heapUp( pos );
+    heapDown( heapPos[ last ] );
+  }
+
+  /*
+  ------------------------------------------------------
+  Setup, collapsing and rebuild of the texture mesh
+  ------------------------------------------------------*/
+
+  bool MeshSimplifier::begin (PolyMesh *newMesh, TexMesh *newTexMesh, const SimplifyOptions &newOptions)
+  {
+    end();
+    options = newOptions;
+    error = 0.0f;
+    uvError = 0.0f;
+    numCollapses = 0;
+    numRefused = 0;
+
+    if (newTexMesh != NULL && newTexMesh->faceCount() != newMesh->faceCount()) {
+      std::cout << "MeshSimplifier: texture mesh doesn't match the mesh" << std::endl;
+      return false; }
+
+    copySplit( newMesh, newTexMesh );
+
+    //Unit-sized box for the errors to compare to texture coordinates
+    Vector3 vmin, vmax;
+    bool first = true;
+    for (PolyMesh::VertIter v( mesh ); !v.end(); ++v) {
+      Vector3 &p = v->point;
+      if (first) { vmin = vmax = p; first = false; continue; }
+      vmin.set( Util::Min( vmin.x, p.x ), Util::Min( vmin.y, p.y ), Util::Min( vmin.z, p.z ));
+      vmax.set( Util::Max( vmax.x, p.x ), Util::Max( vmax.y, p.y ), Util::Max( vmax.z, p.z )); }
+
+    Vector3 extent = vmax - vmin;
+    Float size = Util::Max( extent.x, Util::Max( extent.y, extent.z ));
+    origin = vmin;
+    scale = (size > 0.0f) ? 1.0f / size : 1.0f;
+
+    //Per vertex slot state
+    UintSize numVerts = mesh->verts.end();
+    quadrics.clear(); quadrics.resize( numVerts );
+    best.clear(); best.resize( numVerts );
+    costs.clear(); costs.resize( numVerts );
+    geoErrors.clear(); geoErrors.resize( numVerts );
+    uvErrors.clear(); uvErrors.resize( numVerts );
+    heapPos.clear(); heapPos.resize( numVerts );
+    stamps.clear(); stamps.resize( numVerts );
+    for (UintSize v=0; v<numVerts; ++v) {
+      quadrics[v] = MeshQuadric();
+      best[v] = NULL;
+      costs[v] = FLT_MAX;
+      geoErrors[v] = 0.0f;
+      uvErrors[v] = 0.0f;
+      heapPos[v] = GE_SIMPLIFY_NO_POS;
+      stamps[v] = 0; }
+    stamp = 0;
+
+    //Texture vertex of every corner, faces pair up in order
+    if (texMesh != NULL)
+    {
+      wedgeUV.clear();
+      for (TexMesh::VertIter tv( texMesh ); !tv.end(); ++tv) {
+        tv->tag.id = (int) wedgeUV.size();
+        wedgeUV.pushBack( tv->point ); }
+
+      cornerWedge.clear();
+      cornerWedge.resize( mesh->hedges.end() );
+
+      PolyMesh::FaceIter f;
+      PolyMesh::FaceVertIter fv;
+      TexMesh::FaceIter uf;
+      TexMesh::FaceVertIter ufv;
+      for (f.begin( mesh ), uf.begin( texMesh ); !f.end(); ++f, ++uf)
+        for (fv.begin( *f ), ufv.begin( *uf ); !fv.end(); ++fv, ++ufv)
+          cornerWedge[ fv.hedgeToVertex()->index ] = (Uint32) ufv->tag.id;
+    }
+
+    //Face planes weighted by area
+    for (PolyMesh::FaceIter f( mesh ); !f.end(); ++f)
+    {
+      PolyMesh::HalfEdge *h = f->firstHedge();
+      PolyMesh::Vertex *v[3] = {
+        h->dstVertex(), h->nextHedge()->dstVertex(), h->prevHedge()->dstVertex() };
+
+      Vector3 p0 = local( v[0]->point );
+      Vector3 normal = Vector::Cross( local( v[1]->point ) - p0, local( v[2]->point ) - p0 );
+      Float len = normal.norm();
+      if (len <= 0.0f) continue;
+
+      normal /= len;
+      Float area = len * 0.5f;
+      Float dist = -Vector::Dot( normal, p0 );
+      for (int k=0; k<3; ++k)
+        quadrics[ v[k]->index ].addPlane( normal, dist, area, area );
+    }
+
+    //Planes across the features hold them in place
+    for (PolyMesh::EdgeIter e( mesh ); !e.end(); ++e)
+    {
+      PolyMesh::HalfEdge *h = e->hedge1();
+      if (!isFeature( h )) continue;
+
+      PolyMesh::Vertex *a = h->srcVertex();
+      PolyMesh::Vertex *b = h->dstVertex();
+      Vector3 pa = local( a->point );
+      Vector3 dir = local( b->point ) - pa;
+      Float weight = GE_SIMPLIFY_FEATURE_WEIGHT * dir.normSq();
+      if (weight <= 0.0f) continue;
+
+      PolyMesh::HalfEdge *sides[2] = { h, h->twinHedge() };
+      for (int s=0; s<2; ++s)
+      {
+        if (sides[s]->face == NULL) continue;
+        Vector3 p0 = local( sides[s]->srcVertex()->point );
+        Vector3 p1 = local( sides[s]->dstVertex()->point );
+        Vector3 p2 = local( sides[s]->nextHedge()->dstVertex()->point );
+
+        Vector3 across = Vector::Cross( dir, Vector::Cross( p1 - p0, p2 - p0 ));
+        Float len = across.norm();
+        if (len <= 0.0f) continue;
+
+        across /= len;
+        Float dist = -Vector::Dot( across, pa );
+        quadrics[ a->index ].addPlane( across, dist, weight, 0.0f );
+        quadrics[ b->index ].addPlane( across, dist, weight, 0.0f );
+      }
+    }
+
+    for (PolyMesh::VertIter v( mesh ); !v.end(); ++v)
+      updateVertex( *v );
+
+    return true;
+  }
+
+  /*
+  The working meshes are copies of the source with every
+  polygon split into the triangles of its triangulation.
+  The new diagonals are smooth, the other edges keep their
+  flags. They are of the class of the source, which copies
+  the data its vertices carry. */
+
+  void MeshSimplifier::copySplit (PolyMesh *source, TexMesh *sourceTex)
+  {
+    mesh = (PolyMesh*) ClassOf( source )->instantiate();
+    texMesh = (sourceTex != NULL) ? new TexMesh : NULL;
+
+    for (PolyMesh::FaceIter f( source ); !f.end(); ++f)
+      if (f->firstTriangle() == NULL) {
+        source->triangulate();
+        break; }
+
+    //New vertices by source slot
+    ArrayList< PolyMesh::Vertex* > verts;
+    verts.resize( source->verts.end() );
+    for (PolyMesh::VertIter v( source ); !v.end(); ++v) {
+      verts[ v->index ] = mesh->addVertex();
+      mesh->copyVertex( verts[ v->index ], *v ); }
+
+    //New texture vertex of every source corner, faces pair up in order
+    ArrayList< TexMesh::Vertex* > texCorners;
+    if (texMesh != NULL)
+    {
+      ArrayList< TexMesh::Vertex* > texVerts;
+      texVerts.resize( sourceTex->verts.end() );
+      for (TexMesh::VertIter tv( sourceTex ); !tv.end(); ++tv) {
+        texVerts[ tv->index ] = texMesh->addVertex();
+        texVerts[ tv->index ]->point = tv->point; }
+
+      texCorners.resize( source->hedges.end() );
+
+      PolyMesh::FaceIter f;
+      PolyMesh::FaceVertIter fv;
+      TexMesh::FaceIter uf;
+      TexMesh::FaceVertIter ufv;
+      for (f.begin( source ), uf.begin( sourceTex ); !f.end(); ++f, ++uf)
+        for (fv.begin( *f ), ufv.begin( *uf ); !fv.end(); ++fv, ++ufv)
+          texCorners[ fv.hedgeToVertex()->index ] = texVerts[ ufv->index ];
+    }
+
+    for (PolyMesh::FaceIter f( source ); !f.end(); ++f)
+    {
+      for (PolyMesh::Triangle *t = f->firstTriangle(); t != NULL; t = t->nextTriangle())
+      {
+        PolyMesh::Vertex *corners[3];
+        TexMesh::Vertex *texTri[3];
+        for (int k=0; k<3; ++k) {
+          corners[k] = verts[ t->vertex(k)->index ];
+          if (texMesh != NULL) texTri[k] = texCorners[ t->hedgeToVertex(k)->index ]; }
+
+        PolyMesh::Face *face = mesh->addFace( corners, 3 );
+        if (face == NULL) continue;
+
+        face->smoothGroups = f->smoothGroups;
+        mesh->setMaterialID( face, f->materialID() );
+        if (texMesh == NULL) continue;
+
+        //Same fallback as the rebuild keeps the faces paired
+        if (texMesh->addFace( texTri, 3 ) == NULL)
+        {
+          for (int k=0; k<3; ++k) {
+            Vector2 uv = texTri[k]->point;
+            texTri[k] = texMesh->addVertex();
+            texTri[k]->point = uv; }
+
+          texMesh->addFace( texTri, 3 );
+        }
+      }
+    }
+
+    for (PolyMesh::EdgeIter e( mesh ); !e.end(); ++e)
+      e->isSmooth = true;
+
+    for (PolyMesh::EdgeIter e( source ); !e.end(); ++e)
+    {
+      if (e->isSmooth) continue;
+      PolyMesh::HalfEdge *h = verts[ e->vertex1()->index ]->outHedgeTo( verts[ e->vertex2()->index ] );
+      if (h != NULL) h->fullEdge()->isSmooth = false;
+    }
+  }
+
+  UintSize MeshSimplifier::collapse (UintSize targetFaces, Float maxError)
+  {
+    if (mesh == NULL) return 0;
+
+    while ((UintSize) mesh->faceCount() > targetFaces && !heap.empty())
+    {
+      Uint32 slot = heap.first();
+      PolyMesh::Vertex *a = (PolyMesh::Vertex*) mesh->verts.at( slot );
+      if (!a->valid) {
+        heapRemove( slot );
+        continue; }
+
+      //Stale if the ring changed without the vertex being updated
+      PolyMesh::HalfEdge *h = best[ slot ];
+      if (!h->valid || h->srcVertex() != a) {
+        updateVertex( a );
+        continue; }
+
+      if (std::sqrt( geoErrors[ slot ] ) / scale > maxError)
+        break;
+
+      PolyMesh::Vertex *b = h->dstVertex();
+      if (!collapseHedge( h )) {
+        numRefused++;
+        costs[ slot ] = FLT_MAX;
+        heapRemove( slot );
+        continue; }
+
+      heapRemove( slot );
+
+      //Costs around the kept vertex changed
+      updateVertex( b );
+      PolyMesh::HalfEdge *first = b->outHedge();
+      PolyMesh::HalfEdge *o = first;
+      if (o != NULL) do {
+        updateVertex( o->dstVertex() );
+        o = o->twinHedge()->nextHedge();
+      } while (o != first);
+    }
+
+    return (UintSize) mesh->faceCount();
+  }
+
+  /*
+  Faces of the rebuilt texture mesh follow the faces of the
+  mesh, corners sharing a texture vertex share it again. A
+  face that can't share without breaking the texture mesh
+  gets vertices of its own. */
+
+  void MeshSimplifier::updateTexMesh ()
+  {
+    if (mesh == NULL || texMesh == NULL) return;
+
+    ArrayList< TexMesh::Vertex* > wedgeVerts;
+    wedgeVerts.resize( wedgeUV.size() );
+    for (UintSize w=0; w<wedgeVerts.size(); ++w)
+      wedgeVerts[w] = NULL;
+
+    texMesh->clear();
+
+    for (PolyMesh::FaceIter f( mesh ); !f.end(); ++f)
+    {
+      Uint32 wedges[3];
+      TexMesh::Vertex *texCorners[3];
+
+      //The loop of an added face starts at its second corner,
+      //so the corners go in one further to walk in step
+      int k = 1;
+      for (PolyMesh::FaceVertIter fv( *f ); !fv.end(); ++fv, k=(k+1)%3)
+      {
+        Uint32 w = cornerWedge[ fv.hedgeToVertex()->index ];
+        if (wedgeVerts[w] == NULL) {
+          wedgeVerts[w] = texMesh->addVertex();
+          wedgeVerts[w]->point = wedgeUV[w]; }
+
+        wedges[k] = w;
+        texCorners[k] = wedgeVerts[w];
+      }
+
+      if (texMesh->addFace( texCorners, 3 ) == NULL)
+      {
+        for (k=0; k<3; ++k) {
+          texCorners[k] = texMesh->addVertex();
+          texCorners[k]->point = wedgeUV[ wedges[k] ]; }
+
+        texMesh->addFace( texCorners, 3 );
+      }
+    }
+  }
+
+  void MeshSimplifier::end ()
+  {
+    delete mesh;
+    delete texMesh;
+
+    mesh = NULL;
+    texMesh = NULL;
+    heap.clear();
+  }
+
+}//namespace GE
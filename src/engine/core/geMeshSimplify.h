@@ -0,0 +1,157 @@
+#ifndef __GEMESHSIMPLIFY_H
+#define __GEMESHSIMPLIFY_H
+
+#include "util/geUtil.h"
+#include "math/geVectors.h"
+#include "gePolyMesh.h"
+#include "geTexMesh.h"
+
+#pragma warning(push)
+#pragma warning(disable:4251)
+
+//Weight of the planes holding borders, seams and hard edges in place
+#define GE_SIMPLIFY_FEATURE_WEIGHT 10.0f
+
+//Collapses turning a face further than this (cosine) are refused
+#define GE_SIMPLIFY_MIN_TURN 0.25f
+
+namespace GE
+{
+  /*
+  -----------------------------------------------------------
+  Quadric of the squared distances of a point to a set of
+  planes, as the upper half of the symmetric matrix A, the
+  vector b and the constant c of p'Ap + 2b'p + c. Planes of
+  faces are weighted by the face area, which is summed up
+  separately to turn the error back into a distance.
+  -----------------------------------------------------------*/
+
+  class MeshQuadric
+  {
+  public:
+    Float a00, a01, a02, a11, a12, a22;
+    Float b0, b1, b2;
+    Float c;
+    Float area;
+
+    MeshQuadric ();
+    void addPlane (const Vector3 &normal, Float dist, Float weight, Float planeArea);
+    void add (const MeshQuadric &q);
+    Float eval (const Vector3 &p) const;
+  };
+
+  /*
+  -----------------------------------------------------------
+  Attribute weights scale the squared texture coordinate
+  distance and the turn of the face normals against the
+  squared distance within a mesh scaled to a unit size.
+  -----------------------------------------------------------*/
+
+  class SimplifyOptions
+  {
+  public:
+    SmoothMetric::Enum metric;
+    Float uvWeight;
+    Float normalWeight;
+
+    SimplifyOptions ();
+  };
+
+  /*
+  -----------------------------------------------------------
+  Quadric error simplification of a triangulated PolyMesh.
+  Edges are collapsed cheapest first into one of their end
+  vertices, so the kept vertices never move and the texture
+  coordinates never need interpolation. Borders, texture
+  seams, material borders and hard edges (as defined by the
+  smooth metric) may only collapse along themselves and
+  vertices where they branch or end are kept.
+
+  The simplifier works on its own copy of the meshes with
+  every polygon split along its triangulation. The TexMesh
+  is rebuilt on request to follow the faces of the PolyMesh.
+  Collapsing can be continued in steps to produce a chain of
+  levels.
+  -----------------------------------------------------------*/
+
+  class MeshSimplifier
+  {
+    PolyMesh *mesh;
+    TexMesh *texMesh;
+    SimplifyOptions options;
+
+    //Positions are taken into a unit-sized box
+    Vector3 origin;
+    Float scale;
+
+    //Per vertex slot
+    ArrayList< MeshQuadric > quadrics;
+    ArrayList< PolyMesh::HalfEdge* > best;
+    ArrayList< Float > costs;
+    ArrayList< Float > geoErrors;
+    ArrayList< Float > uvErrors;
+    ArrayList< Uint32 > heapPos;
+    ArrayList< Uint32 > stamps;
+    Uint32 stamp;
+
+    //Texture vertex of every corner by half-edge slot
+    ArrayList< Uint32 > cornerWedge;
+    ArrayList< Vector2 > wedgeUV;
+
+    //Min-heap of vertex slots by cost
+    ArrayList< Uint32 > heap;
+
+    ArrayList< PolyMesh::HalfEdge* > corners;
+    ArrayList< Uint32 > cornerTo;
+    Float error;
+    Float uvError;
+    UintSize numCollapses;
+    UintSize numRefused;
+
+    Vector3 local (const Vector3 &p);
+    bool isFeature (PolyMesh::HalfEdge *h);
+    int countFeatures (PolyMesh::Vertex *v);
+    bool checkLink (PolyMesh::HalfEdge *h);
+    bool mapWedge (PolyMesh::HalfEdge *h, Uint32 from, Uint32 *to);
+    void copySplit (PolyMesh *source, TexMesh *sourceTex);
+    Float evalCollapse (PolyMesh::HalfEdge *h, Float *outGeo, Float *outUv);
+    bool collapseHedge (PolyMesh::HalfEdge *h);
+    void updateVertex (PolyMesh::Vertex *v);
+
+    void heapUp (Uint32 pos);
+    void heapDown (Uint32 pos);
+    void heapUpdate (Uint32 slot);
+    void heapRemove (Uint32 slot);
+
+  public:
+
+    MeshSimplifier ();
+    ~MeshSimplifier ();
+
+    //Copies the meshes to work on, texMesh may be NULL
+    bool begin (PolyMesh *mesh, TexMesh *texMesh, const SimplifyOptions &options);
+
+    //Collapses until at most targetFaces are left or the next collapse
+    //would exceed maxError, returns the number of faces left
+    UintSize collapse (UintSize targetFaces, Float maxError);
+
+    void updateTexMesh ();
+    void end ();
+
+    //Working copies, valid until end()
+    PolyMesh* getMesh () { return mesh; }
+    TexMesh* getTexMesh () { return texMesh; }
+
+    //Largest side of the bounding box, in mesh units
+    Float getSize () { return 1.0f / scale; }
+
+    //Largest geometric error of any collapse so far, in mesh units
+    Float getError () { return error; }
+    Float getUvError () { return uvError; }
+    UintSize getNumCollapses () { return numCollapses; }
+    UintSize getNumRefused () { return numRefused; }
+  };
+
+}//namespace GE
+#pragma warning(pop)
+#endif//__GEMESHSIMPLIFY_H
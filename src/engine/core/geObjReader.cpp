@@ -0,0 +1,578 @@
+#include <iostream>
+#include <cmath>
+#include "util/geUtil.h"
+#include "core/geObjReader.h"
+#include "core/geKernel.h"
+
+namespace GE
+{
+  /*
+  ----------------------------------------------------
+  ObjReader
+  ----------------------------------------------------*/
+
+  ObjReader::ObjReader (UintSize chunkSize)
+  {
+    this->chunkSize = chunkSize;
+    chunk = NULL;
+    chunkUsed = 0;
+    chunkPos = 0;
+    ownChunk = false;
+    fromFile = false;
+    endOfData = true;
+    lineEnd = NULL;
+    cur = NULL;
+    numLines = 0;
+  }
+
+  ObjReader::~ObjReader ()
+  {
+    close();
+  }
+
+  bool ObjReader::open (const CharString &filename)
+  {
+    close();
+
+    file = File( filename );
+    if (!file.open( FileAccess::Read, FileCondition::MustExist )) {
+      std::cout << "Failed opening OBJ file!" << std::endl;
+      return false; }
+
+    chunk = (char*) std::malloc( chunkSize );
+    ownChunk = true;
+    fromFile = true;
+    endOfData = false;
+    return true;
+  }
+
+  /*
+  Reads straight from memory the caller keeps around,
+  there are no chunks to fill. */
+
+  void ObjReader::openData (const void *data, UintSize size)
+  {
+    close();
+
+    chunk = (char*) data;
+    chunkUsed = size;
+    ownChunk = false;
+    fromFile = false;
+    endOfData = true;
+  }
+
+  void ObjReader::close ()
+  {
+    if (fromFile) file.close();
+    if (ownChunk) std::free( chunk );
+
+    chunk = NULL;
+    chunkUsed = 0;
+    chunkPos = 0;
+    ownChunk = false;
+    fromFile = false;
+    endOfData = true;
+    lineEnd = NULL;
+    cur = NULL;
+    numLines = 0;
+  }
+
+  /*
+  Moves the unread rest of the chunk to the front and reads
+  more behind it. The chunk grows when a single line
+  doesn't fit into it. */
+
+  bool ObjReader::fill ()
+  {
+    UintSize rest = chunkUsed - chunkPos;
+    if (rest > 0 && chunkPos > 0)
+      std::memmove( chunk, chunk + chunkPos, rest );
+
+    chunkUsed = rest;
+    chunkPos = 0;
+
+    if (chunkUsed == chunkSize) {
+      chunkSize *= 2;
+      chunk = (char*) std::realloc( chunk, chunkSize ); }
+
+    UintSize numRead = file.read( chunk + chunkUsed, chunkSize - chunkUsed );
+    chunkUsed += numRead;
+
+    if (numRead == 0) endOfData = true;
+    return numRead > 0;
+  }
+
+  bool ObjReader::nextLine ()
+  {
+    const char *start = NULL;
+    while (true)
+    {
+      start = chunk + chunkPos;
+      const char *end = chunk + chunkUsed;
+
+      //Whole line in the chunk
+      const char *newline = (const char*) std::memchr( start, '\n', end - start );
+      if (newline != NULL) {
+        lineEnd = newline;
+        chunkPos = (newline - chunk) + 1;
+        break; }
+
+      //Last line might not end with a newline
+      if (endOfData) {
+        if (start == end) return false;
+        lineEnd = end;
+        chunkPos = chunkUsed;
+        break; }
+
+      fill();
+    }
+
+    cur = start;
+    if (lineEnd > cur && lineEnd[-1] == '\r') lineEnd--;
+    numLines++;
+    return true;
+  }
+
+  void ObjReader::skipWhitespace ()
+  {
+    while (cur < lineEnd && (*cur == ' ' || *cur == '\t'))
+      ++cur;
+  }
+
+  bool ObjReader::token (const char **start, UintSize *length)
+  {
+    skipWhitespace();
+    if (cur >= lineEnd) return false;
+
+    *start = cur;
+    while (cur < lineEnd && *cur != ' ' && *cur != '\t')
+      ++cur;
+
+    *length = cur - *start;
+    return true;
+  }
+
+  bool ObjReader::isToken (const char *start, UintSize length, const char *match)
+  {
+    UintSize matchLength = std::strlen( match );
+    return length == matchLength && std::memcmp( start, match, length ) == 0;
+  }
+
+  /*
+  Decimal float without going through the C locale. Up to
+  18 significant digits are gathered in an integer, which
+  is then scaled by an exact power of ten, so typical OBJ
+  numbers come out the same as strtod gives them. */
+
+  Float ObjReader::ParseFloat (const char *s, const char *end, const char **next)
+  {
+    static const double powers[] = {
+      1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    const char *p = s;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+      negative = (*p == '-');
+      ++p; }
+
+    Uint64 mantissa = 0;
+    Int numDigits = 0;
+    Int exponent = 0;
+    bool anyDigits = false;
+
+    //Integer part
+    while (p < end && *p >= '0' && *p <= '9') {
+      if (numDigits < 18) {
+        mantissa = mantissa * 10 + (*p - '0');
+        if (mantissa > 0) numDigits++; }
+      else exponent++;
+      anyDigits = true;
+      ++p; }
+
+    //Fraction
+    if (p < end && *p == '.') {
+      ++p;
+      while (p < end && *p >= '0' && *p <= '9') {
+        if (numDigits < 18) {
+          mantissa = mantissa * 10 + (*p - '0');
+          if (mantissa > 0) numDigits++;
+          exponent--; }
+        anyDigits = true;
+        ++p; }}
+
+    if (!anyDigits) {
+      *next = s;
+      return 0.0f; }
+
+    //Exponent, only if digits follow
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+      const char *e = p + 1;
+      bool negativeExp = false;
+      if (e < end && (*e == '-' || *e == '+')) {
+        negativeExp = (*e == '-');
+        ++e; }
+
+      if (e < end && *e >= '0' && *e <= '9') {
+        Int value = 0;
+        while (e < end && *e >= '0' && *e <= '9') {
+          if (value < 10000) value = value * 10 + (*e - '0');
+          ++e; }
+        exponent += negativeExp ? -value : value;
+        p = e; }
+    }
+
+    double value = (double) mantissa;
+    if (mantissa != 0 && exponent != 0)
+    {
+      if (exponent > 0 && exponent <= 22) value *= powers[ exponent ];
+      else if (exponent < 0 && exponent >= -22) value /= powers[ -exponent ];
+      else value *= std::pow( 10.0, (double) exponent );
+    }
+
+    *next = p;
+    return (Float) (negative ? -value : value);
+  }
+
+  Float ObjReader::parseFloat ()
+  {
+    skipWhitespace();
+    return ParseFloat( cur, lineEnd, &cur );
+  }
+
+  static Int ParseIntAt (const char **pos, const char *end)
+  {
+    const char *p = *pos;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+      negative = (*p == '-');
+      ++p; }
+
+    Int value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+      value = value * 10 + (*p - '0');
+      ++p; }
+
+    *pos = p;
+    return negative ? -value : value;
+  }
+
+  Int ObjReader::parseInt ()
+  {
+    skipWhitespace();
+    return ParseIntAt( &cur, lineEnd );
+  }
+
+  Vector3 ObjReader::parseVector3 ()
+  {
+    Vector3 v;
+    v.x = parseFloat();
+    v.y = parseFloat();
+    v.z = parseFloat();
+    return v;
+  }
+
+  bool ObjReader::parseCorner (Int *v, Int *vt, Int *vn)
+  {
+    skipWhitespace();
+    if (cur >= lineEnd) return false;
+
+    *v = ParseIntAt( &cur, lineEnd );
+    *vt = 0;
+    *vn = 0;
+
+    if (cur < lineEnd && *cur == '/')
+    {
+      ++cur;
+      if (cur < lineEnd && *cur != '/')
+        *vt = ParseIntAt( &cur, lineEnd );
+
+      if (cur < lineEnd && *cur == '/') {
+        ++cur;
+        *vn = ParseIntAt( &cur, lineEnd ); }
+    }
+
+    //Skip whatever is left of a malformed corner
+    while (cur < lineEnd && *cur != ' ' && *cur != '\t')
+      ++cur;
+
+    return true;
+  }
+
+  /*
+  ----------------------------------------------------
+  ObjMeshLoader
+  ----------------------------------------------------*/
+
+  ObjMeshLoader::ObjMeshLoader ()
+  {
+    curGroup = 0;
+    mesh = NULL;
+    numLods = GE_TRIMESH_NUM_LODS;
+    pool = (Kernel::GetInstance() != NULL) ? Kernel::GetInstance()->getThreadPool() : NULL;
+  }
+
+  void ObjMeshLoader::setLods (UintSize numLods, ThreadPool *pool)
+  {
+    this->numLods = numLods;
+    this->pool = pool;
+  }
+
+  ObjMeshLoader::~ObjMeshLoader ()
+  {
+    reset();
+  }
+
+  void ObjMeshLoader::reset ()
+  {
+    for (UintSize g=0; g<groupIndices.size(); ++g)
+      delete groupIndices[ g ];
+
+    if (mesh != NULL)
+      delete mesh;
+
+    points.clear();
+    texcoords.clear();
+    normals.clear();
+    corners.clear();
+    hashes.clear();
+    slots.clear();
+    materials.clear();
+    groupIndices.clear();
+    curGroup = 0;
+    mesh = NULL;
+  }
+
+  Uint64 ObjMeshLoader::HashCorner (const Corner &c)
+  {
+    Uint64 h = (Uint64) (Uint32) c.v * 0x9E3779B97F4A7C15ull;
+    h ^= (Uint64) (Uint32) c.vt * 0xC2B2AE3D27D4EB4Full;
+    h ^= (Uint64) (Uint32) c.vn * 0x165667B19E3779F9ull;
+    return h ^ (h >> 29);
+  }
+
+  void ObjMeshLoader::rehash (UintSize capacity)
+  {
+    slots.clear();
+    slots.resize( capacity );
+    for (UintSize s=0; s<capacity; ++s)
+      slots[ s ] = -1;
+
+    UintSize mask = capacity - 1;
+    for (UintSize c=0; c<corners.size(); ++c)
+    {
+      UintSize s = (UintSize) hashes[ c ] & mask;
+      while (slots[ s ] != -1) s = (s + 1) & mask;
+      slots[ s ] = (Int32) c;
+    }
+  }
+
+  /*
+  Returns the vertex for a corner, adding one the first
+  time a combination of indices shows up. */
+
+  VertexID ObjMeshLoader::weld (Corner c)
+  {
+    Uint64 hash = HashCorner( c );
+    UintSize mask = slots.size() - 1;
+    UintSize s = (UintSize) hash & mask;
+
+    while (slots[ s ] != -1)
+    {
+      const Corner &other = corners[ slots[ s ] ];
+      if (hashes[ slots[ s ] ] == hash &&
+          other.v == c.v && other.vt == c.vt && other.vn == c.vn)
+        return (VertexID) slots[ s ];
+
+      s = (s + 1) & mask;
+    }
+
+    VertexID id = (VertexID) corners.size();
+    corners.pushBack( c );
+    hashes.pushBack( hash );
+
+    //Grow at half load
+    if (corners.size() * 2 > slots.size())
+      rehash( slots.size() * 2 );
+    else slots[ s ] = (Int32) id;
+
+    return id;
+  }
+
+  void ObjMeshLoader::useMaterial (const char *name, UintSize length)
+  {
+    CharString material( name, (int) length );
+    for (UintSize m=0; m<materials.size(); ++m)
+      if (materials[ m ] == material) {
+        curGroup = m;
+        return; }
+
+    curGroup = materials.size();
+    materials.pushBack( material );
+    groupIndices.pushBack( new ArrayList< VertexID > );
+  }
+
+  /*
+  Negative indices count back from the last element read.
+  Corners with an invalid position are dropped, invalid
+  texture coordinates and normals are left out. */
+
+  static Int ResolveIndex (Int index, UintSize count)
+  {
+    if (index < 0) index += (Int) count;
+    else index -= 1;
+    return (index >= 0 && index < (Int) count) ? index : -1;
+  }
+
+  void ObjMeshLoader::face (ObjReader &reader)
+  {
+    ArrayList< VertexID > &indices = *groupIndices[ curGroup ];
+    VertexID first = 0, prev = 0;
+    UintSize numCorners = 0;
+    Int v, vt, vn;
+
+    while (reader.parseCorner( &v, &vt, &vn ))
+    {
+      Corner c;
+      c.v = ResolveIndex( v, points.size() );
+      c.vt = ResolveIndex( vt, texcoords.size() );
+      c.vn = ResolveIndex( vn, normals.size() );
+      if (c.v == -1) continue;
+
+      VertexID id = weld( c );
+      if (numCorners == 0) first = id;
+      else if (numCorners >= 2) {
+        indices.pushBack( first );
+        indices.pushBack( prev );
+        indices.pushBack( id ); }
+
+      prev = id;
+      numCorners++;
+    }
+  }
+
+  void ObjMeshLoader::finish (bool hasTexcoords)
+  {
+    VertexFormat format;
+    if (hasTexcoords) format.addMember( ShaderData::TexCoord2 );
+    format.addMember( ShaderData::Normal );
+    format.addMember( ShaderData::Coord3 );
+    mesh->setFormat( format );
+
+    VertexBinding< TriVertex > binding;
+    binding.init( mesh->getFormat() );
+
+    //Vertex data from the welded corners
+    mesh->data.clear();
+    mesh->data.resize( corners.size() );
+    bool missingNormals = false;
+
+    for (UintSize c=0; c<corners.size(); ++c)
+    {
+      const Corner &corner = corners[ c ];
+      TriVertex vert = binding( mesh->getVertex( c ));
+
+      *vert.coord = points[ corner.v ];
+      if (hasTexcoords)
+        *vert.texcoord = (corner.vt != -1) ? texcoords[ corner.vt ] : Vector2( 0.0f, 0.0f );
+
+      if (corner.vn != -1) *vert.normal = normals[ corner.vn ];
+      else {
+        *vert.normal = Vector3( 0.0f, 0.0f, 0.0f );
+        missingNormals = true; }
+    }
+
+    //Area weighted face normals where the file has none
+    if (missingNormals)
+    {
+      for (UintSize g=0; g<groupIndices.size(); ++g)
+      {
+        const ArrayList< VertexID > &indices = *groupIndices[ g ];
+        for (UintSize i=0; i+2<indices.size(); i+=3)
+        {
+          const Vector3 &p0 = points[ corners[ indices[i+0] ].v ];
+          const Vector3 &p1 = points[ corners[ indices[i+1] ].v ];
+          const Vector3 &p2 = points[ corners[ indices[i+2] ].v ];
+          Vector3 n = Vector::Cross( p1 - p0, p2 - p0 );
+
+          for (UintSize k=0; k<3; ++k)
+            if (corners[ indices[i+k] ].vn == -1)
+              *binding( mesh->getVertex( indices[i+k] )).normal += n;
+        }
+      }
+
+      for (UintSize c=0; c<corners.size(); ++c)
+        if (corners[ c ].vn == -1) {
+          Vector3 *n = binding( mesh->getVertex( c )).normal;
+          if (n->x != 0.0f || n->y != 0.0f || n->z != 0.0f) n->normalize(); }
+    }
+
+    //Face group for every material that got faces
+    for (UintSize g=0; g<groupIndices.size(); ++g)
+    {
+      const ArrayList< VertexID > &indices = *groupIndices[ g ];
+      if (indices.empty()) continue;
+
+      mesh->addFaceGroup( (MaterialID) g );
+      for (UintSize i=0; i+2<indices.size(); i+=3)
+        mesh->addFace( indices[i+0], indices[i+1], indices[i+2] );
+    }
+
+    mesh->updateBoundingBox();
+    mesh->optimize();
+    if (numLods > 0) mesh->buildLods( numLods, 0.5f, pool );
+  }
+
+  TriMesh* ObjMeshLoader::load (ObjReader &reader)
+  {
+    reset();
+    rehash( 1024 );
+    mesh = new TriMesh;
+
+    //Faces before any usemtl
+    useMaterial( "", 0 );
+
+    const char *cmd = NULL;
+    UintSize length = 0;
+
+    while (reader.nextLine())
+    {
+      if (!reader.token( &cmd, &length )) continue;
+
+      if (reader.isToken( cmd, length, "v" ))
+        points.pushBack( reader.parseVector3() );
+
+      else if (reader.isToken( cmd, length, "vt" )) {
+        Float u = reader.parseFloat();
+        Float v = reader.parseFloat();
+        texcoords.pushBack( Vector2( u, 1.0f - v )); }
+
+      else if (reader.isToken( cmd, length, "vn" ))
+        normals.pushBack( reader.parseVector3() );
+
+      else if (reader.isToken( cmd, length, "f" ))
+        face( reader );
+
+      else if (reader.isToken( cmd, length, "usemtl" )) {
+        const char *name = NULL;
+        UintSize nameLength = 0;
+        if (reader.token( &name, &nameLength ))
+          useMaterial( name, nameLength ); }
+    }
+
+    finish( !texcoords.empty() );
+
+    TriMesh *out = mesh;
+    mesh = NULL;
+    return out;
+  }
+
+  TriMesh* ObjMeshLoader::loadFile (const CharString &filename)
+  {
+    ObjReader reader;
+    if (!reader.open( filename )) return NULL;
+    return load( reader );
+  }
+
+}//namespace GE
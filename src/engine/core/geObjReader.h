@@ -0,0 +1,127 @@
+#ifndef __GEOBJREADER_H
+#define __GEOBJREADER_H
+
+#include "util/geUtil.h"
+#include "math/geVectors.h"
+#include "io/geFile.h"
+#include "geTriMesh.h"
+
+#pragma warning(push)
+#pragma warning(disable:4251)
+
+//Size of the chunks an OBJ file is read in
+#define GE_OBJ_CHUNK_SIZE 65536
+
+namespace GE
+{
+  /*
+  ----------------------------------------------------
+  Streaming tokenizer for Wavefront OBJ files. The file
+  is read in fixed size chunks and lines are handed out
+  as ranges into the chunk, so tokens and numbers are
+  parsed in place without allocating anything.
+  ----------------------------------------------------*/
+
+  class ObjReader
+  {
+    File file;
+    bool fromFile;
+    bool endOfData;
+
+    char *chunk;
+    UintSize chunkSize;
+    UintSize chunkUsed;
+    UintSize chunkPos;
+    bool ownChunk;
+
+    const char *lineEnd;
+    const char *cur;
+    UintSize numLines;
+
+    bool fill ();
+    void skipWhitespace ();
+
+  public:
+    ObjReader (UintSize chunkSize = GE_OBJ_CHUNK_SIZE);
+    ~ObjReader ();
+
+    bool open (const CharString &filename);
+    void openData (const void *data, UintSize size);
+    void close ();
+
+    //Moves to the next line, false once past the last one
+    bool nextLine ();
+    UintSize getNumLines () { return numLines; }
+
+    //Next whitespace separated token on the line
+    bool token (const char **start, UintSize *length);
+    bool isToken (const char *start, UintSize length, const char *match);
+
+    Float parseFloat ();
+    Int parseInt ();
+    Vector3 parseVector3 ();
+
+    //Corner of a face as "v", "v/vt", "v//vn" or "v/vt/vn", one based
+    //and zero if missing. False once no corners are left on the line.
+    bool parseCorner (Int *v, Int *vt, Int *vn);
+
+    static Float ParseFloat (const char *s, const char *end, const char **next);
+  };
+
+  /*
+  ----------------------------------------------------
+  Builds a TriMesh straight from an OBJ file, for when
+  no half-edge topology is needed. Corners with the
+  same position, texture coordinate and normal indices
+  are welded through a hash table. There is a face
+  group for every material, in order of first use.
+  Polygons are split into fans. Levels of detail are
+  built on the kernel's thread pool if there is one.
+  ----------------------------------------------------*/
+
+  class ObjMeshLoader
+  {
+    struct Corner
+    {
+      Int v, vt, vn;
+    };
+
+    ArrayList< Vector3 > points;
+    ArrayList< Vector2 > texcoords;
+    ArrayList< Vector3 > normals;
+
+    ArrayList< Corner > corners;
+    ArrayList< Int32 > slots;
+    ArrayList< Uint64 > hashes;
+
+    ArrayList< CharString > materials;
+    ArrayList< ArrayList< VertexID >* > groupIndices;
+    UintSize curGroup;
+
+    TriMesh *mesh;
+    UintSize numLods;
+    ThreadPool *pool;
+
+    static Uint64 HashCorner (const Corner &c);
+    void rehash (UintSize capacity);
+    VertexID weld (Corner c);
+    void useMaterial (const char *name, UintSize length);
+    void face (ObjReader &reader);
+    void finish (bool hasTexcoords);
+    void reset ();
+
+  public:
+    ObjMeshLoader ();
+    ~ObjMeshLoader ();
+
+    //Zero levels of detail leaves the mesh as it is
+    void setLods (UintSize numLods, ThreadPool *pool = NULL);
+
+    TriMesh* load (ObjReader &reader);
+    TriMesh* loadFile (const CharString &filename);
+    const ArrayList< CharString >& getMaterials () { return materials; }
+  };
+
+}//namespace GE
+#pragma warning(pop)
+#endif//__GEOBJREADER_H
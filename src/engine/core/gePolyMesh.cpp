@@ -1,5 +1,6 @@
 #include "gePolyMesh.h"
 #include "math/geMatrix.h"
+#include <cfloat>
 
 namespace GE
 {
@@ -11,6 +12,9 @@ namespace GE
 
   PolyMesh::PolyMesh ()
   {
+    fanFace = NULL;
+    fanLast = NULL;
+
     for (MaterialID m=0; m<GE_MAX_MATERIAL_ID; ++m)
       facesPerMaterial [m] = 0;
   }
@@ -56,10 +60,10 @@ namespace GE
     addMaterialID( ((PolyMesh::Face*) f)->materialID() );
   }
   
-  ListHandle PolyMesh::deleteFace (HMesh::Face *f)
+  void PolyMesh::deleteFace (HMesh::Face *f)
   {
     subMaterialID( ((PolyMesh::Face*) f)->materialID() );
-    return HMesh::deleteFace(f);
+    HMesh::deleteFace(f);
   }
   
   void PolyMesh::setMaterialID (Face *f, MaterialID id)
@@ -70,6 +74,11 @@ namespace GE
     f->matId = id;
   }
 
+  void PolyMesh::copyVertex (Vertex *to, Vertex *from)
+  {
+    to->point = from->point;
+  }
+
   /*
   --------------------------------------------------
   Calculates face normal from first three vertices
@@ -105,15 +114,15 @@ namespace GE
   being used for each adjacent face.
   -------------------------------------------------*/
   
-  void PolyMesh::updateVertNormalFlat (Vertex *vert)
+  void PolyMesh::updateVertNormalFlat (Vertex *vert, DynamicArrayList<VertexNormal> &normals)
   {
     VertFaceIter f;
     
     //Take the normal off each incident face and store it
     for (f.begin(vert); !f.end(); ++f) {
-      vertexNormals.pushBack (VertexNormal (f->normal));
-      vertexNormals.last().vert = vert;
-      f.hedgeToVertex()->vnormal = &vertexNormals.last();
+      normals.pushBack (VertexNormal (f->normal));
+      normals.last().vert = vert;
+      f.hedgeToVertex()->vnormal = &normals.last();
     }
   }
   
@@ -125,7 +134,7 @@ namespace GE
   each adjacent face.
   -------------------------------------------------*/
   
-  void PolyMesh::updateVertNormalSmooth (Vertex *vert)
+  void PolyMesh::updateVertNormalSmooth (Vertex *vert, DynamicArrayList<VertexNormal> &normals)
   {
     int count = 0;
     Vector3 sum;
@@ -138,12 +147,12 @@ namespace GE
 
     //Average the final normal vector
     if (count > 0) sum /= (Float)count;
-    vertexNormals.pushBack (VertexNormal (sum));
-    vertexNormals.last().vert = vert;
+    normals.pushBack (VertexNormal (sum));
+    normals.last().vert = vert;
 
     //Pass2: store normal into each half-edge
     for (f.begin(vert); !f.end(); ++f) {
-      f.hedgeToVertex()->vnormal = &vertexNormals.last();
+      f.hedgeToVertex()->vnormal = &normals.last();
     }
   }
 
@@ -211,7 +220,7 @@ namespace GE
   of the adjacent faces.
   -------------------------------------------------*/
 
-  void PolyMesh::updateVertNormalGroups(Vertex *vert)
+  void PolyMesh::updateVertNormalGroups (Vertex *vert, DynamicArrayList<VertexNormal> &normals)
   {
     PolyMesh::VertFaceIter f;
     ArraySet<SmoothGroup> groups(8);
@@ -255,9 +264,9 @@ namespace GE
     for (g=0; g<groups.size(); ++g)
     {
       groups[g].normal /= (Float)groups[g].faceCount;
-      vertexNormals.pushBack (VertexNormal (groups[g].normal));
-      vertexNormals.last().vert = vert;
-      groups[g].vnormal = &vertexNormals.last();
+      normals.pushBack (VertexNormal (groups[g].normal));
+      normals.last().vert = vert;
+      groups[g].vnormal = &normals.last();
     }
     
     //Pass2: Apply unique normals to faces
@@ -291,7 +300,7 @@ namespace GE
     }
   };
 
-  void PolyMesh::updateVertNormalEdges (Vertex *vert)
+  void PolyMesh::updateVertNormalEdges (Vertex *vert, DynamicArrayList<VertexNormal> &normals)
   {
     UintSize g;
     SmoothEdgeGroup *curGroup = NULL;
@@ -303,6 +312,9 @@ namespace GE
       if ( ! vf.hedgeToVertex()->fullEdge()->isSmooth)
         break;
 
+    //No hard edge leaves the iterator on the border, if any
+    if (vf.end()) vf.begin( vert );
+
     //Pass2: sum normals into groups
     for (vf.begin( vf ); !vf.end(); ++vf)
     {
@@ -323,9 +335,9 @@ namespace GE
     for (g=0; g<groups.size(); ++g)
     {
       groups[g].normal /= (Float)groups[g].faceCount;
-      vertexNormals.pushBack (VertexNormal (groups[g].normal));
-      vertexNormals.last().vert = vert;
-      groups[g].vnormal = &vertexNormals.last();
+      normals.pushBack (VertexNormal (groups[g].normal));
+      normals.last().vert = vert;
+      groups[g].vnormal = &normals.last();
     }
 
     //Assign normals to faces
@@ -334,44 +346,120 @@ namespace GE
         vf.hedgeToVertex()->vnormal = groups[g].vnormal;
   }
 
-  /*
-  ----------------------------------------------------
-  Updates face and vertex normals for the whole mesh
-  ----------------------------------------------------*/
-
-  void PolyMesh::updateNormals (SmoothMetric::Enum metric)
+  void PolyMesh::updateVertNormal (Vertex *vert, SmoothMetric::Enum metric,
+                                   DynamicArrayList<VertexNormal> &normals)
   {
-    vertexNormals.clear();
-    
-    for (PolyMesh::FaceIter f(this); !f.end(); ++f)
-      updateFaceNormal( *f );
-    
     switch (metric)
     {
     case SmoothMetric::None:
-      
-      for (PolyMesh::VertIter v(this); !v.end(); ++v)
-        updateVertNormalFlat( *v );
+      updateVertNormalFlat( vert, normals );
       break;
 
     case SmoothMetric::All:
-      
-      for (PolyMesh::VertIter v(this); !v.end(); ++v)
-        updateVertNormalSmooth( *v );
+      updateVertNormalSmooth( vert, normals );
       break;
 
     case SmoothMetric::Face:
-      
-      for (PolyMesh::VertIter v(this); !v.end(); ++v)
-        updateVertNormalGroups( *v );
+      updateVertNormalGroups( vert, normals );
       break;
-      
+
     case SmoothMetric::Edge:
+      updateVertNormalEdges( vert, normals );
+      break;
+    }
+  }
+
+  /*
+  ----------------------------------------------------
+  State shared by the jobs of a parallel pass. Faces
+  and vertices are snapshot in iteration order and
+  each job takes a run of them, so it only writes its
+  own faces or the half-edges pointing to its own
+  vertices. New vertex normals go into a list per job
+  and are moved over in job order afterwards, which
+  is the order a single thread creates them in.
+  ----------------------------------------------------*/
+
+  struct PolyMesh::ParallelPass
+  {
+    PolyMesh *mesh;
+    SmoothMetric::Enum metric;
+
+    ArrayList< Face* > faces;
+    ArrayList< Vertex* > verts;
+    UintSize numFaces;
+    DynamicArrayList< VertexNormal > *jobNormals;
+  };
+
+  static UintSize GetNumJobs (UintSize count)
+  {
+    return (count + GE_POLYMESH_JOB_SIZE - 1) / GE_POLYMESH_JOB_SIZE;
+  }
+
+  static UintSize GetJobEnd (UintSize index, UintSize count)
+  {
+    return Util::Min( (index + 1) * GE_POLYMESH_JOB_SIZE, count );
+  }
+
+  void PolyMesh::FaceNormalJob (UintSize index, void *param)
+  {
+    ParallelPass *pass = (ParallelPass*) param;
+    UintSize end = GetJobEnd( index, pass->numFaces );
+    for (UintSize f=index * GE_POLYMESH_JOB_SIZE; f<end; ++f)
+      pass->mesh->updateFaceNormal( pass->faces[ f ] );
+  }
+
+  void PolyMesh::VertNormalJob (UintSize index, void *param)
+  {
+    ParallelPass *pass = (ParallelPass*) param;
+    UintSize end = GetJobEnd( index, pass->verts.size() );
+    for (UintSize v=index * GE_POLYMESH_JOB_SIZE; v<end; ++v)
+      pass->mesh->updateVertNormal( pass->verts[ v ], pass->metric, pass->jobNormals[ index ] );
+  }
+
+  /*
+  ----------------------------------------------------
+  Updates face and vertex normals for the whole mesh
+  ----------------------------------------------------*/
+
+  void PolyMesh::updateNormals (SmoothMetric::Enum metric, ThreadPool *pool)
+  {
+    vertexNormals.clear();
+
+    //A pool of one thread gains nothing from the split
+    if (pool == NULL || pool->getNumThreads() < 2)
+    {
+      for (PolyMesh::FaceIter f(this); !f.end(); ++f)
+        updateFaceNormal( *f );
 
       for (PolyMesh::VertIter v(this); !v.end(); ++v)
-        updateVertNormalEdges( *v );
-      break;
+        updateVertNormal( *v, metric, vertexNormals );
+      return;
     }
+
+    ParallelPass pass;
+    pass.mesh = this;
+    pass.metric = metric;
+
+    pass.faces.reserve( faceCount() );
+    for (PolyMesh::FaceIter f(this); !f.end(); ++f)
+      pass.faces.pushBack( *f );
+
+    pass.verts.reserve( vertexCount() );
+    for (PolyMesh::VertIter v(this); !v.end(); ++v)
+      pass.verts.pushBack( *v );
+
+    pass.numFaces = pass.faces.size();
+    pool->parallelFor( GetNumJobs( pass.numFaces ), FaceNormalJob, &pass );
+
+    UintSize numJobs = GetNumJobs( pass.verts.size() );
+    pass.jobNormals = new DynamicArrayList< VertexNormal > [ numJobs ];
+    pool->parallelFor( numJobs, VertNormalJob, &pass );
+
+    for (UintSize j=0; j<numJobs; ++j)
+      vertexNormals.append( pass.jobNormals[ j ] );
+
+    delete[] pass.jobNormals;
   }
 
   /*
@@ -490,7 +578,11 @@ namespace GE
     Vertex *vertex;
     HalfEdge *hedge;
     Vector2 point;
-    bool orientation;
+    bool convex;
+    bool inGrid;
+    int prev;
+    int next;
+    int nextInCell;
   };
 
   struct TrigEdge
@@ -500,41 +592,203 @@ namespace GE
     Vertex *vertex2;
   };
 
-  typedef LinkedList<TrigNode>::Iterator TrigIter;
-  typedef LinkedList<TrigNode>::CyclicIterator TrigCyclIter;
+  /*
+  The corners run counter-clockwise, so a corner is
+  convex when it turns left. Straight corners cannot
+  be cut, they are treated as concave. */
 
-  bool findNodeOrientation (const TrigNode &prev, TrigNode &cur, const TrigNode &next,
-                            bool convex, bool convexInit)
+  bool findNodeConvex (ArrayList< TrigNode > &nodes, int cur)
   {
-    Vector2 prevV = (prev.point - cur.point).normalize();
-    Vector2 nextV = (next.point - cur.point).normalize();
-    Float cross = Vector::Cross( prevV, nextV );
+    TrigNode &c = nodes[ cur ];
+    const Vector2 &prev = nodes[ c.prev ].point;
+    const Vector2 &next = nodes[ c.next ].point;
+    c.convex = (Vector::Cross( c.point - prev, next - c.point ) > 0.0f);
+    return c.convex;
+  }
 
-    if (!convexInit || cross < -0.01f || cross > 0.01f)
-      cur.orientation = (cross > 0.0f);
-    else cur.orientation = !convex;
+  /*
+  Points on the border count as inside, a corner that
+  touches an ear must keep it from being cut. */
 
-    return cur.orientation;
+  bool isInsideTriangle (const Vector2 &p, const Vector2 &a,
+                         const Vector2 &b, const Vector2 &c)
+  {
+    return Vector::Cross( b - a, p - a ) >= 0.0f &&
+           Vector::Cross( c - b, p - b ) >= 0.0f &&
+           Vector::Cross( a - c, p - c ) >= 0.0f;
   }
-  
-  bool findNodeOrientation (const TrigCyclIter &cur, bool convex, bool convexInit)
+
+  /*
+  Only concave corners can lie inside an ear. A small
+  polygon is simply walked around for them. */
+
+  bool isEar (const ArrayList< TrigNode > &nodes, int cur)
   {
-    TrigCyclIter prev( cur ); --prev;
-    TrigCyclIter next( cur ); ++next;
-    return findNodeOrientation( *prev, *cur, *next, convex, convexInit );
+    const TrigNode &c = nodes[ cur ];
+    const TrigNode &p = nodes[ c.prev ];
+    const TrigNode &n = nodes[ c.next ];
+
+    for (int i = n.next; i != c.prev; i = nodes[ i ].next)
+      if (!nodes[ i ].convex && isInsideTriangle( nodes[ i ].point, p.point, c.point, n.point ))
+        return false;
+
+    return true;
   }
 
+  /*
+  ----------------------------------------------------
+  A large polygon buckets its concave corners into a
+  uniform grid with about one corner per cell. An ear
+  is tested against the corners in the cells it
+  crosses instead of against the whole polygon.
+  Cells chain their corners through the nodes, ones
+  that get cut or turn convex are dropped on the way.
+  ----------------------------------------------------*/
+
+  struct TrigGrid
+  {
+    ArrayList< int > cells;
+    Vector2 min;
+    Vector2 scale;
+    int sizeX;
+    int sizeY;
+
+    void init (ArrayList< TrigNode > &nodes)
+    {
+      UintSize numConcave = 0;
+      Vector2 max = min = nodes[0].point;
+      for (UintSize n=0; n<nodes.size(); ++n) {
+        min.x = Util::Min( min.x, nodes[n].point.x );
+        min.y = Util::Min( min.y, nodes[n].point.y );
+        max.x = Util::Max( max.x, nodes[n].point.x );
+        max.y = Util::Max( max.y, nodes[n].point.y );
+        if (!nodes[n].convex) numConcave++; }
+
+      //Split the cells along the sides in proportion
+      Float w = max.x - min.x, h = max.y - min.y;
+      Float numCells = (Float) Util::Max( numConcave, (UintSize) 1 );
+      Float aspect = (w > 0.0f && h > 0.0f) ? w / h : 1.0f;
+
+      sizeX = Util::Max( (int) std::sqrt( numCells * aspect ), 1 );
+      sizeX = Util::Min( sizeX, (int) numCells );
+      sizeY = Util::Max( (int) (numCells / (Float) sizeX), 1 );
+
+      scale.x = (w > 0.0f) ? (Float) sizeX / w : 0.0f;
+      scale.y = (h > 0.0f) ? (Float) sizeY / h : 0.0f;
+
+      cells.resize( sizeX * sizeY );
+      for (int c=0; c<sizeX * sizeY; ++c)
+        cells[ c ] = -1;
+
+      for (UintSize n=0; n<nodes.size(); ++n) {
+        nodes[n].inGrid = false;
+        if (!nodes[n].convex) insert( nodes, (int) n ); }
+    }
+
+    INLINE int cellX (Float x) const {
+      return Util::Max( 0, Util::Min( (int) ((x - min.x) * scale.x), sizeX-1 )); }
+
+    INLINE int cellY (Float y) const {
+      return Util::Max( 0, Util::Min( (int) ((y - min.y) * scale.y), sizeY-1 )); }
+
+    void insert (ArrayList< TrigNode > &nodes, int n)
+    {
+      if (nodes[ n ].inGrid) return;
+      int c = cellY( nodes[ n ].point.y ) * sizeX + cellX( nodes[ n ].point.x );
+      nodes[ n ].nextInCell = cells[ c ];
+      nodes[ n ].inGrid = true;
+      cells[ c ] = n;
+    }
+
+    //Widens the span by the part of the edge within the band
+    static void ClipEdge (const Vector2 &a, const Vector2 &b, Float lo, Float hi,
+                          Float *xmin, Float *xmax)
+    {
+      if (Util::Max( a.y, b.y ) < lo || Util::Min( a.y, b.y ) > hi)
+        return;
+
+      Float x0 = a.x, x1 = b.x;
+      if (a.y != b.y) {
+        Float t0 = (lo - a.y) / (b.y - a.y);
+        Float t1 = (hi - a.y) / (b.y - a.y);
+        if (t0 > t1) { Float t = t0; t0 = t1; t1 = t; }
+        t0 = Util::Max( t0, 0.0f );
+        t1 = Util::Min( t1, 1.0f );
+        x0 = a.x + (b.x - a.x) * t0;
+        x1 = a.x + (b.x - a.x) * t1; }
+
+      *xmin = Util::Min( *xmin, Util::Min( x0, x1 ));
+      *xmax = Util::Max( *xmax, Util::Max( x0, x1 ));
+    }
+
+    /*
+    Only the cells of every row the triangle crosses
+    are visited, long thin ears along a diagonal would
+    cover most of the grid with their bounds. The band
+    of a row is widened a little against rounding. */
+
+    bool isEar (ArrayList< TrigNode > &nodes, int cur)
+    {
+      const TrigNode &c = nodes[ cur ];
+      const TrigNode &p = nodes[ c.prev ];
+      const TrigNode &n = nodes[ c.next ];
+
+      int y0 = cellY( Util::Min( c.point.y, Util::Min( p.point.y, n.point.y )));
+      int y1 = cellY( Util::Max( c.point.y, Util::Max( p.point.y, n.point.y )));
+      Float height = (scale.y > 0.0f) ? 1.0f / scale.y : 0.0f;
+
+      for (int y=y0; y<=y1; ++y)
+      {
+        Float lo = (y == 0) ? -FLT_MAX : min.y + ((Float) y - 0.001f) * height;
+        Float hi = (y == sizeY-1) ? FLT_MAX : min.y + ((Float) y + 1.001f) * height;
+        Float xmin = FLT_MAX, xmax = -FLT_MAX;
+        ClipEdge( p.point, c.point, lo, hi, &xmin, &xmax );
+        ClipEdge( c.point, n.point, lo, hi, &xmin, &xmax );
+        ClipEdge( n.point, p.point, lo, hi, &xmin, &xmax );
+        if (xmin > xmax) continue;
+
+        for (int x=cellX( xmin ); x<=cellX( xmax ); ++x)
+        {
+          int *link = &cells[ y * sizeX + x ];
+          while (*link != -1)
+          {
+            int i = *link;
+            TrigNode &it = nodes[ i ];
+            if (it.convex || nodes[ it.prev ].next != i) {
+              *link = it.nextInCell;
+              it.inGrid = false;
+              continue; }
+
+            link = &it.nextInCell;
+            if (i == c.prev || i == c.next) continue;
+            if (isInsideTriangle( it.point, p.point, c.point, n.point ))
+              return false;
+          }
+        }
+      }
+
+      return true;
+    }
+  };
+
+  /*
+  ----------------------------------------------------
+  Ear clipping over a ring of nodes linked by index.
+  The nodes and the grid are scratch space reused by
+  every face, so a face costs no allocations once
+  they have grown to the largest one.
+  ----------------------------------------------------*/
+
   void PolyMesh::triangulate ()
   {
     clearTriangles();
-    //int polycount = 0;
+
+    ArrayList< TrigNode > nodes;
+    ArrayList< int > pending;
+    TrigGrid grid;
 
     for (PolyMesh::FaceIter f(this); !f.end(); ++f)
     {
-      //polycount++;
-      //if (polycount == 10163)
-        //int oooo = 1;
-
       PolyMesh::FaceVertIter fv;
       UintSize numavg[3] = {0,0,0};
       UintSize avgi = 0;
@@ -578,91 +832,101 @@ namespace GE
       trigM.setColumn( 2, trigN );
       trigM.setColumn( 3, fv->point );
       trigM = trigM.affineInverse();
-      
-      //Transform polygon into trig space and find bottom-left point
-      LinkedList< TrigNode > trigNodes;
-      bool minFirst = true;
-      TrigIter minI;
+
+      //Transform polygon into trig space
+      nodes.clear();
+      Float area = 0.0f;
 
       for (fv.begin(*f); !fv.end(); ++fv) {
-        
+
+        int n = (int) nodes.size();
         TrigNode node;
         node.vertex = *fv;
         node.hedge = fv.hedgeToVertex();
         node.point = ( trigM * fv->point ).xy();
-        TrigIter newI = trigNodes.pushBack( node );
-        
-        if (minFirst)
-          minI = newI;
-        else if (node.point.x < minI->point.x)
-          minI = newI;
-        else if (node.point.x == minI->point.x && node.point.y < minI->point.y)
-          minI = newI;
-      
-        minFirst = false;
+        node.prev = n - 1;
+        node.next = n + 1;
+        nodes.pushBack( node );
+
+        if (n > 0) area += Vector::Cross( nodes[ n-1 ].point, node.point );
       }
-      
-      //Find orientation for all corners
-      Vector2 prevV, nextV;
-      TrigCyclIter prev, cur, next;
-      bool convex = false, convexInit = false;
 
-      prev.begin( trigNodes, minI ); --prev;
-      cur.begin( trigNodes, minI );
-      next.begin( trigNodes, minI ); ++next;
+      int numNodes = (int) nodes.size();
+      nodes.first().prev = numNodes - 1;
+      nodes.last().next = 0;
+      area += Vector::Cross( nodes.last().point, nodes.first().point );
 
-      for ( ; !cur.end(); ++cur, ++prev, ++next)
-      {
-        findNodeOrientation( *prev, *cur, *next, convex, convexInit );
-        if (!convexInit) { convex = cur->orientation; convexInit = true; }
-      }
+      //Mirror clockwise polygons to run counter-clockwise
+      if (area < 0.0f)
+        for (int n=0; n<numNodes; ++n)
+          nodes[ n ].point.y = -nodes[ n ].point.y;
+
+      for (int n=0; n<numNodes; ++n)
+        findNodeConvex( nodes, n );
+
+      bool indexed = (numNodes > GE_POLYMESH_TRIG_INDEX);
+      if (indexed) grid.init( nodes );
 
-      //Rest corner iterators
-      prev.begin( trigNodes ); --prev;
-      cur.begin( trigNodes );
-      next.begin( trigNodes ); ++next;
+      //Cut ears until triangle or a whole round finds none
+      int numLeft = numNodes;
+      int numTried = 0;
+      int walk = 0;
+      pending.clear();
 
-      //Cut ears until triangle or no ears found
-      while (trigNodes.size() > 3 && !cur.end())
+      while (numLeft > 3 && numTried < numLeft)
       {
-        //Find next convex node
-        if (cur->orientation == convex)
+        int cur = walk;
+        if (!nodes[ cur ].convex || !(indexed ? grid.isEar( nodes, cur ) : isEar( nodes, cur )))
         {
-          //Check if a concave node is inside
-          bool isEar = true;
-          for (TrigCyclIter it( cur ); !it.end(); ++it) {
-            if (it == prev || it == cur || it == next) continue;
-            if (it->orientation == convex) continue;
-            if (Vector::InsideTriangle( it->point, prev->point, cur->point, next->point))
-              { isEar = false; break; }
-          }
-
-          //Cut an ear
-          if (isEar)
-          {
-            addTriangle( *f, prev->hedge, cur->hedge, next->hedge );
-            trigNodes.removeAt( cur );
-            findNodeOrientation( prev, convex, convexInit );
-            findNodeOrientation( next, convex, convexInit );
-            cur.begin( next ); ++next;
-            continue;
-          }
+          //Corners next to earlier cuts may have become ears
+          for (cur = -1; cur == -1 && !pending.empty(); pending.popBack()) {
+            int p = pending.last();
+            if (nodes[ nodes[ p ].prev ].next == p && nodes[ p ].convex &&
+                (indexed ? grid.isEar( nodes, p ) : isEar( nodes, p )))
+              cur = p; }
+
+          //Next corner
+          if (cur == -1) {
+            walk = nodes[ walk ].next;
+            numTried++;
+            continue; }
         }
 
-        //Next corner
-        ++prev; ++cur; ++next;
+        int prev = nodes[ cur ].prev, next = nodes[ cur ].next;
+        addTriangle( *f, nodes[ prev ].hedge, nodes[ cur ].hedge, nodes[ next ].hedge );
+        nodes[ prev ].next = next;
+        nodes[ next ].prev = prev;
+        numLeft--;
+
+        //Neighbours may turn concave, these must block ears too
+        if (findNodeConvex( nodes, prev )) pending.pushBack( prev );
+        else if (indexed) grid.insert( nodes, prev );
+        if (findNodeConvex( nodes, next )) pending.pushBack( next );
+        else if (indexed) grid.insert( nodes, next );
+
+        //Skip a corner so ears stay small instead of fanning out
+        walk = nodes[ next ].next;
+        numTried = 0;
       }
 
       //Cut the remaining corners
+      int cur = walk;
+      int prev = nodes[ cur ].prev;
+      int next = nodes[ cur ].next;
       while (next != prev)
       {
-        addTriangle( *f, prev->hedge, cur->hedge, next->hedge );
-        ++cur; ++next;
+        addTriangle( *f, nodes[ prev ].hedge, nodes[ cur ].hedge, nodes[ next ].hedge );
+        cur = next;
+        next = nodes[ next ].next;
       }
 
     }//Walk faces
   }
 
+  /*
+  Triangles of a face are added in a row, so the end
+  of the last face's list is kept to append in place. */
+
   void PolyMesh::addTriangle (Face *f, HalfEdge *h1, HalfEdge *h2, HalfEdge *h3)
   {
     //Create new triangle
@@ -677,16 +941,23 @@ namespace GE
     //Check if first for this face
     if (f->triangle == NULL) {
       f->triangle = newTri;
+      fanFace = f;
+      fanLast = newTri;
       return;
     }
 
     //Find last triangle on face
-    Triangle *t = f->triangle;    
-    while (t->next != NULL)
-      t = t->next;
+    Triangle *t = fanLast;
+    if (f != fanFace) {
+      t = f->triangle;
+      while (t->next != NULL)
+        t = t->next;
+    }
 
     //Append new one
     t->next = newTri;
+    fanFace = f;
+    fanLast = newTri;
   }
 
   void PolyMesh::clearTriangles()
@@ -695,6 +966,8 @@ namespace GE
       f->triangle = NULL;
 
     triangles.clear();
+    fanFace = NULL;
+    fanLast = NULL;
   }
 
 }//namespace GE
@@ -10,6 +10,12 @@
 #pragma warning(push)
 #pragma warning(disable:4251)
 
+//Faces or vertices handed to one job of a parallel pass
+#define GE_POLYMESH_JOB_SIZE 4096
+
+//Faces with more corners are triangulated through a grid of corners
+#define GE_POLYMESH_TRIG_INDEX 64
+
 namespace GE
 {
 
@@ -201,6 +207,8 @@ namespace GE
   private:
 
     DynamicArrayList<Triangle> triangles;
+    Face *fanFace;
+    Triangle *fanLast;
 
     VertexNormal dummyVertexNormal;
     VertexTangent dummyVertexTangent;
@@ -222,25 +230,43 @@ namespace GE
     void addMaterialID (MaterialID m);
     void subMaterialID (MaterialID m);
     virtual void insertFace (HMesh::Face *f);
-    virtual ListHandle deleteFace (HMesh::Face *f);
+    virtual void deleteFace (HMesh::Face *f);
 
   private:
 
     void updateFaceNormal (Face *f);
     void updateFaceTangent (Face *f, TexMesh::Face *tf);
 
-    void updateVertNormalFlat (Vertex *v);
-    void updateVertNormalSmooth (Vertex *v);
-    void updateVertNormalGroups (Vertex *v);
-    void updateVertNormalEdges (Vertex *v);
+    void updateVertNormal (Vertex *v, SmoothMetric::Enum metric, DynamicArrayList<VertexNormal> &normals);
+    void updateVertNormalFlat (Vertex *v, DynamicArrayList<VertexNormal> &normals);
+    void updateVertNormalSmooth (Vertex *v, DynamicArrayList<VertexNormal> &normals);
+    void updateVertNormalGroups (Vertex *v, DynamicArrayList<VertexNormal> &normals);
+    void updateVertNormalEdges (Vertex *v, DynamicArrayList<VertexNormal> &normals);
     void updateVertTangent (Vertex *v, TexMesh::Vertex *tv);
 
+    /*
+    -------------------------------------------------
+    Jobs of the parallel normal pass. Each takes a
+    run of the faces or vertices that were snapshot
+    into the pass.
+    -------------------------------------------------*/
+
+    struct ParallelPass;
+    static void FaceNormalJob (UintSize index, void *param);
+    static void VertNormalJob (UintSize index, void *param);
+
   public:
 
     PolyMesh();
 
     void setMaterialID (Face *f, MaterialID id);
-    void updateNormals (SmoothMetric::Enum metric = SmoothMetric::None);
+    const LinkedList<MaterialID>& getMaterialsUsed () { return materialsUsed; }
+
+    //Copies vertex data between meshes of this class
+    virtual void copyVertex (Vertex *to, Vertex *from);
+
+    //With a pool the work is split into jobs, the results are the same
+    void updateNormals (SmoothMetric::Enum metric = SmoothMetric::None, ThreadPool *pool = NULL);
     void updateTangents (TexMesh *texMesh);
 
     void triangulate ();
@@ -59,7 +59,7 @@ public:
 class MaterialFaceIter
 {
   PolyMesh *mesh;
-  ListHandle cur;
+  Uint32 cur;
   Uint8 materialID;
   
 public:
@@ -80,8 +80,8 @@ public:
     this->materialID = materialID;
     if (mesh == NULL) return;
     
-    cur = mesh->faces.begin();
-    if (((Face*)*cur)->materialID() != materialID)
+    cur = mesh->faces.first();
+    if (!end() && (*this)->materialID() != materialID)
       ++(*this);
   }
   
@@ -95,10 +95,11 @@ public:
   MaterialFaceIter& operator++()
   {
     if (mesh == NULL) return *this;
-    if (cur == mesh->faces.end()) return *this;
+    if (cur >= mesh->faces.end()) return *this;
 
-    for (++cur; cur!=mesh->faces.end(); ++cur)
-      if (((Face*)*cur)->materialID() == materialID)
+    for (cur = mesh->faces.next( cur ); cur < mesh->faces.end();
+         cur = mesh->faces.next( cur ))
+      if (((Face*) mesh->faces.at( cur ))->materialID() == materialID)
         break;
     
     return *this;
@@ -106,20 +107,20 @@ public:
   
   bool end() const
   {
-    return (mesh == NULL ? true : cur == mesh->faces.end());
+    return (mesh == NULL ? true : cur >= mesh->faces.end());
   }
   
   Face* operator*() const
   {
     if (mesh != NULL)
-      if (cur != mesh->faces.end())
-        return (Face*)(*cur);
+      if (cur < mesh->faces.end())
+        return (Face*) mesh->faces.at( cur );
     return NULL;
   }
   
   Face* operator->() const
   {
-    return (Face*)(*cur);
+    return (Face*) mesh->faces.at( cur );
   }
 };
 
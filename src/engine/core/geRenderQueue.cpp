@@ -0,0 +1,349 @@
+#include "core/geRenderQueue.h"
+
+//Sort key layout from the most significant bit
+#define GE_RQ_TARGET_SHIFT    62
+#define GE_RQ_CUSTOM_SHIFT    61
+#define GE_RQ_SHADER_SHIFT    47
+#define GE_RQ_MATERIAL_SHIFT  33
+#define GE_RQ_MESH_SHIFT      19
+#define GE_RQ_ID_MASK         0x3FFF
+#define GE_RQ_DEPTH_MASK      0x7FFFF
+
+namespace GE
+{
+  /*
+  -----------------------------------------------------
+  RecordingRenderBackend
+  -----------------------------------------------------*/
+
+  RecordingRenderBackend::RecordingRenderBackend ()
+  {
+    clear();
+  }
+
+  void RecordingRenderBackend::clear ()
+  {
+    commands.clear();
+    for (int c=0; c<=RenderCommand::DrawActor; ++c)
+      counts[c] = 0;
+  }
+
+  void RecordingRenderBackend::record (RenderCommand::Enum type, void *object, Int group)
+  {
+    Command cmd;
+    cmd.type = type;
+    cmd.object = object;
+    cmd.group = group;
+    commands.pushBack( cmd );
+    counts[ type ]++;
+  }
+
+  void RecordingRenderBackend::useShader (Shader *shader) {
+    record( RenderCommand::UseShader, shader );
+  }
+
+  void RecordingRenderBackend::bindMesh (Actor3D *actor, TriMesh *mesh, Shader *shader) {
+    record( RenderCommand::BindMesh, actor );
+  }
+
+  void RecordingRenderBackend::unbindMesh (Actor3D *actor, TriMesh *mesh, Shader *shader) {
+    record( RenderCommand::UnbindMesh, actor );
+  }
+
+  void RecordingRenderBackend::beginMaterial (Material *material, RenderTarget::Enum target) {
+    record( RenderCommand::BeginMaterial, material );
+  }
+
+  void RecordingRenderBackend::endMaterial (Material *material, RenderTarget::Enum target) {
+    record( RenderCommand::EndMaterial, material );
+  }
+
+  void RecordingRenderBackend::setTransform (const Matrix4x4 &world) {
+    record( RenderCommand::SetTransform, NULL );
+  }
+
+  void RecordingRenderBackend::drawGroup (Actor3D *actor, TriMesh *mesh, Int group) {
+    record( RenderCommand::DrawGroup, actor, group );
+  }
+
+  void RecordingRenderBackend::drawActor (Actor3D *actor, RenderTarget::Enum target) {
+    record( RenderCommand::DrawActor, actor );
+  }
+
+  /*
+  -----------------------------------------------------
+  RenderIdTable
+  -----------------------------------------------------*/
+
+  RenderIdTable::RenderIdTable ()
+  {
+    count = 0;
+  }
+
+  void RenderIdTable::clear ()
+  {
+    keys.clear();
+    ids.clear();
+    count = 0;
+  }
+
+  Uint32 RenderIdTable::getId (void *ptr)
+  {
+    //NULL always maps to zero
+    if (ptr == NULL) return 0;
+
+    //Grow at half load and reinsert
+    if ((count + 1) * 2 > keys.size())
+    {
+      ArrayList< void* > oldKeys;
+      ArrayList< Uint32 > oldIds;
+      for (UintSize k=0; k<keys.size(); ++k) {
+        oldKeys.pushBack( keys[k] );
+        oldIds.pushBack( ids[k] ); }
+
+      UintSize cap = Util::Max( keys.size() * 2, (UintSize) 64 );
+      keys.clear(); ids.clear();
+      for (UintSize k=0; k<cap; ++k) {
+        keys.pushBack( NULL );
+        ids.pushBack( 0 ); }
+
+      for (UintSize k=0; k<oldKeys.size(); ++k)
+      {
+        if (oldKeys[k] == NULL) continue;
+        UintSize h = (((UintSize) oldKeys[k] >> 4) * 2654435761u) & (cap - 1);
+        while (keys[h] != NULL) h = (h + 1) & (cap - 1);
+        keys[h] = oldKeys[k];
+        ids[h] = oldIds[k];
+      }
+    }
+
+    //Linear probing
+    UintSize mask = keys.size() - 1;
+    UintSize h = (((UintSize) ptr >> 4) * 2654435761u) & mask;
+    while (keys[h] != NULL)
+    {
+      if (keys[h] == ptr) return ids[h];
+      h = (h + 1) & mask;
+    }
+
+    keys[h] = ptr;
+    ids[h] = ++count;
+    return ids[h];
+  }
+
+  /*
+  -----------------------------------------------------
+  RenderQueue
+  -----------------------------------------------------*/
+
+  RenderQueue::RenderQueue ()
+  {
+    begin( RenderTarget::GBuffer );
+  }
+
+  void RenderQueue::begin (RenderTarget::Enum target)
+  {
+    this->target = target;
+    items.clear();
+    shaderIds.clear();
+    materialIds.clear();
+    meshIds.clear();
+    sorted = false;
+
+    stats.numItems = 0;
+    stats.numCustom = 0;
+    stats.numShaderBinds = 0;
+    stats.numMeshBinds = 0;
+    stats.numMaterialBinds = 0;
+  }
+
+  void RenderQueue::add (Actor3D *actor, Shader *shader, Material *material, TriMesh *mesh,
+                         Int group, const Matrix4x4 &world, Float depth)
+  {
+    RenderItem item;
+    item.actor = actor;
+    item.shader = shader;
+    item.material = material;
+    item.mesh = mesh;
+    item.group = group;
+    item.world = world;
+    item.depth = depth;
+    items.pushBack( item );
+    sorted = false;
+  }
+
+  void RenderQueue::addCustom (Actor3D *actor, const Matrix4x4 &world, Float depth)
+  {
+    add( actor, NULL, NULL, NULL, -1, world, depth );
+  }
+
+  void RenderQueue::sort ()
+  {
+    UintSize count = items.size();
+    keys.clear(); keys.resize( count );
+    order.clear(); order.resize( count );
+    tmpKeys.clear(); tmpKeys.resize( count );
+    tmpOrder.clear(); tmpOrder.resize( count );
+
+    //Depth is quantized relative to the farthest item
+    Float maxDepth = 0.0f;
+    for (UintSize i=0; i<count; ++i)
+      maxDepth = Util::Max( maxDepth, items[i].depth );
+    Float depthScale = (maxDepth > 0.0f) ? (Float) GE_RQ_DEPTH_MASK / maxDepth : 0.0f;
+
+    //Build keys and track which bits differ
+    Uint64 keysOr = 0, keysAnd = ~((Uint64) 0);
+    for (UintSize i=0; i<count; ++i)
+    {
+      RenderItem &item = items[i];
+      Uint64 custom = (item.group < 0) ? 1 : 0;
+      Uint64 shader = Util::Min( shaderIds.getId( item.shader ), (Uint32) GE_RQ_ID_MASK );
+      Uint64 material = Util::Min( materialIds.getId( item.material ), (Uint32) GE_RQ_ID_MASK );
+      Uint64 mesh = Util::Min( meshIds.getId( item.mesh ), (Uint32) GE_RQ_ID_MASK );
+      Uint64 depth = (Uint64) Util::Clamp( item.depth * depthScale, 0.0f, (Float) GE_RQ_DEPTH_MASK );
+
+      Uint64 key =
+        ((Uint64) target << GE_RQ_TARGET_SHIFT) |
+        (custom << GE_RQ_CUSTOM_SHIFT) |
+        (shader << GE_RQ_SHADER_SHIFT) |
+        (material << GE_RQ_MATERIAL_SHIFT) |
+        (mesh << GE_RQ_MESH_SHIFT) |
+        depth;
+
+      keys[i] = key;
+      order[i] = (Uint32) i;
+      keysOr |= key;
+      keysAnd &= key;
+    }
+
+    //Radix sort by bytes, skipping bytes equal in all keys
+    Uint64 *srcKeys = keys.buffer(), *dstKeys = tmpKeys.buffer();
+    Uint32 *srcOrder = order.buffer(), *dstOrder = tmpOrder.buffer();
+
+    for (Uint shift=0; shift<64; shift+=8)
+    {
+      if ((((keysOr ^ keysAnd) >> shift) & 0xFF) == 0)
+        continue;
+
+      UintSize offsets[256];
+      for (int b=0; b<256; ++b) offsets[b] = 0;
+      for (UintSize i=0; i<count; ++i)
+        offsets[ (srcKeys[i] >> shift) & 0xFF ]++;
+
+      UintSize sum = 0;
+      for (int b=0; b<256; ++b) {
+        UintSize n = offsets[b];
+        offsets[b] = sum;
+        sum += n; }
+
+      for (UintSize i=0; i<count; ++i)
+      {
+        UintSize o = offsets[ (srcKeys[i] >> shift) & 0xFF ]++;
+        dstKeys[o] = srcKeys[i];
+        dstOrder[o] = srcOrder[i];
+      }
+
+      Uint64 *tk = srcKeys; srcKeys = dstKeys; dstKeys = tk;
+      Uint32 *to = srcOrder; srcOrder = dstOrder; dstOrder = to;
+    }
+
+    //Result must end up in the main arrays
+    if (srcKeys != keys.buffer())
+    {
+      memcpy( keys.buffer(), srcKeys, count * sizeof( Uint64 ));
+      memcpy( order.buffer(), srcOrder, count * sizeof( Uint32 ));
+    }
+
+    sorted = true;
+  }
+
+  const RenderItem& RenderQueue::getSortedItem (UintSize index)
+  {
+    if (!sorted) sort();
+    return items[ order[ index ]];
+  }
+
+  Uint64 RenderQueue::getSortedKey (UintSize index)
+  {
+    if (!sorted) sort();
+    return keys[ index ];
+  }
+
+  /*
+  Issues the sorted items. The shader is switched only when
+  it changes, mesh buffers and vertex format only when the
+  mesh or shader changes and materials only when the
+  material or shader changes (uniforms are per program).
+  Custom items may touch any state so it's reset after. */
+
+  void RenderQueue::submit (RenderBackend *backend)
+  {
+    if (!sorted) sort();
+
+    Shader *curShader = NULL;
+    Material *curMaterial = NULL;
+    TriMesh *curMesh = NULL;
+    Actor3D *meshActor = NULL;
+
+    backend->beginPass( target );
+    stats.numItems = items.size();
+
+    for (UintSize i=0; i<items.size(); ++i)
+    {
+      RenderItem &item = items[ order[i] ];
+
+      //Close open state on shader change or custom item
+      if (item.group < 0 || item.shader != curShader)
+      {
+        if (curMaterial != NULL) backend->endMaterial( curMaterial, target );
+        if (curMesh != NULL) backend->unbindMesh( meshActor, curMesh, curShader );
+        curMaterial = NULL;
+        curMesh = NULL;
+        meshActor = NULL;
+        curShader = NULL;
+      }
+
+      //Let custom items draw themselves
+      if (item.group < 0)
+      {
+        backend->setTransform( item.world );
+        backend->drawActor( item.actor, target );
+        stats.numCustom++;
+        continue;
+      }
+
+      if (item.shader != curShader)
+      {
+        curShader = item.shader;
+        backend->useShader( curShader );
+        stats.numShaderBinds++;
+      }
+
+      if (item.mesh != curMesh)
+      {
+        if (curMesh != NULL) backend->unbindMesh( meshActor, curMesh, curShader );
+        curMesh = item.mesh;
+        meshActor = item.actor;
+        backend->bindMesh( meshActor, curMesh, curShader );
+        stats.numMeshBinds++;
+      }
+
+      if (item.material != curMaterial)
+      {
+        if (curMaterial != NULL) backend->endMaterial( curMaterial, target );
+        curMaterial = item.material;
+        if (curMaterial != NULL) backend->beginMaterial( curMaterial, target );
+        stats.numMaterialBinds++;
+      }
+
+      backend->setTransform( item.world );
+      backend->drawGroup( item.actor, item.mesh, item.group );
+    }
+
+    //Close remaining state
+    if (curMaterial != NULL) backend->endMaterial( curMaterial, target );
+    if (curMesh != NULL) backend->unbindMesh( meshActor, curMesh, curShader );
+    backend->endPass( target );
+  }
+
+}//namespace GE
@@ -0,0 +1,200 @@
+#ifndef __GERENDERQUEUE_H
+#define __GERENDERQUEUE_H
+
+#include "util/geUtil.h"
+#include "math/geMath.h"
+#include "core/geRenderer.h"
+
+namespace GE
+{
+  /*
+  --------------------------------------------
+  Forward declarations
+  --------------------------------------------*/
+
+  class Actor3D;
+  class Shader;
+  class Material;
+  class TriMesh;
+  class Renderer;
+
+  /*
+  -----------------------------------------------------
+  A single draw. Items with a group index draw one index
+  group of a mesh with the given shader and material.
+  Custom items (group -1) let the actor render itself.
+  -----------------------------------------------------*/
+
+  class RenderItem
+  {
+  public:
+    Actor3D *actor;
+    Shader *shader;
+    Material *material;
+    TriMesh *mesh;
+    Int group;
+    Float depth;
+    Matrix4x4 world;
+  };
+
+  class RenderQueueStats
+  {
+  public:
+    UintSize numItems;
+    UintSize numCustom;
+    UintSize numShaderBinds;
+    UintSize numMeshBinds;
+    UintSize numMaterialBinds;
+  };
+
+  /*
+  -----------------------------------------------------
+  State changes issued by the queue. The GL backend
+  forwards them to the actors and materials while the
+  recording backend only logs them, so the queue can be
+  tested without a GPU.
+  -----------------------------------------------------*/
+
+  class RenderBackend
+  {
+  public:
+    virtual ~RenderBackend () {}
+
+    virtual void beginPass (RenderTarget::Enum target) {}
+    virtual void endPass (RenderTarget::Enum target) {}
+
+    virtual void useShader (Shader *shader) = 0;
+    virtual void bindMesh (Actor3D *actor, TriMesh *mesh, Shader *shader) = 0;
+    virtual void unbindMesh (Actor3D *actor, TriMesh *mesh, Shader *shader) = 0;
+    virtual void beginMaterial (Material *material, RenderTarget::Enum target) = 0;
+    virtual void endMaterial (Material *material, RenderTarget::Enum target) = 0;
+    virtual void setTransform (const Matrix4x4 &world) = 0;
+    virtual void drawGroup (Actor3D *actor, TriMesh *mesh, Int group) = 0;
+    virtual void drawActor (Actor3D *actor, RenderTarget::Enum target) = 0;
+  };
+
+  class GLRenderBackend : public RenderBackend
+  {
+    Renderer *renderer;
+    Matrix4x4 view;
+
+  public:
+    GLRenderBackend (Renderer *renderer);
+
+    virtual void beginPass (RenderTarget::Enum target);
+    virtual void endPass (RenderTarget::Enum target);
+
+    virtual void useShader (Shader *shader);
+    virtual void bindMesh (Actor3D *actor, TriMesh *mesh, Shader *shader);
+    virtual void unbindMesh (Actor3D *actor, TriMesh *mesh, Shader *shader);
+    virtual void beginMaterial (Material *material, RenderTarget::Enum target);
+    virtual void endMaterial (Material *material, RenderTarget::Enum target);
+    virtual void setTransform (const Matrix4x4 &world);
+    virtual void drawGroup (Actor3D *actor, TriMesh *mesh, Int group);
+    virtual void drawActor (Actor3D *actor, RenderTarget::Enum target);
+  };
+
+  namespace RenderCommand {
+    enum Enum {
+      UseShader,
+      BindMesh,
+      UnbindMesh,
+      BeginMaterial,
+      EndMaterial,
+      SetTransform,
+      DrawGroup,
+      DrawActor
+    };}
+
+  class RecordingRenderBackend : public RenderBackend
+  {
+  public:
+    class Command
+    {
+    public:
+      RenderCommand::Enum type;
+      void *object;
+      Int group;
+    };
+
+  private:
+    ArrayList< Command > commands;
+    UintSize counts[ RenderCommand::DrawActor + 1 ];
+
+    void record (RenderCommand::Enum type, void *object, Int group = -1);
+
+  public:
+    RecordingRenderBackend ();
+
+    void clear ();
+    const ArrayList< Command >& getCommands () { return commands; }
+    UintSize getCount (RenderCommand::Enum type) { return counts[ type ]; }
+
+    virtual void useShader (Shader *shader);
+    virtual void bindMesh (Actor3D *actor, TriMesh *mesh, Shader *shader);
+    virtual void unbindMesh (Actor3D *actor, TriMesh *mesh, Shader *shader);
+    virtual void beginMaterial (Material *material, RenderTarget::Enum target);
+    virtual void endMaterial (Material *material, RenderTarget::Enum target);
+    virtual void setTransform (const Matrix4x4 &world);
+    virtual void drawGroup (Actor3D *actor, TriMesh *mesh, Int group);
+    virtual void drawActor (Actor3D *actor, RenderTarget::Enum target);
+  };
+
+  /*
+  -----------------------------------------------------
+  Maps pointers to small dense ids in order of first
+  appearance, so they fit into the sort key.
+  -----------------------------------------------------*/
+
+  class RenderIdTable
+  {
+    ArrayList< void* > keys;
+    ArrayList< Uint32 > ids;
+    Uint32 count;
+
+  public:
+    RenderIdTable ();
+    void clear ();
+    Uint32 getId (void *ptr);
+  };
+
+  /*
+  -----------------------------------------------------
+  Collects draw items for a pass and submits them sorted
+  by a 64-bit key made of (target, custom, shader,
+  material, mesh, depth) so that equal state ends up
+  adjacent and redundant binds are skipped.
+  -----------------------------------------------------*/
+
+  class RenderQueue
+  {
+    RenderTarget::Enum target;
+    ArrayList< RenderItem > items;
+    ArrayList< Uint64 > keys, tmpKeys;
+    ArrayList< Uint32 > order, tmpOrder;
+    RenderIdTable shaderIds;
+    RenderIdTable materialIds;
+    RenderIdTable meshIds;
+    RenderQueueStats stats;
+    bool sorted;
+
+  public:
+    RenderQueue ();
+
+    void begin (RenderTarget::Enum target);
+    void add (Actor3D *actor, Shader *shader, Material *material, TriMesh *mesh,
+              Int group, const Matrix4x4 &world, Float depth);
+    void addCustom (Actor3D *actor, const Matrix4x4 &world, Float depth);
+
+    void sort ();
+    void submit (RenderBackend *backend);
+
+    RenderTarget::Enum getTarget () { return target; }
+    UintSize size () { return items.size(); }
+    const RenderItem& getSortedItem (UintSize index);
+    Uint64 getSortedKey (UintSize index);
+    const RenderQueueStats& getStats () { return stats; }
+  };
+
+}//namespace GE
+#endif//__GERENDERQUEUE_H
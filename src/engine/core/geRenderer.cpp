@@ -3,10 +3,14 @@
 #include "core/geLight.h"
 #include "core/geShaders.h"
 #include "core/geScene.h"
+#include "core/geRenderQueue.h"
+#include "core/geShaderCache.h"
+#include "core/actors/geTriMeshActor.h"
 #include "core/geShader.h"
 #include "widgets/geWidget.h"
 #include "core/geGLHeaders.h"
 #include "core/actors/geSkinMeshActor.h"
+#include <cfloat>
 
 #include "core/embedit/Ambient.embedded"
 #include "core/embedit/Dof.embedded"
@@ -38,6 +42,112 @@ namespace GE
     curCamera = NULL;
     curShader = NULL;
     curMaterial = NULL;
+
+    lodPixelScale = 0.0f;
+    lodPixelError = 1.0f;
+
+    shadowStats.numLights = 0;
+    shadowStats.numLightsSkipped = 0;
+    shadowStats.numCasters = 0;
+    shadowStats.numActorsWalked = 0;
+
+    renderQueue = new RenderQueue;
+    glBackend = new GLRenderBackend( this );
+
+    shaders = new ShaderTable;
+    shaderSources = new ShaderSourceCache;
+  }
+
+  /*
+  Composed shaders are owned by the table. Needs to run
+  while the GL context is still current. */
+
+  Renderer::~Renderer()
+  {
+    for (UintSize s=0; s<shaders->size(); ++s)
+      delete shaders->at( s ).shader;
+
+    delete shaders;
+    delete shaderSources;
+    delete glBackend;
+    delete renderQueue;
+  }
+
+  /*
+  -----------------------------------------------------
+  GLRenderBackend
+  -----------------------------------------------------*/
+
+  GLRenderBackend::GLRenderBackend (Renderer *renderer)
+  {
+    this->renderer = renderer;
+  }
+
+  void GLRenderBackend::beginPass (RenderTarget::Enum target)
+  {
+    //Items carry world matrices, keep the view separate
+    glGetFloatv( GL_MODELVIEW_MATRIX, (GLfloat*) view.m );
+    glMatrixMode( GL_MODELVIEW );
+  }
+
+  void GLRenderBackend::endPass (RenderTarget::Enum target)
+  {
+    glMatrixMode( GL_MODELVIEW );
+    glLoadMatrixf( (GLfloat*) view.m );
+  }
+
+  void GLRenderBackend::useShader (Shader *shader)
+  {
+    shader->use();
+    renderer->curShader = shader;
+  }
+
+  void GLRenderBackend::bindMesh (Actor3D *actor, TriMesh *mesh, Shader *shader)
+  {
+    TriMeshActor *meshActor = (TriMeshActor*) actor;
+    meshActor->bindBuffers( mesh );
+    meshActor->bindFormat( shader, mesh, (VertexFormat*) mesh->getFormat() );
+  }
+
+  void GLRenderBackend::unbindMesh (Actor3D *actor, TriMesh *mesh, Shader *shader)
+  {
+    TriMeshActor *meshActor = (TriMeshActor*) actor;
+    meshActor->unbindFormat( shader, (VertexFormat*) mesh->getFormat() );
+    meshActor->unbindBuffers( mesh );
+  }
+
+  void GLRenderBackend::beginMaterial (Material *material, RenderTarget::Enum target)
+  {
+    if (target == RenderTarget::ShadowMap)
+      material->beginShadow();
+    else material->begin();
+  }
+
+  void GLRenderBackend::endMaterial (Material *material, RenderTarget::Enum target)
+  {
+    if (target == RenderTarget::ShadowMap)
+      material->endShadow();
+    else material->end();
+  }
+
+  void GLRenderBackend::setTransform (const Matrix4x4 &world)
+  {
+    Matrix4x4 modelview = view * world;
+    glLoadMatrixf( (GLfloat*) modelview.m );
+  }
+
+  void GLRenderBackend::drawGroup (Actor3D *actor, TriMesh *mesh, Int group)
+  {
+    TriMeshActor *meshActor = (TriMeshActor*) actor;
+    meshActor->renderGroup( mesh, mesh->groups[ group ] );
+  }
+
+  void GLRenderBackend::drawActor (Actor3D *actor, RenderTarget::Enum target)
+  {
+    actor->begin();
+    actor->render( target );
+    actor->end();
+    glMatrixMode( GL_MODELVIEW );
   }
 
   void Renderer::setAvgLuminance (Float l) {
@@ -56,6 +166,20 @@ namespace GE
     return maxLuminance;
   }
 
+  const RenderQueueStats& Renderer::getQueueStats () {
+    return renderQueue->getStats();
+  }
+
+  const ShadowStats& Renderer::getShadowStats () {
+    return shadowStats;
+  }
+
+  UintSize Renderer::getNumShadowCasters (UintSize l)
+  {
+    if (l + 1 >= shadowCasterStart.size()) return 0;
+    return shadowCasterStart[ l+1 ] - shadowCasterStart[ l ];
+  }
+
   void Renderer::setBackColor (const Vector3 &color)
   {
     back = color;
@@ -94,50 +218,31 @@ namespace GE
   Rendering interface
   --------------------------------------*/
 
-  Shader* Renderer::findLightShaderByKey (const LightShaderKey &key)
-  {
-    for (UintSize s=0; s<lightShaders.size(); ++s)
-      if (lightShaders[s] == key)
-        return lightShaders[s].shader;
-
-    return NULL;
-  }
-
   Shader* Renderer::getLightShader (Light *light)
   {
-    LightShaderKey key;
-    key.lightClass = light->getClass();
+    ShaderKey key;
+    key.target = RenderTarget::Lighting;
+    key.geomClass = light->getClass();
+    key.matClass = ClassName( Material );
+    key.computeHash();
 
-    Shader *shader = findLightShaderByKey( key );
+    Shader *shader = shaders->find( key );
     if (shader != NULL) return shader;
 
-
-    printf( "\n");
-    printf( "==============================\n");
-    printf( "    Composing Light Shader    \n" );
-    printf( "==============================\n");
-    printf( "Light: %s\n", key.lightClass->name().buffer() );
-    printf( "\n" );
-
     shader = new Shader();
     light->composeShader( shader );
-    shader->link();
+
+    //Light code is joined from fixed pieces, nothing to cache
+    CharString vertex, fragment;
+    light->composeSource( vertex, fragment );
+    shader->fromString( vertex, fragment );
 
     key.shader = shader;
-    lightShaders.pushBack( key );
+    shaders->insert( key );
 
     return shader;
   }
 
-  Shader* Renderer::findShaderByKey (const ShaderKey &key)
-  {
-    for (UintSize s=0; s<shaders.size(); ++s)
-      if (shaders[s] == key)
-        return shaders[s].shader;
-
-    return NULL;
-  }
-
   Shader* Renderer::getShader (RenderTarget::Enum target,
                                Actor3D *geometry,
                                Material *material)
@@ -151,33 +256,161 @@ namespace GE
     if (material == NULL) key.matClass = ClassName( Material );
     else key.matClass = material->getShaderComposingClass();
 
-    Shader* shader = findShaderByKey( key );
+    key.computeHash();
+    Shader* shader = shaders->find( key );
     if (shader != NULL) {
       curShader = shader;
       return shader;
     }
 
-    printf( "\n");
-    printf( "=================================\n" );
-    printf( "    Composing Geometry Shader    \n" );
-    printf( "=================================\n" );
-    printf( "Target: %s\n", target == RenderTarget::GBuffer ? "GBuffer" : "ShadowMap" );
-    printf( "Geometry: %s\n", key.geomClass->name().buffer() );
-    printf( "Material: %s\n", key.matClass->name().buffer() );
-    printf( "\n" );
-
     shader = new Shader;
     if (geometry != NULL) geometry->composeShader( shader );
     if (material != NULL) material->composeShader( shader );
-    shader->compose( target );
+
+    //Reuse the sources generated for the same inputs before
+    Uint64 composeHash = shader->getComposeHash();
+    const ShaderSource *src = shaderSources->find( key.hash, composeHash );
+    if (src != NULL)
+    {
+      shader->composeDiscard();
+      shader->fromString( src->vertex, src->fragment );
+    }
+    else
+    {
+      CharString vertex, fragment;
+      shader->composeSource( target, vertex, fragment );
+      shaderSources->store( key.hash, composeHash, vertex, fragment );
+      shader->fromString( vertex, fragment );
+    }
     
     key.shader = shader;
-    shaders.pushBack( key );
+    shaders->insert( key );
 
     curShader = shader;
     return shader;
   }
 
+  /*
+  Lists the permutations the scene will ask for, mirroring the
+  material choice of TriMeshActor rendering. Each permutation
+  is listed once with the first actor and material using it. */
+
+  void Renderer::findShaderPermutations (Scene3D *scene, ArrayList< ShaderPermutation > &perms)
+  {
+    ShaderTable found;
+    ShaderPermutation perm;
+    ShaderKey key;
+    key.shader = NULL;
+
+    for (UintSize t=0; t<scene->getTraversal()->size(); ++t)
+    {
+      TravNode node = scene->getTraversal()->at( t );
+      if (node.event != TravEvent::Begin)
+        continue;
+
+      TriMeshActor *actor = Class::SafeCast< TriMeshActor >( node.actor );
+      if (actor == NULL) continue;
+      if (actor->getMesh() == NULL) continue;
+
+      Material *material = actor->getMaterial();
+      if (material == NULL) continue;
+
+      MultiMaterial *multiMat = Class::SafeCast< MultiMaterial >( material );
+      TriMesh *mesh = actor->getMesh();
+
+      for (int target=RenderTarget::GBuffer; target<=RenderTarget::ShadowMap; ++target)
+      {
+        perm.target = (RenderTarget::Enum) target;
+        perm.geometry = actor;
+
+        UintSize numMats = (multiMat == NULL) ? 1 : mesh->groups.size();
+        for (UintSize m=0; m<numMats; ++m)
+        {
+          //Single material shadow shader is material-independent
+          if (multiMat != NULL)
+            perm.material = multiMat->getSubMaterial( mesh->groups[m].materialID );
+          else if (target == RenderTarget::ShadowMap)
+            perm.material = NULL;
+          else
+            perm.material = material;
+
+          if (multiMat != NULL && perm.material == NULL)
+            continue;
+
+          key.target = perm.target;
+          key.geomClass = actor->getShaderComposingClass();
+          key.matClass = (perm.material == NULL) ? ClassName( Material )
+            : perm.material->getShaderComposingClass();
+          key.computeHash();
+
+          if (found.contains( key )) continue;
+          found.insert( key );
+          perms.pushBack( perm );
+        }
+      }
+    }
+
+    //Lights compose their own shaders
+    const ArrayList< Light* > *lights = scene->getLights();
+    for (UintSize l=0; l<lights->size(); ++l)
+    {
+      Light *light = lights->at( l );
+      key.target = RenderTarget::Lighting;
+      key.geomClass = light->getClass();
+      key.matClass = ClassName( Material );
+      key.computeHash();
+
+      if (found.contains( key )) continue;
+      found.insert( key );
+
+      perm.target = RenderTarget::Lighting;
+      perm.geometry = light;
+      perm.material = NULL;
+      perms.pushBack( perm );
+    }
+  }
+
+  /*
+  Composes the given permutations up front, typically found
+  with findShaderPermutations at load time, so the first
+  frames don't stall on composition and compilation. */
+
+  void Renderer::warmShaders (const ArrayList< ShaderPermutation > &perms)
+  {
+    Shader *oldShader = curShader;
+
+    for (UintSize p=0; p<perms.size(); ++p)
+    {
+      const ShaderPermutation &perm = perms[p];
+      if (perm.target == RenderTarget::Lighting)
+        getLightShader( (Light*) perm.geometry );
+      else
+        getShader( perm.target, perm.geometry, perm.material );
+    }
+
+    curShader = oldShader;
+  }
+
+  bool Renderer::loadShaderSources (const CharString &filename)
+  {
+    return shaderSources->load( filename );
+  }
+
+  bool Renderer::saveShaderSources (const CharString &filename)
+  {
+    return shaderSources->save( filename );
+  }
+
+  bool Renderer::hasNewShaderSources ()
+  {
+    return shaderSources->isChanged();
+  }
+
+  UintSize Renderer::getNumShaders ()
+  {
+    return shaders->size();
+  }
+
   Shader* Renderer::getCurrentShader() {
     return curShader;
   }
@@ -190,6 +423,37 @@ namespace GE
     return curCamera;
   }
 
+  /*
+  The vertical scale of the projection turns a length at
+  unit distance into a fraction of half the viewport. */
+
+  void Renderer::setCamera (Camera *camera)
+  {
+    curCamera = camera;
+    lodEye = camera->getGlobalMatrix().getColumn(3).xyz();
+
+    Matrix4x4 proj = camera->getProjection( (Float) viewW, (Float) viewH );
+    lodPixelScale = proj.m[1][1] * (Float) viewH * 0.5f;
+  }
+
+  Float Renderer::getPixelSize (Float length, Float distance)
+  {
+    if (distance <= 0.0f) return FLT_MAX;
+    return length * lodPixelScale / distance;
+  }
+
+  const Vector3& Renderer::getCameraEye () {
+    return lodEye;
+  }
+
+  void Renderer::setLodPixelError (Float pixels) {
+    lodPixelError = pixels;
+  }
+
+  Float Renderer::getLodPixelError () {
+    return lodPixelError;
+  }
+
   void Renderer::beginFrame()
   {
     //Clear the framebuffer
@@ -505,8 +769,133 @@ namespace GE
     buffersInit = true;
   }
 
-  void Renderer::renderShadowMap (Light *light, Scene3D *scene)
+  /*
+  Culls the scene against the camera once per frame. The
+  result is shared by the geometry pass and the shadow
+  caster gathering. */
+
+  void Renderer::cullCamera (Scene3D *scene)
+  {
+    Matrix4x4 camProj = curCamera->getProjection( (Float) viewW, (Float) viewH );
+    Matrix4x4 camView = curCamera->getGlobalMatrix().affineNormalize().affineInverse();
+    Frustum camFrustum;
+    camFrustum.fromMatrix( camProj * camView );
+    scene->cullFrustum( camFrustum, visibleSlots );
+  }
+
+  /*
+  Distance of the actor's bounding box center to the eye and
+  whether it's past the actor's maximum draw distance. */
+
+  Float Renderer::GetDrawDistance (Actor3D *actor, const Vector3 &eye)
+  {
+    BoundingBox bbox = actor->getBoundingBox();
+    Vector3 center = actor->getGlobalMatrix() * ((bbox.min + bbox.max) * 0.5f);
+    return (center - eye).norm();
+  }
+
+  bool Renderer::IsBeyondDrawDistance (Actor3D *actor, Float dist)
+  {
+    //TODO: code real solution (apply root bone transform to resulting
+    //box corners rather than min/max) for the skinned meshes)
+    if (ClassOf( actor ) == ClassName( SkinMeshActor ))
+      return false;
+
+    Float maxDist = actor->getMaxDrawDistance();
+    return (maxDist >= 0.0f && dist > maxDist);
+  }
+
+  /*
+  Intersects the frustum of each light with the scene once
+  per frame and stores the shadow casters in one compact
+  list. Spot and pyramid lights only light inside their
+  frustum, so they get skipped when none of the actors in
+  it is visible to the camera. Casters past their draw
+  distance are left out as they aren't drawn either.
+  Expects cullCamera to have run for the frame. */
+
+  void Renderer::gatherShadowCasters (Scene3D *scene)
+  {
+    const ArrayList< Light* > *lights = scene->getLights();
+    shadowCasters.clear();
+    shadowCasterStart.clear();
+    shadowSkip.clear();
+
+    shadowStats.numLights = 0;
+    shadowStats.numLightsSkipped = 0;
+    shadowStats.numCasters = 0;
+    shadowStats.numActorsWalked = 0;
+
+    //Draw distance is measured from the camera
+    Vector3 eye = curCamera->getGlobalMatrix().getColumn(3).xyz();
+
+    for (UintSize l=0; l<lights->size(); ++l)
+    {
+      Light *light = lights->at( l );
+      shadowCasterStart.pushBack( shadowCasters.size() );
+      shadowSkip.pushBack( 0 );
+
+      shadowStats.numLights++;
+
+      //No casters needed, leave receivers to the light queries
+      if (!light->getCastShadows())
+        continue;
+
+      shadowStats.numActorsWalked += scene->getNumCullSlots();
+
+      //Actors within the light frustum
+      Matrix4x4 lightProj = light->getProjection();
+      Matrix4x4 lightView = light->getGlobalMatrix().affineNormalize().affineInverse();
+      Frustum lightFrustum;
+      lightFrustum.fromMatrix( lightProj * lightView );
+
+      lightActors.clear();
+      scene->findActorsInFrustum( lightFrustum, lightActors );
+
+      //Check for receivers visible to the camera
+      if (ClassOf( light ) == ClassName( SpotLight ) ||
+          ClassOf( light ) == ClassName( PyramidLight ))
+      {
+        bool receivers = false;
+        for (UintSize a=0; a<lightActors.size() && !receivers; ++a)
+        {
+          Actor3D *actor = lightActors[a];
+          if (actor->isRenderable() && visibleSlots[ actor->cullSlot ])
+            receivers = !IsBeyondDrawDistance( actor, GetDrawDistance( actor, eye ));
+        }
+
+        if (!receivers) {
+          shadowSkip.last() = 1;
+          shadowStats.numLightsSkipped++;
+          continue; }
+      }
+
+      //Skinned actors are handled separately as their
+      //bounds don't follow the pose
+      for (UintSize a=0; a<lightActors.size(); ++a)
+      {
+        Actor3D *actor = lightActors[a];
+        if (actor->isRenderable() && actor->getCastShadow())
+          if (ClassOf( actor ) != ClassName( SkinMeshActor ))
+            if (!IsBeyondDrawDistance( actor, GetDrawDistance( actor, eye )))
+              shadowCasters.pushBack( actor );
+      }
+
+      for (UintSize s=0; s<scene->getSkinActors()->size(); ++s)
+      {
+        Actor3D *actor = (Actor3D*) scene->getSkinActors()->at( s );
+        if (actor->isRenderable() && actor->getCastShadow())
+          shadowCasters.pushBack( actor );
+      }
+    }
+
+    shadowCasterStart.pushBack( shadowCasters.size() );
+    shadowStats.numCasters = shadowCasters.size();
+  }
+
+  void Renderer::renderShadowMap (UintSize lightIndex, Scene3D *scene)
   {
+    Light *light = scene->getLights()->at( lightIndex );
     Uint S = shadowMapSize;
     if (!shadowInit)
     {
@@ -561,10 +950,25 @@ namespace GE
     
     Matrix4x4 lightView = light->getGlobalMatrix().affineNormalize().affineInverse();
     glMatrixMode( GL_MODELVIEW );
+
     glLoadMatrixf( (GLfloat*) lightView.m );
 
-    //Render scene
-    traverseScene( scene, RenderTarget::ShadowMap );
+    //Queue casters gathered for this light
+    Vector3 lightPos = light->getGlobalMatrix().getColumn(3).xyz();
+    UintSize first = shadowCasterStart[ lightIndex ];
+    UintSize last = shadowCasterStart[ lightIndex+1 ];
+    renderQueue->begin( RenderTarget::ShadowMap );
+
+    for (UintSize c=first; c<last; ++c)
+    {
+      Actor3D *actor = shadowCasters[c];
+      Matrix4x4 worldMat = actor->getGlobalMatrix();
+      Float depth = (worldMat.getColumn(3).xyz() - lightPos).norm();
+      actor->enqueue( renderQueue, RenderTarget::ShadowMap, worldMat, depth );
+    }
+
+    renderQueue->sort();
+    renderQueue->submit( glBackend );
 
     //Restore state
     glDisable( GL_POLYGON_OFFSET_FILL );
@@ -681,12 +1085,15 @@ namespace GE
       return;
 
     //Set camera current
-    curCamera = camera;
+    setCamera( camera );
 
     //Update scene
     if (scene->hasChanged())
       scene->updateChanges();
 
+    //Advance skinned actors once per frame
+    scene->tickAnimation();
+
     //Setup view and projection
     glViewport( viewX, viewY, viewW, viewH );
     camera->updateProjection( (Float) viewW, (Float) viewH );
@@ -749,8 +1156,12 @@ namespace GE
     glEnable( GL_DEPTH_TEST );
     glDisable( GL_BLEND );
 
+    cullCamera( scene );
     traverseScene( scene, RenderTarget::GBuffer );
 
+    //Find shadow casters for all the lights
+    gatherShadowCasters( scene );
+
 
     /////////////////////////////////////////////////////////////////////////
     //Ambient light pass
@@ -799,6 +1210,10 @@ namespace GE
       UintSize lastStencilIndex = Util::Min( l + numStencilBits, numLights );
       for (; stencilIndex < lastStencilIndex; stencilIndex++)
       {
+        //No stencil or query for lights without receivers
+        if (shadowSkip[ stencilIndex ])
+          continue;
+
         //The stencil bit being set for this light
         int stencilMask = (1 << (stencilIndex % numStencilBits));
         Light* light = scene->getLights()->at( stencilIndex );
@@ -879,6 +1294,10 @@ namespace GE
       //The stencil bit used by this light
       int stencilMask = (1 << (l % numStencilBits));
 
+      //Skip if no receivers visible
+      if (shadowSkip[l])
+        continue;
+
       //Obtain light query result
       GLint litSamples = 0;
       glGetQueryObjectiv( lightQueries[l], GL_QUERY_RESULT, &litSamples );
@@ -887,7 +1306,7 @@ namespace GE
 
       //Check if shadows enabled and render
       if (light->getCastShadows())
-        renderShadowMap( light, scene );
+        renderShadowMap( l, scene );
 
       /////////////////////////////////////////////////
       //Finally light the pixels that need to be lit
@@ -1333,15 +1752,22 @@ namespace GE
       return;
 
     //Set camera current
-    curCamera = camera;
+    setCamera( camera );
 
     //Update scene
     if (scene->hasChanged())
       scene->updateChanges();
 
+    //Advance skinned actors once per frame
+    scene->tickAnimation();
+
     //Render shadow map for the first light
-    if (!scene->getLights()->empty())
-      renderShadowMap( scene->getLights()->first(), scene );
+    cullCamera( scene );
+    gatherShadowCasters( scene );
+
+    bool shadow0 = (!scene->getLights()->empty() && !shadowSkip[0] &&
+                    scene->getLights()->first()->getCastShadows());
+    if (shadow0) renderShadowMap( 0, scene );
 
     //Setup view and projection
     glViewport( viewX, viewY, viewW, viewH );
@@ -1349,7 +1775,7 @@ namespace GE
     camera->updateView();
 
     //Setup camera-eye to light-clip matrix
-    if (!scene->getLights()->empty())
+    if (shadow0)
     {
       Light *l = scene->getLights()->first();
       
@@ -1365,10 +1791,12 @@ namespace GE
       glBindTexture( GL_TEXTURE_2D, shadowMap );
     }
     
-    //Enable lights
+    //Enable lights with visible receivers
     for (UintSize l=0; l<scene->getLights()->size(); ++l)
     {
       Light *light = scene->getLights()->at( l );
+      if (shadowSkip[l])
+        continue;
 
       //Setup transformation matrix
       Matrix4x4 worldCtm = light->getGlobalMatrix().affineNormalize();
@@ -1396,89 +1824,58 @@ namespace GE
     Matrix4x4 camMat = curCamera->getGlobalMatrix();
     Vector3 eye = camMat.getColumn(3).xyz();
 
-    //Frustum for culling
-    Frustum frustum;
+    //Camera visibility comes from cullCamera, the light
+    //frustum is culled on its own
+    ArrayList< Uint8 > *visibleList = &visibleSlots;
     if (target == RenderTarget::ShadowMap)
     {
       Matrix4x4 proj = curLight->getProjection();
       Matrix4x4 modelview = curLight->getGlobalMatrix().affineNormalize().affineInverse();
-      Matrix4x4 m = proj * modelview;
-      frustum.fromMatrix( m );
-    }
-    else
-    {
-      Matrix4x4 proj = curCamera->getProjection( (Float) viewW, (Float) viewH );
-      Matrix4x4 modelview = curCamera->getGlobalMatrix().affineNormalize().affineInverse();
-      Matrix4x4 m = proj * modelview;
-      frustum.fromMatrix( m );
+      Frustum frustum;
+      frustum.fromMatrix( proj * modelview );
+      scene->cullFrustum( frustum, lightVisibleSlots );
+      visibleList = &lightVisibleSlots;
     }
 
+    //Gather visible actors in traversal order
+    const ArrayList< Uint8 > &visible = *visibleList;
+    renderQueue->begin( target );
+    UintSize slot = 0;
+
     //Traverse the scene
     for (UintSize t=0; t<scene->getTraversal()->size(); ++t)
     {
       TravNode node = scene->getTraversal()->at( t );
-      if (node.event == TravEvent::Begin)
-      {
-        //Push matrix on the stack
-        glMatrixMode( GL_MODELVIEW );
-        glPushMatrix();
-        glMultMatrixf( (GLfloat*) node.actor->getMatrix().m );
+      if (node.event != TravEvent::Begin)
+        continue;
 
-        //Skip if disabled for rendering
-        if (!node.actor->isRenderable())
-          continue;
+      bool isVisible = (visible[ slot++ ] != 0);
 
-        //Skip if targeting shadow map and not casting shadows
-        if (target == RenderTarget::ShadowMap)
-          if (node.actor->getCastShadow() == false)
-            continue;
+      //Skip if disabled for rendering
+      if (!node.actor->isRenderable())
+        continue;
 
-        //TODO: code real solution (apply root bone transform to resulting
-        //box corners rather than min/max) for the skinned meshes)
-        if (ClassOf( node.actor ) != ClassName( SkinMeshActor ))
-        {
-          //Get bounding box
-          BoundingBox bbox = node.actor->getBoundingBox();
-          Matrix4x4 worldMat = node.actor->getGlobalMatrix();
-
-          //Maximum draw distance
-          Float maxDist = node.actor->getMaxDrawDistance();
-          if (maxDist >= 0.0f)
-          {
-            //Check distance of bbox center to camera
-            Vector3 center = worldMat * ((bbox.min + bbox.max) * 0.5f);
-            Float dist = (center - eye).norm();
-            if (dist > maxDist) continue;
-          }
-
-          //Transform bbox corners to world space
-          Vector3 bboxCorners[8];
-          bbox.getCorners( bboxCorners );
-          for (Uint c=0; c<8; ++c)
-            bboxCorners[ c ] = worldMat * bboxCorners[ c ];
-
-          //Frustum culling
-          if (frustum.testBox( bboxCorners ) == Frustum::Outside)
-            continue;
-        }
+      //Skip if targeting shadow map and not casting shadows
+      if (target == RenderTarget::ShadowMap)
+        if (node.actor->getCastShadow() == false)
+          continue;
 
-        //Render geometry
-        node.actor->begin();
-        node.actor->render( target );
-      }
-      else if (node.event == TravEvent::End)
-      {
-        //Pop matrix off the stack
-        glMatrixMode( GL_MODELVIEW );
-        glPopMatrix();
+      //Frustum culling
+      if (!isVisible)
+        continue;
 
-        //Skip if disabled for rendering
-        if (!node.actor->isRenderable())
-          continue;
+      //Maximum draw distance from the camera
+      Float dist = GetDrawDistance( node.actor, eye );
+      if (IsBeyondDrawDistance( node.actor, dist ))
+        continue;
 
-        node.actor->end();
-      }
+      //Queue geometry
+      node.actor->enqueue( renderQueue, target, node.actor->getGlobalMatrix(), dist );
     }
+
+    //Render sorted by state, front to back
+    renderQueue->sort();
+    renderQueue->submit( glBackend );
   }
   
   void Renderer::renderWindow (Scene *s, Camera *camera)
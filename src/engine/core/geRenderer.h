@@ -20,6 +20,11 @@ namespace GE
   class Scene3D;
   class Shader;
   class Material;
+  class RenderQueue;
+  class RenderQueueStats;
+  class GLRenderBackend;
+  class ShaderTable;
+  class ShaderSourceCache;
 
 
   /*
@@ -45,26 +50,51 @@ namespace GE
       Shadow     = 4
     };}
 
+  /*
+  Identifies a composed shader permutation. The hash is made
+  from the precomputed class hashes so lookups don't have to
+  compare UUIDs through the class pointers. Light shaders use
+  the Lighting target with the light class as geometry. */
+
   struct ShaderKey
   {
     RenderTarget::Enum target;
     Class matClass;
     Class geomClass;
+    Uint64 hash;
     Shader *shader;
+
+    void computeHash () {
+      hash = geomClass.hash() ^ (matClass.hash() * 0x9E3779B97F4A7C15ull) ^ ((Uint64) target << 59);
+    }
     
     bool operator == (const ShaderKey &k) const {
-      return (target == k.target && matClass == k.matClass && geomClass == k.geomClass);
+      return (hash == k.hash && target == k.target && matClass == k.matClass && geomClass == k.geomClass);
     }
   };
 
-  struct LightShaderKey
+  /*
+  A permutation to compose ahead of time. Composition reads
+  the vertex format so it needs a geometry instance rather
+  than just its class. */
+
+  struct ShaderPermutation
   {
-    Class lightClass;
-    Shader *shader;
+    RenderTarget::Enum target;
+    Actor3D *geometry;
+    Material *material;
+  };
 
-    bool operator == (const LightShaderKey &k) const {
-      return (lightClass == k.lightClass);
-    }
+  /*
+  Counts from the last shadow caster gathering stage. Actors
+  walked is what the full traversal would visit per light. */
+
+  struct ShadowStats
+  {
+    UintSize numLights;
+    UintSize numLightsSkipped;
+    UintSize numCasters;
+    UintSize numActorsWalked;
   };
 
   #define GE_NUM_GBUFFERS 4
@@ -80,6 +110,8 @@ namespace GE
   {
     CLASS( Renderer, Object,
       4829379e,7482,45e3,8897cee5e9acbf59 );
+
+    friend class GLRenderBackend;
     
   private:
 
@@ -90,8 +122,19 @@ namespace GE
     int viewW;
     int viewH;
     Vector3 back;
-    ArrayList< ShaderKey > shaders;
-    ArrayList< LightShaderKey > lightShaders;
+    ShaderTable *shaders;
+    ShaderSourceCache *shaderSources;
+    ArrayList< Uint8 > visibleSlots;
+    ArrayList< Uint8 > lightVisibleSlots;
+    RenderQueue *renderQueue;
+    GLRenderBackend *glBackend;
+
+    //Shadow casters per light, indexed as the scene lights
+    ArrayList< Actor3D* > shadowCasters;
+    ArrayList< UintSize > shadowCasterStart;
+    ArrayList< Uint8 > shadowSkip;
+    ArrayList< Actor3D* > lightActors;
+    ShadowStats shadowStats;
     Float avgLuminance;
     Float maxLuminance;
 
@@ -101,6 +144,11 @@ namespace GE
     Material *curMaterial;
     Light *curLight;
 
+    //Level of detail is chosen from the camera in every pass
+    Vector3 lodEye;
+    Float lodPixelScale;
+    Float lodPixelError;
+
     bool fullScreenInit;
     Uint fullScreenVAO;
     Uint fullScreenVBO;
@@ -211,11 +259,13 @@ namespace GE
     void initBuffers ();
 
     void fullScreenQuad ();
+    void setCamera (Camera *camera);
+    void cullCamera (Scene3D *scene);
     void traverseScene (Scene3D *scene, RenderTarget::Enum target);
-    void renderShadowMap (Light *light, Scene3D *scene);
-    Shader* findShaderByKey (const ShaderKey &key);
-
-    Shader *findLightShaderByKey (const LightShaderKey &key);
+    void gatherShadowCasters (Scene3D *scene);
+    static Float GetDrawDistance (Actor3D *actor, const Vector3 &eye);
+    static bool IsBeyondDrawDistance (Actor3D *actor, Float dist);
+    void renderShadowMap (UintSize lightIndex, Scene3D *scene);
     Shader *getLightShader (Light *light);
 
     void doToon (Uint32 sourceTex, Uint32 targetFB, Uint32 targetAtch);
@@ -229,6 +279,15 @@ namespace GE
                        Material *material);
     
     Renderer();
+    virtual ~Renderer();
+
+    //Shader permutations
+    void findShaderPermutations (Scene3D *scene, ArrayList< ShaderPermutation > &perms);
+    void warmShaders (const ArrayList< ShaderPermutation > &perms);
+    bool loadShaderSources (const CharString &filename);
+    bool saveShaderSources (const CharString &filename);
+    bool hasNewShaderSources ();
+    UintSize getNumShaders ();
 
     void setWindowSize (int width, int height);
     Vector2 getWindowSize ();
@@ -254,6 +313,19 @@ namespace GE
     void setMaxLuminance (Float l);
     Float getAvgLuminance ();
     Float getMaxLuminance ();
+
+    //Projected height in pixels of a length at a distance from the camera
+    Float getPixelSize (Float length, Float distance);
+    const Vector3& getCameraEye ();
+
+    //Meshes switch to a coarser level of detail while its
+    //error stays under this many pixels on screen
+    void setLodPixelError (Float pixels);
+    Float getLodPixelError ();
+
+    const RenderQueueStats& getQueueStats ();
+    const ShadowStats& getShadowStats ();
+    UintSize getNumShadowCasters (UintSize lightIndex);
   };
 }
 
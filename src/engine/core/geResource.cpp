@@ -23,4 +23,9 @@ namespace GE
   {
     name = n;
   }
+
+  UintSize Resource::getByteSize()
+  {
+    return sizeof( Resource );
+  }
 }
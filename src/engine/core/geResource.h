@@ -32,6 +32,9 @@ namespace GE
 
     const CharString& getResourceName() { return name; }
     void setResourceName (const CharString &name);
+
+    //Memory held by the resource, for cache budgets
+    virtual UintSize getByteSize();
   };
   
 }//namespace GE
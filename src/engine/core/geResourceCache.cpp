@@ -0,0 +1,319 @@
+#include "util/geUtil.h"
+#include "io/geFileMap.h"
+#include "core/geResource.h"
+#include "core/geTexture.h"
+#include "core/geTriMesh.h"
+#include "core/geCharacter.h"
+#include "core/geResourceCache.h"
+
+namespace GE
+{
+  ResourceCache::ResourceCache ()
+  {
+    for (int t=0; t<ResourceType::Count; ++t) {
+      budget[ t ] = 0;
+      resident[ t ] = 0; }
+
+    useCounter = 0;
+    resetStats();
+  }
+
+  /*
+  Resources still referenced belong to whoever holds them
+  by now, only the unused ones are deleted. */
+
+  ResourceCache::~ResourceCache ()
+  {
+    clear();
+  }
+
+  ResourceType::Enum ResourceCache::GetType (Resource *res)
+  {
+    if (Class::SafeCast< Texture >( res ) != NULL) return ResourceType::Texture;
+    if (Class::SafeCast< TriMesh >( res ) != NULL) return ResourceType::Mesh;
+    if (Class::SafeCast< Character >( res ) != NULL) return ResourceType::Character;
+    return ResourceType::Other;
+  }
+
+  void ResourceCache::rehash (UintSize capacity)
+  {
+    slots.clear();
+    for (UintSize s=0; s<capacity; ++s)
+      slots.pushBack( -1 );
+
+    UintSize mask = capacity - 1;
+    for (UintSize e=0; e<entries.size(); ++e)
+    {
+      UintSize h = (UintSize) entries[e].hash & mask;
+      while (slots[h] != -1) h = (h + 1) & mask;
+      slots[h] = (Int32) e;
+    }
+  }
+
+  Int32 ResourceCache::findIndex (const CharString &name, Uint64 hash) const
+  {
+    if (slots.empty()) return -1;
+
+    //Linear probing, names only compared on a hash match
+    UintSize mask = slots.size() - 1;
+    UintSize h = (UintSize) hash & mask;
+    while (slots[h] != -1)
+    {
+      const Entry &entry = entries[ slots[h] ];
+      if (entry.hash == hash && entry.name == name) return slots[h];
+      h = (h + 1) & mask;
+    }
+
+    return -1;
+  }
+
+  /*
+  The package is the mapping the resource borrows its
+  arrays from, if any. It's unmapped with the resource. */
+
+  void ResourceCache::insert (Resource *res, const CharString &name, FileMap *package)
+  {
+    Entry entry;
+    entry.name = name;
+    entry.hash = name.hash();
+    entry.resource = res;
+    entry.package = package;
+    entry.type = GetType( res );
+    entry.size = res->getByteSize();
+    entry.lastUse = ++useCounter;
+
+    resident[ entry.type ] += entry.size;
+    res->setResourceName( name );
+
+    Int32 e = findIndex( name, entry.hash );
+    if (e != -1)
+    {
+      Entry &old = entries[e];
+      if (old.resource == res)
+      {
+        //Same resource again keeps the mapping it borrows from
+        resident[ old.type ] -= old.size;
+        if (entry.package == NULL) entry.package = old.package;
+        else if (old.package != entry.package) delete old.package;
+      }
+      else if (old.resource->getRefCount() == 0)
+      {
+        //Nobody uses the replaced one
+        resident[ old.type ] -= old.size;
+        delete old.resource;
+        delete old.package;
+      }
+      else
+      {
+        //The replaced one goes once its users are done
+        retired.pushBack( old );
+      }
+
+      entries[e] = entry;
+      return;
+    }
+
+    entries.pushBack( entry );
+
+    //Grow at half load
+    if (entries.size() * 2 > slots.size()) {
+      rehash( Util::Max( slots.size() * 2, (UintSize) 64 ));
+      return; }
+
+    UintSize mask = slots.size() - 1;
+    UintSize h = (UintSize) entry.hash & mask;
+    while (slots[h] != -1) h = (h + 1) & mask;
+    slots[h] = (Int32) entries.size() - 1;
+  }
+
+  Resource* ResourceCache::find (const CharString &name, Uint64 hash)
+  {
+    Int32 e = findIndex( name, hash );
+    if (e == -1) return NULL;
+    return entries[e].resource;
+  }
+
+  /*
+  Same as find but counts towards the statistics and marks
+  the resource as recently used. */
+
+  Resource* ResourceCache::lookup (const CharString &name, Uint64 hash)
+  {
+    Int32 e = findIndex( name, hash );
+    if (e == -1) {
+      numMisses++;
+      return NULL; }
+
+    numHits++;
+    entries[e].lastUse = ++useCounter;
+    return entries[e].resource;
+  }
+
+  /*
+  Moves the last entry into the freed place. The slots are
+  rebuilt by the caller once it's done removing. */
+
+  void ResourceCache::release (UintSize index)
+  {
+    Entry &entry = entries[ index ];
+    resident[ entry.type ] -= entry.size;
+    delete entry.resource;
+    delete entry.package;
+
+    if (index + 1 < entries.size())
+      entries[ index ] = entries.last();
+    entries.popBack();
+    numEvictions++;
+  }
+
+  /*
+  Replaced resources can't be found by name any more but
+  still count towards the budget until their users are
+  done with them. */
+
+  UintSize ResourceCache::releaseRetired ()
+  {
+    UintSize count = 0;
+    for (UintSize r=retired.size(); r>0; --r)
+    {
+      Entry &entry = retired[ r-1 ];
+      if (entry.resource->getRefCount() > 0) continue;
+
+      resident[ entry.type ] -= entry.size;
+      delete entry.resource;
+      delete entry.package;
+
+      if (r < retired.size())
+        retired[ r-1 ] = retired.last();
+      retired.popBack();
+      numEvictions++;
+      count++;
+    }
+
+    return count;
+  }
+
+  UintSize ResourceCache::evict (ResourceType::Enum type)
+  {
+    UintSize count = 0;
+    while (resident[ type ] > budget[ type ])
+    {
+      //Find the least recently used one nobody references
+      Int32 oldest = -1;
+      for (UintSize e=0; e<entries.size(); ++e)
+      {
+        if (entries[e].type != type) continue;
+        if (entries[e].resource->getRefCount() > 0) continue;
+        if (oldest == -1 || entries[e].lastUse < entries[ oldest ].lastUse)
+          oldest = (Int32) e;
+      }
+
+      //Everything left is in use
+      if (oldest == -1) break;
+      release( (UintSize) oldest );
+      count++;
+    }
+
+    if (count > 0) rehash( slots.size() );
+    return count;
+  }
+
+  bool ResourceCache::isOverBudget ()
+  {
+    for (int t=0; t<ResourceType::Count; ++t)
+      if (budget[ t ] > 0 && resident[ t ] > budget[ t ])
+        return true;
+
+    return false;
+  }
+
+  /*
+  Evicts until every type fits its budget or only resources
+  in use are left. Referenced resources count as used just
+  now, so one released since the last trim ages from here. */
+
+  UintSize ResourceCache::trim ()
+  {
+    Uint64 now = ++useCounter;
+    for (UintSize e=0; e<entries.size(); ++e)
+      if (entries[e].resource->getRefCount() > 0)
+        entries[e].lastUse = now;
+
+    UintSize count = releaseRetired();
+    for (int t=0; t<ResourceType::Count; ++t)
+      if (budget[ t ] > 0)
+        count += evict( (ResourceType::Enum) t );
+
+    return count;
+  }
+
+  /*
+  Deletes every resource nobody references, e.g. between
+  levels. Returns the number of resources deleted. */
+
+  UintSize ResourceCache::clear ()
+  {
+    //Backwards so entries moved by a release were seen already
+    UintSize count = releaseRetired();
+    for (UintSize e=entries.size(); e>0; --e)
+    {
+      if (entries[ e-1 ].resource->getRefCount() == 0) {
+        release( e-1 );
+        count++; }
+    }
+
+    if (count > 0) rehash( slots.size() );
+    return count;
+  }
+
+  void ResourceCache::setBudget (ResourceType::Enum type, UintSize bytes)
+  {
+    budget[ type ] = bytes;
+  }
+
+  UintSize ResourceCache::getBudget (ResourceType::Enum type)
+  {
+    return budget[ type ];
+  }
+
+  UintSize ResourceCache::getResidentBytes (ResourceType::Enum type)
+  {
+    return resident[ type ];
+  }
+
+  UintSize ResourceCache::getResidentBytes ()
+  {
+    UintSize total = 0;
+    for (int t=0; t<ResourceType::Count; ++t)
+      total += resident[ t ];
+    return total;
+  }
+
+  UintSize ResourceCache::getNumResources ()
+  {
+    return entries.size();
+  }
+
+  UintSize ResourceCache::getNumHits ()
+  {
+    return numHits;
+  }
+
+  UintSize ResourceCache::getNumMisses ()
+  {
+    return numMisses;
+  }
+
+  UintSize ResourceCache::getNumEvictions ()
+  {
+    return numEvictions;
+  }
+
+  void ResourceCache::resetStats ()
+  {
+    numHits = 0;
+    numMisses = 0;
+    numEvictions = 0;
+  }
+
+}//namespace GE
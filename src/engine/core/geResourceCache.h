@@ -0,0 +1,99 @@
+#ifndef __GERESOURCECACHE_H
+#define __GERESOURCECACHE_H
+
+#include "util/geUtil.h"
+
+#pragma warning(push)
+#pragma warning(disable:4251)
+
+namespace GE
+{
+  /*
+  --------------------------------------------
+  Forward declarations
+  --------------------------------------------*/
+
+  class Resource;
+  class FileMap;
+
+  namespace ResourceType
+  {
+    enum Enum
+    {
+      Texture,
+      Mesh,
+      Character,
+      Other,
+      Count
+    };
+  }
+
+  /*
+  ----------------------------------------------------
+  Named resources with a memory budget per type. Once
+  a type goes over its budget, resources no reference
+  holds any more are deleted, least recently used
+  first. A budget of 0 means no limit. Names are kept
+  in an open addressing table by their hash.
+  ----------------------------------------------------*/
+
+  class ResourceCache
+  {
+    struct Entry
+    {
+      CharString name;
+      Uint64 hash;
+      Resource *resource;
+      FileMap *package;
+      ResourceType::Enum type;
+      UintSize size;
+      Uint64 lastUse;
+    };
+
+    ArrayList< Entry > entries;
+    ArrayList< Entry > retired;
+    ArrayList< Int32 > slots;
+    UintSize budget[ ResourceType::Count ];
+    UintSize resident[ ResourceType::Count ];
+    Uint64 useCounter;
+
+    UintSize numHits;
+    UintSize numMisses;
+    UintSize numEvictions;
+
+    void rehash (UintSize capacity);
+    Int32 findIndex (const CharString &name, Uint64 hash) const;
+    void release (UintSize index);
+    UintSize evict (ResourceType::Enum type);
+    UintSize releaseRetired ();
+
+  public:
+    ResourceCache ();
+    ~ResourceCache ();
+
+    static ResourceType::Enum GetType (Resource *res);
+
+    void insert (Resource *res, const CharString &name, FileMap *package = NULL);
+    Resource* find (const CharString &name, Uint64 hash);
+    Resource* find (const CharString &name) { return find( name, name.hash() ); }
+    Resource* lookup (const CharString &name, Uint64 hash);
+    Resource* lookup (const CharString &name) { return lookup( name, name.hash() ); }
+    bool isOverBudget ();
+    UintSize trim ();
+    UintSize clear ();
+
+    void setBudget (ResourceType::Enum type, UintSize bytes);
+    UintSize getBudget (ResourceType::Enum type);
+
+    UintSize getResidentBytes (ResourceType::Enum type);
+    UintSize getResidentBytes ();
+    UintSize getNumResources ();
+    UintSize getNumHits ();
+    UintSize getNumMisses ();
+    UintSize getNumEvictions ();
+    void resetStats ();
+  };
+
+}//namespace GE
+#pragma warning(pop)
+#endif//__GERESOURCECACHE_H
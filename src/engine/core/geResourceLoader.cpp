@@ -0,0 +1,418 @@
+#include <iostream>
+#include "util/geUtil.h"
+#include "io/geFile.h"
+#include "io/geFileMap.h"
+#include "image/geImage.h"
+#include "core/geResource.h"
+#include "core/geResourceLoader.h"
+
+namespace GE
+{
+  /*
+  --------------------------------------------------
+  Load request
+  --------------------------------------------------*/
+
+  LoadRequest::LoadRequest ()
+  {
+    order = 0;
+    queued = false;
+    loaded = false;
+    priority = 0;
+    image = NULL;
+    resource = NULL;
+    package = NULL;
+    borrowedSize = 0;
+  }
+
+  LoadRequest::~LoadRequest ()
+  {
+    //Release whatever the finalizer didn't take
+    delete image;
+    delete resource;
+    delete package;
+  }
+
+  /*
+  --------------------------------------------------
+  Worker side
+  --------------------------------------------------*/
+
+  bool ResourceLoader::DecodeImage (LoadRequest *req, const CharString &filename)
+  {
+    Image *img = new Image;
+    if (img->readFile( filename ) != IMAGE_NO_ERROR) {
+      delete img; std::cout << "Failed loading texture '" << filename.buffer() << "'!" << std::endl;
+      return false; }
+
+    req->image = img;
+    return true;
+  }
+
+  /*
+  Takes the native path name like FileMap. The mapping is
+  kept with the request if the resource borrowed from it. */
+
+  bool ResourceLoader::LoadPackage (LoadRequest *req, const CharString &pathName)
+  {
+    //Map the file
+    FileMap *package = new FileMap;
+    if (!package->open( pathName )) {
+      delete package; std::cout << "Failed opening file " << pathName.buffer() << "!" << std::endl;
+      return false; }
+
+    //Check the file signature
+    Serializer s;
+    if (package->getSize() <= s.getSignatureSize() ||
+        ! s.checkSignature( package->getData() )) {
+      delete package; std::cout << "Invalid file " << pathName.buffer() << "!" << std::endl;
+      return false; }
+
+    //Deserialize using arrays in place
+    s.setArrayBorrowing( true );
+    UintSize sigSize = s.getSignatureSize();
+    Object *obj = s.deserialize( package->getData() + sigSize, package->getSize() - sigSize );
+
+    Resource *res = Class::SafeCast< Resource >( obj );
+    if (res == NULL) {
+      delete obj; delete package; std::cout << "Invalid file content " << pathName.buffer() << "!" << std::endl;
+      return false; }
+
+    req->resource = res;
+    req->borrowedSize = s.getBorrowedSize();
+
+    //Unmap right away if nothing was borrowed
+    if (req->borrowedSize == 0) delete package;
+    else req->package = package;
+    return true;
+  }
+
+  bool ResourceLoader::LoadFile (LoadRequest *req)
+  {
+    if (req->name.right(3) == "jpg" ||
+        req->name.right(3) == "png")
+      return DecodeImage( req, req->name );
+    else
+      return LoadPackage( req, File( "Meshes\\" + req->name ).getPathName() );
+  }
+
+  bool ResourceLoader::load (LoadRequest *req)
+  {
+    return LoadFile( req );
+  }
+
+  void ResourceLoader::WorkerMain (void *param)
+  {
+    ResourceLoader *loader = (ResourceLoader*) param;
+    loader->work();
+  }
+
+  void ResourceLoader::work ()
+  {
+    while (true)
+    {
+      workSignal.wait();
+
+      //Take the most important request
+      lock.lock();
+      if (quit) {
+        lock.unlock();
+        break; }
+
+      //Canceled requests leave extra signals behind
+      LoadRequest *req = popQueue();
+      lock.unlock();
+      if (req == NULL) continue;
+
+      //Read and decode outside the lock
+      bool ok = load( req );
+
+      lock.lock();
+      req->loaded = ok;
+      done.pushBack( req );
+      lock.unlock();
+      doneSignal.post();
+    }
+  }
+
+  /*
+  --------------------------------------------------
+  Priority queue
+  --------------------------------------------------*/
+
+  bool ResourceLoader::Before (LoadRequest *a, LoadRequest *b)
+  {
+    //Higher priority first, then in order of request
+    if (a->priority != b->priority)
+      return a->priority > b->priority;
+    return a->order < b->order;
+  }
+
+  void ResourceLoader::siftUp (UintSize index)
+  {
+    while (index > 0)
+    {
+      UintSize parent = (index - 1) / 2;
+      if (!Before( queue[ index ], queue[ parent ] )) break;
+
+      LoadRequest *tmp = queue[ index ];
+      queue[ index ] = queue[ parent ];
+      queue[ parent ] = tmp;
+      index = parent;
+    }
+  }
+
+  void ResourceLoader::siftDown (UintSize index)
+  {
+    while (true)
+    {
+      UintSize first = index;
+      UintSize left = index * 2 + 1;
+      UintSize right = index * 2 + 2;
+
+      if (left < queue.size() && Before( queue[ left ], queue[ first ] )) first = left;
+      if (right < queue.size() && Before( queue[ right ], queue[ first ] )) first = right;
+      if (first == index) break;
+
+      LoadRequest *tmp = queue[ index ];
+      queue[ index ] = queue[ first ];
+      queue[ first ] = tmp;
+      index = first;
+    }
+  }
+
+  void ResourceLoader::pushQueue (LoadRequest *req)
+  {
+    req->queued = true;
+    queue.pushBack( req );
+    siftUp( queue.size() - 1 );
+  }
+
+  LoadRequest* ResourceLoader::popQueue ()
+  {
+    if (queue.empty()) return NULL;
+
+    LoadRequest *req = queue.first();
+    queue.first() = queue.last();
+    queue.popBack();
+    if (!queue.empty()) siftDown( 0 );
+
+    req->queued = false;
+    return req;
+  }
+
+  void ResourceLoader::removeQueue (LoadRequest *req)
+  {
+    int index = queue.indexOf( req );
+    if (index == -1) return;
+
+    //Move the last one in its place and restore the heap
+    queue[ index ] = queue.last();
+    queue.popBack();
+    if ((UintSize) index < queue.size()) {
+      siftDown( (UintSize) index );
+      siftUp( (UintSize) index ); }
+
+    req->queued = false;
+  }
+
+  /*
+  --------------------------------------------------
+  Main thread side
+  --------------------------------------------------*/
+
+  ResourceLoader::ResourceLoader (ResourceFinalizer *f, Uint numThreads)
+  {
+    finalizer = f;
+    quit = false;
+    nextOrder = 0;
+
+    //Keeps the image decoders alive while workers create images
+    decoders = new Image;
+
+    //Leave one core to the main thread
+    if (numThreads == 0)
+      numThreads = Util::Max( Thread::GetNumCores(), (Uint) 2 ) - 1;
+
+    for (Uint t=0; t<numThreads; ++t)
+    {
+      Thread *thread = new Thread;
+      thread->start( ResourceLoader::WorkerMain, this );
+      threads.pushBack( thread );
+    }
+  }
+
+  ResourceLoader::~ResourceLoader ()
+  {
+    stop();
+
+    //Drop everything that wasn't finalized
+    for (LoadRequestIter r = requests.begin(); r != requests.end(); ++r)
+      delete r->second;
+
+    delete decoders;
+  }
+
+  /*
+  Subclasses overriding load must stop the workers in their
+  own destructor, before their part of the object is gone. */
+
+  void ResourceLoader::stop ()
+  {
+    //Wake all the workers and let them exit
+    lock.lock();
+    quit = true;
+    lock.unlock();
+    workSignal.post( (Int) threads.size() );
+
+    for (UintSize t=0; t<threads.size(); ++t)
+      delete threads[ t ];
+    threads.clear();
+  }
+
+  void ResourceLoader::request (ResourceRef *ref, Int priority)
+  {
+    lock.lock();
+
+    LoadRequestIter r = requests.find( ref->name );
+    if (r != requests.end())
+    {
+      //Merge with the pending request
+      LoadRequest *req = r->second;
+      if (!req->refs.contains( ref ))
+        req->refs.pushBack( ref );
+
+      //Move it up the queue if it's still waiting
+      if (req->queued && priority > req->priority) {
+        req->priority = priority;
+        siftUp( (UintSize) queue.indexOf( req )); }
+    }
+    else
+    {
+      //Queue a new request and wake a worker
+      LoadRequest *req = new LoadRequest;
+      req->name = ref->name;
+      req->priority = priority;
+      req->order = nextOrder++;
+      req->refs.pushBack( ref );
+      requests[ req->name ] = req;
+      pushQueue( req );
+      workSignal.post();
+    }
+
+    ref->set( NULL );
+    ref->state = ResourceState::Loading;
+    lock.unlock();
+  }
+
+  /*
+  Detaches the reference from its pending request. A request
+  nobody waits for any more is dropped if it hasn't been
+  picked up by a worker yet. */
+
+  void ResourceLoader::cancel (ResourceRef *ref)
+  {
+    lock.lock();
+
+    LoadRequestIter r = requests.find( ref->name );
+    if (r != requests.end())
+    {
+      LoadRequest *req = r->second;
+      req->refs.remove( ref );
+
+      if (req->refs.empty() && req->queued) {
+        removeQueue( req );
+        requests.erase( r );
+        delete req; }
+    }
+
+    if (ref->state == ResourceState::Loading)
+      ref->state = ResourceState::Placeholder;
+    lock.unlock();
+  }
+
+  void ResourceLoader::finish (LoadRequest *req)
+  {
+    //Finalizer only sees requests that loaded fine
+    Resource *res = NULL;
+    if (req->loaded)
+      res = finalizer->finalize( req );
+
+    //Hand the result to everyone waiting
+    for (UintSize r=0; r<req->refs.size(); ++r)
+    {
+      ResourceRef *ref = req->refs[ r ];
+      ref->set( res );
+      ref->state = (res != NULL) ? ResourceState::Ready : ResourceState::Failed;
+    }
+
+    delete req;
+  }
+
+  /*
+  Finishes loaded requests, most important first, until the
+  budget runs out. At least one is finished on every call so
+  streaming keeps moving even when a single upload overruns
+  the budget. Returns the number of requests finished. */
+
+  UintSize ResourceLoader::finalize (Float budgetMs)
+  {
+    Uint64 start = Time::GetMicroseconds();
+    Uint64 budget = (Uint64) (Util::Max( budgetMs, 0.0f ) * 1000.0f);
+    UintSize count = 0;
+
+    while (true)
+    {
+      lock.lock();
+      if (done.empty()) {
+        lock.unlock();
+        break; }
+
+      //Pick the most important loaded request
+      UintSize first = 0;
+      for (UintSize d=1; d<done.size(); ++d)
+        if (Before( done[ d ], done[ first ] )) first = d;
+
+      LoadRequest *req = done[ first ];
+      done.removeAt( first );
+      requests.erase( req->name );
+      lock.unlock();
+
+      //Upload outside the lock so workers keep going
+      finish( req );
+      count++;
+
+      if (Time::GetMicroseconds() - start >= budget)
+        break;
+    }
+
+    return count;
+  }
+
+  /*
+  Blocks until every pending request is finalized, e.g. for
+  a loading screen. */
+
+  void ResourceLoader::flush ()
+  {
+    while (getNumPending() > 0)
+    {
+      if (finalize( 0.0f ) == 0)
+        doneSignal.wait();
+    }
+  }
+
+  UintSize ResourceLoader::getNumPending ()
+  {
+    lock.lock();
+    UintSize count = requests.size();
+    lock.unlock();
+    return count;
+  }
+
+  Uint ResourceLoader::getNumThreads ()
+  {
+    return (Uint) threads.size();
+  }
+
+}//namespace GE
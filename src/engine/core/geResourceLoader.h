@@ -0,0 +1,137 @@
+#ifndef __GERESOURCELOADER_H
+#define __GERESOURCELOADER_H
+
+#include "util/geUtil.h"
+#include "core/geKernel.h"
+#include <map>
+
+#pragma warning(push)
+#pragma warning(disable:4251)
+
+//Default main thread time per frame for finishing loads
+#define GE_STREAM_BUDGET_MS 2.0f
+
+namespace GE
+{
+  /*
+  --------------------------------------------
+  Forward declarations
+  --------------------------------------------*/
+
+  class Image;
+  class FileMap;
+  class ResourceLoader;
+
+  /*
+  ----------------------------------------------------
+  A resource on its way from disk. Workers fill in the
+  decoded image or the deserialized resource, the main
+  thread finalizes it and hands the result to all the
+  references waiting for it.
+  ----------------------------------------------------*/
+
+  class LoadRequest
+  {
+    friend class ResourceLoader;
+
+  private:
+    Uint64 order;
+    bool queued;
+    bool loaded;
+
+  public:
+    CharString name;
+    Int priority;
+    ArrayList< ResourceRef* > refs;
+
+    //Output of the worker, owned by the request until taken
+    Image *image;
+    Resource *resource;
+    FileMap *package;
+    UintSize borrowedSize;
+
+    LoadRequest ();
+    ~LoadRequest ();
+
+    bool isLoaded () { return loaded; }
+  };
+
+  /*
+  ----------------------------------------------------
+  Main thread step that turns a loaded request into a
+  usable resource, e.g. by uploading it to the GPU.
+  Takes ownership of what it uses from the request.
+  ----------------------------------------------------*/
+
+  class ResourceFinalizer
+  {
+  public:
+    virtual ~ResourceFinalizer () {}
+    virtual Resource* finalize (LoadRequest *req) = 0;
+  };
+
+  /*
+  ----------------------------------------------------
+  Background loading service. Requests are queued by
+  priority, read and decoded on worker threads, and
+  finalized on the main thread within a time budget.
+  Requests for the same name are merged.
+  ----------------------------------------------------*/
+
+  typedef std::map< CharString, LoadRequest* > LoadRequestMap;
+  typedef LoadRequestMap::iterator LoadRequestIter;
+
+  class ResourceLoader
+  {
+  private:
+    ArrayList< Thread* > threads;
+    Semaphore workSignal;
+    Semaphore doneSignal;
+    Mutex lock;
+    bool quit;
+
+    ResourceFinalizer *finalizer;
+    Image *decoders;
+    Uint64 nextOrder;
+
+    //Queue is a binary heap, highest priority first
+    ArrayList< LoadRequest* > queue;
+    ArrayList< LoadRequest* > done;
+    LoadRequestMap requests;
+
+    static bool Before (LoadRequest *a, LoadRequest *b);
+    void siftUp (UintSize index);
+    void siftDown (UintSize index);
+    void pushQueue (LoadRequest *req);
+    LoadRequest* popQueue ();
+    void removeQueue (LoadRequest *req);
+
+    static void WorkerMain (void *param);
+    void work ();
+    void finish (LoadRequest *req);
+
+  protected:
+    //Runs on a worker thread
+    virtual bool load (LoadRequest *req);
+    void stop ();
+
+  public:
+    ResourceLoader (ResourceFinalizer *finalizer, Uint numThreads = 0);
+    virtual ~ResourceLoader ();
+
+    static bool LoadFile (LoadRequest *req);
+    static bool DecodeImage (LoadRequest *req, const CharString &filename);
+    static bool LoadPackage (LoadRequest *req, const CharString &pathName);
+
+    void request (ResourceRef *ref, Int priority = 0);
+    void cancel (ResourceRef *ref);
+    UintSize finalize (Float budgetMs);
+    void flush ();
+
+    UintSize getNumPending ();
+    Uint getNumThreads ();
+  };
+
+}//namespace GE
+#pragma warning(pop)
+#endif//__GERESOURCELOADER_H
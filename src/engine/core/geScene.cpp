@@ -1,25 +1,49 @@
 #include "geScene.h"
 #include "geLight.h"
+#include "geKernel.h"
+#include "actors/geSkinMeshActor.h"
 
 namespace GE
 {
   Scene3D::Scene3D()
   {
     cam = NULL;
+    animTime = 0.0f;
+    animInit = false;
+    setTrackMovedActors( true );
   }
 
   Scene3D::~Scene3D ()
   {
     for (UintSize a=0; a<animations.size(); ++a)
       delete animations[ a ];
+
+    for (UintSize r=0; r<heldResources.size(); ++r)
+      heldResources[ r ]->dereference();
+  }
+
+  /*
+  The resources array keeps plain pointers, so the scene
+  holds a reference to each of them. A cache can't delete
+  them under it then, e.g. before the scene is written. */
+
+  void Scene3D::referenceResources ()
+  {
+    for (UintSize r=0; r<resources.size(); ++r) {
+      resources[ r ]->reference();
+      heldResources.pushBack( resources[ r ] ); }
   }
   
   void Scene3D::updateChanges()
   {
-    bool changed = hasChanged();
+    bool changed = hasStructureChanged();
     Scene::updateChanges();
 
-    if (!changed) return;
+    if (!changed) {
+      updatePendingActors();
+      updateMovedActors();
+      return; }
+
     if (getRoot() == NULL) return;
 
     //Init stack based on last size
@@ -27,7 +51,10 @@ namespace GE
 
     //Clear old data
     lights.clear();
+    skinActors.clear();
     traversal.clear();
+    cullActors.clear();
+    alwaysSlots.clear();
     
     //Walk the scene tree and store traversal order
     stack.pushBack( TravNode( (Actor3D*) getRoot(), TravEvent::Begin ));
@@ -45,12 +72,22 @@ namespace GE
 
       //Notify actory
       node.actor->prepare();
+
+      //Assign culling slot
+      a->cullSlot = cullActors.size();
+      cullActors.pushBack( a );
       
       //Store lights
       Light *l = dynamic_cast< Light* >( a );
       if (l != NULL)
         if (ClassOf( l ) != ClassName( PointLight ))
           lights.pushBack( l );
+
+      //Store skinned actors (bounds don't follow the pose)
+      SkinMeshActor *s = Class::SafeCast< SkinMeshActor >( a );
+      if (s != NULL) {
+        skinActors.pushBack( s );
+        alwaysSlots.pushBack( (Uint32) a->cullSlot ); }
       
       //Put children actors onto the stack
       stack.pushBack( TravNode( a, TravEvent::End ));
@@ -60,6 +97,220 @@ namespace GE
         stack.pushBack( TravNode( child, TravEvent::Begin ));
       }
     }
+
+    buildCullTree();
+  }
+
+  /*
+  Actors waiting on a streamed resource keep the scene
+  changed so they are polled until it arrives. */
+
+  bool Scene3D::hasChanged()
+  {
+    return Scene::hasChanged() || !pendingSlots.empty();
+  }
+
+  /*
+  Culling bounds of an actor in world space */
+
+  BoundingBox Scene3D::GetCullBox (Actor3D *actor)
+  {
+    return actor->getBoundingBox().transform( actor->getGlobalMatrix() );
+  }
+
+  /*
+  Rebuilds the bounding volume hierarchy over the world
+  bounds of all the actors when the structure changes. */
+
+  void Scene3D::buildCullTree ()
+  {
+    cullBoxes.clear();
+    cullDynamic.clear();
+    dynamicSlots.clear();
+    dynamicBoxes.clear();
+    pendingSlots.clear();
+
+    for (UintSize c=0; c<cullActors.size(); ++c)
+    {
+      BoundingBox bbox = GetCullBox( cullActors[c] );
+      cullBoxes.add( bbox.min, bbox.max );
+      cullDynamic.pushBack( -1 );
+
+      if (cullActors[c]->isBoundsPending())
+        pendingSlots.pushBack( (Uint32) c );
+    }
+
+    cullTree.build( cullBoxes );
+    clearMovedActors();
+  }
+
+  /*
+  Actors waiting on a streamed resource are polled until it
+  arrives and then refreshed like the moved ones. */
+
+  void Scene3D::updatePendingActors ()
+  {
+    UintSize p = 0;
+    while (p < pendingSlots.size())
+    {
+      Actor3D *a = cullActors[ pendingSlots[p] ];
+      if (a->isBoundsPending()) { ++p; continue; }
+
+      a->markBoundsChanged();
+      pendingSlots.removeAt( p );
+    }
+  }
+
+  /*
+  Actors moved since the hierarchy was last fitted are
+  tracked in a flat list which is tested on its own and
+  overrides the stale result from the hierarchy. */
+
+  void Scene3D::updateMovedActors ()
+  {
+    const ArrayList< Actor* > &moved = getMovedActors();
+    if (moved.empty()) return;
+
+    for (UintSize m=0; m<moved.size(); ++m)
+    {
+      Actor3D *a = (Actor3D*) moved[m];
+      UintSize slot = a->cullSlot;
+      if (slot >= cullActors.size() || cullActors[ slot ] != a)
+        continue;
+
+      BoundingBox bbox = GetCullBox( a );
+      cullBoxes.set( slot, bbox.min, bbox.max );
+
+      if (cullDynamic[ slot ] == -1)
+      {
+        cullDynamic[ slot ] = (Int) dynamicSlots.size();
+        dynamicSlots.pushBack( (Uint32) slot );
+        dynamicBoxes.add( bbox.min, bbox.max );
+      }
+      else dynamicBoxes.set( cullDynamic[ slot ], bbox.min, bbox.max );
+    }
+
+    clearMovedActors();
+
+    //Refit the hierarchy to current bounds once the flat
+    //list grows too big, rebuild it once refits have
+    //loosened it too much
+    if (dynamicSlots.size() > 64 + cullActors.size() / 8)
+    {
+      cullTree.refit( cullBoxes );
+      if (cullTree.getNumRefits() > GE_CULL_MAX_REFITS ||
+          cullTree.getRefitGrowth() > GE_CULL_MAX_GROWTH)
+        cullTree.build( cullBoxes );
+      for (UintSize d=0; d<dynamicSlots.size(); ++d)
+        cullDynamic[ dynamicSlots[d] ] = -1;
+
+      dynamicSlots.clear();
+      dynamicBoxes.clear();
+    }
+  }
+
+  /*
+  Spatial queries use the hierarchy for the actors that
+  haven't moved since it was refitted and a linear test
+  for the rest. */
+
+  void Scene3D::queryActors (const BoxQuery &q, ArrayList< Actor3D* > &outActors)
+  {
+    if (hasChanged())
+      updateChanges();
+
+    queryItems.clear();
+    cullTree.query( q, queryItems );
+    for (UintSize i=0; i<queryItems.size(); ++i)
+      if (cullDynamic[ queryItems[i] ] == -1)
+        outActors.pushBack( cullActors[ queryItems[i] ] );
+
+    queryItems.clear();
+    dynamicBoxes.query( q, queryItems );
+    for (UintSize i=0; i<queryItems.size(); ++i)
+      outActors.pushBack( cullActors[ dynamicSlots[ queryItems[i] ]] );
+  }
+
+  void Scene3D::findActorsInBox (const BoundingBox &box, ArrayList< Actor3D* > &outActors)
+  {
+    queryActors( RangeQuery( box.min, box.max ), outActors );
+  }
+
+  void Scene3D::findActorsInSphere (const Vector3 &center, Float radius, ArrayList< Actor3D* > &outActors)
+  {
+    queryActors( SphereQuery( center, radius ), outActors );
+  }
+
+  void Scene3D::findActorsInFrustum (const Frustum &f, ArrayList< Actor3D* > &outActors)
+  {
+    queryActors( FrustumQuery( f ), outActors );
+  }
+
+  void Scene3D::findActorsOnRay (const Vector3 &origin, const Vector3 &dir, Float maxDist,
+                                 ArrayList< Actor3D* > &outActors)
+  {
+    queryActors( RayQuery( origin, dir, maxDist ), outActors );
+  }
+
+  UintSize Scene3D::getNumCullSlots ()
+  {
+    return cullActors.size();
+  }
+
+  /*
+  Outputs a visibility flag for every actor in the order
+  of Begin nodes in the traversal. Skinned actors are
+  always reported visible. */
+
+  void Scene3D::cullFrustum (const Frustum &f, ArrayList< Uint8 > &outVisible)
+  {
+    if (hasChanged())
+      updateChanges();
+
+    UintSize numSlots = cullActors.size();
+    outVisible.clear();
+    outVisible.resize( numSlots );
+    if (numSlots == 0) return;
+
+    //Static actors
+    memset( outVisible.buffer(), 0, numSlots );
+    cullTree.cullFrustum( f, outVisible.buffer() );
+
+    //Moved actors
+    if (!dynamicSlots.empty())
+    {
+      dynamicVisible.clear();
+      dynamicVisible.resize( dynamicSlots.size() );
+      dynamicBoxes.cullFrustum( f, 0, dynamicSlots.size(), dynamicVisible.buffer() );
+
+      for (UintSize d=0; d<dynamicSlots.size(); ++d)
+        outVisible[ dynamicSlots[d] ] = dynamicVisible[d];
+    }
+
+    //Actors without reliable bounds
+    for (UintSize a=0; a<alwaysSlots.size(); ++a)
+      outVisible[ alwaysSlots[a] ] = 1;
+  }
+
+  /*
+  Runs the per-frame animation stage for all the skinned
+  actors in the scene. The renderer invokes it before every
+  pass over the scene, so a scene drawn more than once in a
+  frame only advances with the first. */
+
+  void Scene3D::tickAnimation()
+  {
+    Kernel *kernel = Kernel::GetInstance();
+    if (animInit && animTime == kernel->getTime())
+      return;
+
+    animTime = kernel->getTime();
+    animInit = true;
+
+    if (hasChanged())
+      updateChanges();
+
+    SkinMeshActor::TickAll( skinActors, kernel->getInterval(), kernel->getThreadPool() );
   }
 
   void Scene3D::setAmbientColor (const Vector3 &color) {
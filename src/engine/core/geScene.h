@@ -4,6 +4,10 @@
 #include "util/geUtil.h"
 #include "core/geActor.h"
 #include "core/geAnimation.h"
+#include "math/geBoxTree.h"
+
+#define GE_CULL_MAX_REFITS 64     //Refits before the cull tree is rebuilt anyway
+#define GE_CULL_MAX_GROWTH 1.5f   //Node area growth since the build that forces a rebuild
 
 namespace GE
 {
@@ -15,6 +19,7 @@ namespace GE
   class Camera;
   class Renderer;
   class Light;
+  class SkinMeshActor;
 
   /*
   --------------------------------------------
@@ -59,11 +64,39 @@ namespace GE
 
     Camera *cam;
     ArrayList< Light* > lights;
+    ArrayList< SkinMeshActor* > skinActors;
     ArrayList< TravNode > traversal;
 
+    //Culling data per traversal slot (order of Begin nodes)
+    ArrayList< Actor3D* > cullActors;
+    ArrayList< Int > cullDynamic;
+    ArrayList< Uint32 > alwaysSlots;
+    ArrayList< Uint32 > pendingSlots;
+    BoxArray cullBoxes;
+    BoxTree cullTree;
+
+    //Actors moved since the hierarchy was last fitted
+    ArrayList< Uint32 > dynamicSlots;
+    ArrayList< Uint8 > dynamicVisible;
+    BoxArray dynamicBoxes;
+    ArrayList< Uint32 > queryItems;
+
+    static BoundingBox GetCullBox (Actor3D *actor);
+    void buildCullTree ();
+    void updatePendingActors ();
+    void updateMovedActors ();
+    void queryActors (const BoxQuery &q, ArrayList< Actor3D* > &outActors);
+
   private:
     Vector3 ambientColor;
 
+    //Kernel time of the last animation tick
+    Float animTime;
+    bool animInit;
+
+    //Resources referenced on behalf of the scene
+    ArrayList< Resource* > heldResources;
+
   public:
     ArrayList< Animation* > animations;
     ArrayList< Resource* > resources;
@@ -75,11 +108,29 @@ namespace GE
     void bindCamera( Camera *cam );
     inline const ArrayList< TravNode >* getTraversal();
     inline const ArrayList< Light* >* getLights();
+    inline const ArrayList< SkinMeshActor* >* getSkinActors();
 
     void setAmbientColor (const Vector3 &color);
     const Vector3& getAmbientColor ();
 
     virtual void updateChanges();
+    virtual bool hasChanged();
+
+    //Runs once per kernel tick however often it's called
+    void tickAnimation();
+
+    //Keeps the resources from being evicted while the scene lives
+    void referenceResources ();
+
+    UintSize getNumCullSlots ();
+    void cullFrustum (const Frustum &f, ArrayList< Uint8 > &outVisible);
+
+    //Actors with world bounds intersecting a volume
+    void findActorsInBox (const BoundingBox &box, ArrayList< Actor3D* > &outActors);
+    void findActorsInSphere (const Vector3 &center, Float radius, ArrayList< Actor3D* > &outActors);
+    void findActorsInFrustum (const Frustum &f, ArrayList< Actor3D* > &outActors);
+    void findActorsOnRay (const Vector3 &origin, const Vector3 &dir, Float maxDist,
+                          ArrayList< Actor3D* > &outActors);
   };
 
   const ArrayList< TravNode >* Scene3D::getTraversal() {
@@ -89,6 +140,10 @@ namespace GE
   const ArrayList< Light* >* Scene3D::getLights() {
     return &lights;
   }
+
+  const ArrayList< SkinMeshActor* >* Scene3D::getSkinActors() {
+    return &skinActors;
+  }
 }
 
 #endif /* __GESCENE_H */
@@ -0,0 +1,255 @@
+#include <iostream>
+#include "util/geUtil.h"
+#include "core/geResource.h"
+#include "core/geScene.h"
+#include "core/geResourceCache.h"
+#include "core/geScenePackage.h"
+
+namespace GE
+{
+  static const UUID packageID = MAKEUUID( 3d9a6b1e,0c47,4f2a,b5e8716c24d09f33 );
+
+  ScenePackage::ScenePackage ()
+  {
+    scene = NULL;
+    borrowArrays = false;
+    useArenas = false;
+  }
+
+  const void* ScenePackage::GetSignature ()
+  {
+    return &packageID;
+  }
+
+  UintSize ScenePackage::GetSignatureSize ()
+  {
+    //Signature is a UUID
+    return sizeof( UUID );
+  }
+
+  bool ScenePackage::CheckSignature (const void *data, UintSize size)
+  {
+    if (size < GetSignatureSize()) return false;
+    return *((const UUID*) data) == packageID;
+  }
+
+  static UintSize AlignBlob (UintSize offset)
+  {
+    return (offset + GE_SCENE_BLOB_ALIGN - 1) & ~((UintSize) GE_SCENE_BLOB_ALIGN - 1);
+  }
+
+  /*
+  Only meshes, characters and textures get blobs of their
+  own. Other resources, like materials actors point to,
+  stay with the scene. */
+
+  void ScenePackage::Write (Scene3D *scene, void **outData, UintSize *outSize)
+  {
+    ArrayList< Resource* > allResources = scene->resources;
+    ArrayList< Resource* > split;
+
+    scene->resources.clear();
+    for (UintSize r=0; r<allResources.size(); ++r)
+    {
+      if (ResourceCache::GetType( allResources[ r ] ) != ResourceType::Other)
+        split.pushBack( allResources[ r ] );
+      else
+        scene->resources.pushBack( allResources[ r ] );
+    }
+
+    //Serialize the scene first, then every resource on its own
+    ArrayList< void* > blobData;
+    ArrayList< UintSize > blobSize;
+    for (UintSize b=0; b<=split.size(); ++b)
+    {
+      Serializer s;
+      s.setArrayAlignment( true );
+
+      void *data = NULL;
+      UintSize size = 0;
+      s.serialize( (b == 0) ? (Object*) scene : (Object*) split[ b-1 ], &data, &size );
+      blobData.pushBack( data );
+      blobSize.pushBack( size );
+    }
+
+    scene->resources = allResources;
+
+    //Blob offsets past the index
+    Serializer s;
+    s.setArrayAlignment( true );
+    UintSize sigSize = s.getSignatureSize();
+    UintSize numBlobs = blobData.size();
+    UintSize offset = GetSignatureSize() + sizeof( Uint64 ) * (1 + numBlobs * 2);
+
+    ArrayList< UintSize > blobOffset;
+    for (UintSize b=0; b<numBlobs; ++b)
+    {
+      offset = AlignBlob( offset );
+      blobOffset.pushBack( offset );
+      offset += sigSize + blobSize[ b ];
+    }
+
+    //Padding stays zero
+    Uint8 *out = (Uint8*) std::calloc( Util::Max( offset, (UintSize) 1 ), 1 );
+    std::memcpy( out, GetSignature(), GetSignatureSize() );
+
+    Uint64 *index = (Uint64*) (out + GetSignatureSize());
+    *index++ = (Uint64) numBlobs;
+
+    for (UintSize b=0; b<numBlobs; ++b)
+    {
+      *index++ = (Uint64) blobOffset[ b ];
+      *index++ = (Uint64) (sigSize + blobSize[ b ]);
+
+      std::memcpy( out + blobOffset[ b ], s.getSignature(), sigSize );
+      std::memcpy( out + blobOffset[ b ] + sigSize, blobData[ b ], blobSize[ b ] );
+      std::free( blobData[ b ] );
+    }
+
+    *outData = out;
+    *outSize = offset;
+  }
+
+  /*
+  Runs on a worker. Every blob has a serializer of its
+  own, the factory registry is only read. */
+
+  void ScenePackage::loadBlob (Blob &blob)
+  {
+    Serializer s;
+    if (blob.size <= s.getSignatureSize() || !s.checkSignature( blob.data ))
+      return;
+
+    s.setArrayBorrowing( borrowArrays );
+    if (useArenas) s.setObjectArena( new ObjectArena );
+
+    UintSize sigSize = s.getSignatureSize();
+    blob.root = s.deserialize( blob.data + sigSize, blob.size - sigSize );
+    blob.objects = s.getObjects();
+    blob.borrowedSize = s.getBorrowedSize();
+
+    //Arena goes with the last of the objects
+    if (useArenas) s.getObjectArena()->release();
+  }
+
+  /*
+  A resource blob belongs to its root, e.g. a character
+  deletes its meshes. Otherwise scenes, actors and resources
+  like materials are allocated on their own, the rest are
+  members or owned by those, e.g. the scene's animations.
+  Going backwards sees objects before their owner. */
+
+  void ScenePackage::deleteBlob (Blob &blob)
+  {
+    if (Class::SafeCast< Resource >( blob.root ) != NULL)
+      delete blob.root;
+    else
+    {
+      for (UintSize o=blob.objects.size(); o>0; --o)
+      {
+        Object *obj = blob.objects[ o-1 ];
+        if (Class::SafeCast< Scene >( obj ) != NULL ||
+            Class::SafeCast< Actor >( obj ) != NULL ||
+            Class::SafeCast< Resource >( obj ) != NULL)
+          delete obj;
+      }
+    }
+
+    blob.root = NULL;
+    blob.objects.clear();
+  }
+
+  //Undoes a read that failed after deserializing
+  void ScenePackage::deleteObjects ()
+  {
+    for (UintSize b=0; b<blobs.size(); ++b)
+      deleteBlob( blobs[ b ] );
+
+    blobs.clear();
+    objects.clear();
+  }
+
+  void ScenePackage::LoadJob (UintSize index, void *param)
+  {
+    ScenePackage *package = (ScenePackage*) param;
+    package->loadBlob( package->blobs[ index ] );
+  }
+
+  bool ScenePackage::read (const void *data, UintSize size, ThreadPool *pool, bool borrow)
+  {
+    const Uint8 *bytes = (const Uint8*) data;
+    borrowArrays = borrow;
+    blobs.clear();
+    objects.clear();
+    scene = NULL;
+
+    //Check the index fits
+    if (!CheckSignature( data, size )) return false;
+    UintSize indexOffset = GetSignatureSize();
+    if (size < indexOffset + sizeof( Uint64 )) return false;
+
+    const Uint64 *index = (const Uint64*) (bytes + indexOffset);
+    UintSize numBlobs = (UintSize) *index++;
+    if (numBlobs == 0 || (size - indexOffset) / (sizeof( Uint64 ) * 2) < numBlobs)
+      return false;
+
+    blobs.resize( numBlobs );
+    for (UintSize b=0; b<numBlobs; ++b)
+    {
+      Uint64 offset = *index++;
+      Uint64 blobSize = *index++;
+      if (offset > size || blobSize > size - offset) {
+        std::cout << "Invalid scene package index!" << std::endl;
+        blobs.clear();
+        return false; }
+
+      blobs[ b ].data = bytes + offset;
+      blobs[ b ].size = (UintSize) blobSize;
+      blobs[ b ].root = NULL;
+      blobs[ b ].borrowedSize = 0;
+    }
+
+    //Deserialize all the blobs at once
+    if (pool != NULL)
+      pool->parallelFor( blobs.size(), LoadJob, this );
+    else
+      for (UintSize b=0; b<blobs.size(); ++b)
+        loadBlob( blobs[ b ] );
+
+    //Nothing to join without the scene
+    scene = Class::SafeCast< Scene3D >( blobs.first().root );
+    if (scene == NULL) {
+      std::cout << "Invalid scene in scene package!" << std::endl;
+      deleteObjects();
+      return false; }
+
+    //Join the resources back with the scene
+    for (UintSize b=0; b<blobs.size(); ++b)
+    {
+      if (b > 0)
+      {
+        //A blob that isn't a resource is dropped whole
+        Resource *res = Class::SafeCast< Resource >( blobs[ b ].root );
+        if (res != NULL) scene->resources.pushBack( res );
+        else {
+          std::cout << "Invalid resource in scene package!" << std::endl;
+          deleteBlob( blobs[ b ] );
+          continue; }
+      }
+
+      for (UintSize o=0; o<blobs[ b ].objects.size(); ++o)
+        objects.pushBack( blobs[ b ].objects[ o ] );
+    }
+
+    return true;
+  }
+
+  UintSize ScenePackage::getBorrowedSize ()
+  {
+    UintSize total = 0;
+    for (UintSize b=0; b<blobs.size(); ++b)
+      total += blobs[ b ].borrowedSize;
+    return total;
+  }
+
+}//namespace GE
@@ -0,0 +1,83 @@
+#ifndef __GESCENEPACKAGE_H
+#define __GESCENEPACKAGE_H
+
+#include "util/geUtil.h"
+
+#pragma warning(push)
+#pragma warning(disable:4251)
+
+//Alignment of the blobs within a scene package
+#define GE_SCENE_BLOB_ALIGN 16
+
+namespace GE
+{
+  /*
+  --------------------------------------------
+  Forward declarations
+  --------------------------------------------*/
+
+  class Scene3D;
+  class Resource;
+  class ThreadPool;
+
+  /*
+  ----------------------------------------------------
+  Scene file with the scene and each of its resources
+  stored as separate blobs behind an index, so the
+  resources can be deserialized in parallel. Resources
+  don't point into the scene or at each other, actors
+  reference them by name, so the only link to restore
+  when joining the blobs is the scene's resource list.
+
+  Layout: package signature, blob count, then offset
+  and size of each blob. Every blob is a serializer
+  signature followed by its data, the scene first.
+  ----------------------------------------------------*/
+
+  class ScenePackage
+  {
+    struct Blob
+    {
+      const Uint8 *data;
+      UintSize size;
+      Object *root;
+      ArrayList< Object* > objects;
+      UintSize borrowedSize;
+    };
+
+    ArrayList< Blob > blobs;
+    ArrayList< Object* > objects;
+    Scene3D *scene;
+    bool borrowArrays;
+    bool useArenas;
+
+    static void LoadJob (UintSize index, void *param);
+    void loadBlob (Blob &blob);
+    void deleteBlob (Blob &blob);
+    void deleteObjects ();
+
+  public:
+    ScenePackage ();
+
+    static const void* GetSignature ();
+    static UintSize GetSignatureSize ();
+    static bool CheckSignature (const void *data, UintSize size);
+
+    //Whole file content including the signature
+    static void Write (Scene3D *scene, void **outData, UintSize *outSize);
+
+    //Places the objects of every blob in an arena of its own
+    void setObjectArenas (bool enable) { useArenas = enable; }
+
+    //Data starts with the signature and must outlive borrowed arrays
+    bool read (const void *data, UintSize size, ThreadPool *pool = NULL, bool borrow = false);
+
+    Scene3D* getScene () { return scene; }
+    const ArrayList< Object* >& getObjects () { return objects; }
+    UintSize getNumBlobs () { return blobs.size(); }
+    UintSize getBorrowedSize ();
+  };
+
+}//namespace GE
+#pragma warning(pop)
+#endif//__GESCENEPACKAGE_H
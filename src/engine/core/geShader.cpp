@@ -15,6 +15,7 @@ namespace GE
   
   Shader::~Shader ()
   {
+    deleteNodes();
     detachShaders();
     deleteShaders();
     deleteProgram();
@@ -29,6 +30,25 @@ namespace GE
     }
   }
 
+  void Shader::deleteNodes ()
+  {
+    typedef LinkedList<Node*>::Iterator NodeIter;
+
+    for (NodeIter n=vertShaderNodes.begin(); n!=vertShaderNodes.end(); ++n)
+      delete *n;
+    for (NodeIter n=fragShaderNodes.begin(); n!=fragShaderNodes.end(); ++n)
+      delete *n;
+
+    vertShaderNodes.clear();
+    fragShaderNodes.clear();
+
+    if (newShaderNode != NULL)
+    {
+      delete newShaderNode;
+      newShaderNode = NULL;
+    }
+  }
+
   void Shader::deleteShaders ()
   {
     for (UintSize v=0; v<vertShaders.size(); ++v)
@@ -193,14 +213,19 @@ namespace GE
   DataUnit DataUnit::Mat4( DataType::Matrix, 4 );
   DataUnit DataUnit::Sampler2D( DataType::Sampler2D, 1 );
 
-  CharString DataUnit::toString()
+  const char* DataUnit::typeName() const
   {
+    static const char *vecNames[] = { "vec2", "vec3", "vec4" };
+    static const char *ivecNames[] = { "ivec2", "ivec3", "ivec4" };
+    static const char *matNames[] = { "mat2", "mat3", "mat4" };
+
     if (count > 1)
     {
+      if (count > 4) return "invalidtype";
       switch (type) {
-      case DataType::Int: return "ivec" + CharString::FInt(count);
-      case DataType::Float: return "vec" + CharString::FInt(count);
-      case DataType::Matrix: return "mat" + CharString::FInt(count);
+      case DataType::Int: return ivecNames[ count-2 ];
+      case DataType::Float: return vecNames[ count-2 ];
+      case DataType::Matrix: return matNames[ count-2 ];
       default: return "invalidtype";
       }
     }
@@ -216,6 +241,11 @@ namespace GE
     return "invalidtype";
   }
 
+  CharString DataUnit::toString()
+  {
+    return typeName();
+  }
+
   void Shader::Socket::resolveKnownData()
   {
     builtInAccess[ ShaderType::Vertex ] = false;
@@ -375,19 +405,54 @@ namespace GE
     return (Int32) uniforms.size()-1;
   }
 
-  void output (CharString &code, int indent, const CharString &str)
+  /*
+  The output helpers append pieces straight to the code instead
+  of concatenating temporaries first, since every + allocates. */
+
+  static void outputIndent (CharString &code, int indent)
   {
     for (int i=0; i<indent; ++i)
       code += "  ";
+  }
+
+  static void output (CharString &code, int indent, const char *str)
+  {
+    outputIndent( code, indent );
     code += str;
   }
 
-  void outputLines (CharString &code, int indent, const CharString &str)
+  static void outputLines (CharString &code, int indent, const CharString &str)
+  {
+    const char *chars = str.buffer();
+    int length = str.length();
+    int start = 0;
+
+    //Empty lines are kept except a leading one, like tokenize
+    for (int c=0; c<length; ++c)
+    {
+      if (chars[c] != '\n') continue;
+      if (c > 0) {
+        outputIndent( code, indent );
+        code += CharString( chars + start, c - start );
+        code += '\n'; }
+      start = c + 1;
+    }
+
+    if (length > start) {
+      outputIndent( code, indent );
+      code += CharString( chars + start, length - start );
+      code += '\n'; }
+  }
+
+  static void outputDecl (CharString &code, int indent, const char *qualifier,
+                          const DataUnit &unit, const char *prefix, const CharString &name)
   {
-    ArrayList<CharString> lines;
-    str.tokenize( "\n", &lines );
-    for (UintSize l=0; l<lines.size(); ++l)
-      output( code, indent, lines[l]+"\n" );
+    outputIndent( code, indent );
+    code += qualifier;
+    code += unit.typeName();
+    code += ' ';
+    code += prefix;
+    code += name;
   }
 
   CharString Shader::outputShader (LinkedList<Socket> *varying,
@@ -400,9 +465,13 @@ namespace GE
     int indent = 0;
     typedef LinkedList<Socket>::Iterator SocketIter;
     typedef LinkedList<Node*>::Iterator NodeIter;
-    CharString shaderStr;
+    char nodeName[ 32 ];
     int nID = 0;
 
+    //Appending reallocates to the exact size so start big enough
+    CharString shaderStr;
+    shaderStr.reserveAndCopy( 4096 + code.length() );
+
     //Output preprocessor directives
     //shaderStr += "#version 130\n\n";
 
@@ -410,8 +479,10 @@ namespace GE
     for (UintSize u=0; u<uniforms.size(); ++u) {
       Uniform &su = uniforms[u];
       if (su.loc != target) continue;
-      output( shaderStr, indent, "uniform " + su.unit.toString() + " " + su.name );
-      if (su.count > 1) shaderStr += "[" + CharString::FInt( su.count ) + "];\n";
+      outputDecl( shaderStr, indent, "uniform ", su.unit, "", su.name );
+      if (su.count > 1) {
+        sprintf( nodeName, "[%d];\n", (int) su.count );
+        shaderStr += nodeName; }
       else shaderStr += ";\n";
     }
 
@@ -419,14 +490,16 @@ namespace GE
     if (target == ShaderType::Vertex) {
       for (UintSize a=0; a<attribs.size(); ++a) {
         VertexAttrib &va = attribs[a];
-        output( shaderStr, indent, "attribute " + va.unit.toString() + " " + va.name + ";\n" );
+        outputDecl( shaderStr, indent, "attribute ", va.unit, "", va.name );
+        shaderStr += ";\n";
       }}
 
     //Output varying for each remaining socket requiring varying input
     if (varying != NULL) {
-      for (SocketIter v=varying->begin(); v!=varying->end(); ++v)
-        output( shaderStr, indent, "varying " + v->unit.toString() + " v" + v->name + ";\n");
-    }
+      for (SocketIter v=varying->begin(); v!=varying->end(); ++v) {
+        outputDecl( shaderStr, indent, "varying ", v->unit, "v", v->name );
+        shaderStr += ";\n";
+      }}
 
     //Output function definition for each node used
     for (NodeIter n=nodes->begin(); n!=nodes->end(); ++n)
@@ -434,18 +507,19 @@ namespace GE
       UintSize arg=0;
       Node *node = *n;
       shaderStr += "\n";
-      output( shaderStr, indent, "void node" + CharString::FInt(nID++) + " (" );
+      sprintf( nodeName, "void node%d (", nID++ );
+      output( shaderStr, indent, nodeName );
       for (UintSize i=0; i<node->inSocks.size(); ++i, ++arg)
       {
         if (arg>0) shaderStr += ", ";
         Socket &sock = node->inSocks[i];
-        shaderStr += "in " + sock.unit.toString() + " in" + sock.name;
+        outputDecl( shaderStr, 0, "in ", sock.unit, "in", sock.name );
       }
       for (UintSize o=0; o<node->outSocks.size(); ++o, ++arg)
       {
         if (arg>0) shaderStr += ", ";
         Socket &sock = node->outSocks[o];
-        shaderStr += "out " + sock.unit.toString() + " out" + sock.name;
+        outputDecl( shaderStr, 0, "out ", sock.unit, "out", sock.name );
       }
       shaderStr += ")\n";
       output( shaderStr, indent, "{\n" );
@@ -459,18 +533,25 @@ namespace GE
     indent += 1;
 
     //Ouput a simple declaration for satisfied sockets
-    for (SocketIter d=done->begin(); d!=done->end(); ++d)
-      output( shaderStr, indent, d->unit.toString() + " t" + d->name + ";\n");
+    for (SocketIter d=done->begin(); d!=done->end(); ++d) {
+      outputDecl( shaderStr, indent, "", d->unit, "t", d->name );
+      shaderStr += ";\n";
+    }
 
     //Init unsatisfied socket variables with builtin, attribute or varying data
     if (init != NULL) {
       for (SocketIter i=init->begin(); i!=init->end(); ++i) {
-        if (i->source == DataSource::BuiltIn && i->builtInAccess[ target ])
-          output( shaderStr, indent, i->unit.toString() + " t" + i->name + " " + i->getInitString() + ";\n" );
-        else if (i->source == DataSource::Attribute && target==ShaderType::Vertex)
-          output( shaderStr, indent, i->unit.toString() + " t" + i->name + " = " + i->name + ";\n");
-        else
-          output( shaderStr, indent, i->unit.toString() + " t" + i->name + " = v" + i->name  + ";\n");
+        outputDecl( shaderStr, indent, "", i->unit, "t", i->name );
+        if (i->source == DataSource::BuiltIn && i->builtInAccess[ target ]) {
+          shaderStr += " ";
+          shaderStr += i->getInitString(); }
+        else if (i->source == DataSource::Attribute && target==ShaderType::Vertex) {
+          shaderStr += " = ";
+          shaderStr += i->name; }
+        else {
+          shaderStr += " = v";
+          shaderStr += i->name; }
+        shaderStr += ";\n";
       }}
 
     shaderStr+= "\n";
@@ -481,16 +562,19 @@ namespace GE
     {
       UintSize arg=0;
       Node *node = *n;
-      output( shaderStr, indent, "node" + CharString::FInt(nID++) + "( " );
+      sprintf( nodeName, "node%d( ", nID++ );
+      output( shaderStr, indent, nodeName );
       for (UintSize i=0; i<node->inSocks.size(); ++i, ++arg)
       {
         if (arg>0) shaderStr += ", ";
-        shaderStr += "t" + node->inSocks[i].name;
+        shaderStr += "t";
+        shaderStr += node->inSocks[i].name;
       }
       for (UintSize o=0; o<node->outSocks.size(); ++o, ++arg)
       {
         if (arg>0) shaderStr += ", ";
-        shaderStr += "t" + node->outSocks[o].name;
+        shaderStr += "t";
+        shaderStr += node->outSocks[o].name;
       }
       shaderStr += " );\n";
     }
@@ -502,9 +586,13 @@ namespace GE
     shaderStr += "\n";
     if (target != ShaderType::Fragment) {
       if (varying != NULL) {
-        for (SocketIter v=varying->begin(); v!=varying->end(); ++v)
-          output( shaderStr, indent, "v" + v->name + " = t" + v->name + ";\n");
-      }}
+        for (SocketIter v=varying->begin(); v!=varying->end(); ++v) {
+          output( shaderStr, indent, "v" );
+          shaderStr += v->name;
+          shaderStr += " = t";
+          shaderStr += v->name;
+          shaderStr += ";\n";
+        }}}
 
     //End main
     indent -= 1;
@@ -579,7 +667,9 @@ namespace GE
     }
   }
 
-  bool Shader::compose (RenderTarget::Enum target)
+  bool Shader::composeSource (RenderTarget::Enum target,
+                              CharString &vertSource,
+                              CharString &fragSource)
   {
     typedef LinkedList<Socket>::Iterator SocketIter;
     typedef LinkedList<Node*>::Iterator NodeIter;
@@ -651,24 +741,104 @@ namespace GE
     //Find the vertex nodes that produce data for sockets
     findNodesForSockets( &vertSocks, &vertShaderNodes, &vertDoneSocks, &vertUsedNodes );
 
-    CharString vertShaderStr = outputShader
+    vertSource = outputShader
       ( &varying, &vertSocks, &vertDoneSocks, &vertUsedNodes, vertCode, ShaderType::Vertex );
-    CharString fragShaderStr = outputShader
+    fragSource = outputShader
       ( &varying, &fragSocks, &fragDoneSocks, &fragUsedNodes, fragCode, ShaderType::Fragment );
 
-    vertShaderNodes.clear();
-    fragShaderNodes.clear();
+    deleteNodes();
     
     /*
     printf( "-----------------------\nVertexShader:\n-----------------------\n");
-    printf( "%s\n", vertShaderStr.buffer() );
+    printf( "%s\n", vertSource.buffer() );
     printf( "-----------------------\nFragmentShader:\n-----------------------\n");
-    printf( "%s\n", fragShaderStr.buffer() );
+    printf( "%s\n", fragSource.buffer() );
     */
 
+    return true;
+  }
+
+  bool Shader::compose (RenderTarget::Enum target)
+  {
+    CharString vertShaderStr, fragShaderStr;
+    if (!composeSource( target, vertShaderStr, fragShaderStr ))
+      return false;
+
     return fromString( vertShaderStr, fragShaderStr );
   }
 
+  void Shader::composeDiscard ()
+  {
+    deleteNodes();
+  }
+
+  static void HashBytes (Uint64 &h, const void *data, UintSize size)
+  {
+    //FNV-1a
+    const Uint8 *bytes = (const Uint8*) data;
+    for (UintSize b=0; b<size; ++b) {
+      h ^= bytes[b];
+      h *= 0x100000001B3ull; }
+  }
+
+  static void HashString (Uint64 &h, const CharString &str)
+  {
+    HashBytes( h, str.buffer(), (UintSize) str.length() );
+    HashBytes( h, "", 1 );
+  }
+
+  static void HashInt (Uint64 &h, Int64 value)
+  {
+    HashBytes( h, &value, sizeof( value ));
+  }
+
+  /*
+  Covers attributes, uniforms and nodes registered so far, so
+  cached sources can be told apart from stale ones after the
+  composing code of a material or actor has been changed. */
+
+  Uint64 Shader::getComposeHash ()
+  {
+    typedef LinkedList<Node*>::Iterator NodeIter;
+    Uint64 h = 0xCBF29CE484222325ull;
+
+    for (UintSize a=0; a<attribs.size(); ++a) {
+      HashString( h, attribs[a].name );
+      HashInt( h, attribs[a].unit.type );
+      HashInt( h, attribs[a].unit.count ); }
+
+    for (UintSize u=0; u<uniforms.size(); ++u) {
+      HashString( h, uniforms[u].name );
+      HashInt( h, uniforms[u].loc );
+      HashInt( h, uniforms[u].unit.type );
+      HashInt( h, uniforms[u].unit.count );
+      HashInt( h, uniforms[u].count ); }
+
+    LinkedList<Node*> *lists[2] = { &vertShaderNodes, &fragShaderNodes };
+    for (int l=0; l<2; ++l)
+    {
+      HashInt( h, l );
+      for (NodeIter n=lists[l]->begin(); n!=lists[l]->end(); ++n)
+      {
+        Node *node = *n;
+        HashString( h, node->code );
+
+        for (UintSize i=0; i<node->inSocks.size(); ++i) {
+          HashInt( h, node->inSocks[i].data );
+          HashInt( h, node->inSocks[i].index );
+          HashString( h, node->inSocks[i].name ); }
+
+        HashInt( h, -1 );
+        for (UintSize o=0; o<node->outSocks.size(); ++o) {
+          HashInt( h, node->outSocks[o].data );
+          HashInt( h, node->outSocks[o].index );
+          HashString( h, node->outSocks[o].name ); }
+      }
+    }
+
+    return h;
+  }
+
   UintSize Shader::getNumVertexShaders () {
     return vertShaders.size();
   }
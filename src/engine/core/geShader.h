@@ -45,6 +45,7 @@ namespace GE
     bool operator== (const DataUnit &u) const
       { return (type == u.type && count == u.count); }
     CharString toString();
+    const char* typeName() const;
 
     static DataUnit Float;
     static DataUnit Vec2;
@@ -203,6 +204,7 @@ namespace GE
     ArrayList< GLShader* > vertShaders;
     ArrayList< GLShader* > fragShaders;
     GLProgram *program;
+    void deleteNodes ();
     void attachShaders ();
     void detachShaders ();
     void deleteShaders ();
@@ -238,6 +240,17 @@ namespace GE
 
     bool compose (RenderTarget::Enum target);
 
+    //Composition without compiling, needs no GL context
+    bool composeSource (RenderTarget::Enum target,
+                        CharString &vertSource,
+                        CharString &fragSource);
+
+    //Drops the nodes when sources come from a cache instead
+    void composeDiscard ();
+
+    //Fingerprint of everything registered for composition
+    Uint64 getComposeHash ();
+
     //Used for linking of multiple vertex/fragment sources
     bool compile (ShaderType::Enum target,
                   const CharString &source);
@@ -0,0 +1,275 @@
+#include "core/geShaderCache.h"
+#include "io/geFile.h"
+
+//Bump when the engine side of composition changes
+#define GE_SHADER_CACHE_SIGNATURE  "GESC"
+#define GE_SHADER_CACHE_VERSION    1
+
+namespace GE
+{
+  /*
+  -----------------------------------------------------
+  ShaderTable
+  -----------------------------------------------------*/
+
+  ShaderTable::ShaderTable ()
+  {
+    clear();
+  }
+
+  void ShaderTable::clear ()
+  {
+    keys.clear();
+    slots.clear();
+  }
+
+  void ShaderTable::rehash (UintSize capacity)
+  {
+    slots.clear();
+    for (UintSize s=0; s<capacity; ++s)
+      slots.pushBack( -1 );
+
+    UintSize mask = capacity - 1;
+    for (UintSize k=0; k<keys.size(); ++k)
+    {
+      UintSize h = (UintSize) keys[k].hash & mask;
+      while (slots[h] != -1) h = (h + 1) & mask;
+      slots[h] = (Int32) k;
+    }
+  }
+
+  Int32 ShaderTable::findIndex (const ShaderKey &key) const
+  {
+    if (slots.empty()) return -1;
+
+    //Linear probing
+    UintSize mask = slots.size() - 1;
+    UintSize h = (UintSize) key.hash & mask;
+    while (slots[h] != -1)
+    {
+      if (keys[ slots[h] ] == key) return slots[h];
+      h = (h + 1) & mask;
+    }
+
+    return -1;
+  }
+
+  bool ShaderTable::contains (const ShaderKey &key) const
+  {
+    return findIndex( key ) != -1;
+  }
+
+  Shader* ShaderTable::find (const ShaderKey &key) const
+  {
+    Int32 k = findIndex( key );
+    if (k == -1) return NULL;
+    return keys[k].shader;
+  }
+
+  void ShaderTable::insert (const ShaderKey &key)
+  {
+    keys.pushBack( key );
+
+    //Grow at half load
+    if (keys.size() * 2 > slots.size()) {
+      rehash( Util::Max( slots.size() * 2, (UintSize) 32 ));
+      return; }
+
+    UintSize mask = slots.size() - 1;
+    UintSize h = (UintSize) key.hash & mask;
+    while (slots[h] != -1) h = (h + 1) & mask;
+    slots[h] = (Int32) keys.size() - 1;
+  }
+
+  /*
+  -----------------------------------------------------
+  ShaderSourceCache
+  -----------------------------------------------------*/
+
+  ShaderSourceCache::ShaderSourceCache ()
+  {
+    clear();
+  }
+
+  void ShaderSourceCache::clear ()
+  {
+    sources.clear();
+    slots.clear();
+    changed = false;
+  }
+
+  void ShaderSourceCache::rehash (UintSize capacity)
+  {
+    slots.clear();
+    for (UintSize s=0; s<capacity; ++s)
+      slots.pushBack( -1 );
+
+    UintSize mask = capacity - 1;
+    for (UintSize e=0; e<sources.size(); ++e)
+    {
+      UintSize h = (UintSize) sources[e].permutation & mask;
+      while (slots[h] != -1) h = (h + 1) & mask;
+      slots[h] = (Int32) e;
+    }
+  }
+
+  Int32 ShaderSourceCache::findIndex (Uint64 permutation) const
+  {
+    if (slots.empty()) return -1;
+
+    UintSize mask = slots.size() - 1;
+    UintSize h = (UintSize) permutation & mask;
+    while (slots[h] != -1)
+    {
+      if (sources[ slots[h] ].permutation == permutation)
+        return slots[h];
+      h = (h + 1) & mask;
+    }
+
+    return -1;
+  }
+
+  const ShaderSource* ShaderSourceCache::find (Uint64 permutation, Uint64 compose) const
+  {
+    Int32 e = findIndex( permutation );
+    if (e == -1) return NULL;
+
+    //Stale entry composed from different inputs
+    if (sources[e].compose != compose) return NULL;
+    return &sources[e];
+  }
+
+  void ShaderSourceCache::store (Uint64 permutation, Uint64 compose,
+                                 const CharString &vertex, const CharString &fragment)
+  {
+    changed = true;
+
+    //Replace existing entry
+    Int32 e = findIndex( permutation );
+    if (e != -1) {
+      sources[e].compose = compose;
+      sources[e].vertex = vertex;
+      sources[e].fragment = fragment;
+      return; }
+
+    ShaderSource src;
+    src.permutation = permutation;
+    src.compose = compose;
+    src.vertex = vertex;
+    src.fragment = fragment;
+    sources.pushBack( src );
+
+    if (sources.size() * 2 > slots.size()) {
+      rehash( Util::Max( slots.size() * 2, (UintSize) 32 ));
+      return; }
+
+    UintSize mask = slots.size() - 1;
+    UintSize h = (UintSize) permutation & mask;
+    while (slots[h] != -1) h = (h + 1) & mask;
+    slots[h] = (Int32) sources.size() - 1;
+  }
+
+  /*
+  A corrupt length can't be allowed to allocate more than
+  the rest of the file holds. */
+
+  static bool ReadString (File &file, UintSize fileSize, CharString &str)
+  {
+    Uint32 length = 0;
+    if (file.read( &length, sizeof( Uint32 )) != sizeof( Uint32 ))
+      return false;
+
+    UintSize pos = file.getPointer();
+    if (pos > fileSize || (UintSize) length > fileSize - pos)
+      return false;
+
+    ArrayList< char > chars;
+    chars.resize( length + 1 );
+    if (file.read( chars.buffer(), length ) != length)
+      return false;
+
+    str = CharString( chars.buffer(), (int) length );
+    return true;
+  }
+
+  static void WriteString (File &file, const CharString &str)
+  {
+    Uint32 length = (Uint32) str.length();
+    file.write( &length, sizeof( Uint32 ));
+    file.write( str.buffer(), length );
+  }
+
+  /*
+  Layout: signature, version, count and then per entry the
+  permutation hash, compose hash and the two sources each
+  prefixed by its length. Written in native byte order since
+  the cache never leaves the machine that generated it. */
+
+  bool ShaderSourceCache::load (const CharString &filename)
+  {
+    File file( filename );
+    if (!file.open( FileAccess::Read, FileCondition::MustExist ))
+      return false;
+
+    char sig[4];
+    Uint32 version = 0, count = 0;
+    file.read( sig, 4 );
+    file.read( &version, sizeof( Uint32 ));
+
+    if (memcmp( sig, GE_SHADER_CACHE_SIGNATURE, 4 ) != 0 ||
+        version != GE_SHADER_CACHE_VERSION ||
+        file.read( &count, sizeof( Uint32 )) != sizeof( Uint32 ))
+    {
+      printf( "Ignoring outdated shader cache %s\n", filename.buffer() );
+      file.close();
+      return false;
+    }
+
+    UintSize fileSize = file.getSize();
+    for (Uint32 e=0; e<count; ++e)
+    {
+      ShaderSource src;
+      if (file.read( &src.permutation, sizeof( Uint64 )) != sizeof( Uint64 ) ||
+          file.read( &src.compose, sizeof( Uint64 )) != sizeof( Uint64 ) ||
+          !ReadString( file, fileSize, src.vertex ) ||
+          !ReadString( file, fileSize, src.fragment ))
+      {
+        printf( "Truncated or corrupt shader cache %s\n", filename.buffer() );
+        break;
+      }
+
+      store( src.permutation, src.compose, src.vertex, src.fragment );
+    }
+
+    file.close();
+    changed = false;
+    return true;
+  }
+
+  bool ShaderSourceCache::save (const CharString &filename)
+  {
+    File file( filename );
+    if (!file.open( FileAccess::Write, FileCondition::Truncate )) {
+      printf( "Failed writing shader cache %s\n", filename.buffer() );
+      return false; }
+
+    Uint32 version = GE_SHADER_CACHE_VERSION;
+    Uint32 count = (Uint32) sources.size();
+    file.write( GE_SHADER_CACHE_SIGNATURE, 4 );
+    file.write( &version, sizeof( Uint32 ));
+    file.write( &count, sizeof( Uint32 ));
+
+    for (UintSize e=0; e<sources.size(); ++e)
+    {
+      file.write( &sources[e].permutation, sizeof( Uint64 ));
+      file.write( &sources[e].compose, sizeof( Uint64 ));
+      WriteString( file, sources[e].vertex );
+      WriteString( file, sources[e].fragment );
+    }
+
+    file.close();
+    changed = false;
+    return true;
+  }
+
+}//namespace GE
@@ -0,0 +1,89 @@
+#ifndef __GESHADERCACHE_H
+#define __GESHADERCACHE_H
+
+#include "util/geUtil.h"
+#include "core/geRenderer.h"
+
+//Default file the renderer loads composed sources from,
+//relative to the executable (see Kernel::setShaderCacheFile)
+#define GE_SHADER_CACHE_FILE "shaders.gecache"
+
+namespace GE
+{
+  /*
+  --------------------------------------------
+  Forward declarations
+  --------------------------------------------*/
+
+  class Shader;
+
+  /*
+  -----------------------------------------------------
+  Open addressing table of composed shaders indexed by
+  the permutation hash. Lookups compare the 64-bit hash
+  first and fall back to the full key only on a match.
+  -----------------------------------------------------*/
+
+  class ShaderTable
+  {
+    ArrayList< ShaderKey > keys;
+    ArrayList< Int32 > slots;
+
+    void rehash (UintSize capacity);
+    Int32 findIndex (const ShaderKey &key) const;
+
+  public:
+    ShaderTable ();
+
+    void clear ();
+    bool contains (const ShaderKey &key) const;
+    Shader* find (const ShaderKey &key) const;
+    void insert (const ShaderKey &key);
+
+    UintSize size () const { return keys.size(); }
+    const ShaderKey& at (UintSize index) const { return keys[ index ]; }
+  };
+
+  /*
+  -----------------------------------------------------
+  Generated GLSL sources keyed by permutation hash. The
+  compose hash fingerprints what the actor and material
+  registered, so entries go stale when their code does.
+  -----------------------------------------------------*/
+
+  class ShaderSource
+  {
+  public:
+    Uint64 permutation;
+    Uint64 compose;
+    CharString vertex;
+    CharString fragment;
+  };
+
+  class ShaderSourceCache
+  {
+    ArrayList< ShaderSource > sources;
+    ArrayList< Int32 > slots;
+    bool changed;
+
+    Int32 findIndex (Uint64 permutation) const;
+    void rehash (UintSize capacity);
+
+  public:
+    ShaderSourceCache ();
+
+    void clear ();
+    const ShaderSource* find (Uint64 permutation, Uint64 compose) const;
+    void store (Uint64 permutation, Uint64 compose,
+                const CharString &vertex, const CharString &fragment);
+
+    bool load (const CharString &filename);
+    bool save (const CharString &filename);
+
+    bool isChanged () const { return changed; }
+    UintSize size () const { return sources.size(); }
+    const ShaderSource& at (UintSize index) const { return sources[ index ]; }
+  };
+
+}//namespace GE
+#endif//__GESHADERCACHE_H
@@ -0,0 +1,141 @@
+#include "core/geShaderComposer.h"
+#include "core/geShader.h"
+#include "core/geMaterial.h"
+#include "core/geSkinMesh.h"
+#include "core/actors/geTriMeshActor.h"
+#include "core/actors/geSkinMeshActor.h"
+
+namespace GE
+{
+  ShaderComposer::ShaderComposer ()
+  {
+    clear();
+  }
+
+  void ShaderComposer::clear ()
+  {
+    geomClasses.clear();
+    matClasses.clear();
+    targets.clear();
+  }
+
+  void ShaderComposer::addGeometryClass (Class geomClass) {
+    geomClasses.pushBack( geomClass );
+  }
+
+  void ShaderComposer::addMaterialClass (Class matClass) {
+    matClasses.pushBack( matClass );
+  }
+
+  void ShaderComposer::addTarget (RenderTarget::Enum target) {
+    targets.pushBack( target );
+  }
+
+  /*
+  Everything the engine itself composes shaders for. The base
+  Material stands for the material-independent shadow shader. */
+
+  void ShaderComposer::addDefaults ()
+  {
+    addGeometryClass( ClassName( TriMeshActor ));
+    addGeometryClass( ClassName( SkinMeshActor ));
+
+    addMaterialClass( ClassName( Material ));
+    addMaterialClass( ClassName( StandardMaterial ));
+    addMaterialClass( ClassName( DiffuseTexMat ));
+    addMaterialClass( ClassName( NormalTexMat ));
+
+    addTarget( RenderTarget::GBuffer );
+    addTarget( RenderTarget::ShadowMap );
+  }
+
+  /*
+  Matches the formats of exported meshes: skinned meshes carry
+  joint data and normal mapped ones tangent frames. */
+
+  void ShaderComposer::GetVertexFormat (Class geomClass, Class matClass, VertexFormat &format)
+  {
+    format.addMember( ShaderData::TexCoord2 );
+    format.addMember( ShaderData::Normal );
+    format.addMember( ShaderData::Coord3 );
+
+    if (geomClass == ClassName( SkinMeshActor )) {
+      format.addMember( ShaderData::JointIndex );
+      format.addMember( ShaderData::JointWeight ); }
+
+    if (matClass == ClassName( NormalTexMat )) {
+      format.addMember( ShaderData::Tangent );
+      format.addMember( ShaderData::Bitangent ); }
+  }
+
+  UintSize ShaderComposer::getNumPermutations ()
+  {
+    return geomClasses.size() * matClasses.size() * targets.size();
+  }
+
+  bool ShaderComposer::composePermutation (UintSize index, ShaderKey &key, ShaderSource &source)
+  {
+    //Index runs over targets fastest, then materials
+    UintSize t = index % targets.size();
+    UintSize m = (index / targets.size()) % matClasses.size();
+    UintSize g = index / (targets.size() * matClasses.size());
+
+    Actor3D *geometry = (Actor3D*) Class::SafeCast( ClassName( Actor3D ), geomClasses[g]->instantiate() );
+    Material *material = (Material*) Class::SafeCast( ClassName( Material ), matClasses[m]->instantiate() );
+    if (geometry == NULL || material == NULL) {
+      delete geometry;
+      delete material;
+      return false; }
+
+    //Mesh actors read their vertex format when composing
+    TriMesh triMesh;
+    SkinTriMesh skinMesh;
+    TriMeshActor *meshActor = Class::SafeCast< TriMeshActor >( geometry );
+    if (meshActor != NULL)
+    {
+      VertexFormat format;
+      GetVertexFormat( geomClasses[g], matClasses[m], format );
+      TriMesh *mesh = (meshActor->getClass() == ClassName( SkinMeshActor )) ? &skinMesh : &triMesh;
+      mesh->setFormat( format );
+      meshActor->TriMeshActor::setMesh( mesh );
+    }
+
+    key.target = targets[t];
+    key.geomClass = geometry->getShaderComposingClass();
+    key.matClass = material->getShaderComposingClass();
+    key.shader = NULL;
+    key.computeHash();
+
+    //Same steps as Renderer::getShader short of compiling
+    Shader shader;
+    geometry->composeShader( &shader );
+    material->composeShader( &shader );
+
+    source.permutation = key.hash;
+    source.compose = shader.getComposeHash();
+    bool status = shader.composeSource( key.target, source.vertex, source.fragment );
+
+    delete geometry;
+    delete material;
+    return status;
+  }
+
+  UintSize ShaderComposer::composeAll (ShaderSourceCache *cache)
+  {
+    UintSize count = 0;
+    ShaderKey key;
+    ShaderSource source;
+
+    for (UintSize p=0; p<getNumPermutations(); ++p)
+    {
+      if (!composePermutation( p, key, source ))
+        continue;
+
+      cache->store( source.permutation, source.compose, source.vertex, source.fragment );
+      count++;
+    }
+
+    return count;
+  }
+
+}//namespace GE
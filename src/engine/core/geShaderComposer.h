@@ -0,0 +1,49 @@
+#ifndef __GESHADERCOMPOSER_H
+#define __GESHADERCOMPOSER_H
+
+#include "util/geUtil.h"
+#include "core/geRenderer.h"
+#include "core/geShaderCache.h"
+
+namespace GE
+{
+  /*
+  --------------------------------------------
+  Forward declarations
+  --------------------------------------------*/
+
+  class VertexFormat;
+
+  /*
+  -----------------------------------------------------
+  Composes shader sources for every combination of the
+  registered geometry classes, material classes and
+  render targets without a GL context, so the source
+  cache can be filled offline. Geometry is given a mesh
+  in the vertex format the exporter writes for it.
+  -----------------------------------------------------*/
+
+  class ShaderComposer
+  {
+    ArrayList< Class > geomClasses;
+    ArrayList< Class > matClasses;
+    ArrayList< RenderTarget::Enum > targets;
+
+  public:
+    ShaderComposer ();
+
+    void clear ();
+    void addGeometryClass (Class geomClass);
+    void addMaterialClass (Class matClass);
+    void addTarget (RenderTarget::Enum target);
+    void addDefaults ();
+
+    UintSize getNumPermutations ();
+    bool composePermutation (UintSize index, ShaderKey &key, ShaderSource &source);
+    UintSize composeAll (ShaderSourceCache *cache);
+
+    static void GetVertexFormat (Class geomClass, Class matClass, VertexFormat &format);
+  };
+
+}//namespace GE
+#endif//__GESHADERCOMPOSER_H
@@ -4,6 +4,7 @@
 #include "util/geUtil.h"
 #include "math/geVectors.h"
 #include "core/geAnimation.h"
+#include "core/geAnimCompress.h"
 #include "core/geActor.h"
 #include "core/geCamera.h"
 #include "core/actors/geSkinMeshActor.h"
@@ -33,11 +34,13 @@ namespace GE
     
     virtual void onValueChanged (AnimTrack *track, Int param)
     {
-      if (ClassOf( track ) == ClassName( Vec3AnimTrack ))
-        valueT = ((Vec3AnimTrack*) track)->getValue();
+      if (ClassOf( track ) == ClassName( Vec3AnimTrack ) ||
+          ClassOf( track ) == ClassName( CompactVec3AnimTrack ))
+        track->getValue( &valueT );
       
-      else if (ClassOf( track ) == ClassName( QuatAnimTrack ))
-        valueR = ((QuatAnimTrack*) track)->getValue();
+      else if (ClassOf( track ) == ClassName( QuatAnimTrack ) ||
+               ClassOf( track ) == ClassName( CompactQuatAnimTrack ))
+        track->getValue( &valueR );
     }
 
     virtual void onAnyValueChanged ()
@@ -67,15 +70,17 @@ namespace GE
 
     virtual void onValueChanged (AnimTrack *track, Int param)
     {
-      if (ClassOf( track ) == ClassName( Vec3AnimTrack ))
+      if (ClassOf( track ) == ClassName( Vec3AnimTrack ) ||
+          ClassOf( track ) == ClassName( CompactVec3AnimTrack ))
       {
-        Vec3AnimTrack* vtrack = (Vec3AnimTrack*) track;
-        actor->setJointTranslation( param, vtrack->getValue() );
+        Vector3 t; track->getValue( &t );
+        actor->setJointTranslation( param, t );
       }
-      else if (ClassOf( track ) == ClassName( QuatAnimTrack ))
+      else if (ClassOf( track ) == ClassName( QuatAnimTrack ) ||
+               ClassOf( track ) == ClassName( CompactQuatAnimTrack ))
       {
-        QuatAnimTrack* qtrack = (QuatAnimTrack*) track;
-        actor->setJointRotation( param, qtrack->getValue() );
+        Quat r; track->getValue( &r );
+        actor->setJointRotation( param, r );
       }
     }
   };
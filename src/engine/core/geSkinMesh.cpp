@@ -3,6 +3,20 @@
 namespace GE
 {
 
+  void SPolyMesh::copyVertex (PolyMesh::Vertex *to, PolyMesh::Vertex *from)
+  {
+    PolyMesh::copyVertex( to, from );
+
+    Vertex *skinTo = (Vertex*) to;
+    Vertex *skinFrom = (Vertex*) from;
+
+    for (int i=0; i<4; ++i)
+      skinTo->boneIndex[ i ] = skinFrom->boneIndex[ i ];
+
+    for (int i=0; i<4; ++i)
+      skinTo->boneWeight[ i ] = skinFrom->boneWeight[ i ];
+  }
+
   void SkinTriMesh::fromPoly (PolyMesh *m, TexMesh *um)
   {
     binding.init( getFormat() );
@@ -25,6 +39,27 @@ namespace GE
       triVert.jointWeight[ i ] = skinVert->boneWeight[ i ];
   }
 
+  //Comes before the vertices are taken over
+  PolyMesh* SkinTriMesh::newPolyMesh ()
+  {
+    binding.init( getFormat() );
+    return new SPolyMesh;
+  }
+
+  void SkinTriMesh::vertexToPoly (VertexID vertexID, PolyMesh::Vertex *polyVert)
+  {
+    TriMesh::vertexToPoly( vertexID, polyVert );
+
+    SPolyMesh::Vertex *skinVert = (SPolyMesh::Vertex*) polyVert;
+    SkinVertex triVert = binding( getVertex( vertexID ) );
+
+    for (int i=0; i<4; ++i)
+      skinVert->boneIndex[ i ] = triVert.jointIndex[ i ];
+
+    for (int i=0; i<4; ++i)
+      skinVert->boneWeight[ i ] = triVert.jointWeight[ i ];
+  }
+
   /*
   -------------------------------------------------------------
   Algorithm that copies faces of a mesh into a sub mesh and
@@ -54,6 +54,10 @@ namespace GE
   {
     CLASS( SPolyMesh, PolyMesh,
       4b87e6ad,c85c,4863,93de87ef8577a609 );
+
+  public:
+
+    virtual void copyVertex (PolyMesh::Vertex *to, PolyMesh::Vertex *from);
   };
 
   /*
@@ -104,6 +108,9 @@ namespace GE
     virtual void vertexFromPoly (PolyMesh::Vertex *polyVert,
                                  PolyMesh::HalfEdge *polyHedge,
                                  TexMesh::Vertex *texVert);
+
+    virtual PolyMesh* newPolyMesh ();
+    virtual void vertexToPoly (VertexID vertexID, PolyMesh::Vertex *polyVert);
   };
 
   /*
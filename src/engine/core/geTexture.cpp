@@ -6,6 +6,24 @@ namespace GE
   
   Texture::Texture()
   {
+    byteSize = 0;
+    handle = 0;
+  }
+
+  Texture::~Texture()
+  {
+    if (handle != 0)
+      glDeleteTextures(1, (GLuint*)&handle);
+  }
+
+  /*
+  Textures may be deserialized on loader threads, so the GL
+  object is only created once the texture is first used on
+  the main thread. */
+
+  void Texture::create()
+  {
+    if (handle != 0) return;
     glGenTextures(1, (GLuint*)&handle);
 
     glBindTexture(GL_TEXTURE_2D, handle);
@@ -15,17 +33,24 @@ namespace GE
 		glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
   }
 
-  Texture::~Texture()
-  {
-    glDeleteTextures(1, (GLuint*)&handle);
-  }
-
   void Texture::fromData(int width, int height, enum ColorFormat format, const void *data)
   {
     this->format = format;
+    create();
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glBindTexture(GL_TEXTURE_2D, handle);
 
+    //Mipmap chain adds a third to the base level
+    UintSize numBytes = 0;
+    switch(format)
+    {
+    case COLOR_FORMAT_GRAY: numBytes = 1; break;
+    case COLOR_FORMAT_GRAY_ALPHA: numBytes = 2; break;
+    case COLOR_FORMAT_RGB: numBytes = 3; break;
+    case COLOR_FORMAT_RGB_ALPHA: numBytes = 4; break;
+    }
+    byteSize = (UintSize) width * (UintSize) height * numBytes * 4 / 3;
+
     switch(format)
     {
     case COLOR_FORMAT_GRAY:
@@ -62,6 +87,7 @@ namespace GE
   void Texture::updateRegion(int offX, int offY, int width, int height, ColorFormat format, const void *data)
   {
     this->format = format;
+    create();
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
     glBindTexture(GL_TEXTURE_2D, handle);
 
@@ -92,6 +118,7 @@ namespace GE
 
   Uint32 Texture::getHandle()
   {
+    create();
     return handle;
   }
   
@@ -100,4 +127,9 @@ namespace GE
     return format;
   }
 
+  UintSize Texture::getByteSize()
+  {
+    return sizeof( Texture ) + byteSize;
+  }
+
 }/* namespace GE */
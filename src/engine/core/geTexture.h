@@ -20,6 +20,9 @@ namespace GE
 
     Uint32 handle;
     ColorFormat format;
+    UintSize byteSize;
+
+    void create();
 
   public:
     Texture();
@@ -27,6 +30,7 @@ namespace GE
 
     Uint32 getHandle();
     ColorFormat getFormat();
+    virtual UintSize getByteSize();
 
     void fromData(int width, int height, ColorFormat format, const void *data);
     void fromImage(const Image *img);
@@ -1,4 +1,6 @@
 #include "geTriMesh.h"
+#include "geMeshSimplify.h"
+#include "geMeshOptimize.h"
 #include "geGLHeaders.h"
 
 namespace GE
@@ -306,6 +308,33 @@ namespace GE
     TexMesh::Vertex *texVertex;
     VertexID vertexID;
   };
+
+  /*
+  Vertex variant already output, indexed by vertex ID. */
+
+  struct UniqueVariant
+  {
+    PolyMesh::HalfEdge *hedge;
+    Uint64 hash;
+  };
+
+  /*
+  Variants are only ever matched within one polygon vertex,
+  so the table holds those of the current vertex alone.
+  Slots stamped with an earlier vertex count as empty,
+  which saves clearing the table between vertices. */
+
+  struct UniqueSlot
+  {
+    Uint32 stamp;
+    VertexID vertexID;
+  };
+
+  static Uint64 MixHash (Uint64 h, Uint64 value)
+  {
+    h = (h ^ value) * 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 32);
+  }
   
   void TriMesh::fromPoly (PolyMesh *m, TexMesh *um)
   {
@@ -319,33 +348,64 @@ namespace GE
     indices.clear();
     binding.init( &format );
 
-    //Allocate structures for vert-per-face unique data
-    //and store texture vertex pointers
+    //Vert-per-face unique data in a single block, storing
+    //texture vertex pointers. Every corner has a half-edge.
+    UintSize numCorners = (UintSize) m->hedgeCount();
+    ArrayList< UniqueData > unique( numCorners );
+    unique.resize( numCorners );
+    UintSize c = 0;
+
     for (f.begin(m), uf.begin(um); !f.end(); ++f, ++uf) {
       for (fv.begin(*f), ufv.begin(*uf); !fv.end(); ++fv, ++ufv) {
-        UniqueData *fvd = new UniqueData;
+        UniqueData *fvd = &unique[ c++ ];
         fvd->vertexID = 0;
         fvd->texVertex = *ufv;
         fv.hedgeToVertex()->tag.ptr = fvd;
       }}
 
+    //Hash table of the variants of a vertex, at most half full
+    ArrayList< UniqueSlot > slots;
+    ArrayList< UniqueVariant > variants( numCorners );
+    UintSize mask = 0;
+    Uint32 stamp = 0;
+
     //Walk all the vertices of the mesh
     for (PolyMesh::VertIter v(m); !v.end(); ++v)
     {
+      VertexID firstVertexID = nextVertexID;
+      stamp++;
+
       //Walk adjacent faces and output unique vertex variants
       for (PolyMesh::VertFaceIter vf(*v); !vf.end(); ++vf) {
         PolyMesh::HalfEdge *vfh = vf.hedgeToVertex();
         UniqueData *vfd = (UniqueData*) vfh->tag.ptr;
+        Uint64 hash = hashPolyVertex( *v, vfh );
+
+        //Grow the table once a vertex has many variants
+        if ((nextVertexID - firstVertexID + 1) * 2 > slots.size()) {
+          UintSize capacity = Util::Max( slots.size() * 2, (UintSize) 16 );
+          slots.clear();
+          slots.resize( capacity );
+          for (UintSize s=0; s<capacity; ++s)
+            slots[ s ].stamp = 0;
+
+          mask = capacity - 1;
+          for (VertexID id=firstVertexID; id<nextVertexID; ++id) {
+            UintSize s = (UintSize) variants[ id ].hash & mask;
+            while (slots[ s ].stamp == stamp) s = (s + 1) & mask;
+            slots[ s ].stamp = stamp;
+            slots[ s ].vertexID = id; }
+        }
         
-        //Walk existing vertex variants
+        //Probe existing vertex variants with the same hash
         bool existingFound = false;
-        for (PolyMesh::VertFaceIter vf2(*v); vf2 != vf; ++vf2) {
-          PolyMesh::HalfEdge *vfh2 = vf2.hedgeToVertex();
-          UniqueData *vfd2 = (UniqueData*) vfh2->tag.ptr;
+        UintSize s = (UintSize) hash & mask;
+        for (; slots[ s ].stamp == stamp; s = (s + 1) & mask) {
+          const UniqueVariant &variant = variants[ slots[ s ].vertexID ];
 
           //Check for match and assign existing vertex ID
-          if (isPolyVertexEqual( *v, vfh, vfh2)) {
-            vfd->vertexID = vfd2->vertexID;
+          if (variant.hash == hash && isPolyVertexEqual( *v, vfh, variant.hedge )) {
+            vfd->vertexID = slots[ s ].vertexID;
             existingFound = true;
             break;
           }
@@ -355,6 +415,11 @@ namespace GE
         if (!existingFound) {
           vertexFromPoly (*v, vfh, vfd->texVertex);
           vfd->vertexID = nextVertexID++;
+
+          UniqueVariant variant = { vfh, hash };
+          variants.pushBack( variant );
+          slots[ s ].stamp = stamp;
+          slots[ s ].vertexID = vfd->vertexID;
         }
       }//Walk adjacent faces
     }//Walk all vertices
@@ -371,11 +436,20 @@ namespace GE
       for (PolyMesh::MaterialFaceIter mf( m, *mid ); !mf.end(); ++mf)
         faceFromPoly( *mf );
     }
+  }
 
-    //Deallocate vert-per-face unique data
-    for (f.begin(m); !f.end(); ++f)
-      for (fv.begin(*f); !fv.end(); ++fv)
-        delete fv.hedgeToVertex()->tag.ptr;
+  /*
+  Corners equal by isPolyVertexEqual must hash the same. */
+
+  Uint64 TriMesh::hashPolyVertex (PolyMesh::Vertex *polyVert,
+                                  PolyMesh::HalfEdge *polyHedge)
+  {
+    Uint64 h = 0;
+    h = MixHash( h, (Uint64) (UintSize) polyVert );
+    h = MixHash( h, (Uint64) (UintSize) ((UniqueData*)polyHedge->tag.ptr)->texVertex );
+    h = MixHash( h, (Uint64) polyHedge->parentFace()->materialID() );
+    h = MixHash( h, (Uint64) (UintSize) polyHedge->vertexNormal() );
+    return h;
   }
 
   bool TriMesh::isPolyVertexEqual (PolyMesh::Vertex *polyVert,
@@ -411,7 +485,7 @@ namespace GE
   {
     TriVertex vert = binding( addVertex() );
     
-    if (texVert != NULL)
+    if (texVert != NULL && vert.texcoord != NULL)
       *vert.texcoord = texVert->point;
     
     *vert.normal = polyHedge->vertexNormal()->coord;
@@ -468,6 +542,34 @@ namespace GE
     return groups[ group ].count / 3;
   }
 
+  TriMesh::~TriMesh ()
+  {
+    if (isOnGpu)
+    {
+      glDeleteBuffers( 1, &dataVBO );
+      glDeleteBuffers( 1, &indexVBO );
+    }
+
+    clearLods();
+  }
+
+  /*
+  Arrays borrowed from a package count too, the mapping
+  stays for as long as the mesh. */
+
+  UintSize TriMesh::getByteSize ()
+  {
+    UintSize size = sizeof( TriMesh ) +
+      data.size() * data.elementSize() +
+      indices.size() * sizeof( VertexID ) +
+      groups.size() * sizeof( IndexGroup );
+
+    for (UintSize l=0; l<lods.size(); ++l)
+      size += lods[ l ]->getByteSize();
+
+    return size;
+  }
+
   void TriMesh::sendToGpu ()
   {
     if (!isOnGpu)
@@ -486,6 +588,9 @@ namespace GE
     glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
 
     isOnGpu = true;
+
+    for (UintSize l=0; l<lods.size(); ++l)
+      lods[ l ]->sendToGpu();
   }
 
   void TriMesh::updateBoundingBox()
@@ -515,6 +620,281 @@ namespace GE
     return bbox;
   }
 
+  /*
+  ----------------------------------------------------
+  Drawing order
+  ----------------------------------------------------*/
+
+  void TriMesh::optimize (bool overdraw)
+  {
+    //Meshes mapped from a package stay as they were saved
+    if (data.isBorrowed() || indices.isBorrowed())
+      return;
+
+    ArrayList< Vector3 > points;
+    if (overdraw)
+    {
+      VertexBinding <TriVertex> vertBind;
+      vertBind.init( &format );
+
+      for (UintSize v=0; v<getVertexCount(); ++v)
+      {
+        TriVertex vert = vertBind( getVertex( v ) );
+        if (vert.coord == NULL) { overdraw = false; break; }
+        points.pushBack( *vert.coord );
+      }
+    }
+
+    MeshOptimizer optimizer;
+    for (UintSize g=0; g<groups.size(); ++g)
+    {
+      VertexID *groupIndices = indices.buffer() + groups[ g ].start;
+      optimizer.optimizeCache( groupIndices, groups[ g ].count, getVertexCount() );
+      if (overdraw)
+        optimizer.optimizeOverdraw( groupIndices, groups[ g ].count, points );
+    }
+
+    optimizeFetch();
+  }
+
+  /*
+  Vertices no face uses are moved to the end. */
+
+  void TriMesh::optimizeFetch ()
+  {
+    if (data.isBorrowed() || indices.isBorrowed())
+      return;
+
+    UintSize numVerts = getVertexCount();
+    ArrayList< VertexID > remap;
+    remap.resize( numVerts );
+    for (UintSize v=0; v<numVerts; ++v)
+      remap[ v ] = (VertexID) numVerts;
+
+    VertexID next = 0;
+    for (UintSize i=0; i<indices.size(); ++i)
+    {
+      VertexID v = indices[ i ];
+      if (remap[ v ] == numVerts) remap[ v ] = next++;
+      indices[ i ] = remap[ v ];
+    }
+
+    for (UintSize v=0; v<numVerts; ++v)
+      if (remap[ v ] == numVerts) remap[ v ] = next++;
+
+    //Move the vertex data over from a copy
+    GenericArrayList oldData( data );
+    UintSize size = data.elementSize();
+    for (UintSize v=0; v<numVerts; ++v)
+      std::memcpy( data[ remap[ v ]], oldData[ v ], size );
+  }
+
+  /*
+  ----------------------------------------------------
+  Levels of detail
+  ----------------------------------------------------*/
+
+  /*
+  The levels are made by continuing to collapse the same
+  meshes, so the error of each is measured against the
+  original. Levels are instances of the class of this mesh
+  and go through its fromPoly. Stops early once a level
+  can't lose a tenth of the faces of the previous one
+  within the largest error allowed. */
+
+  void TriMesh::buildLods (PolyMesh *m, TexMesh *uv, UintSize numLods, Float ratio,
+                           SmoothMetric::Enum metric, ThreadPool *pool)
+  {
+    clearLods();
+
+    //Levels can't carry tangents, fromPoly doesn't make them
+    if (format.findMember( ShaderData::Tangent, "" ) != NULL)
+      return;
+
+    SimplifyOptions options;
+    options.metric = metric;
+    MeshSimplifier simplifier;
+    if (!simplifier.begin( m, uv, options ))
+      return;
+
+    Float maxError = simplifier.getSize() * GE_TRIMESH_LOD_MAX_ERROR;
+    UintSize numFaces = (UintSize) simplifier.getMesh()->faceCount();
+    for (UintSize l=0; l<numLods; ++l)
+    {
+      UintSize target = (UintSize) ((Float) numFaces * ratio);
+      UintSize left = simplifier.collapse( target, maxError );
+      if (left == 0 || left > numFaces - numFaces / 10)
+        break;
+
+      numFaces = left;
+      simplifier.updateTexMesh();
+      PolyMesh *lodMesh = simplifier.getMesh();
+      lodMesh->triangulate();
+      lodMesh->updateNormals( metric, pool );
+
+      TriMesh *lod = (TriMesh*) ClassOf( this )->instantiate();
+      lod->setFormat( format );
+      lod->fromPoly( lodMesh, simplifier.getTexMesh() );
+      lod->updateBoundingBox();
+      lod->optimize();
+      lod->lodError = simplifier.getError();
+      lods.pushBack( lod );
+    }
+
+    simplifier.end();
+  }
+
+  /*
+  Orders vertex data by position and texture coordinate
+  to weld the corners of a TriMesh. */
+
+  struct WeldKey
+  {
+    Vector3 coord;
+    Vector2 texcoord;
+
+    bool operator< (const WeldKey &k) const
+    {
+      if (coord.x != k.coord.x) return coord.x < k.coord.x;
+      if (coord.y != k.coord.y) return coord.y < k.coord.y;
+      if (coord.z != k.coord.z) return coord.z < k.coord.z;
+      if (texcoord.x != k.texcoord.x) return texcoord.x < k.texcoord.x;
+      return texcoord.y < k.texcoord.y;
+    }
+  };
+
+  typedef std::map< WeldKey, void* > WeldMap;
+  typedef WeldMap::iterator WeldIter;
+
+  PolyMesh* TriMesh::newPolyMesh ()
+  {
+    return new PolyMesh;
+  }
+
+  void TriMesh::vertexToPoly (VertexID vertexID, PolyMesh::Vertex *polyVert)
+  {
+    polyVert->point = *binding( getVertex( vertexID )).coord;
+  }
+
+  /*
+  Triangles whose corners weld together or that would
+  make the PolyMesh non-manifold are left out of the
+  levels. Every half-edge keeps the vertex of this mesh
+  at its corner in the tag, to compare the normals on
+  both sides of an edge. */
+
+  void TriMesh::buildLods (UintSize numLods, Float ratio, ThreadPool *pool)
+  {
+    clearLods();
+
+    UintSize numVerts = getVertexCount();
+    if (numVerts == 0 || indices.empty()) return;
+    binding.init( &format );
+
+    TriVertex first = binding( getVertex( 0 ));
+    if (first.coord == NULL) return;
+    bool hasTexcoords = (first.texcoord != NULL);
+    bool hasNormals = (first.normal != NULL);
+
+    PolyMesh *polyMesh = newPolyMesh();
+    TexMesh *texMesh = new TexMesh;
+    ArrayList< PolyMesh::Vertex* > polyVerts( numVerts );
+    ArrayList< TexMesh::Vertex* > texVerts( numVerts );
+    ArrayList< Vector3 > normals( numVerts );
+    WeldMap polyWeld, texWeld;
+
+    for (UintSize v=0; v<numVerts; ++v)
+    {
+      TriVertex vert = binding( getVertex( v ));
+      WeldKey key;
+      key.coord = *vert.coord;
+      key.texcoord.set( 0.0f, 0.0f );
+      normals.pushBack( hasNormals ? *vert.normal : Vector3( 0.0f, 0.0f, 0.0f ));
+
+      WeldIter w = polyWeld.find( key );
+      if (w == polyWeld.end()) {
+        PolyMesh::Vertex *polyVert = polyMesh->addVertex();
+        vertexToPoly( (VertexID) v, polyVert );
+        w = polyWeld.insert( WeldMap::value_type( key, polyVert )).first; }
+      polyVerts.pushBack( (PolyMesh::Vertex*) w->second );
+
+      if (hasTexcoords) key.texcoord = *vert.texcoord;
+      w = texWeld.find( key );
+      if (w == texWeld.end()) {
+        TexMesh::Vertex *texVert = texMesh->addVertex();
+        texVert->point = key.texcoord;
+        w = texWeld.insert( WeldMap::value_type( key, texVert )).first; }
+      texVerts.pushBack( (TexMesh::Vertex*) w->second );
+    }
+
+    for (UintSize g=0; g<groups.size(); ++g)
+    {
+      IndexGroup &grp = groups[ g ];
+      for (UintSize c=0; c+2<grp.count; c+=3)
+      {
+        VertexID *id = indices.buffer() + grp.start + c;
+        PolyMesh::Vertex *corners[3];
+        TexMesh::Vertex *texCorners[3];
+        for (int k=0; k<3; ++k) {
+          corners[k] = polyVerts[ id[k] ];
+          texCorners[k] = texVerts[ id[k] ]; }
+
+        if (corners[0] == corners[1] || corners[1] == corners[2] || corners[2] == corners[0])
+          continue;
+
+        PolyMesh::Face *face = polyMesh->addFace( corners, 3 );
+        if (face == NULL) continue;
+        texMesh->addFace( texCorners, 3 );
+        polyMesh->setMaterialID( face, grp.materialID );
+
+        for (int k=0; k<3; ++k)
+          face->hedgeTo( corners[k] )->tag.id = (int) id[k];
+      }
+    }
+
+    //Hard where either end has a different normal on each side
+    for (PolyMesh::EdgeIter e( polyMesh ); !e.end(); ++e)
+    {
+      HMesh::HalfEdge *h1 = e->hedge1();
+      HMesh::HalfEdge *h2 = e->hedge2();
+      if (h1->face == NULL || h2->face == NULL) {
+        e->isSmooth = true;
+        continue; }
+
+      e->isSmooth =
+        normals[ h1->tag.id ] == normals[ h2->prev->tag.id ] &&
+        normals[ h2->tag.id ] == normals[ h1->prev->tag.id ];
+    }
+
+    polyMesh->triangulate();
+    buildLods( polyMesh, texMesh, numLods, ratio, SmoothMetric::Edge, pool );
+
+    delete polyMesh;
+    delete texMesh;
+  }
+
+  void TriMesh::clearLods ()
+  {
+    for (UintSize l=0; l<lods.size(); ++l)
+      delete lods[ l ];
+
+    lods.clear();
+  }
+
+  UintSize TriMesh::getLodCount ()
+  {
+    return lods.size();
+  }
+
+  TriMesh* TriMesh::getLod (Float maxError)
+  {
+    for (UintSize l=lods.size(); l>0; --l)
+      if (lods[ l-1 ]->lodError <= maxError)
+        return lods[ l-1 ];
+
+    return this;
+  }
+
   /*
   ----------------------------------------------------
   Copies a part of the mesh to another mesh
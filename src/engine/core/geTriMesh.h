@@ -12,6 +12,12 @@
 #pragma warning(push)
 #pragma warning(disable:4251)
 
+//Levels of detail stop at an error of this part of the mesh size
+#define GE_TRIMESH_LOD_MAX_ERROR 0.05f
+
+//Levels of detail built for meshes on import and load
+#define GE_TRIMESH_NUM_LODS 4
+
 namespace GE
 {
   /*
@@ -193,7 +199,16 @@ namespace GE
         s->dataArray( &groups );
         s->data( &bbox );
       }
+
+      //Levels of detail came with version 2
+      if (v >= 2)
+      {
+        s->objectPtrArray( &lods );
+        s->data( &lodError );
+      }
     }
+
+    virtual Uint version () { return 2; }
    
   public:
 
@@ -217,6 +232,11 @@ namespace GE
     Uint32 indexVBO;
     bool isOnGpu;
 
+    //Coarser levels of detail, each with the geometric error
+    //in mesh units it was simplified with
+    ArrayList <TriMesh*> lods;
+    Float lodError;
+
     
   protected:
 
@@ -227,6 +247,11 @@ namespace GE
       PolyMesh::Vertex *polyVert,
       PolyMesh::HalfEdge *polyHedge1,
       PolyMesh::HalfEdge *polyHedge2 );
+
+    //Must cover whatever isPolyVertexEqual compares
+    virtual Uint64 hashPolyVertex (
+      PolyMesh::Vertex *polyVert,
+      PolyMesh::HalfEdge *polyHedge );
     
     virtual void vertexFromPoly (
       PolyMesh::Vertex *polyVert,
@@ -235,14 +260,23 @@ namespace GE
     
     virtual void faceFromPoly (
       PolyMesh::Face *polyFace );
+
+    //The way back, for building levels of detail from the mesh data
+    virtual PolyMesh* newPolyMesh ();
+
+    virtual void vertexToPoly (
+      VertexID vertexID,
+      PolyMesh::Vertex *polyVert );
     
   public:
     
     TriMesh (const VertexFormat &f) : data(f.getByteSize())
-    { isOnGpu = false; setFormat( f ); }
+    { isOnGpu = false; lodError = 0.0f; setFormat( f ); }
     
     TriMesh () : data(sizeof(Uint8))
-    { isOnGpu = false; setDefaultFormat(); }
+    { isOnGpu = false; lodError = 0.0f; setDefaultFormat(); }
+
+    virtual ~TriMesh ();
 
     void setDefaultFormat();
     void setFormat( const VertexFormat &f);
@@ -264,7 +298,31 @@ namespace GE
     void updateBoundingBox();
     BoundingBox getBoundingBox();
 
+    //Reorders the faces of every group for the vertex cache,
+    //optionally in clusters drawn outside in against overdraw,
+    //then the vertices in the order they are first used.
+    //Run before sending to the GPU, levels of detail aren't touched
+    void optimize (bool overdraw = false);
+    void optimizeFetch ();
+
+    //Simplifies a copy of the meshes this one was made from,
+    //every level keeps about [ratio] of the faces of the previous.
+    //Normals of the levels are computed on [pool] if given
+    void buildLods (PolyMesh *m, TexMesh *uv, UintSize numLods, Float ratio = 0.5f,
+                    SmoothMetric::Enum metric = SmoothMetric::None, ThreadPool *pool = NULL);
+
+    //Same from the mesh data itself, for meshes that weren't made
+    //from a PolyMesh. Corners are welded by position and edges
+    //between differing normals are kept hard
+    void buildLods (UintSize numLods, Float ratio = 0.5f, ThreadPool *pool = NULL);
+    void clearLods ();
+    UintSize getLodCount ();
+
+    //Coarsest level with an error of at most [maxError], or this mesh
+    TriMesh* getLod (Float maxError);
+
     void sendToGpu ();
+    virtual UintSize getByteSize ();
   };
 
   /*
@@ -58,7 +58,7 @@ namespace GE
   Statics
   ----------------------------*/
    
-  int Image::ClassCount = 0;
+  volatile Int Image::ClassCount = 0;
   bool Image::LittleEndian = false;
   ArrayList<ImageDecoder*> *Image::Decoders = NULL;
   ArrayList<ImageEncoder*> *Image::Encoders = NULL;
@@ -71,7 +71,7 @@ namespace GE
   Image::Image()
   {
     //Initialize the static part of the class
-    if (++Image::ClassCount == 1) {
+    if (Atomic::Increment( &Image::ClassCount ) == 1) {
       
       //Find endianness
       int testEndian = 1;
@@ -99,7 +99,7 @@ namespace GE
   Image::~Image()
   {
     //Destroy the static part of the class
-    if (--Image::ClassCount == 0) {
+    if (Atomic::Decrement( &Image::ClassCount ) == 0) {
 
       for (UintSize d=0; d<Image::Decoders->size(); ++d)
         delete Image::Decoders->elementAt(d);
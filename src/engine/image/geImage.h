@@ -92,7 +92,7 @@ namespace GE
     
   private:
     
-    static int ClassCount;
+    static volatile Int ClassCount;
     static bool LittleEndian;
     static ArrayList<ImageDecoder*> *Decoders;
     static ArrayList<ImageEncoder*> *Encoders;
@@ -0,0 +1,109 @@
+#include "io/geFileMap.h"
+
+#if !defined(WIN32)
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+namespace GE
+{
+  FileMap::FileMap ()
+  {
+    data = NULL;
+    size = 0;
+
+    #if defined(WIN32)
+    file = INVALID_HANDLE_VALUE;
+    mapping = NULL;
+    #else
+    file = -1;
+    #endif
+  }
+
+  FileMap::~FileMap ()
+  {
+    close();
+  }
+
+  /*
+  Takes the native path name as returned by File. Empty
+  files can't be mapped and fail like missing ones. */
+
+  bool FileMap::open (const CharString &pathName)
+  {
+    close();
+
+    #if defined(WIN32)
+
+    CharString longpath = "\\\\?\\" + pathName;
+    file = CreateFile( longpath.buffer(), GENERIC_READ, FILE_SHARE_READ,
+                       NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL );
+    if (file == INVALID_HANDLE_VALUE)
+      return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx( file, &fileSize ) || fileSize.QuadPart == 0) {
+      close();
+      return false; }
+
+    mapping = CreateFileMapping( file, NULL, PAGE_WRITECOPY, 0, 0, NULL );
+    if (mapping == NULL) {
+      close();
+      return false; }
+
+    data = (Uint8*) MapViewOfFile( mapping, FILE_MAP_COPY, 0, 0, 0 );
+    if (data == NULL) {
+      close();
+      return false; }
+
+    size = (UintSize) fileSize.QuadPart;
+
+    #else
+
+    file = ::open( pathName.buffer(), O_RDONLY );
+    if (file == -1)
+      return false;
+
+    struct stat fs;
+    if (fstat( file, &fs ) != 0 || fs.st_size == 0) {
+      close();
+      return false; }
+
+    void *view = mmap( NULL, (size_t) fs.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0 );
+    if (view == MAP_FAILED) {
+      close();
+      return false; }
+
+    data = (Uint8*) view;
+    size = (UintSize) fs.st_size;
+
+    #endif
+
+    return true;
+  }
+
+  void FileMap::close ()
+  {
+    #if defined(WIN32)
+
+    if (data != NULL) UnmapViewOfFile( data );
+    if (mapping != NULL) CloseHandle( mapping );
+    if (file != INVALID_HANDLE_VALUE) CloseHandle( file );
+    mapping = NULL;
+    file = INVALID_HANDLE_VALUE;
+
+    #else
+
+    if (data != NULL) munmap( data, size );
+    if (file != -1) ::close( file );
+    file = -1;
+
+    #endif
+
+    data = NULL;
+    size = 0;
+  }
+
+}//namespace GE
@@ -0,0 +1,45 @@
+#ifndef __GEFILEMAP_H
+#define __GEFILEMAP_H
+
+#include "util/geUtil.h"
+
+namespace GE
+{
+  /*
+  ----------------------------------------------------
+  Read-only view of a whole file mapped into memory.
+  Pages are copy-on-write, so data used in place can
+  still be modified without touching the file.
+  ----------------------------------------------------*/
+
+  class FileMap
+  {
+  private:
+    Uint8 *data;
+    UintSize size;
+
+  #if defined(WIN32)
+    HANDLE file;
+    HANDLE mapping;
+  #else
+    int file;
+  #endif
+
+    //No copies of the mapping
+    FileMap (const FileMap &m) {}
+    FileMap& operator= (const FileMap &m) { return *this; }
+
+  public:
+    FileMap ();
+    ~FileMap ();
+
+    bool open (const CharString &pathName);
+    void close ();
+
+    bool isOpen () const { return data != NULL; }
+    Uint8* getData () const { return data; }
+    UintSize getSize () const { return size; }
+  };
+
+}//namespace GE
+#endif//__GEFILEMAP_H
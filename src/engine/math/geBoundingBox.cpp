@@ -55,4 +55,27 @@ namespace GE
     corners[6].set( max.x, max.y, min.z );
     corners[7].set( max.x, max.y, max.z );
   }
+
+  /*
+  Returns the box enclosing this one after transformation
+  by the given affine matrix. Extents are projected onto
+  the absolute matrix axes instead of transforming all of
+  the corners. */
+
+  BoundingBox BoundingBox::transform (const Matrix4x4 &m) const
+  {
+    Vector3 c = (min + max) * 0.5f;
+    Vector3 e = (max - min) * 0.5f;
+    Vector3 wc = m * c;
+
+    Vector3 we(
+      fabsf( m.m[0][0] ) * e.x + fabsf( m.m[1][0] ) * e.y + fabsf( m.m[2][0] ) * e.z,
+      fabsf( m.m[0][1] ) * e.x + fabsf( m.m[1][1] ) * e.y + fabsf( m.m[2][1] ) * e.z,
+      fabsf( m.m[0][2] ) * e.x + fabsf( m.m[1][2] ) * e.y + fabsf( m.m[2][2] ) * e.z );
+
+    BoundingBox out;
+    out.min = wc - we;
+    out.max = wc + we;
+    return out;
+  }
 }
@@ -25,6 +25,7 @@ namespace GE
     BoundingBox& operator += (const Vector3 &vert);
     BoundingBox& operator += (const BoundingBox &bbox);
     void getCorners (Vector3 *corners);
+    BoundingBox transform (const Matrix4x4 &m) const;
   };
 
 
@@ -0,0 +1,594 @@
+#include "math/geBoxTree.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#  define GE_BOXTREE_SSE
+#  include <xmmintrin.h>
+#endif
+
+namespace GE
+{
+  /*
+  -----------------------------------------------------
+  Queries
+  -----------------------------------------------------*/
+
+  RangeQuery::RangeQuery (const Vector3 &min, const Vector3 &max)
+  {
+    this->min = min;
+    this->max = max;
+  }
+
+  BoxQuery::Result RangeQuery::test (const Vector3 &c, const Vector3 &e) const
+  {
+    if (c.x + e.x < min.x || c.x - e.x > max.x) return Outside;
+    if (c.y + e.y < min.y || c.y - e.y > max.y) return Outside;
+    if (c.z + e.z < min.z || c.z - e.z > max.z) return Outside;
+
+    if (c.x - e.x >= min.x && c.x + e.x <= max.x &&
+        c.y - e.y >= min.y && c.y + e.y <= max.y &&
+        c.z - e.z >= min.z && c.z + e.z <= max.z)
+      return Inside;
+
+    return Intersect;
+  }
+
+  SphereQuery::SphereQuery (const Vector3 &center, Float radius)
+  {
+    this->center = center;
+    this->radius = radius;
+  }
+
+  BoxQuery::Result SphereQuery::test (const Vector3 &c, const Vector3 &e) const
+  {
+    Float dx = fabsf( center.x - c.x );
+    Float dy = fabsf( center.y - c.y );
+    Float dz = fabsf( center.z - c.z );
+    Float r2 = radius * radius;
+
+    //Distance to the nearest point of the box
+    Float nx = Util::Max( dx - e.x, 0.0f );
+    Float ny = Util::Max( dy - e.y, 0.0f );
+    Float nz = Util::Max( dz - e.z, 0.0f );
+    if (nx*nx + ny*ny + nz*nz > r2)
+      return Outside;
+
+    //Distance to the farthest corner of the box
+    Float fx = dx + e.x;
+    Float fy = dy + e.y;
+    Float fz = dz + e.z;
+    if (fx*fx + fy*fy + fz*fz <= r2)
+      return Inside;
+
+    return Intersect;
+  }
+
+  /*
+  Ray from the origin along the direction, up to the
+  given distance measured in lengths of the direction. */
+
+  RayQuery::RayQuery (const Vector3 &origin, const Vector3 &dir, Float maxDist)
+  {
+    this->origin = origin;
+    this->maxDist = maxDist;
+
+    //Avoid infinities for the axis-parallel rays
+    invDir.x = (fabsf( dir.x ) > 1e-20f) ? 1.0f / dir.x : 1e20f;
+    invDir.y = (fabsf( dir.y ) > 1e-20f) ? 1.0f / dir.y : 1e20f;
+    invDir.z = (fabsf( dir.z ) > 1e-20f) ? 1.0f / dir.z : 1e20f;
+  }
+
+  BoxQuery::Result RayQuery::test (const Vector3 &c, const Vector3 &e) const
+  {
+    //Intersect the ray with the slabs of the box
+    Float tx1 = (c.x - e.x - origin.x) * invDir.x;
+    Float tx2 = (c.x + e.x - origin.x) * invDir.x;
+    Float ty1 = (c.y - e.y - origin.y) * invDir.y;
+    Float ty2 = (c.y + e.y - origin.y) * invDir.y;
+    Float tz1 = (c.z - e.z - origin.z) * invDir.z;
+    Float tz2 = (c.z + e.z - origin.z) * invDir.z;
+
+    Float tmin = Util::Max( Util::Max( Util::Min( tx1, tx2 ), Util::Min( ty1, ty2 )), Util::Min( tz1, tz2 ));
+    Float tmax = Util::Min( Util::Min( Util::Max( tx1, tx2 ), Util::Max( ty1, ty2 )), Util::Max( tz1, tz2 ));
+
+    if (tmax < Util::Max( tmin, 0.0f ) || tmin > maxDist)
+      return Outside;
+
+    return Intersect;
+  }
+
+  FrustumQuery::FrustumQuery (const Frustum &f) : frustum( f )
+  {}
+
+  BoxQuery::Result FrustumQuery::test (const Vector3 &c, const Vector3 &e) const
+  {
+    switch (frustum.testCenterExtent( c, e )) {
+    case Frustum::Outside: return Outside;
+    case Frustum::Inside: return Inside;
+    default: return Intersect; }
+  }
+
+  /*
+  -----------------------------------------------------
+  BoxArray
+  -----------------------------------------------------*/
+
+  void BoxArray::clear ()
+  {
+    cx.clear(); cy.clear(); cz.clear();
+    ex.clear(); ey.clear(); ez.clear();
+  }
+
+  UintSize BoxArray::size () const
+  {
+    return cx.size();
+  }
+
+  UintSize BoxArray::add (const Vector3 &min, const Vector3 &max)
+  {
+    cx.pushBack( 0.0f ); cy.pushBack( 0.0f ); cz.pushBack( 0.0f );
+    ex.pushBack( 0.0f ); ey.pushBack( 0.0f ); ez.pushBack( 0.0f );
+
+    UintSize index = cx.size() - 1;
+    set( index, min, max );
+    return index;
+  }
+
+  void BoxArray::set (UintSize i, const Vector3 &min, const Vector3 &max)
+  {
+    cx[i] = (min.x + max.x) * 0.5f;
+    cy[i] = (min.y + max.y) * 0.5f;
+    cz[i] = (min.z + max.z) * 0.5f;
+
+    ex[i] = (max.x - min.x) * 0.5f;
+    ey[i] = (max.y - min.y) * 0.5f;
+    ez[i] = (max.z - min.z) * 0.5f;
+  }
+
+  Vector3 BoxArray::getCenter (UintSize i) const
+  {
+    return Vector3( cx[i], cy[i], cz[i] );
+  }
+
+  Vector3 BoxArray::getExtent (UintSize i) const
+  {
+    return Vector3( ex[i], ey[i], ez[i] );
+  }
+
+  void BoxArray::cullFrustum (const Frustum &f, UintSize first, UintSize count,
+                              Uint8 *outVisible, Uint planeMask) const
+  {
+    const Float *pcx = cx.buffer() + first;
+    const Float *pcy = cy.buffer() + first;
+    const Float *pcz = cz.buffer() + first;
+    const Float *pex = ex.buffer() + first;
+    const Float *pey = ey.buffer() + first;
+    const Float *pez = ez.buffer() + first;
+
+    //Gather the planes that need testing
+    Vector4 planes[6], absPlanes[6];
+    Uint numPlanes = 0;
+    for (int p=0; p<6; ++p)
+    {
+      if ((planeMask & (1 << p)) == 0) continue;
+      const Vector4 &pl = f.planes[p];
+      planes[ numPlanes ] = pl;
+      absPlanes[ numPlanes ].set( fabsf( pl.x ), fabsf( pl.y ), fabsf( pl.z ), 0.0f );
+      numPlanes++;
+    }
+
+    UintSize i = 0;
+
+    #if defined(GE_BOXTREE_SSE)
+
+    //Broadcast plane coefficients once
+    __m128 nx[6], ny[6], nz[6], nw[6];
+    __m128 ax[6], ay[6], az[6];
+    for (Uint p=0; p<numPlanes; ++p)
+    {
+      nx[p] = _mm_set1_ps( planes[p].x );
+      ny[p] = _mm_set1_ps( planes[p].y );
+      nz[p] = _mm_set1_ps( planes[p].z );
+      nw[p] = _mm_set1_ps( planes[p].w );
+      ax[p] = _mm_set1_ps( absPlanes[p].x );
+      ay[p] = _mm_set1_ps( absPlanes[p].y );
+      az[p] = _mm_set1_ps( absPlanes[p].z );
+    }
+
+    //Test four boxes at a time
+    __m128 zero = _mm_setzero_ps();
+    for (; i+4 <= count; i+=4)
+    {
+      __m128 bcx = _mm_loadu_ps( pcx + i );
+      __m128 bcy = _mm_loadu_ps( pcy + i );
+      __m128 bcz = _mm_loadu_ps( pcz + i );
+      __m128 bex = _mm_loadu_ps( pex + i );
+      __m128 bey = _mm_loadu_ps( pey + i );
+      __m128 bez = _mm_loadu_ps( pez + i );
+      __m128 outside = zero;
+
+      for (Uint p=0; p<numPlanes; ++p)
+      {
+        //d = n.c + w, r = |n|.e, outside if d + r <= 0
+        __m128 d = _mm_add_ps( _mm_add_ps(
+          _mm_mul_ps( bcx, nx[p] ), _mm_mul_ps( bcy, ny[p] )), _mm_add_ps(
+          _mm_mul_ps( bcz, nz[p] ), nw[p] ));
+        __m128 r = _mm_add_ps( _mm_add_ps(
+          _mm_mul_ps( bex, ax[p] ), _mm_mul_ps( bey, ay[p] )),
+          _mm_mul_ps( bez, az[p] ));
+        outside = _mm_or_ps( outside, _mm_cmple_ps( _mm_add_ps( d, r ), zero ));
+      }
+
+      int bits = _mm_movemask_ps( outside );
+      outVisible[ i+0 ] = (bits & 1) ? 0 : 1;
+      outVisible[ i+1 ] = (bits & 2) ? 0 : 1;
+      outVisible[ i+2 ] = (bits & 4) ? 0 : 1;
+      outVisible[ i+3 ] = (bits & 8) ? 0 : 1;
+    }
+
+    #endif
+
+    //Scalar path for the rest
+    for (; i<count; ++i)
+    {
+      Uint8 visible = 1;
+      for (Uint p=0; p<numPlanes; ++p)
+      {
+        Float d = pcx[i] * planes[p].x + pcy[i] * planes[p].y + pcz[i] * planes[p].z + planes[p].w;
+        Float r = pex[i] * absPlanes[p].x + pey[i] * absPlanes[p].y + pez[i] * absPlanes[p].z;
+        if (d + r <= 0.0f) { visible = 0; break; }
+      }
+      outVisible[i] = visible;
+    }
+  }
+
+  /*
+  Appends the indices of the boxes passing the query */
+
+  void BoxArray::query (const BoxQuery &q, ArrayList <Uint32> &outItems) const
+  {
+    for (UintSize i=0; i<size(); ++i)
+      if (q.test( getCenter( i ), getExtent( i )) != BoxQuery::Outside)
+        outItems.pushBack( (Uint32) i );
+  }
+
+  /*
+  -----------------------------------------------------
+  BoxTree
+  -----------------------------------------------------*/
+
+  BoxTree::BoxTree ()
+  {
+    maxLeafSize = 8;
+    buildArea = 0.0f;
+    fitArea = 0.0f;
+    numRefits = 0;
+  }
+
+  void BoxTree::clear ()
+  {
+    boxes.clear();
+    items.clear();
+    nodes.clear();
+    buildArea = 0.0f;
+    fitArea = 0.0f;
+    numRefits = 0;
+  }
+
+  UintSize BoxTree::getNumItems () const
+  {
+    return items.size();
+  }
+
+  UintSize BoxTree::getNumNodes () const
+  {
+    return nodes.size();
+  }
+
+  void BoxTree::build (const BoxArray &input, UintSize leafSize)
+  {
+    clear();
+    maxLeafSize = Util::Max( leafSize, (UintSize) 1 );
+    leafVisible.resize( maxLeafSize );
+
+    //Start with items in input order. Boxes get reordered
+    //along with the items so they end up in leaf order and
+    //the build itself works on contiguous memory.
+    for (UintSize i=0; i<input.size(); ++i)
+    {
+      items.pushBack( (Uint32) i );
+      boxes.cx.pushBack( input.cx[i] );
+      boxes.cy.pushBack( input.cy[i] );
+      boxes.cz.pushBack( input.cz[i] );
+      boxes.ex.pushBack( input.ex[i] );
+      boxes.ey.pushBack( input.ey[i] );
+      boxes.ez.pushBack( input.ez[i] );
+    }
+
+    if (items.empty()) return;
+    buildNode( 0, (Uint32) items.size() );
+
+    buildArea = fitArea = sumNodeArea();
+  }
+
+  Uint32 BoxTree::buildNode (Uint32 first, Uint32 count)
+  {
+    const Float *cx = boxes.cx.buffer(), *ex = boxes.ex.buffer();
+    const Float *cy = boxes.cy.buffer(), *ey = boxes.ey.buffer();
+    const Float *cz = boxes.cz.buffer(), *ez = boxes.ez.buffer();
+
+    //Find bounds of the boxes and of their centers
+    Vector3 bmin( 1e30f ), bmax( -1e30f );
+    Vector3 cmin( 1e30f ), cmax( -1e30f );
+    for (Uint32 i=first; i<first+count; ++i)
+    {
+      bmin.x = Util::Min( bmin.x, cx[i] - ex[i] ); bmax.x = Util::Max( bmax.x, cx[i] + ex[i] );
+      bmin.y = Util::Min( bmin.y, cy[i] - ey[i] ); bmax.y = Util::Max( bmax.y, cy[i] + ey[i] );
+      bmin.z = Util::Min( bmin.z, cz[i] - ez[i] ); bmax.z = Util::Max( bmax.z, cz[i] + ez[i] );
+
+      cmin.x = Util::Min( cmin.x, cx[i] ); cmax.x = Util::Max( cmax.x, cx[i] );
+      cmin.y = Util::Min( cmin.y, cy[i] ); cmax.y = Util::Max( cmax.y, cy[i] );
+      cmin.z = Util::Min( cmin.z, cz[i] ); cmax.z = Util::Max( cmax.z, cz[i] );
+    }
+
+    //Add node (references into the list aren't stable)
+    BoxTreeNode node;
+    node.center = (bmin + bmax) * 0.5f;
+    node.extent = (bmax - bmin) * 0.5f;
+    node.first = first;
+    node.count = count;
+    node.right = 0;
+
+    Uint32 index = (Uint32) nodes.size();
+    nodes.pushBack( node );
+
+    if (count <= maxLeafSize)
+      return index;
+
+    //Split at the median along the longest axis of the centers
+    Vector3 csize = cmax - cmin;
+    Uint axis = 0;
+    if (csize.y > csize.x) axis = 1;
+    if (csize.z > (axis == 0 ? csize.x : csize.y)) axis = 2;
+
+    Uint32 half = count / 2;
+    partition( first, count, axis );
+
+    buildNode( first, half );
+    Uint32 right = buildNode( first + half, count - half );
+    nodes[ index ].right = right;
+
+    return index;
+  }
+
+  /*
+  Updates the boxes from the input (same items as given
+  to the last build) and refits the node bounds without
+  changing the tree topology. Much cheaper than a build
+  but the culling efficiency degrades as boxes move. */
+
+  void BoxTree::refit (const BoxArray &input)
+  {
+    for (UintSize i=0; i<items.size(); ++i)
+    {
+      Uint32 item = items[i];
+      boxes.cx[i] = input.cx[ item ];
+      boxes.cy[i] = input.cy[ item ];
+      boxes.cz[i] = input.cz[ item ];
+      boxes.ex[i] = input.ex[ item ];
+      boxes.ey[i] = input.ey[ item ];
+      boxes.ez[i] = input.ez[ item ];
+    }
+
+    //Children always come after their parent
+    for (Int n=(Int)nodes.size()-1; n>=0; --n)
+      fitNode( (Uint32) n );
+
+    fitArea = sumNodeArea();
+    numRefits++;
+  }
+
+  /*
+  The summed surface area of the nodes is proportional to
+  the expected number of nodes a query visits, so its growth
+  since the build measures how loose the refits have made
+  the hierarchy. */
+
+  Float BoxTree::sumNodeArea () const
+  {
+    Float area = 0.0f;
+    for (UintSize n=0; n<nodes.size(); ++n)
+    {
+      const Vector3 &e = nodes[n].extent;
+      area += e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+    return area;
+  }
+
+  UintSize BoxTree::getNumRefits () const
+  {
+    return numRefits;
+  }
+
+  Float BoxTree::getRefitGrowth () const
+  {
+    if (buildArea <= 0.0f) return 1.0f;
+    return fitArea / buildArea;
+  }
+
+  void BoxTree::fitNode (Uint32 index)
+  {
+    BoxTreeNode &node = nodes[ index ];
+    Vector3 bmin( 1e30f ), bmax( -1e30f );
+
+    if (node.right == 0)
+    {
+      //Enclose leaf boxes
+      for (Uint32 i=node.first; i<node.first + node.count; ++i)
+      {
+        Vector3 c = boxes.getCenter( i );
+        Vector3 e = boxes.getExtent( i );
+        bmin.x = Util::Min( bmin.x, c.x - e.x ); bmax.x = Util::Max( bmax.x, c.x + e.x );
+        bmin.y = Util::Min( bmin.y, c.y - e.y ); bmax.y = Util::Max( bmax.y, c.y + e.y );
+        bmin.z = Util::Min( bmin.z, c.z - e.z ); bmax.z = Util::Max( bmax.z, c.z + e.z );
+      }
+    }
+    else
+    {
+      //Enclose both children
+      const BoxTreeNode *child[2] = { &nodes[ index+1 ], &nodes[ node.right ] };
+      for (int k=0; k<2; ++k)
+      {
+        Vector3 lo = child[k]->center - child[k]->extent;
+        Vector3 hi = child[k]->center + child[k]->extent;
+        bmin.x = Util::Min( bmin.x, lo.x ); bmax.x = Util::Max( bmax.x, hi.x );
+        bmin.y = Util::Min( bmin.y, lo.y ); bmax.y = Util::Max( bmax.y, hi.y );
+        bmin.z = Util::Min( bmin.z, lo.z ); bmax.z = Util::Max( bmax.z, hi.z );
+      }
+    }
+
+    node.center = (bmin + bmax) * 0.5f;
+    node.extent = (bmax - bmin) * 0.5f;
+  }
+
+  void BoxTree::swap (Int a, Int b)
+  {
+    Uint32 ti = items[a]; items[a] = items[b]; items[b] = ti;
+    Float t;
+    t = boxes.cx[a]; boxes.cx[a] = boxes.cx[b]; boxes.cx[b] = t;
+    t = boxes.cy[a]; boxes.cy[a] = boxes.cy[b]; boxes.cy[b] = t;
+    t = boxes.cz[a]; boxes.cz[a] = boxes.cz[b]; boxes.cz[b] = t;
+    t = boxes.ex[a]; boxes.ex[a] = boxes.ex[b]; boxes.ex[b] = t;
+    t = boxes.ey[a]; boxes.ey[a] = boxes.ey[b]; boxes.ey[b] = t;
+    t = boxes.ez[a]; boxes.ez[a] = boxes.ez[b]; boxes.ez[b] = t;
+  }
+
+  void BoxTree::partition (Uint32 first, Uint32 count, Uint axis)
+  {
+    //Centers on the split axis
+    const Float *c = (axis == 0) ? boxes.cx.buffer() :
+                     (axis == 1) ? boxes.cy.buffer() : boxes.cz.buffer();
+
+    //Quickselect so that the lower half precedes the median
+    Int lo = (Int) first;
+    Int hi = (Int) (first + count - 1);
+    Int k = (Int) (first + count / 2);
+
+    while (lo < hi)
+    {
+      Float pivot = c[ (lo + hi) / 2 ];
+      Int i = lo, j = hi;
+
+      while (i <= j)
+      {
+        while (c[i] < pivot) ++i;
+        while (c[j] > pivot) --j;
+        if (i <= j) {
+          swap( i, j );
+          ++i; --j; }
+      }
+
+      if (k <= j) hi = j;
+      else if (k >= i) lo = i;
+      else break;
+    }
+  }
+
+  /*
+  Marks the items visible in the frustum. Flags of the
+  hidden items are left untouched so the caller should
+  clear the output first. Subtrees fully outside are
+  skipped, subtrees fully inside are accepted without
+  testing and only the planes still intersecting a node
+  are tested further down. */
+
+  void BoxTree::cullFrustum (const Frustum &f, Uint8 *outVisible)
+  {
+    if (nodes.empty()) return;
+
+    //Tree depth is logarithmic due to median splits
+    Uint32 stackNode[ 64 ];
+    Uint stackMask[ 64 ];
+    Int top = 0;
+
+    stackNode[0] = 0;
+    stackMask[0] = 0x3F;
+
+    while (top >= 0)
+    {
+      const BoxTreeNode &node = nodes[ stackNode[ top ]];
+      Uint32 index = stackNode[ top ];
+      Uint mask = stackMask[ top ];
+      top--;
+
+      Frustum::Result r = f.testCenterExtent( node.center, node.extent, &mask );
+      if (r == Frustum::Outside)
+        continue;
+
+      if (r == Frustum::Inside)
+      {
+        //Accept whole subtree
+        for (Uint32 i=node.first; i<node.first + node.count; ++i)
+          outVisible[ items[i] ] = 1;
+      }
+      else if (node.right == 0)
+      {
+        //Test leaf boxes against remaining planes
+        boxes.cullFrustum( f, node.first, node.count, leafVisible.buffer(), mask );
+        for (Uint32 i=0; i<node.count; ++i)
+          if (leafVisible[i]) outVisible[ items[ node.first + i ]] = 1;
+      }
+      else
+      {
+        //Descend into children
+        stackNode[ ++top ] = node.right;
+        stackMask[ top ] = mask;
+        stackNode[ ++top ] = index + 1;
+        stackMask[ top ] = mask;
+      }
+    }
+  }
+
+  /*
+  Appends the items passing the query. Subtrees fully
+  inside the query are accepted without testing. */
+
+  void BoxTree::query (const BoxQuery &q, ArrayList <Uint32> &outItems) const
+  {
+    if (nodes.empty()) return;
+
+    Uint32 stack[ 64 ];
+    Int top = 0;
+    stack[0] = 0;
+
+    while (top >= 0)
+    {
+      Uint32 index = stack[ top-- ];
+      const BoxTreeNode &node = nodes[ index ];
+
+      BoxQuery::Result r = q.test( node.center, node.extent );
+      if (r == BoxQuery::Outside)
+        continue;
+
+      if (r == BoxQuery::Inside)
+      {
+        //Accept whole subtree
+        for (Uint32 i=node.first; i<node.first + node.count; ++i)
+          outItems.pushBack( items[i] );
+      }
+      else if (node.right == 0)
+      {
+        //Test leaf boxes
+        for (Uint32 i=node.first; i<node.first + node.count; ++i)
+          if (q.test( boxes.getCenter( i ), boxes.getExtent( i )) != BoxQuery::Outside)
+            outItems.pushBack( items[i] );
+      }
+      else
+      {
+        //Descend into children
+        stack[ ++top ] = node.right;
+        stack[ ++top ] = index + 1;
+      }
+    }
+  }
+
+}//namespace GE
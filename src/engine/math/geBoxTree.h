@@ -0,0 +1,155 @@
+#ifndef __GEBOXTREE_H
+#define __GEBOXTREE_H
+
+#include "util/geUtil.h"
+#include "math/geVectors.h"
+#include "math/geFrustum.h"
+
+namespace GE
+{
+
+  /*
+  --------------------------------------------------
+  Spatial queries against boxes given by their
+  center and half-size. Inside means the box is
+  wholly contained so a subtree can be accepted
+  without further tests.
+  --------------------------------------------------*/
+
+  class BoxQuery
+  {
+  public:
+
+    enum Result
+    {
+      Outside,
+      Inside,
+      Intersect
+    };
+
+    virtual ~BoxQuery () {}
+    virtual Result test (const Vector3 &center, const Vector3 &extent) const = 0;
+  };
+
+  class RangeQuery : public BoxQuery
+  {
+    Vector3 min, max;
+
+  public:
+    RangeQuery (const Vector3 &min, const Vector3 &max);
+    virtual Result test (const Vector3 &center, const Vector3 &extent) const;
+  };
+
+  class SphereQuery : public BoxQuery
+  {
+    Vector3 center;
+    Float radius;
+
+  public:
+    SphereQuery (const Vector3 &center, Float radius);
+    virtual Result test (const Vector3 &center, const Vector3 &extent) const;
+  };
+
+  class RayQuery : public BoxQuery
+  {
+    Vector3 origin;
+    Vector3 invDir;
+    Float maxDist;
+
+  public:
+    RayQuery (const Vector3 &origin, const Vector3 &dir, Float maxDist);
+    virtual Result test (const Vector3 &center, const Vector3 &extent) const;
+  };
+
+  class FrustumQuery : public BoxQuery
+  {
+    const Frustum &frustum;
+
+  public:
+    FrustumQuery (const Frustum &f);
+    virtual Result test (const Vector3 &center, const Vector3 &extent) const;
+  };
+
+  /*
+  --------------------------------------------------
+  Axis-aligned boxes stored as separate arrays of
+  centers and half-sizes (structure of arrays) so
+  that they can be tested four at a time.
+  --------------------------------------------------*/
+
+  class BoxArray
+  {
+  public:
+    ArrayList <Float> cx, cy, cz;
+    ArrayList <Float> ex, ey, ez;
+
+    void clear ();
+    UintSize size () const;
+    UintSize add (const Vector3 &min, const Vector3 &max);
+    void set (UintSize index, const Vector3 &min, const Vector3 &max);
+    Vector3 getCenter (UintSize index) const;
+    Vector3 getExtent (UintSize index) const;
+
+    void cullFrustum (const Frustum &f, UintSize first, UintSize count,
+                      Uint8 *outVisible, Uint planeMask = 0x3F) const;
+
+    void query (const BoxQuery &q, ArrayList <Uint32> &outItems) const;
+  };
+
+  /*
+  --------------------------------------------------
+  Bounding volume hierarchy over a set of boxes.
+  Nodes are laid out depth-first so the left child
+  always follows its parent. Boxes are reordered so
+  every node covers a contiguous range of them.
+  Leaves have no right child.
+  --------------------------------------------------*/
+
+  class BoxTreeNode
+  {
+  public:
+    Vector3 center;
+    Vector3 extent;
+    Uint32 first;
+    Uint32 count;
+    Uint32 right;
+  };
+
+  class BoxTree
+  {
+  private:
+    BoxArray boxes;
+    ArrayList <Uint32> items;
+    ArrayList <BoxTreeNode> nodes;
+    ArrayList <Uint8> leafVisible;
+    UintSize maxLeafSize;
+
+    //Node area at the last build and after the last refit
+    Float buildArea;
+    Float fitArea;
+    UintSize numRefits;
+
+    Uint32 buildNode (Uint32 first, Uint32 count);
+    Float sumNodeArea () const;
+    void fitNode (Uint32 index);
+    void partition (Uint32 first, Uint32 count, Uint axis);
+    void swap (Int a, Int b);
+
+  public:
+    BoxTree ();
+
+    void clear ();
+    void build (const BoxArray &input, UintSize leafSize = 8);
+    void refit (const BoxArray &input);
+    UintSize getNumItems () const;
+    UintSize getNumNodes () const;
+    UintSize getNumRefits () const;
+    Float getRefitGrowth () const;
+
+    void cullFrustum (const Frustum &f, Uint8 *outVisible);
+    void query (const BoxQuery &q, ArrayList <Uint32> &outItems) const;
+  };
+
+
+}//namespace GE
+#endif//__GEBOXTREE_H
@@ -41,4 +41,41 @@ namespace GE
 
     return Frustum::Inside;
   }
+
+  /*
+  Tests an axis-aligned box given by its center and half
+  size. Only the planes with their bit set in the mask are
+  tested; the bits of the planes the box is fully inside
+  of are cleared, so the mask can be passed on to any boxes
+  contained within this one. */
+
+  Frustum::Result Frustum::testCenterExtent (const Vector3 &c, const Vector3 &e,
+                                             Uint *planeMask) const
+  {
+    Uint mask = (planeMask != NULL) ? *planeMask : 0x3F;
+
+    for (int p=0; p<6; ++p)
+    {
+      if ((mask & (1 << p)) == 0)
+        continue;
+
+      //Signed distance of center and projected radius of the box
+      const Vector4 &pl = planes[p];
+      Float d = c.x * pl.x + c.y * pl.y + c.z * pl.z + pl.w;
+      Float r = e.x * fabsf( pl.x ) + e.y * fabsf( pl.y ) + e.z * fabsf( pl.z );
+
+      //All corners outside
+      if (d + r <= 0.0f)
+        return Frustum::Outside;
+
+      //All corners inside
+      if (d - r > 0.0f)
+        mask &= ~(1 << p);
+    }
+
+    if (planeMask != NULL)
+      *planeMask = mask;
+
+    return (mask == 0) ? Frustum::Inside : Frustum::Intersect;
+  }
 }
@@ -14,7 +14,8 @@ namespace GE
     enum Result
     {
       Outside,
-      Inside
+      Inside,
+      Intersect
     };
 
     enum PlaneIndex
@@ -32,6 +33,8 @@ namespace GE
     void fromMatrix (const Matrix4x4 &m);
     Result testPoint (const Vector3 &p, int pl) const;
     Result testBox (Vector3 box[8]) const;
+    Result testCenterExtent (const Vector3 &center, const Vector3 &extent,
+                             Uint *planeMask = NULL) const;
   };
 
 
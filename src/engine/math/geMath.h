@@ -5,5 +5,6 @@
 #include "math/geMatrix.h"
 #include "math/geBoundingBox.h"
 #include "math/geFrustum.h"
+#include "math/geBoxTree.h"
 
 #endif//__GEMATH_H
@@ -14,6 +14,7 @@ namespace GE
   Actor::Actor()
   {
     valid = true;
+    globalValid = false;
     parent = NULL;
     scene = NULL;
   }
@@ -74,6 +75,7 @@ namespace GE
 
     Scene *newScene = getScene();
     if (newScene != NULL) newScene->markChanged();
+    markMatrixChanged();
   }
 
   void Actor::addChild (Actor* c)
@@ -96,6 +98,7 @@ namespace GE
 
     Scene *newScene = c->getScene();
     if (newScene != NULL) newScene->markChanged();
+    c->markMatrixChanged();
   }
   
   void Actor::removeChild (Actor* c)
@@ -105,6 +108,7 @@ namespace GE
 
     children.remove( c );
     c->parent = NULL;
+    c->markMatrixChanged();
   }
 
   void Actor::getAncestors (ArrayList<Actor*> &list)
@@ -120,6 +124,8 @@ namespace GE
   Scene::Scene()
   {
     changed = true;
+    matrixChanged = true;
+    trackMoved = false;
     root = NULL;
   }
 
@@ -128,37 +134,79 @@ namespace GE
     changed = true;
   }
 
+  void Scene::markMatrixChanged()
+  {
+    matrixChanged = true;
+  }
+
+  /*
+  When enabled, actors whose global matrix gets invalidated
+  are collected until cleared so that derived scenes can
+  refresh per-actor data incrementally. */
+
+  void Scene::setTrackMovedActors (bool track)
+  {
+    trackMoved = track;
+    movedActors.clear();
+  }
+
+  void Scene::clearMovedActors ()
+  {
+    movedActors.clear();
+  }
+
+  //Actors whose bounds changed in place count as well
   bool Scene::hasChanged ()
+  {
+    return changed || matrixChanged || !movedActors.empty();
+  }
+
+  bool Scene::hasStructureChanged ()
   {
     return changed;
   }
 
   void Scene::updateChanges()
   {
-    //Check if changed at all
-    if (!changed) return;
-    changed = false;
-
-    //Clear old data
-    traversal.clear();
-    if (root == NULL) return;
-
-    //Push root onto stack
-    ArrayList <Actor*> stack;
-    stack.pushBack( root );
-    while (!stack.empty())
+    //Rebuild traversal if structure changed
+    if (changed)
     {
-      //Pop top
-      Actor* parent = stack.last();
-      stack.popBack();
-
-      //Add to traversal
-      traversal.pushBack( parent );
+      changed = false;
+      matrixChanged = true;
+
+      //Clear old data
+      traversal.clear();
+      movedActors.clear();
+      if (root != NULL)
+      {
+        //Push root onto stack
+        ArrayList <Actor*> stack;
+        stack.pushBack( root );
+        while (!stack.empty())
+        {
+          //Pop top
+          Actor* parent = stack.last();
+          stack.popBack();
+
+          //Add to traversal
+          traversal.pushBack( parent );
+
+          //Push children onto stack
+          const ArrayList <Actor*> & children = parent->getChildren();
+          for (UintSize c=0; c<children.size(); ++c)
+            stack.pushBack( children[c] );
+        }
+      }
+    }
 
-      //Push children onto stack
-      const ArrayList <Actor*> & children = parent->getChildren();
-      for (UintSize c=0; c<children.size(); ++c)
-        stack.pushBack( children[c] );
+    //Refresh invalid global matrices top-down (parents
+    //always precede their children in the traversal)
+    if (matrixChanged)
+    {
+      matrixChanged = false;
+      for (UintSize t=0; t<traversal.size(); ++t)
+        if (!traversal[t]->globalValid)
+          traversal[t]->updateGlobalMatrix();
     }
   }
 
@@ -169,6 +217,7 @@ namespace GE
 
     root = actor;
     root->scene = this;
+    root->markMatrixChanged();
     markChanged();
   }
 
@@ -259,20 +308,69 @@ namespace GE
     setSize( s.x, s.y );
   }
 
+  /*
+  The global matrix is cached and only recomputed when the actor
+  or any of its ancestors has changed its local matrix or parent.
+  A subtree is either completely invalid or its root is valid, so
+  invalidation can stop at the first already invalid actor. */
+
+  void Actor::markMatrixChanged ()
+  {
+    if (!globalValid) return;
+
+    Scene *s = getScene();
+    if (s != NULL) s->markMatrixChanged();
+    bool track = (s != NULL && s->trackMoved);
+
+    ArrayList <Actor*> stack;
+    stack.pushBack( this );
+    while (!stack.empty())
+    {
+      Actor *a = stack.last();
+      stack.popBack();
+
+      if (!a->globalValid) continue;
+      a->globalValid = false;
+      if (track) s->movedActors.pushBack( a );
+
+      for (UintSize c=0; c<a->children.size(); ++c)
+        stack.pushBack( a->children[c] );
+    }
+  }
+
+  /*
+  Bounds of an actor can change while its matrix stays the
+  same (e.g. a new mesh), which has to be reported to the
+  scene explicitly. */
+
+  void Actor::markBoundsChanged ()
+  {
+    Scene *s = getScene();
+    if (s != NULL && s->trackMoved)
+      s->movedActors.pushBack( this );
+  }
+
+  void Actor::updateGlobalMatrix ()
+  {
+    if (parent != NULL)
+      globalMat = parent->getGlobalMatrix() * mat;
+    else globalMat = mat;
+
+    globalValid = true;
+  }
+
   Matrix4x4 Actor::getGlobalMatrix (bool inclusive)
   {
-    Matrix4x4 g;
-    if (inclusive)
-      g = getMatrix();
-    
-    Actor *p = getParent();
-    while (p != NULL)
+    if (!inclusive)
     {
-      g = p->getMatrix() * g;
-      p = p->getParent();
+      if (parent == NULL) return Matrix4x4();
+      return parent->getGlobalMatrix();
     }
 
-    return g;
+    if (!globalValid)
+      updateGlobalMatrix();
+
+    return globalMat;
   }
 
   bool Actor::hitTest (float x, float y)
@@ -98,9 +98,13 @@ namespace GE
 
   private:
     bool valid;
+    bool globalValid;
     Scene *scene;
     Actor *parent;
     CharString name;
+    Matrix4x4 globalMat;
+
+    void updateGlobalMatrix ();
 
   protected:
     Vector2 loc;
@@ -121,6 +125,8 @@ namespace GE
     //Location
     Matrix4x4& getMatrix() { return mat; }
     virtual Matrix4x4 getGlobalMatrix (bool inclusive = true);
+    void markMatrixChanged ();
+    void markBoundsChanged ();
 
     void setLoc (float x, float y);
     void setLoc (const Vector2 &loc);
@@ -163,6 +169,8 @@ namespace GE
 
   class Scene : public Object
   {
+    friend class Actor;
+
     CLASS( Scene, Object,
       b70776ed,5881,48fb,8fc46f317579d987 );
 
@@ -174,8 +182,17 @@ namespace GE
 
   private:
     bool changed;
+    bool matrixChanged;
     Actor* root;
     ArrayList <Actor*> traversal;
+    ArrayList <Actor*> movedActors;
+    bool trackMoved;
+
+    void markMatrixChanged ();
+
+  protected:
+    void setTrackMovedActors (bool track);
+    void clearMovedActors ();
 
   public:
     Scene ();
@@ -186,10 +203,12 @@ namespace GE
 
     void updateChanges ();
     void markChanged ();
-    bool hasChanged ();
+    virtual bool hasChanged ();
+    bool hasStructureChanged ();
 
     Actor* findTopActorAt (float x, float y);
     const ArrayList<Actor*> & getTraversal () { return traversal; }
+    const ArrayList<Actor*> & getMovedActors () { return movedActors; }
 
     Actor* findFirstActorByClass (Class cls);
     void findActorsByClass (Class cls, ArrayList< Actor* > &outActors);
@@ -17,6 +17,7 @@ namespace GE
     Uint32 eltSize;
     Uint8 *elements;
     void *temp;
+    bool borrowed;
     
   public:
     
@@ -50,6 +51,7 @@ namespace GE
       cap = 1;
       elements = (Uint8*) std::malloc( cap * eltSize );
       temp = std::malloc( eltSize );
+      borrowed = false;
     }
 
     /*
@@ -66,6 +68,7 @@ namespace GE
       cap = (Uint32) (newCap > 0 ? newCap : 1);
       elements = (Uint8*) std::malloc( cap * eltSize );
       temp = std::malloc( eltSize );
+      borrowed = false;
     }
 
     /*
@@ -81,6 +84,7 @@ namespace GE
       cap = other.cap;
       elements = (Uint8*) std::malloc( cap * eltSize );
       temp = std::malloc( eltSize );
+      borrowed = false;
 
       //Can't call virtuals in constructor!
       std::memcpy( elements, other.elements, sz * eltSize );
@@ -94,7 +98,7 @@ namespace GE
     virtual ~GenericArrayList ()
     {
       //Can't call virtuals in destructor!
-      std::free( elements );
+      if (!borrowed) std::free( elements );
       std::free( temp );
     }
 
@@ -122,6 +126,17 @@ namespace GE
     virtual void copy (void *dst, const void *src, UintSize n) {
       std::memcpy( dst, src, n * eltSize );
     }
+
+    /*
+    -----------------------------------------------------
+    Frees the element storage unless it is borrowed
+    -----------------------------------------------------*/
+
+    void freeElements ()
+    {
+      if (!borrowed) std::free( elements );
+      borrowed = false;
+    }
   
   public:
     
@@ -155,7 +170,7 @@ namespace GE
       eltSize = (Uint32) esz;
 
       //Free old memory and allocate new
-      std::free( elements );
+      freeElements();
       std::free( temp );
       elements = (Uint8*) std::malloc( cap * eltSize );
       temp = std::malloc( eltSize );
@@ -179,7 +194,7 @@ namespace GE
       if (n > cap)
       {
         //Free old memory and allocate more
-        std::free( elements );
+        freeElements();
         elements = (Uint8*) std::malloc( n * eltSize );
         cap = (Uint32) n;
       }
@@ -198,7 +213,7 @@ namespace GE
         sz = 0;
 
         //Free old memory and allocate more
-        std::free( elements );
+        freeElements();
         elements = (Uint8*) std::malloc( n * eltSize );
         cap = (Uint32) n;
 
@@ -232,7 +247,7 @@ namespace GE
         
         //Destruct and free old elements
         destruct( elements, sz );
-        std::free( elements );
+        freeElements();
         
         //Switch to new array
         elements = (Uint8*) newElements;
@@ -256,7 +271,7 @@ namespace GE
         
         //Destruct and free old elements
         destruct( elements, sz );
-        std::free( elements );
+        freeElements();
         
         //Switch to new array
         elements = (Uint8*) newElements;
@@ -268,6 +283,36 @@ namespace GE
       sz = (Uint32) n;
     }
 
+    /*
+    ----------------------------------------------------
+    Makes [n] elements at external memory the contents
+    of the array without copying them. The memory must
+    stay valid and writable for as long as the array
+    uses it. It is never freed by the array, which
+    switches to storage of its own once it has to grow.
+    ----------------------------------------------------*/
+
+    void borrow (void *data, UintSize n)
+    {
+      //Nothing to grow from
+      if (n == 0) {
+        clear();
+        return;
+      }
+
+      //Destruct and free old elements
+      destruct( elements, sz );
+      freeElements();
+
+      //Switch to external array
+      elements = (Uint8*) data;
+      sz = cap = (Uint32) n;
+      borrowed = true;
+    }
+
+    bool isBorrowed () const
+    { return borrowed; }
+
     /*
     ------------------------------------------------------
     Enlarges the array capacity at element insertion by
@@ -527,7 +572,8 @@ namespace GE
     ArrayList<T>& operator= (const ArrayList<T> &other)
     {
       clear();
-      pushListBack( other );
+      pushListBack( &other );
+      return *this;
     }
   };
 
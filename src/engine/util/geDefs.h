@@ -49,6 +49,7 @@
 
 #ifndef WIN32
 #  include <sys/time.h>
+#  include <time.h>
 #endif
 
 
@@ -81,6 +82,7 @@ namespace GE
   #define SIN(a)   ((Float)std::sin(a))
   #define TAN(a)   ((Float)std::tan(a))
   #define ACOS(a)  ((Float)std::acos(a))
+  #define ASIN(a)  ((Float)std::asin(a))
   #define SQRT(a)  ((Float)std::sqrt(a))
   #define FLOOR(a) ((Float)std::floor(a))
   #define CEIL(a)  ((Float)std::ceil(a))
@@ -90,6 +90,46 @@ namespace GE
         _size--;
     }
 
+    /*
+    Moves the elements of [other] to the end of this list
+    without copying, so pointers to them stay valid. Spare
+    elements of this list are handed over in exchange and
+    [other] is left empty. */
+
+    bool append (DynamicArrayList &other)
+    {
+      while (_arraycap < _size + other._size)
+        if (!extendArray()) return false;
+
+      //Swap with our spare elements, take the rest
+      int taken = other._size;
+      for (int e=0; e<other._size; ++e)
+      {
+        int dst = _size + e;
+        if (dst < _elementcap) {
+          T *spare = elements[dst];
+          elements[dst] = other.elements[e];
+          other.elements[e] = spare;
+        }else{
+          elements[dst] = other.elements[e];
+          if (taken == other._size) taken = e;
+        }
+      }
+
+      //Close the gap left by the taken elements
+      int cap = taken;
+      for (int e=other._size; e<other._elementcap; ++e)
+        other.elements[cap++] = other.elements[e];
+
+      if (_size + other._size > _elementcap)
+        _elementcap = _size + other._size;
+
+      _size += other._size;
+      other._elementcap = cap;
+      other._size = 0;
+      return true;
+    }
+
     T& operator[] (int index) const {
       return *elements[index];
     }
@@ -27,4 +27,11 @@ namespace GE
     //Cast failed
     return NULL;
   }
-}
+
+  void Object::operator delete (void *p)
+  {
+    if (!ObjectArena::Free( p ))
+      ::operator delete( p );
+  }
+
+}//namespace GE
@@ -53,6 +53,16 @@ namespace GE
       if (d4 < c.d4) return true;
       return false;
     }
+
+    //64-bit mix of all the fields for hash tables
+    Uint64 hash() const
+    {
+      Uint64 h = (((Uint64) d1 << 32) | ((Uint64) d2 << 16) | (Uint64) d3) ^ (d4 * 0x9E3779B97F4A7C15ull);
+      h ^= h >> 33; h *= 0xFF51AFD7ED558CCDull;
+      h ^= h >> 33; h *= 0xC4CEB9FE1A85EC53ull;
+      h ^= h >> 33;
+      return h;
+    }
   };
 
   /*
@@ -64,19 +74,27 @@ namespace GE
   {
   private:
     UUID id;
+    Uint64 h;
     CharString n;
 
   public:
     IClass (const UUID &id, const CharString &name) {
       this->id = id;
+      this->h = id.hash();
       this->n = name;
     }
 
     const UUID& uuid() const { return id; }
+    Uint64 hash() const { return h; }
     const CharString& name() const { return n; }
     
     virtual Class super() const = 0;
+    virtual UintSize size() const = 0;
     virtual Object* instantiate() const = 0;
+
+    //Constructs into memory of size() bytes owned by the caller
+    virtual Object* instantiate (void *where) const = 0;
+    virtual void destroy (Object *instance) const = 0;
   };
 
   /*
@@ -116,6 +134,11 @@ namespace GE
       return ptr->uuid() < other.ptr->uuid();
     }
 
+    //Precomputed from the UUID when the class is registered
+    Uint64 hash () const {
+      return ptr->hash();
+    }
+
     const IClass* operator-> () const {
       return ptr;
     }
@@ -143,6 +166,8 @@ namespace GE
   public:
     IClass2 (const UUID &id, const CharString &name) : IClass(id,name) {}
     virtual Class super() const { return SuperClass::GetClass(); }
+    virtual UintSize size() const { return sizeof( ThisClass ); }
+    virtual void destroy (Object *instance) const { static_cast< ThisClass* >( instance )->~ThisClass(); }
   };
 
   /*
@@ -156,6 +181,7 @@ namespace GE
   public:
     IConcrete (const UUID &id, const CharString &name) : IClass2(id,name) {}
     virtual Object* instantiate() const { return new ThisClass(); }
+    virtual Object* instantiate (void *where) const { return new (where) ThisClass(); }
   };
 
   template <class ThisClass, class SuperClass>
@@ -164,6 +190,7 @@ namespace GE
   public:
     IAbstract (const UUID &id, const CharString &name) : IClass2(id,name) {}
     virtual Object* instantiate() const { return NULL; }
+    virtual Object* instantiate (void *where) const { return NULL; }
   };
 
   /*
@@ -175,7 +202,7 @@ namespace GE
   class IFactory
   {
   public:
-    virtual Object* produce() = 0;
+    virtual Object* produce (ObjectArena *arena) = 0;
   };
 
   template <class C>
@@ -185,20 +212,22 @@ namespace GE
 
     //This uses the return type of produce function to determine
     //whether a custom one has been defined for this class
-    virtual Object* produce() {
-      return produceDispatch( &C::produce );
+    virtual Object* produce (ObjectArena *arena) {
+      return produceDispatch( &C::produce, arena );
     };
 
   private:
 
     //This will match produce function with correct return type
-    Object* produceDispatch (C* (*funcPtr) ()) {
+    Object* produceDispatch (C* (*funcPtr) (), ObjectArena *arena) {
       return C::produce();
     }
 
-    //This will match produce function with any other return type
+    //This will match produce function with any other return type,
+    //the default constructor can place the object in an arena
     template <class Other>
-    Object* produceDispatch (Other* (*funcPtr) ()) {
+    Object* produceDispatch (Other* (*funcPtr) (), ObjectArena *arena) {
+      if (arena != NULL) return new (arena->alloc( sizeof( C ))) C();
       return new C();
     }
   };
@@ -264,6 +293,9 @@ namespace GE
 
     virtual Uint version () { return 1; }
     static Object* produce() { return NULL; }
+
+    //Memory of objects placed in an ObjectArena stays with it
+    static void operator delete (void *p);
     virtual void serialize (Serializer *serializer, Uint version) {}
   };
 
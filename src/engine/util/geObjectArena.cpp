@@ -0,0 +1,148 @@
+#include "util/geUtil.h"
+
+namespace GE
+{
+  /*
+  Blocks of all the arenas, ordered by address, so deleting
+  an object can tell whether it lies in one. Only searched
+  while any arena is alive. */
+
+  struct ArenaBlock
+  {
+    Uint8 *start;
+    Uint8 *end;
+    ObjectArena *arena;
+  };
+
+  static ArrayList< ArenaBlock > arenaBlocks;
+  static volatile Int numArenaBlocks = 0;
+  static Mutex arenaLock;
+
+  static Int FindArenaBlock (void *p)
+  {
+    //Last block starting at or before the address
+    UintSize lo = 0, hi = arenaBlocks.size();
+    while (lo < hi)
+    {
+      UintSize mid = (lo + hi) / 2;
+      if (arenaBlocks[ mid ].start <= (Uint8*) p) lo = mid + 1;
+      else hi = mid;
+    }
+
+    if (lo == 0 || (Uint8*) p >= arenaBlocks[ lo-1 ].end) return -1;
+    return (Int) lo - 1;
+  }
+
+  //Lock is held by the caller
+  static void RemoveArenaBlocks (ObjectArena *arena)
+  {
+    UintSize b = 0;
+    while (b < arenaBlocks.size())
+    {
+      if (arenaBlocks[ b ].arena == arena) arenaBlocks.removeAt( b );
+      else ++b;
+    }
+
+    numArenaBlocks = (Int) arenaBlocks.size();
+  }
+
+  ObjectArena::ObjectArena (UintSize blockSize)
+  {
+    this->blockSize = blockSize;
+    blockUsed = blockSize;
+    byteSize = 0;
+    numObjects = 0;
+    released = false;
+  }
+
+  ObjectArena::~ObjectArena ()
+  {
+    for (UintSize b=0; b<blocks.size(); ++b)
+      std::free( blocks[ b ] );
+  }
+
+  void ObjectArena::addBlock (UintSize size)
+  {
+    ArenaBlock block;
+    block.start = (Uint8*) std::malloc( size );
+    block.end = block.start + size;
+    block.arena = this;
+    blocks.pushBack( block.start );
+    byteSize += size;
+
+    arenaLock.lock();
+    UintSize b = arenaBlocks.size();
+    while (b > 0 && arenaBlocks[ b-1 ].start > block.start) --b;
+    arenaBlocks.insertAt( b, block );
+    numArenaBlocks = (Int) arenaBlocks.size();
+    arenaLock.unlock();
+  }
+
+  /*
+  Sizes are rounded up so every object stays aligned like
+  one from malloc. Objects bigger than a block get a block
+  of their own. */
+
+  void* ObjectArena::alloc (UintSize size)
+  {
+    size = (size + 15) & ~((UintSize) 15);
+    Atomic::Increment( &numObjects );
+
+    if (size > blockSize)
+    {
+      //Keep the current block last to go on filling it
+      addBlock( size );
+      Uint8 *own = blocks.last();
+      if (blocks.size() > 1) {
+        blocks.last() = blocks[ blocks.size()-2 ];
+        blocks[ blocks.size()-2 ] = own; }
+      return own;
+    }
+
+    if (blockUsed + size > blockSize)
+    {
+      addBlock( blockSize );
+      blockUsed = 0;
+    }
+
+    void *p = blocks.last() + blockUsed;
+    blockUsed += size;
+    return p;
+  }
+
+  /*
+  The owner is done placing objects. The arena goes away
+  with the last of them, or right now if none is left. */
+
+  void ObjectArena::release ()
+  {
+    arenaLock.lock();
+    released = true;
+    bool done = (numObjects == 0);
+    if (done) RemoveArenaBlocks( this );
+    arenaLock.unlock();
+
+    if (done) delete this;
+  }
+
+  bool ObjectArena::Free (void *p)
+  {
+    if (numArenaBlocks == 0)
+      return false;
+
+    arenaLock.lock();
+    Int b = FindArenaBlock( p );
+    if (b == -1) {
+      arenaLock.unlock();
+      return false; }
+
+    ObjectArena *arena = arenaBlocks[ b ].arena;
+    bool done = (Atomic::Decrement( &arena->numObjects ) == 0 && arena->released);
+    if (done) RemoveArenaBlocks( arena );
+    arenaLock.unlock();
+
+    if (done) delete arena;
+    return true;
+  }
+
+}//namespace GE
@@ -0,0 +1,45 @@
+#ifndef __GEOBJECTARENA_H
+#define __GEOBJECTARENA_H 1
+
+namespace GE
+{
+  //Size of the blocks objects are placed in
+  #define GE_OBJECT_ARENA_BLOCK 65536
+
+  /*
+  ----------------------------------------------------------
+  Block allocator for the objects of one package, filled by
+  one serializer at a time. Objects are placed one after
+  another and deleted as usual, which runs their destructor
+  but leaves the memory to the arena. Once the owner
+  releases the arena and the last of its objects is deleted,
+  all the blocks are freed at once.
+  ----------------------------------------------------------*/
+
+  class ObjectArena
+  {
+    ArrayList< Uint8* > blocks;
+    UintSize blockSize;
+    UintSize blockUsed;
+    UintSize byteSize;
+    volatile Int numObjects;
+    bool released;
+
+    ~ObjectArena ();
+    void addBlock (UintSize size);
+
+  public:
+    ObjectArena (UintSize blockSize = GE_OBJECT_ARENA_BLOCK);
+
+    void* alloc (UintSize size);
+    void release ();
+
+    UintSize getNumObjects () { return (UintSize) numObjects; }
+    UintSize getByteSize () { return byteSize; }
+
+    //Counts off an object if it lies in any arena
+    static bool Free (void *p);
+  };
+
+}//namespace GE
+#endif//__GEOBJECTARENA_H
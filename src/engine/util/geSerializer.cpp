@@ -7,15 +7,113 @@ namespace GE
   Static members
   ---------------------------------------------------------*/
 
-  Serializer::ClassMap Serializer::classes;
+  ArrayList< Serializer::ClassEntry > Serializer::classes;
+  ArrayList< Int32 > Serializer::classSlots;
+
+  /*
+  ---------------------------------------------------
+  Class registry
+  ---------------------------------------------------*/
+
+  void Serializer::RehashClasses (UintSize capacity)
+  {
+    classSlots.clear();
+    for (UintSize s=0; s<capacity; ++s)
+      classSlots.pushBack( -1 );
+
+    UintSize mask = capacity - 1;
+    for (UintSize c=0; c<classes.size(); ++c)
+    {
+      UintSize h = (UintSize) classes[c].hash & mask;
+      while (classSlots[h] != -1) h = (h + 1) & mask;
+      classSlots[h] = (Int32) c;
+    }
+  }
+
+  Int32 Serializer::FindClass (const UUID &id, Uint64 hash)
+  {
+    if (classSlots.empty()) return -1;
+
+    //Linear probing
+    UintSize mask = classSlots.size() - 1;
+    UintSize h = (UintSize) hash & mask;
+    while (classSlots[h] != -1)
+    {
+      const ClassEntry &entry = classes[ classSlots[h] ];
+      if (entry.hash == hash && entry.id == id) return classSlots[h];
+      h = (h + 1) & mask;
+    }
+
+    return -1;
+  }
+
+  void Serializer::AddFactory (const UUID &id, Uint64 hash, IFactory *factory)
+  {
+    //Registering again replaces the factory
+    Int32 c = FindClass( id, hash );
+    if (c != -1) {
+      classes[c].factory = factory;
+      return; }
+
+    ClassEntry entry;
+    entry.id = id;
+    entry.hash = hash;
+    entry.factory = factory;
+    classes.pushBack( entry );
+
+    //Grow at half load
+    if (classes.size() * 2 > classSlots.size()) {
+      RehashClasses( Util::Max( classSlots.size() * 2, (UintSize) 64 ));
+      return; }
+
+    UintSize mask = classSlots.size() - 1;
+    UintSize h = (UintSize) hash & mask;
+    while (classSlots[h] != -1) h = (h + 1) & mask;
+    classSlots[h] = (Int32) classes.size() - 1;
+  }
+
+  Object* Serializer::Produce (const UUID &id, ObjectArena *arena)
+  {
+    Int32 c = FindClass( id, id.hash() );
+    if (c == -1) return NULL;
+    return classes[c].factory->produce( arena );
+  }
+
+  Serializer::Serializer ()
+  {
+    state = &stateSave;
+    borrowArrays = false;
+    borrowMinSize = GE_SERIAL_BORROW_SIZE;
+    borrowedSize = 0;
+    alignArrays = false;
+    arena = NULL;
+  }
 
   /*
   ---------------------------------------------------------
   Data management
   ---------------------------------------------------------*/
 
+  void Serializer::State::grow (UintSize size)
+  {
+    //Stop writing at the end of a fixed buffer
+    if (!growable) {
+      overflow = true;
+      simulate = true;
+      return;
+    }
+
+    //Reallocate with at least double capacity
+    capacity = Util::Max( capacity * 2, size );
+    buffer = (Uint8*) std::realloc( buffer, capacity );
+  }
+
   void Serializer::State::skip (UintSize size)
   {
+    //Make room for data stored later
+    if (!simulate && offset + size > capacity)
+      grow( offset + size );
+
     //Advance copy offset
     offset += size;
   }
@@ -31,6 +129,10 @@ namespace GE
 
   void Serializer::State::store (const void *from, UintSize size)
   {
+    //Make room for data
+    if (!simulate && offset + size > capacity)
+      grow( offset + size );
+
     if (!simulate)
     {
       //Copy [size] bytes of data to buffer at copy offset
@@ -59,6 +161,24 @@ namespace GE
     return buffer + offset;
   }
 
+  /*
+  Borrowed elements are accessed in place so the payload
+  has to meet the alignment of the element members, which
+  are assumed to be at most 4 bytes wide. */
+
+  bool Serializer::State::IsAligned (const void *p, UintSize eltSize)
+  {
+    UintSize align = eltSize & (~eltSize + 1);
+    if (align > sizeof( Uint32 )) align = sizeof( Uint32 );
+    return ((UintSize) p & (align - 1)) == 0;
+  }
+
+  UintSize Serializer::State::AlignPadding (UintSize offset)
+  {
+    //Bytes from offset to the next aligned one
+    return (GE_SERIAL_ARRAY_ALIGN - (offset % GE_SERIAL_ARRAY_ALIGN)) % GE_SERIAL_ARRAY_ALIGN;
+  }
+
   /*
   ---------------------------------------------------------
   Base Callbacks
@@ -123,9 +243,14 @@ namespace GE
     UintSize size = a->size();
     store( &size, sizeof( UintSize ));
 
-    //Store array elements
-    for (UintSize s=0; s<size; ++s)
-      store( a->at( s ), a->elementSize() );
+    //Pad to the array alignment
+    if (serializer->alignArrays) {
+      static const Uint8 zeros[ GE_SERIAL_ARRAY_ALIGN ] = {0};
+      store( zeros, AlignPadding( offset ));
+    }
+
+    //Store array elements as a single block
+    store( a->buffer(), size * a->elementSize() );
   }
 
   void Serializer::StateSave::string (CharString *s)
@@ -248,13 +373,27 @@ namespace GE
     UintSize size = 0;
     load( &size, sizeof( UintSize ));
 
+    //Skip padding to the array alignment
+    if (serializer->alignArrays)
+      skip( AlignPadding( offset ));
+
+    //Borrow large payloads from the buffer if enabled
+    UintSize bytes = size * a->elementSize();
+    if (serializer->borrowArrays && bytes >= serializer->borrowMinSize &&
+        IsAligned( pointer(), a->elementSize() ))
+    {
+      a->borrow( pointer(), size );
+      serializer->borrowedSize += bytes;
+      skip( bytes );
+      return;
+    }
+
     //Insert array elements
     a->clear();
     a->resize( size );
 
-    //Load array elements
-    for (UintSize s=0; s<size; ++s)
-      data( a->at(s), a->elementSize() );
+    //Load array elements as a single block
+    load( a->buffer(), bytes );
   }
 
   void Serializer::StateLoad::string (CharString *s)
@@ -503,7 +642,7 @@ namespace GE
       load( &size, sizeof( UintSize ));
 
       //Instantiate object
-      Object *p = Serializer::Produce( cid );
+      Object *p = Serializer::Produce( cid, serializer->arena );
 
       //Check for invalid class ID
       if (p == NULL) {
@@ -546,25 +685,64 @@ namespace GE
   High-Level Control
   ---------------------------------------------------------*/
 
+  /*
+  The graph is written in a single run. Object sizes and
+  serial IDs are stored back into space skipped earlier,
+  so the buffer only ever grows past the current offset. */
+
   void Serializer::serialize (Object *root, void **outData, UintSize *outSize)
   {
     //Enter saving state
     state = &stateSave;
     state->serializer = this;
-    
-    //Simulation run
-    state->reset( true, 0, 0 );
+
+    //Start with a growable buffer
+    state->capacity = GE_SERIAL_BUFFER_SIZE;
+    state->buffer = (Uint8*) std::malloc( state->capacity );
+    state->growable = true;
+    state->overflow = false;
+
+    //Run
+    state->reset( false, 0, 0 );
     state->run( &root );
-    
-    //Allocate buffer
+
+    //Trim buffer to data size
     UintSize bufSize = state->offset;
-    state->buffer= (Uint8*) std::malloc( bufSize );
+    state->buffer = (Uint8*) std::realloc( state->buffer, Util::Max( bufSize, (UintSize) 1 ));
     *outData = state->buffer;
     *outSize = bufSize;
-    
-    //Real run
+  }
+
+  bool Serializer::serialize (Object *root, void *data, UintSize size)
+  {
+    //Enter saving state
+    state = &stateSave;
+    state->serializer = this;
+
+    //Write into the given buffer
+    state->capacity = size;
+    state->buffer = (Uint8*) data;
+    state->growable = false;
+    state->overflow = false;
+
+    //Run
     state->reset( false, 0, 0 );
     state->run( &root );
+
+    //Check that everything fit
+    return !state->overflow;
+  }
+
+  UintSize Serializer::measure (Object *root)
+  {
+    //Enter saving state
+    state = &stateSave;
+    state->serializer = this;
+
+    //Simulation run
+    state->reset( true, 0, 0 );
+    state->run( &root );
+    return state->offset;
   }
 
   Object* Serializer::deserialize (const void *data, UintSize size)
@@ -573,6 +751,10 @@ namespace GE
     state = &stateLoad;
     state->serializer = this;
     state->buffer = (Uint8*) data;
+    state->capacity = size;
+    state->growable = false;
+    state->overflow = false;
+    borrowedSize = 0;
 
     //Run
     Object *rootPtr = NULL;
@@ -582,15 +764,32 @@ namespace GE
     return rootPtr;
   }
 
+  /*
+  The buffer passed to deserialize must then outlive the
+  loaded objects and stay writable. Arrays that are not
+  borrowed (small or misaligned) are copied as before. */
+
+  void Serializer::setArrayBorrowing (bool enable, UintSize minSize)
+  {
+    borrowArrays = enable;
+    borrowMinSize = Util::Max( minSize, (UintSize) 1 );
+  }
+
   /*
   --------------------------------------------------
   Signature management
   --------------------------------------------------*/
 
+  /*
+  Packages written with aligned arrays have a signature of
+  their own since the padding changes the data layout. */
+
+  static const UUID sigID = MAKEUUID( b4c0ad4f,1e5b,453e,be8a9bde08a550ab );
+  static const UUID sigAlignedID = MAKEUUID( 6e1f3a2c,d847,4b05,93ea5c27f10b8d46 );
+
   const void* Serializer::getSignature ()
   {
-    static const UUID sigID = MAKEUUID( b4c0ad4f,1e5b,453e,be8a9bde08a550ab );
-    return &sigID;
+    return alignArrays ? &sigAlignedID : &sigID;
   }
 
   UintSize Serializer::getSignatureSize ()
@@ -601,10 +800,28 @@ namespace GE
 
   bool Serializer::checkSignature (const void *data)
   {
-    //Compare data to signature
+    //Compare data to both signatures
     UUID *dataID = (UUID*) data;
-    UUID *sigID = (UUID*) getSignature();
-    return (*dataID == *sigID);
+    if (*dataID == sigID) {
+      alignArrays = false;
+      return true; }
+
+    //Switch to the layout of the package
+    if (*dataID == sigAlignedID) {
+      alignArrays = true;
+      return true; }
+
+    return false;
+  }
+
+  /*
+  --------------------------------------------------
+  Format options
+  --------------------------------------------------*/
+
+  void Serializer::setArrayAlignment (bool enable)
+  {
+    alignArrays = enable;
   }
 
 }//namespace GE
@@ -5,6 +5,15 @@ namespace GE
 {
   #define INVALID_SERIAL_ID 0xFFFFFFFF
 
+  //Smallest array payload borrowed from the load buffer
+  #define GE_SERIAL_BORROW_SIZE 4096
+
+  //Initial size of the growable save buffer
+  #define GE_SERIAL_BUFFER_SIZE 65536
+
+  //Alignment of array payloads in aligned packages
+  #define GE_SERIAL_ARRAY_ALIGN 16
+
   class Serializer
   {
     friend class State;
@@ -40,15 +49,22 @@ namespace GE
       Uint8 *buffer;
       UintSize offset;
       UintSize maxoffset;
+      UintSize capacity;
       bool simulate;
+      bool growable;
+      bool overflow;
       ArrayList< Object* > objMap;
 
+      void grow (UintSize size);
       void skip (UintSize size);
       void store (const void *from, UintSize to, UintSize size);
       void store (const void *from, UintSize size);
       void load (void *to, UintSize size);
       void* pointer();
 
+      static bool IsAligned (const void *p, UintSize eltSize);
+      static UintSize AlignPadding (UintSize offset);
+
       virtual void data (void *p, UintSize size) {}
       virtual void dataPtr (void **pp, UintSize *size) {}
       virtual void dataArray (GenericArrayList *a) {}
@@ -122,8 +138,19 @@ namespace GE
     //Statistics
     ArrayList< Object* > objects;
 
+    //Load options
+    bool borrowArrays;
+    UintSize borrowMinSize;
+    UintSize borrowedSize;
+    ObjectArena *arena;
+
+    //Format options
+    bool alignArrays;
+
   public:
 
+    Serializer ();
+
     void data (void *p, UintSize size);
     void dataPtr (void **pp, UintSize *size);
     void dataArray (GenericArrayList *a);
@@ -155,8 +182,22 @@ namespace GE
     bool loading() { return state == &stateLoad; }
 
     void serialize (Object *root, void **outData, UintSize *outSize);
+    bool serialize (Object *root, void *data, UintSize size);
+    UintSize measure (Object *root);
     Object* deserialize (const void *data, UintSize size);
 
+    //Lets loaded data arrays use the source buffer in place
+    void setArrayBorrowing (bool enable, UintSize minSize = GE_SERIAL_BORROW_SIZE);
+    UintSize getBorrowedSize () { return borrowedSize; }
+
+    //Pads data arrays so they can be borrowed from mapped files
+    void setArrayAlignment (bool enable);
+    bool getArrayAlignment () { return alignArrays; }
+
+    //Places loaded objects in an arena, NULL for the heap
+    void setObjectArena (ObjectArena *a) { arena = a; }
+    ObjectArena* getObjectArena () { return arena; }
+
     const void* getSignature ();
     UintSize getSignatureSize ();
     bool checkSignature (const void *data);
@@ -165,10 +206,20 @@ namespace GE
 
   private:
 
-    //Maps UUID to class
-    typedef std::map< UUID, IFactory* > ClassMap;
-    typedef ClassMap::iterator ClassMapIter;
-    static ClassMap classes;
+    //Open addressing table from UUID to factory
+    struct ClassEntry
+    {
+      UUID id;
+      Uint64 hash;
+      IFactory *factory;
+    };
+
+    static ArrayList< ClassEntry > classes;
+    static ArrayList< Int32 > classSlots;
+
+    static void RehashClasses (UintSize capacity);
+    static Int32 FindClass (const UUID &id, Uint64 hash);
+    static void AddFactory (const UUID &id, Uint64 hash, IFactory *factory);
 
   public:
 
@@ -176,16 +227,11 @@ namespace GE
     template <class C> static void Register ()
     {
       Class c = C::GetClass();
-      classes[ c->uuid() ] = new Factory<C>;
+      AddFactory( c->uuid(), c->hash(), new Factory<C> );
     }
 
     //Produce object matching given UUID
-    static Object* Produce (const UUID &id)
-    {
-      ClassMapIter i = classes.find( id );
-      if (i == classes.end()) return NULL;
-      return i->second->produce();
-    }
+    static Object* Produce (const UUID &id, ObjectArena *arena = NULL);
   };
 
 }//namespace GE
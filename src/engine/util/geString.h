@@ -564,6 +564,18 @@ namespace GE
     bool operator< (const BasicString<CharType> &str) const {
       return compare (str.buf, str.size) == -1;
     }
+
+    /*
+    64-bit FNV-1a hash of the characters for hash tables. */
+
+    Uint64 hash() const
+    {
+      Uint64 h = 0xCBF29CE484222325ull;
+      for (int i=0; i<size; ++i) {
+        h ^= (Uint64) buf[i];
+        h *= 0x100000001B3ull; }
+      return h;
+    }
     
     /*
     Content accessor functions.
@@ -0,0 +1,314 @@
+#include "util/geUtil.h"
+
+#if !defined(WIN32)
+#  include <pthread.h>
+#  include <unistd.h>
+#endif
+
+namespace GE
+{
+  /*
+  ----------------------------------------------
+  Atomic
+  ----------------------------------------------*/
+
+  Int Atomic::Increment (volatile Int *value)
+  {
+    #if defined(WIN32)
+    return (Int) InterlockedIncrement( (volatile LONG*) value );
+    #else
+    return __sync_add_and_fetch( value, 1 );
+    #endif
+  }
+
+  Int Atomic::Decrement (volatile Int *value)
+  {
+    #if defined(WIN32)
+    return (Int) InterlockedDecrement( (volatile LONG*) value );
+    #else
+    return __sync_sub_and_fetch( value, 1 );
+    #endif
+  }
+
+  /*
+  ----------------------------------------------
+  Mutex
+  ----------------------------------------------*/
+
+  Mutex::Mutex ()
+  {
+    #if defined(WIN32)
+    CRITICAL_SECTION *cs = new CRITICAL_SECTION;
+    InitializeCriticalSection( cs );
+    handle = cs;
+    #else
+    pthread_mutex_t *m = new pthread_mutex_t;
+    pthread_mutex_init( m, NULL );
+    handle = m;
+    #endif
+  }
+
+  Mutex::~Mutex ()
+  {
+    #if defined(WIN32)
+    DeleteCriticalSection( (CRITICAL_SECTION*) handle );
+    delete (CRITICAL_SECTION*) handle;
+    #else
+    pthread_mutex_destroy( (pthread_mutex_t*) handle );
+    delete (pthread_mutex_t*) handle;
+    #endif
+  }
+
+  void Mutex::lock ()
+  {
+    #if defined(WIN32)
+    EnterCriticalSection( (CRITICAL_SECTION*) handle );
+    #else
+    pthread_mutex_lock( (pthread_mutex_t*) handle );
+    #endif
+  }
+
+  void Mutex::unlock ()
+  {
+    #if defined(WIN32)
+    LeaveCriticalSection( (CRITICAL_SECTION*) handle );
+    #else
+    pthread_mutex_unlock( (pthread_mutex_t*) handle );
+    #endif
+  }
+
+  /*
+  ----------------------------------------------
+  Semaphore (posix semaphores are not available
+  everywhere so it's built on a condition var)
+  ----------------------------------------------*/
+
+  #if !defined(WIN32)
+  struct SemaphoreData
+  {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    Int count;
+  };
+  #endif
+
+  Semaphore::Semaphore (Int initial)
+  {
+    #if defined(WIN32)
+    handle = CreateSemaphore( NULL, initial, 0x7FFFFFFF, NULL );
+    #else
+    SemaphoreData *data = new SemaphoreData;
+    pthread_mutex_init( &data->mutex, NULL );
+    pthread_cond_init( &data->cond, NULL );
+    data->count = initial;
+    handle = data;
+    #endif
+  }
+
+  Semaphore::~Semaphore ()
+  {
+    #if defined(WIN32)
+    CloseHandle( (HANDLE) handle );
+    #else
+    SemaphoreData *data = (SemaphoreData*) handle;
+    pthread_cond_destroy( &data->cond );
+    pthread_mutex_destroy( &data->mutex );
+    delete data;
+    #endif
+  }
+
+  void Semaphore::wait ()
+  {
+    #if defined(WIN32)
+    WaitForSingleObject( (HANDLE) handle, INFINITE );
+    #else
+    SemaphoreData *data = (SemaphoreData*) handle;
+    pthread_mutex_lock( &data->mutex );
+    while (data->count == 0)
+      pthread_cond_wait( &data->cond, &data->mutex );
+    data->count--;
+    pthread_mutex_unlock( &data->mutex );
+    #endif
+  }
+
+  void Semaphore::post (Int count)
+  {
+    #if defined(WIN32)
+    ReleaseSemaphore( (HANDLE) handle, count, NULL );
+    #else
+    SemaphoreData *data = (SemaphoreData*) handle;
+    pthread_mutex_lock( &data->mutex );
+    data->count += count;
+    pthread_cond_broadcast( &data->cond );
+    pthread_mutex_unlock( &data->mutex );
+    #endif
+  }
+
+  /*
+  ----------------------------------------------
+  Thread
+  ----------------------------------------------*/
+
+  class ThreadEntry
+  {
+  public:
+    #if defined(WIN32)
+    static DWORD WINAPI Main (LPVOID param)
+    #else
+    static void* Main (void *param)
+    #endif
+    {
+      Thread *thread = (Thread*) param;
+      thread->func( thread->param );
+      return 0;
+    }
+  };
+
+  Thread::Thread ()
+  {
+    handle = NULL;
+    func = NULL;
+    param = NULL;
+  }
+
+  Thread::~Thread ()
+  {
+    join();
+  }
+
+  bool Thread::start (ThreadFunc f, void *p)
+  {
+    if (handle != NULL) return false;
+    func = f;
+    param = p;
+
+    #if defined(WIN32)
+    handle = CreateThread( NULL, 0, ThreadEntry::Main, this, 0, NULL );
+    return handle != NULL;
+    #else
+    pthread_t *t = new pthread_t;
+    if (pthread_create( t, NULL, ThreadEntry::Main, this ) != 0) {
+      delete t; return false; }
+    handle = t;
+    return true;
+    #endif
+  }
+
+  void Thread::join ()
+  {
+    if (handle == NULL) return;
+
+    #if defined(WIN32)
+    WaitForSingleObject( (HANDLE) handle, INFINITE );
+    CloseHandle( (HANDLE) handle );
+    #else
+    pthread_join( *((pthread_t*) handle), NULL );
+    delete (pthread_t*) handle;
+    #endif
+
+    handle = NULL;
+  }
+
+  Uint Thread::GetNumCores ()
+  {
+    #if defined(WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo( &info );
+    return Util::Max( (Uint) info.dwNumberOfProcessors, (Uint) 1 );
+    #else
+    long n = sysconf( _SC_NPROCESSORS_ONLN );
+    return n > 0 ? (Uint) n : 1;
+    #endif
+  }
+
+  /*
+  ----------------------------------------------
+  ThreadPool
+  ----------------------------------------------*/
+
+  ThreadPool::ThreadPool (Uint numThreads)
+  {
+    quit = false;
+    jobFunc = NULL;
+    jobParam = NULL;
+    nextJob = 0;
+    numJobs = 0;
+
+    //Default to one thread per core
+    if (numThreads == 0)
+      numThreads = Thread::GetNumCores();
+
+    //Calling thread counts as one of the workers
+    for (Uint t=1; t<numThreads; ++t)
+    {
+      Thread *thread = new Thread;
+      thread->start( ThreadPool::WorkerMain, this );
+      threads.pushBack( thread );
+    }
+  }
+
+  ThreadPool::~ThreadPool ()
+  {
+    //Wake all the workers and let them exit
+    quit = true;
+    startSignal.post( (Int) threads.size() );
+
+    for (UintSize t=0; t<threads.size(); ++t)
+      delete threads[ t ];
+  }
+
+  Uint ThreadPool::getNumThreads ()
+  {
+    return (Uint) threads.size() + 1;
+  }
+
+  void ThreadPool::WorkerMain (void *param)
+  {
+    ThreadPool *pool = (ThreadPool*) param;
+    while (true)
+    {
+      pool->startSignal.wait();
+      if (pool->quit) break;
+
+      pool->runJobs();
+      pool->doneSignal.post();
+    }
+  }
+
+  void ThreadPool::runJobs ()
+  {
+    //Grab jobs one by one until none left
+    while (true)
+    {
+      Int job = Atomic::Increment( &nextJob ) - 1;
+      if (job >= numJobs) break;
+      jobFunc( (UintSize) job, jobParam );
+    }
+  }
+
+  void ThreadPool::parallelFor (UintSize count, JobFunc func, void *param)
+  {
+    //Run inline if there's nothing to distribute
+    if (threads.empty() || count <= 1)
+    {
+      for (UintSize j=0; j<count; ++j)
+        func( j, param );
+      return;
+    }
+
+    //Setup job range
+    jobFunc = func;
+    jobParam = param;
+    numJobs = (Int) count;
+    nextJob = 0;
+
+    //Wake workers and help them out
+    startSignal.post( (Int) threads.size() );
+    runJobs();
+
+    //Wait for all the workers to finish
+    for (UintSize t=0; t<threads.size(); ++t)
+      doneSignal.wait();
+  }
+
+}//namespace GE
@@ -0,0 +1,114 @@
+#ifndef __GETHREAD_H
+#define __GETHREAD_H
+
+namespace GE
+{
+  /*
+  ----------------------------------------------
+  Atomic integer operations
+  ----------------------------------------------*/
+
+  class Atomic
+  {
+  public:
+    static Int Increment (volatile Int *value);
+    static Int Decrement (volatile Int *value);
+  };
+
+  /*
+  ----------------------------------------------
+  Mutual exclusion lock
+  ----------------------------------------------*/
+
+  class Mutex
+  {
+  private:
+    void *handle;
+
+  public:
+    Mutex ();
+    ~Mutex ();
+
+    void lock ();
+    void unlock ();
+  };
+
+  /*
+  ----------------------------------------------
+  Counting semaphore
+  ----------------------------------------------*/
+
+  class Semaphore
+  {
+  private:
+    void *handle;
+
+  public:
+    Semaphore (Int initial = 0);
+    ~Semaphore ();
+
+    void wait ();
+    void post (Int count = 1);
+  };
+
+  /*
+  ----------------------------------------------
+  Native thread running a single function
+  ----------------------------------------------*/
+
+  typedef void (*ThreadFunc) (void *param);
+
+  class Thread
+  {
+    friend class ThreadEntry;
+
+  private:
+    void *handle;
+    ThreadFunc func;
+    void *param;
+
+  public:
+    Thread ();
+    ~Thread ();
+
+    bool start (ThreadFunc func, void *param);
+    void join ();
+
+    static Uint GetNumCores ();
+  };
+
+  /*
+  ---------------------------------------------------
+  A pool of worker threads that executes a range of
+  independent jobs. The calling thread takes part in
+  the work and returns when all the jobs are done.
+  ---------------------------------------------------*/
+
+  typedef void (*JobFunc) (UintSize index, void *param);
+
+  class ThreadPool
+  {
+  private:
+    ArrayList< Thread* > threads;
+    Semaphore startSignal;
+    Semaphore doneSignal;
+    bool quit;
+
+    JobFunc jobFunc;
+    void *jobParam;
+    volatile Int nextJob;
+    Int numJobs;
+
+    static void WorkerMain (void *param);
+    void runJobs ();
+
+  public:
+    ThreadPool (Uint numThreads = 0);
+    ~ThreadPool ();
+
+    Uint getNumThreads ();
+    void parallelFor (UintSize count, JobFunc func, void *param);
+  };
+
+}//namespace GE
+#endif//__GETHREAD_H
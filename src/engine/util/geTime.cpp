@@ -15,7 +15,7 @@ namespace GE
     gettimeofday(&t, NULL);
     
     Time::sec = t.tv_sec;
-    Time::msec = t.tv_usec;
+    Time::msec = t.tv_usec / 1000;
     #endif
   }
   
@@ -28,10 +28,24 @@ namespace GE
     gettimeofday(&t, NULL);
     
     int seconds = t.tv_sec - Time::sec;
-    int mseconds = (t.tv_usec / 1000);
-    if (mseconds < Time::msec) seconds--;
+    int mseconds = (t.tv_usec / 1000) - Time::msec;
     
     return seconds*1000 + mseconds;
     #endif
   }
+
+  Uint64 Time::GetMicroseconds()
+  {
+    #if defined(WIN32)
+    LARGE_INTEGER freq, count;
+    QueryPerformanceFrequency( &freq );
+    QueryPerformanceCounter( &count );
+    return (Uint64) (count.QuadPart / freq.QuadPart) * 1000000 +
+      (Uint64) (count.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart;
+    #else
+    struct timespec t;
+    clock_gettime( CLOCK_MONOTONIC, &t );
+    return (Uint64) t.tv_sec * 1000000 + (Uint64) t.tv_nsec / 1000;
+    #endif
+  }
 }
@@ -13,6 +13,9 @@ namespace GE
   public:
     static void ResetTicks();
     static int GetTicks();
+
+    //Monotonic clock for measuring short intervals
+    static Uint64 GetMicroseconds();
   };
 };
 
@@ -10,10 +10,12 @@
 #include "util/geHeapArrayList.h"
 #include "util/geLinkedList.h"
 #include "util/geString.h"
+#include "util/geObjectArena.h"
 #include "util/geObject.h"
 #include "util/geSerializer.h"
 #include "util/geTextParser.h"
 #include "util/geTime.h"
+#include "util/geThread.h"
 
 
 #endif//__GEUTIL_H
@@ -146,6 +146,10 @@ public:
 
 File getProjectFolder ();
 Float getWorldScale ();
+Float getAnimToleranceR ();
+Float getAnimToleranceT ();
+bool getAnimCompress ();
+bool getExportLods ();
 void trace( const CharString &s);
 void setStatus (const CharString &msg);
 void clearStatus ();
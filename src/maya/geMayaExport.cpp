@@ -1807,6 +1807,44 @@ void exportAnimClip (const MDagPath objPath,
     outTrackT->addKey( keyT );
   }
 }
+/*
+------------------------------------------------------------
+Reduce baked animation keys and store them quantized
+------------------------------------------------------------*/
+
+void compressAnimKeys (Animation *anim)
+{
+  if (!getAnimCompress()) return;
+
+  //Count baked keys
+  UintSize numBaked = 0;
+  for (UintSize t=0; t<anim->getNumTracks(); ++t)
+  {
+    AnimTrack *track = anim->getTrack( t );
+    if (ClassOf( track ) == ClassName( QuatAnimTrack ) ||
+        ClassOf( track ) == ClassName( Vec3AnimTrack ))
+      numBaked += track->getNumKeys();
+  }
+
+  AnimCompress::CompressAnimation( anim,
+    getAnimToleranceR(), getAnimToleranceT() );
+
+  //Count stored keys
+  UintSize numStored = 0;
+  for (UintSize t=0; t<anim->getNumTracks(); ++t)
+  {
+    AnimTrack *track = anim->getTrack( t );
+    if (ClassOf( track ) == ClassName( CompactQuatAnimTrack ))
+      numStored += ((CompactQuatAnimTrack*) track)->getNumStoredKeys();
+    else if (ClassOf( track ) == ClassName( CompactVec3AnimTrack ))
+      numStored += ((CompactVec3AnimTrack*) track)->getNumStoredKeys();
+  }
+
+  trace( "compressAnimKeys: reduced "
+    + CharString::FInt( (int) numBaked ) + " keys to "
+    + CharString::FInt( (int) numStored ) + "." );
+}
+
 /*
 class Test : public AnimObserver
 {
@@ -1932,6 +1970,7 @@ Animation* exportAnimation (int kps, MayaAnimDummy *anim)
     outAnim->addEvent( outEvt );
   }
 
+  compressAnimKeys( outAnim );
   return outAnim;
 }
 
@@ -2042,6 +2081,7 @@ Animation* exportSkinAnimation (int start, int end, int fps)
   //Export animation
   Animation *outAnim = new Animation;
   exportAnimKeys( nodeTree, start, end, fps, outAnim );
+  compressAnimKeys( outAnim );
 
   return outAnim;
 }
@@ -2115,13 +2155,18 @@ Character* exportCharacter (const MObject &meshNode, bool tangents)
   SkinSuperToSubMesh splitter( outTriMesh );
   splitter.splitByBoneLimit( 24 );
 
+  //Levels of detail per sub-mesh keep its joint palette
   UintSize numMeshes = splitter.getSubMeshCount();
+  ThreadPool *pool = getExportLods() ? new ThreadPool : NULL;
   for (UintSize m=0; m<numMeshes; ++m)
   {
     SkinTriMesh *mesh = (SkinTriMesh*) splitter.getSubMesh(m);
     mesh->updateBoundingBox();
+    mesh->optimize( true );
+    if (pool != NULL) mesh->buildLods( GE_TRIMESH_NUM_LODS, 0.5f, pool );
     character->meshes.pushBack( mesh );
   }
+  delete pool;
 
   trace( "exportCharacter: Generated " + CharString::FInt( (int)numMeshes ) + " sub-meshes." );
 
@@ -2156,5 +2201,12 @@ TriMesh* exportMesh (const MObject &meshNode, bool tangents)
   meshExporter.exportMesh( meshNode );
 
   outTriMesh->updateBoundingBox();
+  outTriMesh->optimize( true );
+
+  //Levels of detail, none when the mesh has tangents
+  if (getExportLods()) {
+    ThreadPool pool;
+    outTriMesh->buildLods( GE_TRIMESH_NUM_LODS, 0.5f, &pool ); }
+
   return outTriMesh;
 }
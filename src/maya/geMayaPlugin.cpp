@@ -11,6 +11,7 @@
 
 bool g_chkExportSkin = false;
 bool g_chkExportTangents = false;
+bool g_chkExportLods = true;
 CharString g_outFileName;
 CharString g_skinFileName;
 CharString g_statusText;
@@ -22,6 +23,9 @@ std::map< std::string, Actor3D* > g_mapNameToActor;
 CharString g_sceneFileName;
 MayaSceneDummy *g_scene = NULL;
 Float g_worldScale = 1.0f;
+bool g_chkCompressAnim = true;
+Float g_animToleranceR = 0.0005f;
+Float g_animToleranceT = 0.0005f;
 
 /*
 ---------------------------------------
@@ -85,6 +89,43 @@ CharString getTextFieldText (const CharString &textField)
   return result.asChar();
 }
 
+/*
+Tolerances are read from the GUI when present, the last
+valid value is kept when the field doesn't parse. */
+
+Float readToleranceField (const CharString &textField, Float *tolerance)
+{
+  CharString str = getTextFieldText( textField );
+  if (str.length() == 0) return *tolerance;
+
+  int len = 0;
+  Float value = str.parseFloatAt( 0, &len );
+  if (len > 0 && value >= 0.0f)
+    *tolerance = value;
+
+  return *tolerance;
+}
+
+Float getAnimToleranceR ()
+{
+  return readToleranceField( "GTxtAnimTolR", &g_animToleranceR );
+}
+
+Float getAnimToleranceT ()
+{
+  return readToleranceField( "GTxtAnimTolT", &g_animToleranceT );
+}
+
+bool getAnimCompress ()
+{
+  return g_chkCompressAnim;
+}
+
+bool getExportLods ()
+{
+  return g_chkExportLods;
+}
+
 void setStatus (const CharString &msg)
 {
   g_statusText += msg + "\\n";
@@ -314,7 +355,7 @@ void findExportableNodesInSelection (ArrayList< MDagPath > &outPaths)
   findNodesInSelection( MFn::kCamera, outPaths );
 }
 
-bool writePackageFile (void *data, UintSize size, File &file)
+bool writePackageFile (Serializer &s, void *data, UintSize size, File &file)
 {
   //Create missing directories
   if (!file.createPath())
@@ -326,8 +367,7 @@ bool writePackageFile (void *data, UintSize size, File &file)
     return false;
   }
   
-  //Write data
-  Serializer s;
+  //Write data with the signature of its layout
   file.write( s.getSignature(), s.getSignatureSize() );
   file.write( data, size );
   file.close();
@@ -424,6 +464,56 @@ class CmdTangentsOff : public MPxCommand
   }
 };
 
+/*
+------------------------------------------
+Command for the "Export LODs" checkbox
+------------------------------------------*/
+
+class CmdLodsOn : public MPxCommand
+{ public:
+  static void *creator() { return new CmdLodsOn; }
+  virtual MStatus doIt (const MArgList &args)
+  {
+    g_chkExportLods = true;
+    return MStatus::kSuccess;
+  }
+};
+
+class CmdLodsOff : public MPxCommand
+{ public:
+  static void *creator() { return new CmdLodsOff; }
+  virtual MStatus doIt (const MArgList &args)
+  {
+    g_chkExportLods = false;
+    return MStatus::kSuccess;
+  }
+};
+
+/*
+------------------------------------------
+Command for the "Compress keys" checkbox
+------------------------------------------*/
+
+class CmdCompressOn : public MPxCommand
+{ public:
+  static void *creator() { return new CmdCompressOn; }
+  virtual MStatus doIt (const MArgList &args)
+  {
+    g_chkCompressAnim = true;
+    return MStatus::kSuccess;
+  }
+};
+
+class CmdCompressOff : public MPxCommand
+{ public:
+  static void *creator() { return new CmdCompressOff; }
+  virtual MStatus doIt (const MArgList &args)
+  {
+    g_chkCompressAnim = false;
+    return MStatus::kSuccess;
+  }
+};
+
 /*
 --------------------------------------------
 Command for browsing the output file
@@ -492,11 +582,12 @@ public:
 
     //Serialize and free data
     Serializer s;
+    s.setArrayAlignment( true );
     s.serialize( res, &outData, &outSize );
     delete res;
 
     //Write to file
-    if (! writePackageFile( outData, outSize, File( outFileName ) ))
+    if (! writePackageFile( s, outData, outSize, File( outFileName ) ))
       return MStatus::kFailure;
 
     setStatus( "Done." );
@@ -799,14 +890,16 @@ public:
       scene->animations.pushBack( outAnim );
     }
 
-    //Export scene data
+    //Export scene data with resources in blobs of their own
     void *outData = NULL;
     UintSize outSize = 0;
-    Serializer s;
-    s.serialize( scene, &outData, &outSize );
+    ScenePackage::Write( scene, &outData, &outSize );
 
     //Write to file
-    writePackageFile( outData, outSize, outFile );
+    if (outFile.createPath() && outFile.open( FileAccess::Write, FileCondition::Truncate )) {
+      outFile.write( outData, outSize );
+      outFile.close(); }
+    else trace( "Export: failed opening output file for writing!" );
     std::free( outData );
 
     setStatus( "Done." );
@@ -1100,6 +1193,7 @@ class CmdSaveChar : public MPxCommand
 
     //Export character
     Serializer s; void *outData; UintSize outSize=0;
+    s.setArrayAlignment( true );
     s.serialize( g_character, &outData, &outSize );
     
     //Make sure something was actually exported
@@ -1499,6 +1593,7 @@ class CmdSceneSave : public MPxCommand
   {
     //Export scene
     Serializer s; void *outData; UintSize outSize=0;
+    s.setArrayAlignment( true );
     s.serialize( g_scene, &outData, &outSize );
     
     //Make sure something was actually exported
@@ -1508,7 +1603,7 @@ class CmdSceneSave : public MPxCommand
     }
 
     //Open output file for writing
-    if (!writePackageFile( outData, outSize, file )) {
+    if (!writePackageFile( s, outData, outSize, file )) {
       setStatus( "Failed writing to file." );
       return MStatus::kFailure;
     }
@@ -2029,9 +2124,20 @@ class CmdRestoreGui : public MPxCommand
     if (g_chkExportTangents)
       MGlobal::executeCommand( "checkBox -edit -value true GChkTangents" );
 
+    if (!g_chkExportLods)
+      MGlobal::executeCommand( "checkBox -edit -value false GChkLods" );
+
     if (g_outFileName.length() > 0)
       setTextFieldText( "GTxtFile", g_outFileName );
 
+    //Animation keys
+
+    if (!g_chkCompressAnim)
+      MGlobal::executeCommand( "checkBox -edit -value false GChkCompress" );
+
+    setTextFieldText( "GTxtAnimTolR", CharString::FFloat( g_animToleranceR ));
+    setTextFieldText( "GTxtAnimTolT", CharString::FFloat( g_animToleranceT ));
+
     //Animation
 
     if (g_animation != NULL)
@@ -2090,6 +2196,10 @@ MStatus initializePlugin ( MObject obj )
   plugin.registerCommand( "GCmdSkinOff", CmdSkinOff::creator );
   plugin.registerCommand( "GCmdTangentsOn", CmdTangentsOn::creator );
   plugin.registerCommand( "GCmdTangentsOff", CmdTangentsOff::creator );
+  plugin.registerCommand( "GCmdLodsOn", CmdLodsOn::creator );
+  plugin.registerCommand( "GCmdLodsOff", CmdLodsOff::creator );
+  plugin.registerCommand( "GCmdCompressOn", CmdCompressOn::creator );
+  plugin.registerCommand( "GCmdCompressOff", CmdCompressOff::creator );
   plugin.registerCommand( "GCmdBrowseFile", CmdBrowseFile::creator );
   plugin.registerCommand( "GCmdBrowseSkinFile", CmdBrowseSkinFile::creator );
   plugin.registerCommand( "GCmdProcessAnim", CmdProcessAnim::creator );
@@ -2157,6 +2267,10 @@ MStatus uninitializePlugin( MObject obj)
   plugin.deregisterCommand( "GCmdSkinOff" );
   plugin.deregisterCommand( "GCmdTangentsOn" );
   plugin.deregisterCommand( "GCmdTangentsOff" );
+  plugin.deregisterCommand( "GCmdLodsOn" );
+  plugin.deregisterCommand( "GCmdLodsOff" );
+  plugin.deregisterCommand( "GCmdCompressOn" );
+  plugin.deregisterCommand( "GCmdCompressOff" );
   plugin.deregisterCommand( "GCmdBrowseFile" );
   plugin.deregisterCommand( "GCmdBrowseSkinFile" );
   plugin.deregisterCommand( "GCmdProcessAnim" );
@@ -26,6 +26,7 @@ global proc GCmdOpen()
   frameLayout -label "Static Mesh \\ Skin Pose" -bv true -bs "etchedIn" -mh 10 -mw 10 -collapsable true -collapse true; 
   columnLayout -columnAlign "left" -adjustableColumn true -rs 2 GColPose; 
     checkBox -label "Export tangents" -onCommand "GCmdTangentsOn" -offCommand "GCmdTangentsOff" GChkTangents;
+    checkBox -label "Export LODs" -value true -onCommand "GCmdLodsOn" -offCommand "GCmdLodsOff" GChkLods;
     checkBox -label "Export with skin" -onCommand "GCmdSkinOn" -offCommand "GCmdSkinOff" GChkSkin; 
     separator -height 10 -style "none"; 
     text -label "File name:"; 
@@ -39,6 +40,20 @@ global proc GCmdOpen()
     button -label "Export" -align "center" -command "GCmdExport"; 
     button -label "Export All" -align "center" -command "GCmdExportAll";
     
+  setParent GColMain; 
+  frameLayout -label "Animation Keys" -bv true -bs "etchedIn" -mh 10 -mw 10 -collapsable true -collapse true;
+  columnLayout -columnAlign "left" -adjustableColumn true -rs 2 GColAnimKeys; 
+    checkBox -label "Compress keys" -value true -onCommand "GCmdCompressOn" -offCommand "GCmdCompressOff" GChkCompress;
+    
+    rowLayout -nc 2 -adj 2 -cw 1 70 -cat 1 "both" 0; 
+    text -label "Rot. error:"; 
+    textField -text "0.0005" GTxtAnimTolR; 
+    
+    setParent GColAnimKeys; 
+    rowLayout -nc 2 -adj 2 -cw 1 70 -cat 1 "both" 0; 
+    text -label "Pos. error:"; 
+    textField -text "0.0005" GTxtAnimTolT; 
+    
   setParent GColMain; 
   frameLayout -label "New Animation" -bv true -bs "etchedIn" -mh 10 -mw 10 -collapsable true -collapse true;
   columnLayout -columnAlign "left" -adjustableColumn true -rs 2 GColNewAnim; 
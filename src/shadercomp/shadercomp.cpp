@@ -0,0 +1,74 @@
+#include "util/geUtil.h"
+#include "core/geShaderComposer.h"
+using namespace GE;
+
+#include <cstdio>
+#include <cstring>
+
+/*
+-----------------------------------------------------------
+Composes the shader permutations of all the engine's
+geometry and material classes for the GBuffer and shadow
+map targets without a GL context and writes the sources
+into the cache file the renderer loads at startup. Entries
+of an existing cache file are kept unless recomposed.
+-----------------------------------------------------------*/
+
+const char* targetName (RenderTarget::Enum target)
+{
+  switch (target) {
+  case RenderTarget::GBuffer: return "GBuffer";
+  case RenderTarget::ShadowMap: return "ShadowMap";
+  default: return "Lighting"; }
+}
+
+int main (int argc, char **argv)
+{
+  const char *filename = GE_SHADER_CACHE_FILE;
+  bool verbose = false;
+
+  for (int a=1; a<argc; ++a)
+  {
+    if (strcmp( argv[a], "-v" ) == 0) verbose = true;
+    else if (argv[a][0] == '-') {
+      fprintf( stderr, "Usage: shadercomp [-v] [OUTPUT]\n" );
+      return 1; }
+    else filename = argv[a];
+  }
+
+  ShaderComposer composer;
+  composer.addDefaults();
+
+  ShaderSourceCache cache;
+  cache.load( filename );
+  UintSize numOld = cache.size();
+
+  //Compose every permutation
+  ShaderKey key;
+  ShaderSource source;
+  UintSize numFailed = 0;
+
+  for (UintSize p=0; p<composer.getNumPermutations(); ++p)
+  {
+    if (!composer.composePermutation( p, key, source )) {
+      numFailed++;
+      continue; }
+
+    cache.store( source.permutation, source.compose, source.vertex, source.fragment );
+
+    printf( "%016llx  %-9s  %-16s  %s\n", (unsigned long long) key.hash, targetName( key.target ),
+            key.geomClass->name().buffer(), key.matClass->name().buffer() );
+
+    if (verbose) {
+      printf( "%s\n", source.vertex.buffer() );
+      printf( "%s\n", source.fragment.buffer() ); }
+  }
+
+  if (!cache.save( filename ))
+    return 1;
+
+  printf( "Wrote %d permutations to %s (%d cached before, %d failed)\n",
+          (int) cache.size(), filename, (int) numOld, (int) numFailed );
+
+  return (numFailed == 0) ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of compact animation tracks. Bakes a
+synthetic clip, reduces and quantizes it, then reports
+memory, error and pose sampling throughput of both.
+-----------------------------------------------------------*/
+
+UintSize numJoints = 64;
+UintSize numKeys = 480;
+UintSize numSamples = 100000;
+Float toleranceR = 0.0005f;
+Float toleranceT = 0.0005f;
+
+Animation* createAnimation ()
+{
+  Animation *anim = new Animation;
+  anim->name = "Walk";
+  anim->kps = 24;
+  anim->duration = (Float) (numKeys - 1) / anim->kps;
+
+  for (UintSize j=0; j<numJoints; ++j)
+  {
+    QuatAnimTrack *trackR = new QuatAnimTrack;
+    Vec3AnimTrack *trackT = new Vec3AnimTrack;
+
+    //Smooth motion with a per-joint phase, like a baked cycle
+    Float phase = (Float) j * 0.37f;
+    for (UintSize k=0; k<numKeys; ++k)
+    {
+      Float t = (Float) k / anim->kps;
+      Quat r; r.fromAxisAngle( 0.0f, 1.0f, 0.0f, 0.6f * SIN( 2.0f * t + phase ));
+      Quat s; s.fromAxisAngle( 1.0f, 0.0f, 0.0f, 0.3f * SIN( 3.0f * t + phase ));
+      trackR->addKey( r * s );
+      trackT->addKey( Vector3( 0.0f, 1.0f + 0.05f * SIN( 4.0f * t ), 0.1f * t ));
+    }
+
+    anim->addTrack( trackR );
+    anim->addTrack( trackT );
+  }
+
+  return anim;
+}
+
+UintSize getRawMemory (Animation *anim)
+{
+  UintSize size = 0;
+  for (UintSize t=0; t<anim->getNumTracks(); ++t)
+  {
+    AnimTrack *track = anim->getTrack( t );
+    size += track->getNumKeys() * track->getValueSize();
+  }
+  return size;
+}
+
+/*
+Tracks that couldn't be compressed count at full size. */
+
+UintSize getCompactMemory (Animation *anim, UintSize *outKeys, UintSize *outFull)
+{
+  UintSize size = 0;
+  *outKeys = 0;
+  *outFull = 0;
+
+  for (UintSize t=0; t<anim->getNumTracks(); ++t)
+  {
+    AnimTrack *track = anim->getTrack( t );
+    if (ClassOf( track ) == ClassName( CompactQuatAnimTrack )) {
+      size += ((CompactQuatAnimTrack*) track)->getMemorySize();
+      *outKeys += ((CompactQuatAnimTrack*) track)->getNumStoredKeys(); }
+    else if (ClassOf( track ) == ClassName( CompactVec3AnimTrack )) {
+      size += ((CompactVec3AnimTrack*) track)->getMemorySize();
+      *outKeys += ((CompactVec3AnimTrack*) track)->getNumStoredKeys(); }
+    else {
+      size += track->getNumKeys() * track->getValueSize();
+      *outKeys += track->getNumKeys();
+      *outFull += 1; }
+  }
+  return size;
+}
+
+void measureError (Animation *raw, Animation *compact, Float *outErrR, Float *outErrT)
+{
+  AnimPose poseRaw, poseCompact;
+  *outErrR = 0.0f;
+  *outErrT = 0.0f;
+
+  //Compare at frames and in between them
+  for (UintSize s=0; s<numKeys*4; ++s)
+  {
+    Float time = raw->duration * (Float) s / (Float) (numKeys*4 - 1);
+    raw->sample( time, &poseRaw );
+    compact->sample( time, &poseCompact );
+
+    for (UintSize j=0; j<numJoints; ++j)
+    {
+      //Angle from the chord, the cosine of small ones rounds to 1
+      Quat r1 = *((Quat*) poseRaw.getValue( 2*j+0 ));
+      Quat r2 = *((Quat*) poseCompact.getValue( 2*j+0 ));
+      Float s = (Quat::Dot( r1, r2 ) < 0.0f) ? -1.0f : 1.0f;
+      Float dx = r1.x - s * r2.x, dy = r1.y - s * r2.y;
+      Float dz = r1.z - s * r2.z, dw = r1.w - s * r2.w;
+      Float chord = SQRT( dx*dx + dy*dy + dz*dz + dw*dw );
+      *outErrR = Util::Max( *outErrR, 4.0f * ASIN( Util::Min( 0.5f * chord, 1.0f )));
+
+      Vector3 t1 = *((Vector3*) poseRaw.getValue( 2*j+1 ));
+      Vector3 t2 = *((Vector3*) poseCompact.getValue( 2*j+1 ));
+      *outErrT = Util::Max( *outErrT, (t1 - t2).norm() );
+    }
+  }
+}
+
+Float measureThroughput (Animation *anim)
+{
+  AnimPose pose;
+  Time::ResetTicks();
+
+  for (UintSize s=0; s<numSamples; ++s)
+  {
+    Float time = anim->duration * (Float) (s % 997) / 997.0f;
+    anim->sample( time, &pose );
+  }
+
+  int ms = Util::Max( Time::GetTicks(), 1 );
+  return (Float) numSamples / (Float) ms;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) toleranceR = (Float) atof( argv[1] );
+  if (argc > 2) toleranceT = (Float) atof( argv[2] );
+
+  Animation *raw = createAnimation();
+  Animation *compact = createAnimation();
+  AnimCompress::CompressAnimation( compact, toleranceR, toleranceT );
+
+  printf( "Joints: %d, Keys: %d, Tolerance: %f rad / %f units\n",
+          (int) numJoints, (int) numKeys, toleranceR, toleranceT );
+
+  //Memory
+  UintSize storedKeys = 0;
+  UintSize fullTracks = 0;
+  UintSize rawBytes = getRawMemory( raw );
+  UintSize compactBytes = getCompactMemory( compact, &storedKeys, &fullTracks );
+  printf( "Raw:     %8d bytes  %8d keys\n", (int) rawBytes, (int) (numKeys * numJoints * 2) );
+  printf( "Compact: %8d bytes  %8d keys  (%.1f%%)\n", (int) compactBytes, (int) storedKeys,
+          100.0f * (Float) compactBytes / (Float) rawBytes );
+  printf( "Full precision: %d of %d tracks\n", (int) fullTracks, (int) compact->getNumTracks() );
+
+  //Error
+  Float errR, errT;
+  measureError( raw, compact, &errR, &errT );
+  printf( "Max error: %f rad, %f units\n", errR, errT );
+
+  //Throughput
+  printf( "Raw:     %10.2f poses/ms\n", measureThroughput( raw ));
+  printf( "Compact: %10.2f poses/ms\n", measureThroughput( compact ));
+
+  delete raw;
+  delete compact;
+  return EXIT_SUCCESS;
+}
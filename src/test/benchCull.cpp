@@ -0,0 +1,212 @@
+#include "util/geUtil.h"
+#include "math/geMath.h"
+#include "math/geBoxTree.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of frustum culling. Scatters boxes over
+a square level and culls them against a camera frustum
+with the scalar corner test, the SoA batch test and the
+bounding volume hierarchy. Also compares sphere and ray
+queries through the hierarchy with linear scans.
+-----------------------------------------------------------*/
+
+Float RandomRange (Float min, Float max)
+{
+  return min + (max - min) * ((Float) rand() / (Float) RAND_MAX);
+}
+
+void createBoxes (UintSize count, BoxArray &boxes)
+{
+  //Keep density constant so the visible count scales too
+  Float side = SQRT( (Float) count ) * 4.0f;
+  boxes.clear();
+
+  for (UintSize b=0; b<count; ++b)
+  {
+    Vector3 center( RandomRange( -side, side ), RandomRange( 0.0f, 20.0f ), RandomRange( -side, side ));
+    Vector3 extent( RandomRange( 0.5f, 2.0f ), RandomRange( 0.5f, 4.0f ), RandomRange( 0.5f, 2.0f ));
+    boxes.add( center - extent, center + extent );
+  }
+}
+
+Frustum createFrustum ()
+{
+  //Camera at the center of the level looking along +Z
+  Matrix4x4 proj;
+  proj.setPerspectiveFovLH( Util::DegToRad( 60.0f ), 16.0f / 9.0f, 1.0f, 500.0f );
+
+  Matrix4x4 view;
+  view.setTranslation( 0.0f, -10.0f, 0.0f );
+
+  Frustum f;
+  f.fromMatrix( proj * view );
+  return f;
+}
+
+UintSize cullCorners (const Frustum &f, const BoxArray &boxes, Uint8 *visible)
+{
+  UintSize count = 0;
+  for (UintSize b=0; b<boxes.size(); ++b)
+  {
+    Vector3 c = boxes.getCenter( b );
+    Vector3 e = boxes.getExtent( b );
+    BoundingBox bbox;
+    bbox.min = c - e;
+    bbox.max = c + e;
+
+    Vector3 corners[8];
+    bbox.getCorners( corners );
+    visible[b] = (f.testBox( corners ) == Frustum::Outside) ? 0 : 1;
+    count += visible[b];
+  }
+  return count;
+}
+
+UintSize cullBatch (const Frustum &f, const BoxArray &boxes, Uint8 *visible)
+{
+  boxes.cullFrustum( f, 0, boxes.size(), visible );
+
+  UintSize count = 0;
+  for (UintSize b=0; b<boxes.size(); ++b)
+    count += visible[b];
+  return count;
+}
+
+UintSize cullTree (const Frustum &f, BoxTree &tree, Uint8 *visible, UintSize size)
+{
+  memset( visible, 0, size );
+  tree.cullFrustum( f, visible );
+
+  UintSize count = 0;
+  for (UintSize b=0; b<size; ++b)
+    count += visible[b];
+  return count;
+}
+
+UintSize queryLinear (const BoxQuery &q, const BoxArray &boxes, ArrayList<Uint32> &items)
+{
+  items.clear();
+  boxes.query( q, items );
+  return items.size();
+}
+
+UintSize queryTree (const BoxQuery &q, const BoxTree &tree, ArrayList<Uint32> &items)
+{
+  items.clear();
+  tree.query( q, items );
+  return items.size();
+}
+
+int main (int argc, char **argv)
+{
+  UintSize sizes[] = { 10000, 100000, 1000000 };
+  UintSize numSizes = 3;
+  UintSize workload = 20000000;
+
+  if (argc > 1) {
+    sizes[0] = (UintSize) atoi( argv[1] );
+    numSizes = 1; }
+
+  Frustum frustum = createFrustum();
+
+  for (UintSize s=0; s<numSizes; ++s)
+  {
+    UintSize count = sizes[s];
+    UintSize repeat = Util::Max( workload / count, (UintSize) 1 );
+
+    BoxArray boxes;
+    createBoxes( count, boxes );
+    Uint8 *visible = new Uint8[ count ];
+
+    //Build hierarchy
+    BoxTree tree;
+    Time::ResetTicks();
+    tree.build( boxes );
+    int buildMs = Time::GetTicks();
+
+    //Refit to unchanged boxes keeps the results intact
+    Time::ResetTicks();
+    tree.refit( boxes );
+    int refitMs = Time::GetTicks();
+
+    //Scalar corner test
+    UintSize visCorners = 0;
+    Time::ResetTicks();
+    for (UintSize r=0; r<repeat; ++r)
+      visCorners = cullCorners( frustum, boxes, visible );
+    Float msCorners = (Float) Time::GetTicks() / repeat;
+
+    //SoA batch test
+    UintSize visBatch = 0;
+    Time::ResetTicks();
+    for (UintSize r=0; r<repeat; ++r)
+      visBatch = cullBatch( frustum, boxes, visible );
+    Float msBatch = (Float) Time::GetTicks() / repeat;
+
+    //Hierarchy
+    UintSize visTree = 0;
+    Time::ResetTicks();
+    for (UintSize r=0; r<repeat; ++r)
+      visTree = cullTree( frustum, tree, visible, count );
+    Float msTree = (Float) Time::GetTicks() / repeat;
+
+    printf( "Boxes: %8d  Visible: %7d  Nodes: %7d  Build: %5d ms  Refit: %4d ms\n",
+            (int) count, (int) visTree, (int) tree.getNumNodes(), buildMs, refitMs );
+    printf( "  Corners: %9.3f ms  (visible %d)\n", msCorners, (int) visCorners );
+    printf( "  Batch:   %9.3f ms  (visible %d)\n", msBatch, (int) visBatch );
+    printf( "  Tree:    %9.3f ms  (visible %d)\n", msTree, (int) visTree );
+
+    //Sphere and ray queries, linear against hierarchy
+    ArrayList<Uint32> items;
+    SphereQuery sphere( Vector3( 0.0f, 10.0f, 0.0f ), 50.0f );
+    RayQuery ray( Vector3( -SQRT( (Float) count ) * 4.0f, 5.0f, 0.0f ), Vector3( 1.0f, 0.0f, 0.0f ), 1e10f );
+    const BoxQuery *queries[2] = { &sphere, &ray };
+    const char *names[2] = { "Sphere", "Ray" };
+
+    for (int q=0; q<2; ++q)
+    {
+      UintSize hitsLinear = 0, hitsTree = 0;
+      Time::ResetTicks();
+      for (UintSize r=0; r<repeat; ++r)
+        hitsLinear = queryLinear( *queries[q], boxes, items );
+      Float msLinear = (Float) Time::GetTicks() / repeat;
+
+      Time::ResetTicks();
+      for (UintSize r=0; r<repeat; ++r)
+        hitsTree = queryTree( *queries[q], tree, items );
+      Float msQTree = (Float) Time::GetTicks() / repeat;
+
+      printf( "  %-7s  linear %9.3f ms  tree %9.3f ms  (hits %d / %d)\n",
+              names[q], msLinear, msQTree, (int) hitsLinear, (int) hitsTree );
+    }
+
+    //Scatter the boxes again, refitting lets the hierarchy
+    //degrade until it gets rebuilt
+    createBoxes( count, boxes );
+    tree.refit( boxes );
+    Float growth = tree.getRefitGrowth();
+
+    Time::ResetTicks();
+    for (UintSize r=0; r<repeat; ++r)
+      visTree = cullTree( frustum, tree, visible, count );
+    Float msRefit = (Float) Time::GetTicks() / repeat;
+
+    tree.build( boxes );
+    Time::ResetTicks();
+    for (UintSize r=0; r<repeat; ++r)
+      visTree = cullTree( frustum, tree, visible, count );
+    Float msRebuild = (Float) Time::GetTicks() / repeat;
+
+    printf( "  Moved    refit %9.3f ms  rebuilt %9.3f ms  (area growth %.1fx)\n",
+            msRefit, msRebuild, growth );
+
+    delete[] visible;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of registry lookups. Deserializes a
+scene shaped like an exported level, where every object
+is instantiated through the factory registry, and reports
+objects per second. Then fills a resource cache with
+meshes named like exported ones and reports lookups per
+second by name, as done for every resolved reference.
+-----------------------------------------------------------*/
+
+UintSize numActors = 20000;
+UintSize numGroups = 100;
+UintSize numResources = 5000;
+UintSize numLookups = 2000000;
+UintSize numRepeat = 10;
+
+Scene3D* createScene ()
+{
+  Scene3D *scene = new Scene3D;
+  Actor3D *root = new Actor3D;
+  scene->setRoot( root );
+
+  for (UintSize g=0; g<numGroups; ++g)
+  {
+    Actor3D *group = new Actor3D;
+    group->translate( (Float) g * 10.0f, 0.0f, 0.0f );
+    root->addChild( group );
+
+    for (UintSize a=g; a<numActors; a+=numGroups)
+    {
+      StandardMaterial *mat = new StandardMaterial;
+      mat->setDiffuseColor( Vector3( (Float) (a % 10) * 0.1f, 0.5f, 0.5f ));
+
+      char name[ 64 ];
+      snprintf( name, sizeof( name ), "Mesh%d", (int) (a % 200) );
+
+      TriMeshActor *actor = new TriMeshActor;
+      actor->setMesh( CharString( name ));
+      actor->setMaterial( mat );
+      actor->translate( 0.0f, 0.0f, (Float) a );
+      group->addChild( actor );
+    }
+  }
+
+  return scene;
+}
+
+CharString getResourceName (UintSize r)
+{
+  char name[ 128 ];
+  snprintf( name, sizeof( name ), "Levels/Level%02d/Props/Prop_%05d.mesh", (int) (r % 37), (int) r );
+  return name;
+}
+
+bool benchDeserialize ()
+{
+  Scene3D *scene = createScene();
+
+  Serializer saver;
+  void *data = NULL;
+  UintSize size = 0;
+  saver.serialize( scene, &data, &size );
+  UintSize numObjects = saver.getObjects().size();
+
+  //Check all the objects come back
+  Serializer check;
+  Object *loaded = check.deserialize( data, size );
+  bool ok = Class::SafeCast< Scene3D >( loaded ) != NULL &&
+    check.getObjects().size() == numObjects;
+
+  Uint64 start = Time::GetMicroseconds();
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    Serializer s;
+    s.deserialize( data, size );
+  }
+  Float ms = (Float) (Time::GetMicroseconds() - start) / 1000.0f / numRepeat;
+
+  printf( "Deserialize: %d objects in %.2f ms, %.0f objects/s\n",
+          (int) numObjects, ms, (ms > 0.0f) ? (Float) numObjects * 1000.0f / ms : 0.0f );
+
+  std::free( data );
+  return ok;
+}
+
+bool benchLookup ()
+{
+  ResourceCache cache;
+  ArrayList< CharString > names;
+  for (UintSize r=0; r<numResources; ++r)
+  {
+    names.pushBack( getResourceName( r ));
+    cache.insert( new TriMesh, names.last() );
+  }
+
+  //Same pseudo random order every run
+  bool ok = true;
+  UintSize found = 0;
+  Uint32 seed = 12345;
+
+  Uint64 start = Time::GetMicroseconds();
+  for (UintSize l=0; l<numLookups; ++l)
+  {
+    seed = seed * 1664525 + 1013904223;
+    if (cache.lookup( names[ (seed >> 8) % numResources ] ) != NULL)
+      found++;
+  }
+  Float ms = (Float) (Time::GetMicroseconds() - start) / 1000.0f;
+
+  ok = ok && found == numLookups;
+  ok = ok && cache.lookup( "Levels/Missing.mesh" ) == NULL;
+
+  printf( "Lookup: %d resources, %.2f ms for %d lookups, %.0f lookups/s\n",
+          (int) numResources, ms, (int) numLookups,
+          (ms > 0.0f) ? (Float) numLookups * 1000.0f / ms : 0.0f );
+  return ok;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) numActors = (UintSize) atoi( argv[1] );
+  if (argc > 2) numRepeat = (UintSize) atoi( argv[2] );
+
+  Serializer::Register< Scene3D >();
+  Serializer::Register< Actor3D >();
+  Serializer::Register< TriMeshActor >();
+  Serializer::Register< StandardMaterial >();
+  Serializer::Register< ResourceRef >();
+  Serializer::Register< TriMesh >();
+
+  bool ok = benchDeserialize();
+  ok = benchLookup() && ok;
+
+  printf( "Data check: %s\n", ok ? "OK" : "FAILED" );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
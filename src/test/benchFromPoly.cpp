@@ -0,0 +1,283 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of TriMesh::fromPoly. Builds dense
+polygonal meshes with texture seams, several materials
+and flat or smooth normals, plus a disk with a pole of
+high valence, and exports them with the old per corner
+search and with the hashed vertex welding. Checks both
+give the same vertex data, indices and face groups.
+-----------------------------------------------------------*/
+
+UintSize gridSize = 300;
+UintSize diskSegments = 2000;
+UintSize numRepeat = 3;
+
+/*
+The export TriMesh::fromPoly did before hashing, with a
+new UniqueData per corner and a search through the
+earlier corners of the same vertex. */
+
+struct LegacyUniqueData
+{
+  TexMesh::Vertex *texVertex;
+  VertexID vertexID;
+};
+
+class LegacyTriMesh : public TriMesh
+{
+public:
+  virtual void fromPoly (PolyMesh *m, TexMesh *um)
+  {
+    PolyMesh::FaceIter f;
+    PolyMesh::FaceVertIter fv;
+    TexMesh::FaceIter uf;
+    TexMesh::FaceVertIter ufv;
+    VertexID nextVertexID = 0;
+
+    data.clear();
+    indices.clear();
+    binding.init( getFormat() );
+
+    for (f.begin(m), uf.begin(um); !f.end(); ++f, ++uf) {
+      for (fv.begin(*f), ufv.begin(*uf); !fv.end(); ++fv, ++ufv) {
+        LegacyUniqueData *fvd = new LegacyUniqueData;
+        fvd->vertexID = 0;
+        fvd->texVertex = *ufv;
+        fv.hedgeToVertex()->tag.ptr = fvd;
+      }}
+
+    for (PolyMesh::VertIter v(m); !v.end(); ++v)
+    {
+      for (PolyMesh::VertFaceIter vf(*v); !vf.end(); ++vf) {
+        PolyMesh::HalfEdge *vfh = vf.hedgeToVertex();
+        LegacyUniqueData *vfd = (LegacyUniqueData*) vfh->tag.ptr;
+
+        bool existingFound = false;
+        for (PolyMesh::VertFaceIter vf2(*v); vf2 != vf; ++vf2) {
+          PolyMesh::HalfEdge *vfh2 = vf2.hedgeToVertex();
+          LegacyUniqueData *vfd2 = (LegacyUniqueData*) vfh2->tag.ptr;
+          if (isPolyVertexEqual( *v, vfh, vfh2)) {
+            vfd->vertexID = vfd2->vertexID;
+            existingFound = true;
+            break; }
+        }
+
+        if (!existingFound) {
+          vertexFromPoly (*v, vfh, vfd->texVertex);
+          vfd->vertexID = nextVertexID++; }
+      }
+    }
+
+    const LinkedList<MaterialID> &materials = m->getMaterialsUsed();
+    for (LinkedList<MaterialID>::Iterator mid=materials.begin();
+         mid != materials.end(); ++mid)
+    {
+      addFaceGroup( *mid );
+      for (PolyMesh::MaterialFaceIter mf( m, *mid ); !mf.end(); ++mf)
+        faceFromPoly( *mf );
+    }
+
+    for (f.begin(m); !f.end(); ++f)
+      for (fv.begin(*f); !fv.end(); ++fv)
+        delete (LegacyUniqueData*) fv.hedgeToVertex()->tag.ptr;
+  }
+};
+
+struct PolyInput
+{
+  PolyMesh *mesh;
+  TexMesh *texMesh;
+};
+
+/*
+Quads with a texture seam every 8 columns and a new
+material every 32 rows. */
+
+PolyInput createGrid (UintSize n, SmoothMetric::Enum metric)
+{
+  PolyInput in;
+  in.mesh = new PolyMesh;
+  in.texMesh = new TexMesh;
+
+  ArrayList< PolyMesh::Vertex* > verts;
+  for (UintSize y=0; y<=n; ++y)
+    for (UintSize x=0; x<=n; ++x) {
+      PolyMesh::Vertex *v = in.mesh->addVertex();
+      v->point.set( (Float) x, std::sin( (Float) x * 0.3f ) * std::cos( (Float) y * 0.2f ), (Float) y );
+      verts.pushBack( v ); }
+
+  //Seam columns get a second texture vertex for the faces on their right
+  ArrayList< TexMesh::Vertex* > left, right;
+  for (UintSize y=0; y<=n; ++y)
+    for (UintSize x=0; x<=n; ++x) {
+      TexMesh::Vertex *t = in.texMesh->addVertex();
+      t->point.set( (Float) (x % 8) / 8.0f, (Float) y / (Float) n );
+      left.pushBack( t );
+
+      if (x % 8 == 0) {
+        t = in.texMesh->addVertex();
+        t->point.set( 0.0f, (Float) y / (Float) n ); }
+      right.pushBack( t ); }
+
+  for (UintSize y=0; y<n; ++y)
+    for (UintSize x=0; x<n; ++x)
+    {
+      UintSize a = y * (n+1) + x;
+      UintSize i[4] = { a, a + 1, a + n + 2, a + n + 1 };
+
+      PolyMesh::Vertex *corners[4];
+      TexMesh::Vertex *texCorners[4];
+      for (int k=0; k<4; ++k) {
+        corners[k] = verts[ i[k] ];
+        bool leftSide = (k == 0 || k == 3);
+        texCorners[k] = leftSide ? right[ i[k] ] : left[ i[k] ]; }
+
+      PolyMesh::Face *face = in.mesh->addFace( corners, 4 );
+      in.texMesh->addFace( texCorners, 4 );
+      face->smoothGroups = 1;
+      in.mesh->setMaterialID( face, (MaterialID) (y / 32) );
+    }
+
+  in.mesh->triangulate();
+  in.mesh->updateNormals( metric );
+  return in;
+}
+
+/*
+Triangle fan around a pole with rings of quads outside,
+the pole vertex touches every segment. */
+
+PolyInput createDisk (UintSize segments, UintSize rings)
+{
+  PolyInput in;
+  in.mesh = new PolyMesh;
+  in.texMesh = new TexMesh;
+
+  PolyMesh::Vertex *pole = in.mesh->addVertex();
+  pole->point.set( 0.0f, 1.0f, 0.0f );
+  TexMesh::Vertex *texPole = in.texMesh->addVertex();
+  texPole->point.set( 0.5f, 0.5f );
+
+  ArrayList< PolyMesh::Vertex* > verts;
+  ArrayList< TexMesh::Vertex* > texVerts;
+  for (UintSize r=1; r<=rings; ++r)
+    for (UintSize s=0; s<segments; ++s) {
+      Float angle = (Float) s / (Float) segments * 6.2831853f;
+      Float radius = (Float) r / (Float) rings;
+      PolyMesh::Vertex *v = in.mesh->addVertex();
+      v->point.set( std::cos( angle ) * radius, 1.0f - radius, std::sin( angle ) * radius );
+      verts.pushBack( v );
+      TexMesh::Vertex *t = in.texMesh->addVertex();
+      t->point.set( 0.5f + std::cos( angle ) * radius * 0.5f, 0.5f + std::sin( angle ) * radius * 0.5f );
+      texVerts.pushBack( t ); }
+
+  for (UintSize s=0; s<segments; ++s) {
+    UintSize s1 = (s + 1) % segments;
+    PolyMesh::Vertex *corners[3] = { pole, verts[ s1 ], verts[ s ] };
+    TexMesh::Vertex *texCorners[3] = { texPole, texVerts[ s1 ], texVerts[ s ] };
+    in.mesh->addFace( corners, 3 )->smoothGroups = 1;
+    in.texMesh->addFace( texCorners, 3 ); }
+
+  for (UintSize r=0; r+1<rings; ++r)
+    for (UintSize s=0; s<segments; ++s) {
+      UintSize s1 = (s + 1) % segments;
+      UintSize i[4] = { r * segments + s, r * segments + s1, (r+1) * segments + s1, (r+1) * segments + s };
+      PolyMesh::Vertex *corners[4];
+      TexMesh::Vertex *texCorners[4];
+      for (int k=0; k<4; ++k) {
+        corners[k] = verts[ i[k] ];
+        texCorners[k] = texVerts[ i[k] ]; }
+      in.mesh->addFace( corners, 4 )->smoothGroups = 1;
+      in.texMesh->addFace( texCorners, 4 ); }
+
+  in.mesh->triangulate();
+  in.mesh->updateNormals( SmoothMetric::None );
+  return in;
+}
+
+bool isSameMesh (TriMesh *a, TriMesh *b)
+{
+  UintSize vertexSize = a->getFormat()->getByteSize();
+  if (a->getVertexCount() != b->getVertexCount()) return false;
+  if (a->indices.size() != b->indices.size()) return false;
+  if (a->groups.size() != b->groups.size()) return false;
+
+  if (a->getVertexCount() > 0 &&
+      std::memcmp( a->getVertex(0), b->getVertex(0), a->getVertexCount() * vertexSize ) != 0)
+    return false;
+
+  for (UintSize i=0; i<a->indices.size(); ++i)
+    if (a->indices[ i ] != b->indices[ i ]) return false;
+
+  for (UintSize g=0; g<a->groups.size(); ++g)
+    if (a->groups[ g ].materialID != b->groups[ g ].materialID ||
+        a->groups[ g ].start != b->groups[ g ].start ||
+        a->groups[ g ].count != b->groups[ g ].count)
+      return false;
+
+  return true;
+}
+
+Float getMs (Uint64 start)
+{
+  return (Float) (Time::GetMicroseconds() - start) / 1000.0f;
+}
+
+bool runExport (const char *name, PolyInput in)
+{
+  VertexFormat format;
+  format.addMember( ShaderData::TexCoord2 );
+  format.addMember( ShaderData::Normal );
+  format.addMember( ShaderData::Coord3 );
+
+  LegacyTriMesh legacy;
+  TriMesh hashed;
+  legacy.setFormat( format );
+  hashed.setFormat( format );
+  Float msLegacy = 0.0f, msHashed = 0.0f;
+
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    Uint64 start = Time::GetMicroseconds();
+    legacy.fromPoly( in.mesh, in.texMesh );
+    Float ms = getMs( start );
+    msLegacy = (r == 0) ? ms : Util::Min( msLegacy, ms );
+
+    start = Time::GetMicroseconds();
+    hashed.fromPoly( in.mesh, in.texMesh );
+    ms = getMs( start );
+    msHashed = (r == 0) ? ms : Util::Min( msHashed, ms );
+  }
+
+  bool ok = isSameMesh( &legacy, &hashed );
+  printf( "%s: %d vertices, %d faces, per corner search %.2f ms, hashed %.2f ms, %.2fx%s\n",
+          name, (int) hashed.getVertexCount(), (int) hashed.getFaceCount(),
+          msLegacy, msHashed, (msHashed > 0.0f) ? msLegacy / msHashed : 0.0f,
+          ok ? "" : ", MISMATCH" );
+
+  delete in.mesh;
+  delete in.texMesh;
+  return ok;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) gridSize = (UintSize) atoi( argv[1] );
+  if (argc > 2) diskSegments = (UintSize) atoi( argv[2] );
+
+  bool ok = true;
+  ok = runExport( "Grid, smooth", createGrid( gridSize, SmoothMetric::All )) && ok;
+  ok = runExport( "Grid, flat", createGrid( gridSize, SmoothMetric::None )) && ok;
+  ok = runExport( "Disk pole", createDisk( diskSegments, 8 )) && ok;
+
+  printf( "Data check: %s\n", ok ? "OK" : "FAILED" );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,249 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+#if defined(WIN32)
+#  include <psapi.h>
+#else
+#  include <unistd.h>
+#endif
+
+/*
+-----------------------------------------------------------
+Headless benchmark of the half-edge mesh storage. Builds
+a PolyMesh grid of a million quads with its TexMesh, then
+times triangulation, normal and tangent recomputation, a
+walk over the faces around every vertex and teardown, and
+reports the resident set the mesh takes. A smaller pair of
+grids is merged, welded along the seam, and has edges
+collapsed and removed, then the whole structure is checked
+for consistency and the counts are printed.
+-----------------------------------------------------------*/
+
+UintSize gridSize = 1000;
+UintSize checkSize = 48;
+UintSize numRepeat = 3;
+
+UintSize getResidentBytes ()
+{
+  #if defined(WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters )))
+    return 0;
+  return (UintSize) counters.WorkingSetSize;
+  #else
+  long pages = 0, resident = 0;
+  FILE *file = fopen( "/proc/self/statm", "r" );
+  if (file == NULL) return 0;
+  if (fscanf( file, "%ld %ld", &pages, &resident ) != 2) resident = 0;
+  fclose( file );
+  return (UintSize) resident * (UintSize) sysconf( _SC_PAGESIZE );
+  #endif
+}
+
+Float getMs (Uint64 start)
+{
+  return (Float) (Time::GetMicroseconds() - start) / 1000.0f;
+}
+
+Float getMB (UintSize bytes)
+{
+  return (Float) bytes / (1024.0f * 1024.0f);
+}
+
+/*
+Quads over an n by n grid of points with the given x
+offset. The points are returned for welding. */
+
+void buildGrid (PolyMesh *mesh, UintSize n, Float offset,
+                ArrayList< PolyMesh::Vertex* > *verts)
+{
+  for (UintSize y=0; y<=n; ++y)
+    for (UintSize x=0; x<=n; ++x) {
+      PolyMesh::Vertex *v = mesh->addVertex();
+      v->point.set( offset + (Float) x, std::sin( (Float) x * 0.3f ) * std::cos( (Float) y * 0.2f ), (Float) y );
+      verts->pushBack( v ); }
+
+  for (UintSize y=0; y<n; ++y)
+    for (UintSize x=0; x<n; ++x) {
+      UintSize a = y * (n+1) + x;
+      PolyMesh::Vertex *corners[4] = {
+        (*verts)[ a ], (*verts)[ a + n + 1 ], (*verts)[ a + n + 2 ], (*verts)[ a + 1 ] };
+      mesh->addFace( corners, 4 )->smoothGroups = 1; }
+}
+
+void buildTexGrid (TexMesh *mesh, UintSize n)
+{
+  ArrayList< TexMesh::Vertex* > verts;
+  for (UintSize y=0; y<=n; ++y)
+    for (UintSize x=0; x<=n; ++x) {
+      TexMesh::Vertex *v = mesh->addVertex();
+      v->point.set( (Float) x / (Float) n, (Float) y / (Float) n );
+      verts.pushBack( v ); }
+
+  for (UintSize y=0; y<n; ++y)
+    for (UintSize x=0; x<n; ++x) {
+      UintSize a = y * (n+1) + x;
+      TexMesh::Vertex *corners[4] = {
+        verts[ a ], verts[ a + n + 1 ], verts[ a + n + 2 ], verts[ a + 1 ] };
+      mesh->addFace( corners, 4 ); }
+}
+
+/*
+Links between entities point both ways, every iterated
+entity is valid and the iterators see as many entities
+as the counters report. */
+
+bool isConsistent (PolyMesh *mesh)
+{
+  int numVerts = 0, numHedges = 0, numEdges = 0, numFaces = 0;
+
+  for (PolyMesh::VertIter v( mesh ); !v.end(); ++v, ++numVerts) {
+    if (!v->valid) return false;
+    if (v->hedge != NULL && v->hedge->twin->vert != *v) return false; }
+
+  for (PolyMesh::HedgeIter h( mesh ); !h.end(); ++h, ++numHedges) {
+    if (!h->valid || !h->twin->valid || !h->edge->valid) return false;
+    if (h->twin->twin != *h) return false;
+    if (h->next->prev != *h || h->prev->next != *h) return false;
+    if (h->next->face != h->face) return false;
+    if (h->face != NULL && !h->face->valid) return false; }
+
+  for (PolyMesh::EdgeIter e( mesh ); !e.end(); ++e, ++numEdges)
+    if (!e->valid || e->hedge->edge != *e) return false;
+
+  for (PolyMesh::FaceIter f( mesh ); !f.end(); ++f, ++numFaces)
+    if (!f->valid || f->hedge->face != *f) return false;
+
+  return numVerts == mesh->vertexCount() && numHedges == mesh->hedgeCount() &&
+    numEdges == mesh->edgeCount() && numFaces == mesh->faceCount() &&
+    numHedges == numEdges * 2;
+}
+
+bool runTopology (UintSize n)
+{
+  PolyMesh *mesh = new PolyMesh;
+  PolyMesh *other = new PolyMesh;
+  ArrayList< PolyMesh::Vertex* > left, right;
+  buildGrid( mesh, n, 0.0f, &left );
+  buildGrid( other, n, (Float) n, &right );
+
+  int numVerts = mesh->vertexCount() + other->vertexCount();
+  int numFaces = mesh->faceCount() + other->faceCount();
+  mesh->mergeWith( other );
+  bool ok = mesh->vertexCount() == numVerts && mesh->faceCount() == numFaces &&
+    other->vertexCount() == 0 && other->faceCount() == 0;
+  delete other;
+
+  //Weld the right column of the first grid to the left one of the second
+  int numWelds = 0;
+  for (UintSize y=0; y<=n; ++y)
+    if (mesh->weldVertices( left[ y * (n+1) + n ], right[ y * (n+1) ] ))
+      numWelds++;
+
+  //Collapse and remove every few inner edges
+  ArrayList< PolyMesh::Edge* > edges;
+  for (PolyMesh::EdgeIter e( mesh ); !e.end(); ++e)
+    edges.pushBack( *e );
+
+  int numCollapsed = 0, numRemoved = 0;
+  for (UintSize e=0; e<edges.size(); e+=7)
+    if (edges[ e ]->valid && edges[ e ]->hedge->face != NULL &&
+        edges[ e ]->hedge->twin->face != NULL)
+      if (mesh->collapseEdge( edges[ e ] ))
+        numCollapsed++;
+
+  mesh->clearInvalid();
+  edges.clear();
+  for (PolyMesh::EdgeIter e( mesh ); !e.end(); ++e)
+    edges.pushBack( *e );
+
+  for (UintSize e=3; e<edges.size(); e+=11)
+    if (edges[ e ]->valid && mesh->removeEdge( edges[ e ] ))
+      numRemoved++;
+
+  mesh->clearInvalid();
+
+  //New entities go into the freed slots
+  ArrayList< PolyMesh::Vertex* > extra;
+  buildGrid( mesh, 4, (Float) (3 * n), &extra );
+
+  ok = isConsistent( mesh ) && ok;
+  mesh->triangulate();
+  mesh->updateNormals( SmoothMetric::All );
+
+  printf( "Topology: %d welds, %d collapses, %d removals, %d vertices, %d edges, %d faces, %s\n",
+          numWelds, numCollapsed, numRemoved, mesh->vertexCount(), mesh->edgeCount(),
+          mesh->faceCount(), ok ? "consistent" : "BROKEN" );
+
+  delete mesh;
+  return ok;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) gridSize = (UintSize) atoi( argv[1] );
+  if (argc > 2) checkSize = (UintSize) atoi( argv[2] );
+
+  bool ok = runTopology( checkSize );
+
+  UintSize rssStart = getResidentBytes();
+  Uint64 start = Time::GetMicroseconds();
+  PolyMesh *mesh = new PolyMesh;
+  ArrayList< PolyMesh::Vertex* > verts( (gridSize+1) * (gridSize+1) );
+  buildGrid( mesh, gridSize, 0.0f, &verts );
+  Float msBuild = getMs( start );
+  UintSize rssMesh = getResidentBytes() - rssStart;
+  verts.clear();
+
+  TexMesh *texMesh = new TexMesh;
+  buildTexGrid( texMesh, gridSize );
+
+  printf( "Build: %d faces, %d half-edges, %.2f ms, %.1f MB resident, %.1f MB entity storage\n",
+          mesh->faceCount(), mesh->hedgeCount(), msBuild, getMB( rssMesh ),
+          getMB( mesh->getByteSize() ));
+
+  start = Time::GetMicroseconds();
+  mesh->triangulate();
+  printf( "Triangulate: %.2f ms\n", getMs( start ));
+
+  Float msNormals = 0.0f, msTangents = 0.0f, msWalk = 0.0f;
+  UintSize numAdjacent = 0;
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    start = Time::GetMicroseconds();
+    mesh->updateNormals( SmoothMetric::All );
+    Float ms = getMs( start );
+    msNormals = (r == 0) ? ms : Util::Min( msNormals, ms );
+
+    start = Time::GetMicroseconds();
+    mesh->updateTangents( texMesh );
+    ms = getMs( start );
+    msTangents = (r == 0) ? ms : Util::Min( msTangents, ms );
+
+    start = Time::GetMicroseconds();
+    numAdjacent = 0;
+    for (PolyMesh::VertIter v( mesh ); !v.end(); ++v)
+      for (PolyMesh::VertFaceIter vf( *v ); !vf.end(); ++vf)
+        numAdjacent++;
+    ms = getMs( start );
+    msWalk = (r == 0) ? ms : Util::Min( msWalk, ms );
+  }
+
+  printf( "Normals: %.2f ms, tangents: %.2f ms, vertex faces walk: %.2f ms\n",
+          msNormals, msTangents, msWalk );
+
+  ok = ok && numAdjacent == gridSize * gridSize * 4;
+
+  start = Time::GetMicroseconds();
+  delete mesh;
+  delete texMesh;
+  printf( "Teardown: %.2f ms\n", getMs( start ));
+
+  printf( "Data check: %s\n", ok ? "OK" : "FAILED" );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,177 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of normal recomputation on a thread
+pool. Builds a triangulated PolyMesh grid with several
+smoothing groups and hard edges, runs updateNormals with
+every smooth metric on one thread without a pool, and
+again on pools of 1..N threads. Checks every pooled run
+gives the same face normals and the same vertex normals
+in the same order.
+-----------------------------------------------------------*/
+
+UintSize gridSize = 700;
+Uint maxThreads = 0;
+UintSize numRepeat = 3;
+
+/*
+Quads in bands of smoothing groups and a hard edge
+every 16 columns. */
+
+PolyMesh* createGrid (UintSize n)
+{
+  PolyMesh *mesh = new PolyMesh;
+
+  ArrayList< PolyMesh::Vertex* > verts;
+  for (UintSize y=0; y<=n; ++y)
+    for (UintSize x=0; x<=n; ++x) {
+      PolyMesh::Vertex *v = mesh->addVertex();
+      v->point.set( (Float) x, std::sin( (Float) x * 0.3f ) * std::cos( (Float) y * 0.2f ), (Float) y );
+      verts.pushBack( v ); }
+
+  for (UintSize y=0; y<n; ++y)
+    for (UintSize x=0; x<n; ++x)
+    {
+      UintSize a = y * (n+1) + x;
+      UintSize i[4] = { a, a + 1, a + n + 2, a + n + 1 };
+
+      PolyMesh::Vertex *corners[4];
+      for (int k=0; k<4; ++k)
+        corners[k] = verts[ i[k] ];
+
+      PolyMesh::Face *face = mesh->addFace( corners, 4 );
+      face->smoothGroups = (y % 24 < 2) ? 0 : (1 << ((y / 12) % 3));
+    }
+
+  for (PolyMesh::EdgeIter e( mesh ); !e.end(); ++e)
+    e->isSmooth = !(e->vertex1()->point.x == e->vertex2()->point.x &&
+                    (int) e->vertex1()->point.x % 16 == 0);
+
+  mesh->triangulate();
+  return mesh;
+}
+
+/*
+Everything the passes write, with vertex normals
+referred to by their position. */
+
+struct Result
+{
+  ArrayList< Vector3 > faceNormals;
+  ArrayList< Vector3 > vertexNormals;
+  ArrayList< PolyMesh::Vertex* > normalVerts;
+  ArrayList< int > hedgeNormals;
+};
+
+void record (PolyMesh *mesh, Result *r)
+{
+  int id = 0;
+  for (PolyMesh::VertexNormalIter n( mesh ); !n.end(); ++n) {
+    n->tag.id = id++;
+    r->vertexNormals.pushBack( n->coord );
+    r->normalVerts.pushBack( n->vert ); }
+
+  for (PolyMesh::FaceIter f( mesh ); !f.end(); ++f)
+    r->faceNormals.pushBack( f->normal );
+
+  for (PolyMesh::HedgeIter h( mesh ); !h.end(); ++h)
+    if (h->face != NULL)
+      r->hedgeNormals.pushBack( h->vertexNormal()->tag.id );
+}
+
+bool isSame (const Result &a, const Result &b)
+{
+  if (a.faceNormals.size() != b.faceNormals.size() ||
+      a.vertexNormals.size() != b.vertexNormals.size() ||
+      a.hedgeNormals.size() != b.hedgeNormals.size())
+    return false;
+
+  if (a.faceNormals.size() > 0 && std::memcmp( a.faceNormals.buffer(), b.faceNormals.buffer(),
+        a.faceNormals.size() * sizeof( Vector3 )) != 0) return false;
+
+  if (a.vertexNormals.size() > 0 && std::memcmp( a.vertexNormals.buffer(), b.vertexNormals.buffer(),
+        a.vertexNormals.size() * sizeof( Vector3 )) != 0) return false;
+
+  for (UintSize n=0; n<a.normalVerts.size(); ++n)
+    if (a.normalVerts[ n ] != b.normalVerts[ n ]) return false;
+
+  for (UintSize h=0; h<a.hedgeNormals.size(); ++h)
+    if (a.hedgeNormals[ h ] != b.hedgeNormals[ h ]) return false;
+
+  return true;
+}
+
+Float getMs (Uint64 start)
+{
+  return (Float) (Time::GetMicroseconds() - start) / 1000.0f;
+}
+
+/*
+Recomputes with the given metric, the fastest of a
+few runs. */
+
+void run (PolyMesh *mesh, SmoothMetric::Enum metric, ThreadPool *pool, Float *msNormals)
+{
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    Uint64 start = Time::GetMicroseconds();
+    mesh->updateNormals( metric, pool );
+    Float ms = getMs( start );
+    *msNormals = (r == 0) ? ms : Util::Min( *msNormals, ms );
+  }
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) gridSize = (UintSize) atoi( argv[1] );
+  if (argc > 2) maxThreads = (Uint) atoi( argv[2] );
+  if (maxThreads == 0) maxThreads = Thread::GetNumCores();
+
+  PolyMesh *mesh = createGrid( gridSize );
+  printf( "Mesh: %d faces, %d vertices, %d cores\n",
+          mesh->faceCount(), mesh->vertexCount(), (int) Thread::GetNumCores() );
+
+  const char *names[4] = { "None", "All", "Face", "Edge" };
+  SmoothMetric::Enum metrics[4] = {
+    SmoothMetric::None, SmoothMetric::All, SmoothMetric::Face, SmoothMetric::Edge };
+
+  bool ok = true;
+  for (int m=0; m<4; ++m)
+  {
+    Float msSerial = 0.0f;
+    run( mesh, metrics[m], NULL, &msSerial );
+    Result serial;
+    record( mesh, &serial );
+
+    printf( "%s, no pool: normals %.2f ms\n", names[m], msSerial );
+
+    for (Uint t=1; t<=maxThreads; ++t)
+    {
+      ThreadPool pool( t );
+      Float msNormals = 0.0f;
+      run( mesh, metrics[m], &pool, &msNormals );
+
+      Result pooled;
+      record( mesh, &pooled );
+      bool same = isSame( serial, pooled );
+      ok = ok && same;
+
+      printf( "%s, %2d threads: normals %.2f ms %.2fx%s\n",
+              names[m], (int) t,
+              msNormals, (msNormals > 0.0f) ? msSerial / msNormals : 0.0f,
+              same ? "" : ", MISMATCH" );
+    }
+  }
+
+  delete mesh;
+
+  printf( "Data check: %s\n", ok ? "OK" : "FAILED" );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
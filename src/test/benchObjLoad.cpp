@@ -0,0 +1,275 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of OBJ parsing. Generates a textured
+grid as OBJ text and tokenizes it the way LoaderObj
+does, a ByteString per line and per token with strtod,
+then with ObjReader. Also builds a TriMesh from it with
+ObjMeshLoader, from memory and streamed from a file.
+Checks both tokenizers read the same numbers and that
+the corners get welded back into the grid vertices.
+-----------------------------------------------------------*/
+
+UintSize gridSize = 400;
+UintSize numRepeat = 3;
+
+ByteString createObj (UintSize n)
+{
+  ArrayList< char > text;
+  char line[ 256 ];
+
+  for (UintSize y=0; y<=n; ++y)
+    for (UintSize x=0; x<=n; ++x)
+    {
+      Float fx = (Float) x / (Float) n;
+      Float fy = (Float) y / (Float) n;
+      int len = snprintf( line, sizeof( line ),
+        "v %f %f %f\nvt %f %f\nvn %f %f %f\n",
+        fx * 10.0f, std::sin( fx * 6.0f ) * std::cos( fy * 4.0f ), fy * -10.0f,
+        fx, fy, 0.0f, 1.0f, 0.0f );
+      for (int c=0; c<len; ++c) text.pushBack( line[ c ] );
+    }
+
+  for (UintSize y=0; y<n; ++y)
+  {
+    //Two materials in bands of rows
+    int len = snprintf( line, sizeof( line ), "usemtl Band%d\n", (int) ((y / 16) % 2) );
+    for (int c=0; c<len; ++c) text.pushBack( line[ c ] );
+
+    for (UintSize x=0; x<n; ++x)
+    {
+      int a = (int) (y * (n+1) + x + 1);
+      int b = a + 1;
+      int c = a + (int) n + 2;
+      int d = a + (int) n + 1;
+      len = snprintf( line, sizeof( line ),
+        "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a,a,a, b,b,b, c,c,c, d,d,d );
+      for (int k=0; k<len; ++k) text.pushBack( line[ k ] );
+    }
+  }
+
+  return ByteString( (const Byte*) text.buffer(), (int) text.size() );
+}
+
+/*
+The per line tokenizer of LoaderObj. */
+
+struct OldTokenizer
+{
+  const ByteString *buffer;
+  int bufPointer;
+  bool endOfFile;
+  ByteString line;
+  int linePointer;
+
+  void readLine ()
+  {
+    char c = 0;
+    linePointer = 0;
+    line.reserve( 20 );
+
+    do {
+      if (bufPointer == buffer->length()) {
+        endOfFile = true; return; }
+      c = (*buffer)[ bufPointer++ ];
+
+      if (line.length() == line.capacity())
+        line.reserveAndCopy( 2 * line.capacity() );
+
+      if (c != '\n' && c != '\r')
+        line += c;
+
+    } while (c != '\n');
+  }
+
+  ByteString parseToken ()
+  {
+    int start = 0, end = 0;
+    for (start = linePointer; start < line.length(); ++start)
+      if (line[ start ] != ' ' && line[ start ] != '\t') break;
+    for (end = start; end < line.length(); ++end)
+      if (line[ end ] == ' ' || line[ end ] == '\t') break;
+
+    linePointer = end;
+    return line.sub( start, end - start );
+  }
+};
+
+struct ParseSums
+{
+  UintSize numLines;
+  double floats;
+  Int64 indices;
+};
+
+ParseSums tokenizeOld (const ByteString &obj)
+{
+  ParseSums sums = { 0, 0.0, 0 };
+  OldTokenizer t;
+  t.buffer = &obj;
+  t.bufPointer = 0;
+  t.endOfFile = false;
+
+  ArrayList< ByteString > ints( 3 );
+  while (true)
+  {
+    t.readLine();
+    if (t.endOfFile) break;
+    sums.numLines++;
+
+    ByteString command = t.parseToken();
+    if (command == "v" || command == "vn") {
+      for (int k=0; k<3; ++k) sums.floats += t.parseToken().parseFloat(); }
+
+    else if (command == "vt") {
+      for (int k=0; k<2; ++k) sums.floats += t.parseToken().parseFloat(); }
+
+    else if (command == "f") {
+      ByteString corner = t.parseToken();
+      while (corner != "") {
+        ints.clear();
+        corner.tokenize( "/", &ints );
+        for (UintSize i=0; i<ints.size(); ++i)
+          sums.indices += ints[ i ].parseInteger();
+        corner = t.parseToken(); }}
+  }
+
+  return sums;
+}
+
+ParseSums tokenizeReader (const ByteString &obj)
+{
+  ParseSums sums = { 0, 0.0, 0 };
+  ObjReader reader;
+  reader.openData( obj.buffer(), obj.length() );
+
+  const char *cmd = NULL;
+  UintSize length = 0;
+  while (reader.nextLine())
+  {
+    if (!reader.token( &cmd, &length )) continue;
+
+    if (reader.isToken( cmd, length, "v" ) || reader.isToken( cmd, length, "vn" )) {
+      for (int k=0; k<3; ++k) sums.floats += reader.parseFloat(); }
+
+    else if (reader.isToken( cmd, length, "vt" )) {
+      for (int k=0; k<2; ++k) sums.floats += reader.parseFloat(); }
+
+    else if (reader.isToken( cmd, length, "f" )) {
+      Int v, vt, vn;
+      while (reader.parseCorner( &v, &vt, &vn ))
+        sums.indices += v + vt + vn; }
+  }
+
+  sums.numLines = reader.getNumLines();
+  return sums;
+}
+
+Float getMs (Uint64 start)
+{
+  return (Float) (Time::GetMicroseconds() - start) / 1000.0f;
+}
+
+Float getMLinesPerSec (UintSize numLines, Float ms)
+{
+  return (ms > 0.0f) ? (Float) numLines / (ms * 1000.0f) : 0.0f;
+}
+
+bool checkMesh (TriMesh *mesh, UintSize n)
+{
+  if (mesh == NULL) return false;
+  return mesh->getVertexCount() == (n+1) * (n+1) &&
+    mesh->indices.size() == n * n * 6 &&
+    mesh->groups.size() == ((n > 16) ? 2 : 1);
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) gridSize = (UintSize) atoi( argv[1] );
+
+  ByteString obj = createObj( gridSize );
+  printf( "OBJ: %dx%d grid, %.1f MB\n",
+          (int) gridSize, (int) gridSize, (Float) obj.length() / (1024.0f * 1024.0f) );
+
+  bool ok = true;
+  ParseSums oldSums = { 0, 0.0, 0 }, newSums = { 0, 0.0, 0 };
+  Float msOld = 0.0f, msNew = 0.0f;
+
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    Uint64 start = Time::GetMicroseconds();
+    oldSums = tokenizeOld( obj );
+    Float ms = getMs( start );
+    msOld = (r == 0) ? ms : Util::Min( msOld, ms );
+
+    start = Time::GetMicroseconds();
+    newSums = tokenizeReader( obj );
+    ms = getMs( start );
+    msNew = (r == 0) ? ms : Util::Min( msNew, ms );
+  }
+
+  printf( "ByteString tokens: %.2f ms, %.2f M lines/s\n",
+          msOld, getMLinesPerSec( oldSums.numLines, msOld ));
+  printf( "ObjReader tokens: %.2f ms, %.2f M lines/s, %.2fx\n",
+          msNew, getMLinesPerSec( newSums.numLines, msNew ),
+          (msNew > 0.0f) ? msOld / msNew : 0.0f );
+
+  //Same lines, indices and numbers within float rounding
+  ok = ok && oldSums.numLines == newSums.numLines;
+  ok = ok && oldSums.indices == newSums.indices;
+  ok = ok && std::fabs( oldSums.floats - newSums.floats ) <= 1e-6 * std::fabs( oldSums.floats ) + 1e-3;
+
+  //Straight to a TriMesh
+  Float msMesh = 0.0f;
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    ObjMeshLoader loader;
+    loader.setLods( 0 );
+    ObjReader reader;
+    reader.openData( obj.buffer(), obj.length() );
+
+    Uint64 start = Time::GetMicroseconds();
+    TriMesh *mesh = loader.load( reader );
+    Float ms = getMs( start );
+    msMesh = (r == 0) ? ms : Util::Min( msMesh, ms );
+
+    ok = ok && checkMesh( mesh, gridSize );
+    ok = ok && loader.getMaterials().size() == ((gridSize > 16) ? 3 : 2);
+    delete mesh;
+  }
+
+  printf( "ObjMeshLoader from memory: %.2f ms, %.2f M lines/s\n",
+          msMesh, getMLinesPerSec( newSums.numLines, msMesh ));
+
+  //Streamed from a file in chunks
+  const char *path = "benchObjLoad.obj";
+  FILE *file = fopen( path, "wb" );
+  if (file != NULL)
+  {
+    fwrite( obj.buffer(), 1, obj.length(), file );
+    fclose( file );
+
+    ObjMeshLoader loader;
+    loader.setLods( 0 );
+    Uint64 start = Time::GetMicroseconds();
+    TriMesh *mesh = loader.loadFile( path );
+    Float ms = getMs( start );
+
+    ok = ok && checkMesh( mesh, gridSize );
+    printf( "ObjMeshLoader from file: %.2f ms, %.2f M lines/s\n",
+            ms, getMLinesPerSec( newSums.numLines, ms ));
+
+    delete mesh;
+    remove( path );
+  }
+
+  printf( "Data check: %s\n", ok ? "OK" : "FAILED" );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,229 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+#if defined(WIN32)
+#  include <psapi.h>
+#else
+#  include <unistd.h>
+#endif
+
+/*
+-----------------------------------------------------------
+Headless benchmark of object arenas. Loads a large scene
+made of many small objects with each object allocated on
+the heap, then with the objects of the scene placed in an
+ObjectArena. Reports load time, teardown time and the
+resident set once loaded.
+Pass "heap" or "arena" to run only one of them, so the
+memory of one run isn't reused by the other. Pass "save"
+first to write the scene to a file the single runs load,
+so the memory of building it isn't reused either.
+-----------------------------------------------------------*/
+
+UintSize numActors = 100000;
+UintSize numGroups = 500;
+const char *mode = "both";
+const char *fileName = "benchObjectArena.bin";
+
+Scene3D* createScene ()
+{
+  Scene3D *scene = new Scene3D;
+  Actor3D *root = new Actor3D;
+  scene->setRoot( root );
+
+  for (UintSize g=0; g<numGroups; ++g)
+  {
+    Actor3D *group = new Actor3D;
+    group->translate( (Float) g * 10.0f, 0.0f, 0.0f );
+    root->addChild( group );
+
+    for (UintSize a=g; a<numActors; a+=numGroups)
+    {
+      StandardMaterial *mat = new StandardMaterial;
+      mat->setDiffuseColor( Vector3( (Float) (a % 10) * 0.1f, 0.5f, 0.5f ));
+
+      char name[ 64 ];
+      snprintf( name, sizeof( name ), "Mesh%d", (int) (a % 200) );
+
+      TriMeshActor *actor = new TriMeshActor;
+      actor->setMesh( CharString( name ));
+      actor->setMaterial( mat );
+      actor->translate( 0.0f, 0.0f, (Float) a );
+      group->addChild( actor );
+    }
+  }
+
+  return scene;
+}
+
+UintSize getResidentBytes ()
+{
+  #if defined(WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters )))
+    return 0;
+  return (UintSize) counters.WorkingSetSize;
+  #else
+  long pages = 0, resident = 0;
+  FILE *file = fopen( "/proc/self/statm", "r" );
+  if (file == NULL) return 0;
+  if (fscanf( file, "%ld %ld", &pages, &resident ) != 2) resident = 0;
+  fclose( file );
+  return (UintSize) resident * (UintSize) sysconf( _SC_PAGESIZE );
+  #endif
+}
+
+/*
+Scenes, actors and resources are allocated on their own,
+the rest of the objects are members of them. Members are
+recorded after their owner, so going backwards sees them
+before the owner is deleted. */
+
+bool isAllocated (Object *obj)
+{
+  return Class::SafeCast< Scene >( obj ) != NULL ||
+    Class::SafeCast< Actor >( obj ) != NULL ||
+    Class::SafeCast< Resource >( obj ) != NULL;
+}
+
+UintSize deleteObjects (const ArrayList< Object* > &objects)
+{
+  UintSize count = 0;
+  for (UintSize o=objects.size(); o>0; --o)
+    if (isAllocated( objects[ o-1 ] )) {
+      delete objects[ o-1 ];
+      count++; }
+
+  return count;
+}
+
+Float getMs (Uint64 start)
+{
+  return (Float) (Time::GetMicroseconds() - start) / 1000.0f;
+}
+
+bool runLoad (const void *data, UintSize size, UintSize numObjects, bool inArena)
+{
+  ObjectArena *arena = inArena ? new ObjectArena : NULL;
+
+  Serializer s;
+  s.setObjectArena( arena );
+
+  Uint64 start = Time::GetMicroseconds();
+  Object *root = s.deserialize( data, size );
+  Float loadMs = getMs( start );
+
+  UintSize rss = getResidentBytes();
+  bool ok = Class::SafeCast< Scene3D >( root ) != NULL &&
+    s.getObjects().size() == numObjects;
+
+  UintSize arenaObjects = 0, arenaBytes = 0;
+  if (arena != NULL) {
+    arenaObjects = arena->getNumObjects();
+    arenaBytes = arena->getByteSize();
+    arena->release(); }
+
+  //Unload the whole scene, the arena goes with the last object
+  start = Time::GetMicroseconds();
+  UintSize numDeleted = deleteObjects( s.getObjects() );
+  Float teardownMs = getMs( start );
+
+  //Every object deleted on its own came from the arena
+  if (inArena) ok = ok && arenaObjects == numDeleted;
+
+  printf( "%s: load %.2f ms, teardown %.2f ms, resident %.1f MB",
+          inArena ? "Arena" : "Heap", loadMs, teardownMs,
+          (Float) rss / (1024.0f * 1024.0f) );
+  if (inArena) printf( ", %.1f MB in arena blocks", (Float) arenaBytes / (1024.0f * 1024.0f) );
+  printf( "\n" );
+
+  return ok;
+}
+
+/*
+Saved scenes start with their object count. */
+
+bool saveScene (const void *data, UintSize size, UintSize numObjects)
+{
+  FILE *file = fopen( fileName, "wb" );
+  if (file == NULL) return false;
+
+  Uint64 count = (Uint64) numObjects;
+  bool ok = fwrite( &count, sizeof( count ), 1, file ) == 1 &&
+    fwrite( data, 1, size, file ) == size;
+  fclose( file );
+  return ok;
+}
+
+bool loadScene (void **outData, UintSize *outSize, UintSize *outObjects)
+{
+  FILE *file = fopen( fileName, "rb" );
+  if (file == NULL) return false;
+
+  Uint64 count = 0;
+  fseek( file, 0, SEEK_END );
+  long end = ftell( file );
+  fseek( file, 0, SEEK_SET );
+  if (end <= (long) sizeof( count ) || fread( &count, sizeof( count ), 1, file ) != 1) {
+    fclose( file );
+    return false; }
+
+  UintSize size = (UintSize) end - sizeof( count );
+  void *data = std::malloc( size );
+  if (fread( data, 1, size, file ) != size) {
+    std::free( data );
+    fclose( file );
+    return false; }
+
+  fclose( file );
+  *outData = data;
+  *outSize = size;
+  *outObjects = (UintSize) count;
+  return true;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) numActors = (UintSize) atoi( argv[1] );
+  if (argc > 2) mode = argv[2];
+
+  Serializer::Register< Scene3D >();
+  Serializer::Register< Actor3D >();
+  Serializer::Register< TriMeshActor >();
+  Serializer::Register< StandardMaterial >();
+  Serializer::Register< ResourceRef >();
+
+  void *data = NULL;
+  UintSize size = 0;
+  UintSize numObjects = 0;
+  bool single = strcmp( mode, "heap" ) == 0 || strcmp( mode, "arena" ) == 0;
+  if (!single || !loadScene( &data, &size, &numObjects ))
+  {
+    Serializer saver;
+    Scene3D *scene = createScene();
+    saver.serialize( scene, &data, &size );
+    numObjects = saver.getObjects().size();
+    deleteObjects( saver.getObjects() );
+  }
+
+  printf( "Scene: %d objects, %.1f MB serialized\n",
+          (int) numObjects, (Float) size / (1024.0f * 1024.0f) );
+
+  if (strcmp( mode, "save" ) == 0) {
+    bool saved = saveScene( data, size, numObjects );
+    std::free( data );
+    printf( "Saved to %s: %s\n", fileName, saved ? "OK" : "FAILED" );
+    return saved ? EXIT_SUCCESS : EXIT_FAILURE; }
+
+  bool ok = true;
+  if (strcmp( mode, "arena" ) != 0) ok = runLoad( data, size, numObjects, false ) && ok;
+  if (strcmp( mode, "heap" ) != 0) ok = runLoad( data, size, numObjects, true ) && ok;
+
+  std::free( data );
+  printf( "Data check: %s\n", ok ? "OK" : "FAILED" );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
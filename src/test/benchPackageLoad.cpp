@@ -0,0 +1,228 @@
+#include "core/geEngine.h"
+#include "io/geFileMap.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of package loading. Writes a large mesh
+package in the plain and the aligned layout, then loads it
+the way Kernel used to, by reading the file into memory and
+copying every array, and the way it does now, by mapping
+the file and borrowing the arrays in place. Reports load
+time, including a first pass over the vertex data since
+mapped pages are only read in when touched, and memory
+each load allocates for file data.
+-----------------------------------------------------------*/
+
+UintSize numVerts = 2000000;
+UintSize numRepeat = 10;
+const char *fileName = "benchPackage.bin";
+
+void createMesh (TriMesh *mesh)
+{
+  VertexFormat format;
+  format.addMember( ShaderData::TexCoord2 );
+  format.addMember( ShaderData::Normal );
+  format.addMember( ShaderData::Coord3 );
+  mesh->setFormat( format );
+  mesh->setResourceName( "Level" );
+
+  UintSize side = 2;
+  while (side * side < numVerts) side++;
+
+  mesh->data.clear();
+  mesh->data.resize( side * side );
+  Float *v = (Float*) mesh->data.buffer();
+  for (UintSize y=0; y<side; ++y) {
+    for (UintSize x=0; x<side; ++x)
+    {
+      *v++ = (Float) x / side;  *v++ = (Float) y / side;
+      *v++ = 0.0f;  *v++ = 1.0f;  *v++ = 0.0f;
+      *v++ = (Float) x;  *v++ = 0.0f;  *v++ = (Float) y;
+    }}
+
+  mesh->addFaceGroup( 0 );
+  for (UintSize y=0; y+1<side; ++y) {
+    for (UintSize x=0; x+1<side; ++x)
+    {
+      VertexID i = (VertexID) (y * side + x);
+      mesh->addFace( i, i + (VertexID) side, i + 1 );
+      mesh->addFace( i + 1, i + (VertexID) side, i + (VertexID) side + 1 );
+    }}
+}
+
+bool writePackage (TriMesh *mesh, bool aligned)
+{
+  Serializer s;
+  s.setArrayAlignment( aligned );
+
+  void *data = NULL;
+  UintSize size = 0;
+  s.serialize( mesh, &data, &size );
+
+  FILE *file = fopen( fileName, "wb" );
+  if (file == NULL) {
+    std::free( data );
+    return false; }
+
+  fwrite( s.getSignature(), 1, s.getSignatureSize(), file );
+  fwrite( data, 1, size, file );
+  fclose( file );
+  std::free( data );
+  return true;
+}
+
+UintSize getArrayBytes (TriMesh *mesh)
+{
+  return mesh->data.size() * mesh->data.elementSize() +
+    mesh->indices.size() * sizeof( VertexID ) +
+    mesh->groups.size() * sizeof( TriMesh::IndexGroup );
+}
+
+bool meshEqual (TriMesh *a, TriMesh *b)
+{
+  if (a == NULL || b == NULL) return false;
+  if (a->data.size() != b->data.size()) return false;
+  if (a->indices.size() != b->indices.size()) return false;
+  if (memcmp( a->data.buffer(), b->data.buffer(), a->data.size() * a->data.elementSize() ) != 0) return false;
+  return memcmp( a->indices.buffer(), b->indices.buffer(), a->indices.size() * sizeof( VertexID )) == 0;
+}
+
+Float touchMesh (TriMesh *mesh)
+{
+  //Read every vertex like an upload to the GPU would
+  Float sum = 0.0f;
+  if (mesh == NULL) return sum;
+  for (UintSize v=0; v<mesh->data.size(); ++v)
+    sum += *(Float*) mesh->data.at( v );
+  return sum;
+}
+
+/*
+Previous Kernel path: the whole file is read into memory
+and every array is copied out of it. */
+
+TriMesh* loadRead (UintSize &outAllocated)
+{
+  FILE *file = fopen( fileName, "rb" );
+  if (file == NULL) return NULL;
+
+  fseek( file, 0, SEEK_END );
+  UintSize fileSize = (UintSize) ftell( file );
+  fseek( file, 0, SEEK_SET );
+
+  Uint8 *data = (Uint8*) std::malloc( fileSize );
+  UintSize numRead = fread( data, 1, fileSize, file );
+  fclose( file );
+
+  Serializer s;
+  TriMesh *mesh = NULL;
+  if (numRead == fileSize && s.checkSignature( data ))
+  {
+    UintSize sigSize = s.getSignatureSize();
+    mesh = (TriMesh*) s.deserialize( data + sigSize, fileSize - sigSize );
+  }
+
+  //The read buffer and the copies are resident at once
+  outAllocated = fileSize + (mesh ? getArrayBytes( mesh ) : 0);
+  std::free( data );
+  return mesh;
+}
+
+/*
+Current Kernel path: the file is mapped and large arrays
+are borrowed from the mapping. */
+
+TriMesh* loadMapped (FileMap &package, UintSize &outAllocated)
+{
+  Serializer s;
+  if (!package.open( fileName )) return NULL;
+  if (!s.checkSignature( package.getData() )) return NULL;
+  s.setArrayBorrowing( true );
+
+  UintSize sigSize = s.getSignatureSize();
+  TriMesh *mesh = (TriMesh*) s.deserialize(
+    package.getData() + sigSize, package.getSize() - sigSize );
+
+  //Only arrays that could not be borrowed are allocated
+  outAllocated = (mesh ? getArrayBytes( mesh ) : 0) - s.getBorrowedSize();
+  return mesh;
+}
+
+bool runLayout (TriMesh *original, bool aligned)
+{
+  if (!writePackage( original, aligned )) {
+    printf( "Failed writing %s\n", fileName );
+    return false; }
+
+  printf( "\n%s layout:\n", aligned ? "Aligned" : "Plain" );
+  bool ok = true;
+  UintSize allocRead = 0, allocMapped = 0;
+
+  //Check results once
+  TriMesh *meshRead = loadRead( allocRead );
+  ok = ok && meshEqual( original, meshRead );
+  delete meshRead;
+
+  FileMap check;
+  TriMesh *meshMapped = loadMapped( check, allocMapped );
+  ok = ok && meshEqual( original, meshMapped );
+  printf( "Mapped: vertex data %s, indices %s\n",
+          meshMapped && meshMapped->data.isBorrowed() ? "borrowed" : "copied",
+          meshMapped && meshMapped->indices.isBorrowed() ? "borrowed" : "copied" );
+  delete meshMapped;
+  check.close();
+
+  Float sum = 0.0f;
+  Time::ResetTicks();
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    UintSize alloc = 0;
+    TriMesh *mesh = loadRead( alloc );
+    sum += touchMesh( mesh );
+    delete mesh;
+  }
+  Float msRead = (Float) Time::GetTicks() / numRepeat;
+
+  Time::ResetTicks();
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    UintSize alloc = 0;
+    FileMap package;
+    TriMesh *mesh = loadMapped( package, alloc );
+    sum += touchMesh( mesh );
+    delete mesh;
+  }
+  Float msMapped = (Float) Time::GetTicks() / numRepeat;
+
+  printf( "Read and copy: %.2f ms, %.1f MB allocated\n",
+          msRead, (Float) allocRead / (1024.0f * 1024.0f) );
+  printf( "Map and borrow: %.2f ms, %.1f MB allocated\n",
+          msMapped, (Float) allocMapped / (1024.0f * 1024.0f) );
+  printf( "Data check: %s (%.0f)\n", ok ? "OK" : "FAILED", sum );
+  return ok;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) numVerts = (UintSize) atoi( argv[1] );
+  if (argc > 2) fileName = argv[2];
+
+  Serializer::Register< TriMesh >();
+
+  TriMesh mesh;
+  createMesh( &mesh );
+  printf( "Vertices: %d, triangles: %d, arrays: %.1f MB\n",
+          (int) mesh.getVertexCount(), (int) mesh.getFaceCount(),
+          (Float) getArrayBytes( &mesh ) / (1024.0f * 1024.0f) );
+
+  bool ok = runLayout( &mesh, false );
+  ok = runLayout( &mesh, true ) && ok;
+
+  remove( fileName );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,136 @@
+#include "util/geUtil.h"
+#include "math/geMath.h"
+#include "core/geRenderQueue.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+
+/*
+-----------------------------------------------------------
+Headless test and benchmark of the render queue. Fills it
+with draw items of synthetic actors in scene order, submits
+them to the recording backend and checks that every draw
+sees the right shader and material. Reports the binds
+issued against one bind of each kind per item as with
+the unsorted traversal.
+-----------------------------------------------------------*/
+
+UintSize numActors = 20000;
+UintSize numGroups = 3;
+UintSize numMeshes = 200;
+UintSize numMaterials = 60;
+UintSize numShaders = 8;
+UintSize numRepeat = 20;
+
+//Opaque handles, the recording backend never dereferences them
+static char handles[ 4 ][ 100000 ];
+
+Actor3D* fakeActor (UintSize a) { return (Actor3D*) &handles[0][a]; }
+TriMesh* fakeMesh (UintSize m) { return (TriMesh*) &handles[1][m]; }
+Material* fakeMaterial (UintSize m) { return (Material*) &handles[2][m]; }
+Shader* fakeShader (UintSize s) { return (Shader*) &handles[3][s]; }
+
+UintSize materialOf (UintSize a, UintSize g) { return (a * 7 + g) % numMaterials; }
+UintSize shaderOf (UintSize a, UintSize g) { return materialOf( a,g ) % numShaders; }
+
+void fillQueue (RenderQueue &queue)
+{
+  queue.begin( RenderTarget::GBuffer );
+  Matrix4x4 world;
+
+  for (UintSize a=0; a<numActors; ++a)
+  {
+    //Every 50th actor renders itself like skinned meshes
+    Float depth = (Float) (rand() % 1000);
+    if (a % 50 == 0) {
+      queue.addCustom( fakeActor( a ), world, depth );
+      continue; }
+
+    for (UintSize g=0; g<numGroups; ++g)
+      queue.add( fakeActor( a ), fakeShader( shaderOf( a,g )), fakeMaterial( materialOf( a,g )),
+                 fakeMesh( a % numMeshes ), (Int) g, world, depth );
+  }
+}
+
+bool checkOrder (RenderQueue &queue)
+{
+  for (UintSize i=1; i<queue.size(); ++i)
+    if (queue.getSortedKey( i-1 ) > queue.getSortedKey( i ))
+      return false;
+  return true;
+}
+
+bool checkCommands (RecordingRenderBackend &backend)
+{
+  //Replay and verify state at every draw
+  const ArrayList< RecordingRenderBackend::Command > &cmds = backend.getCommands();
+  void *shader = NULL, *material = NULL, *meshActor = NULL;
+  UintSize numDraws = 0;
+
+  for (UintSize c=0; c<cmds.size(); ++c)
+  {
+    const RecordingRenderBackend::Command &cmd = cmds[c];
+    switch (cmd.type)
+    {
+    case RenderCommand::UseShader: shader = cmd.object; break;
+    case RenderCommand::BindMesh: meshActor = cmd.object; break;
+    case RenderCommand::UnbindMesh: meshActor = NULL; break;
+    case RenderCommand::BeginMaterial: material = cmd.object; break;
+    case RenderCommand::EndMaterial: material = NULL; break;
+    case RenderCommand::DrawActor: numDraws++; break;
+    case RenderCommand::DrawGroup:
+      {
+        UintSize a = (UintSize) ((char*) cmd.object - handles[0]);
+        UintSize m = (UintSize) ((char*) meshActor - handles[0]);
+        if (shader != fakeShader( shaderOf( a, cmd.group ))) return false;
+        if (material != fakeMaterial( materialOf( a, cmd.group ))) return false;
+        if (meshActor == NULL || m % numMeshes != a % numMeshes) return false;
+        numDraws++;
+        break;
+      }
+    default: break;
+    }
+  }
+
+  UintSize numCustom = numActors / 50;
+  return numDraws == (numActors - numCustom) * numGroups + numCustom;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) numActors = (UintSize) atoi( argv[1] );
+  if (numActors > 100000) numActors = 100000;
+
+  RenderQueue queue;
+  RecordingRenderBackend backend;
+
+  //Correctness
+  fillQueue( queue );
+  queue.sort();
+  bool orderOk = checkOrder( queue );
+  queue.submit( &backend );
+  bool commandsOk = checkCommands( backend );
+
+  const RenderQueueStats &stats = queue.getStats();
+  UintSize numItems = stats.numItems - stats.numCustom;
+  printf( "Items: %d (%d custom)\n", (int) stats.numItems, (int) stats.numCustom );
+  printf( "Shader binds:   %7d  avoided %7d\n", (int) stats.numShaderBinds, (int) (numItems - stats.numShaderBinds) );
+  printf( "Mesh binds:     %7d  avoided %7d\n", (int) stats.numMeshBinds, (int) (numItems - stats.numMeshBinds) );
+  printf( "Material binds: %7d  avoided %7d\n", (int) stats.numMaterialBinds, (int) (numItems - stats.numMaterialBinds) );
+  printf( "Sort order: %s, Draw state: %s\n", orderOk ? "OK" : "FAILED", commandsOk ? "OK" : "FAILED" );
+
+  //Throughput of fill, sort and submit
+  Time::ResetTicks();
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    backend.clear();
+    fillQueue( queue );
+    queue.sort();
+    queue.submit( &backend );
+  }
+  Float ms = (Float) Time::GetTicks() / numRepeat;
+  printf( "Fill + sort + submit: %.3f ms per frame\n", ms );
+
+  return (orderOk && commandsOk) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,207 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of the resource cache. Plays through a
+sequence of levels, each spawning actors that reference a
+set of meshes drawn from a larger pool with neighbouring
+levels sharing some of them. Runs the sequence with no
+budget, the way Kernel kept every resource before, and
+with a mesh budget. Reports peak resident memory, cache
+hits, misses and evictions, and checks that no mesh still
+referenced by an actor was evicted.
+-----------------------------------------------------------*/
+
+UintSize numLevels = 40;
+UintSize numPool = 400;
+UintSize numLevelMeshes = 40;
+UintSize numActors = 400;
+UintSize numMeshVerts = 20000;
+UintSize budgetMB = 64;
+
+UintSize numLoads = 0;
+
+CharString getMeshName (UintSize m)
+{
+  char name[ 64 ];
+  snprintf( name, sizeof( name ), "Mesh%d", (int) m );
+  return name;
+}
+
+/*
+Stands in for reading a mesh package. Vertex data is
+derived from the name so the content can be checked. */
+
+TriMesh* loadMesh (UintSize m)
+{
+  TriMesh *mesh = new TriMesh;
+
+  VertexFormat format;
+  format.addMember( ShaderData::TexCoord2 );
+  format.addMember( ShaderData::Normal );
+  format.addMember( ShaderData::Coord3 );
+  mesh->setFormat( format );
+
+  mesh->data.clear();
+  mesh->data.resize( numMeshVerts );
+  Float *v = (Float*) mesh->data.buffer();
+  for (UintSize i=0; i<numMeshVerts * 8; ++i)
+    *v++ = (Float) m;
+
+  mesh->addFaceGroup( 0 );
+  for (UintSize i=0; i+2<numMeshVerts; i+=3)
+    mesh->addFace( (VertexID) i, (VertexID) i+1, (VertexID) i+2 );
+
+  numLoads++;
+  return mesh;
+}
+
+bool meshValid (TriMesh *mesh, UintSize m)
+{
+  if (mesh == NULL || mesh->data.size() != numMeshVerts) return false;
+  Float *v = (Float*) mesh->data.buffer();
+  return v[0] == (Float) m && v[ numMeshVerts * 8 - 1 ] == (Float) m;
+}
+
+/*
+Same as Kernel::requestResource for a resource that loads
+right away. */
+
+void resolve (ResourceCache &cache, MeshRef *ref, UintSize m)
+{
+  *ref = getMeshName( m );
+  Resource *res = cache.lookup( ref->name );
+  if (res == NULL) {
+    res = loadMesh( m );
+    cache.insert( res, ref->name ); }
+
+  *ref = (TriMesh*) res;
+}
+
+struct LevelActor
+{
+  MeshRef mesh;
+  UintSize meshIndex;
+};
+
+bool runLevels (UintSize budget, UintSize &peak)
+{
+  ResourceCache cache;
+  cache.setBudget( ResourceType::Mesh, budget );
+  numLoads = 0;
+  peak = 0;
+  bool ok = true;
+
+  Uint64 start = Time::GetMicroseconds();
+  for (UintSize l=0; l<numLevels; ++l)
+  {
+    //Level uses a window of the pool overlapping the last one
+    UintSize first = (l * numLevelMeshes / 2) % numPool;
+    ArrayList< LevelActor* > actors;
+    for (UintSize a=0; a<numActors; ++a)
+    {
+      LevelActor *actor = new LevelActor;
+      actor->meshIndex = (first + (a * 7) % numLevelMeshes) % numPool;
+      resolve( cache, &actor->mesh, actor->meshIndex );
+      actors.pushBack( actor );
+    }
+
+    //A frame of the level, then the end of frame trim
+    peak = Util::Max( peak, cache.getResidentBytes() );
+    if (cache.isOverBudget()) cache.trim();
+
+    for (UintSize a=0; a<actors.size(); ++a)
+      ok = ok && meshValid( actors[ a ]->mesh, actors[ a ]->meshIndex );
+
+    //Unload the level
+    for (UintSize a=0; a<actors.size(); ++a)
+      delete actors[ a ];
+  }
+  Float ms = (Float) (Time::GetMicroseconds() - start) / 1000.0f;
+
+  printf( "%s: peak %.1f MB, %d meshes left resident, %d loads, %.1f ms\n",
+          budget > 0 ? "Budget" : "No budget",
+          (Float) peak / (1024.0f * 1024.0f), (int) cache.getNumResources(),
+          (int) numLoads, ms );
+  printf( "  hits %d, misses %d, evictions %d\n",
+          (int) cache.getNumHits(), (int) cache.getNumMisses(),
+          (int) cache.getNumEvictions() );
+
+  //Hits and misses add up to the lookups, misses to the loads
+  ok = ok && cache.getNumHits() + cache.getNumMisses() == numLevels * numActors;
+  ok = ok && cache.getNumMisses() == numLoads;
+  return ok;
+}
+
+/*
+A mesh replaced under its name stays until its user is
+done with it, and one a scene holds survives clearing. */
+
+bool runReplace ()
+{
+  ResourceCache cache;
+  bool ok = true;
+
+  MeshRef ref;
+  resolve( cache, &ref, 0 );
+  cache.insert( loadMesh( 1 ), getMeshName( 0 ));
+  ok = ok && cache.getNumResources() == 1;
+  ok = ok && meshValid( (TriMesh*) cache.find( getMeshName( 0 )), 1 );
+
+  cache.clear();
+  ok = ok && meshValid( ref, 0 );
+
+  ref = (TriMesh*) NULL;
+  cache.clear();
+  ok = ok && cache.getNumResources() == 0 && cache.getResidentBytes() == 0;
+
+  Scene3D *scene = new Scene3D;
+  scene->resources.pushBack( loadMesh( 2 ));
+  scene->referenceResources();
+  cache.insert( scene->resources[0], getMeshName( 2 ));
+
+  cache.clear();
+  ok = ok && meshValid( (TriMesh*) scene->resources[0], 2 );
+
+  delete scene;
+  cache.clear();
+  ok = ok && cache.getNumResources() == 0 && cache.getResidentBytes() == 0;
+
+  printf( "Replace: %d evictions\n", (int) cache.getNumEvictions() );
+  return ok;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) numLevels = (UintSize) atoi( argv[1] );
+  if (argc > 2) budgetMB = (UintSize) atoi( argv[2] );
+
+  Serializer::Register< TriMesh >();
+
+  UintSize meshBytes = 0;
+  {
+    TriMesh *mesh = loadMesh( 0 );
+    meshBytes = mesh->getByteSize();
+    delete mesh;
+  }
+
+  printf( "Levels: %d, %d meshes per level from a pool of %d, %.2f MB each\n",
+          (int) numLevels, (int) numLevelMeshes, (int) numPool,
+          (Float) meshBytes / (1024.0f * 1024.0f) );
+
+  UintSize peakUnbounded = 0, peakBudget = 0;
+  bool ok = runLevels( 0, peakUnbounded );
+  ok = runLevels( budgetMB * 1024 * 1024, peakBudget ) && ok;
+  ok = runReplace() && ok;
+
+  //Over budget by at most the meshes one level holds
+  ok = ok && peakBudget <= budgetMB * 1024 * 1024 + numLevelMeshes * meshBytes;
+
+  printf( "Data check: %s\n", ok ? "OK" : "FAILED" );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
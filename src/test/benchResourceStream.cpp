@@ -0,0 +1,325 @@
+#include "core/geEngine.h"
+#include "io/geFileMap.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of resource streaming. Writes a set of
+mesh packages and loads them all on the main thread, the
+way Kernel::getResource does, then through ResourceLoader
+with worker threads and a per-frame finalization budget.
+The GPU upload is stubbed by a copy of the vertex data.
+Reports the longest main thread stall of both, and checks
+that every reference ends up with the right mesh, that
+high priority requests finish first and that a canceled
+request never reaches its reference.
+-----------------------------------------------------------*/
+
+UintSize numMeshes = 64;
+UintSize numMeshVerts = 100000;
+Float budgetMs = 2.0f;
+const char *fileFormat = "benchStream%d.bin";
+
+ArrayList< TriMesh* > originals;
+ArrayList< Int > finishOrder;
+ArrayList< Uint8 > uploadBuffer;
+
+CharString getFileName (UintSize m)
+{
+  char name[ 64 ];
+  snprintf( name, sizeof( name ), fileFormat, (int) m );
+  return name;
+}
+
+TriMesh* createMesh (UintSize m)
+{
+  TriMesh *mesh = new TriMesh;
+  mesh->setResourceName( getFileName( m ));
+
+  VertexFormat format;
+  format.addMember( ShaderData::TexCoord2 );
+  format.addMember( ShaderData::Normal );
+  format.addMember( ShaderData::Coord3 );
+  mesh->setFormat( format );
+
+  mesh->data.clear();
+  mesh->data.resize( numMeshVerts );
+  Float *v = (Float*) mesh->data.buffer();
+  for (UintSize i=0; i<numMeshVerts * 8; ++i)
+    *v++ = (Float) ((i * 7 + m) % 100) * 0.01f;
+
+  mesh->addFaceGroup( 0 );
+  for (UintSize i=0; i+2<numMeshVerts; i+=3)
+    mesh->addFace( (VertexID) i, (VertexID) i+1, (VertexID) i+2 );
+
+  return mesh;
+}
+
+bool writePackage (TriMesh *mesh)
+{
+  Serializer s;
+  s.setArrayAlignment( true );
+
+  void *data = NULL;
+  UintSize size = 0;
+  s.serialize( mesh, &data, &size );
+
+  FILE *file = fopen( mesh->getResourceName().buffer(), "wb" );
+  if (file == NULL) {
+    std::free( data );
+    return false; }
+
+  fwrite( s.getSignature(), 1, s.getSignatureSize(), file );
+  fwrite( data, 1, size, file );
+  fclose( file );
+  std::free( data );
+  return true;
+}
+
+bool meshEqual (TriMesh *a, TriMesh *b)
+{
+  if (a == NULL || b == NULL) return false;
+  if (a->data.size() != b->data.size()) return false;
+  if (a->indices.size() != b->indices.size()) return false;
+  if (memcmp( a->data.buffer(), b->data.buffer(), a->data.size() * a->data.elementSize() ) != 0) return false;
+  return memcmp( a->indices.buffer(), b->indices.buffer(), a->indices.size() * sizeof( VertexID )) == 0;
+}
+
+/*
+Stands in for the kernel: the upload is a copy of the
+vertex and index data into a staging buffer. */
+
+class StubFinalizer : public ResourceFinalizer
+{
+public:
+  ArrayList< FileMap* > packages;
+
+  virtual Resource* finalize (LoadRequest *req)
+  {
+    TriMesh *mesh = Class::SafeCast< TriMesh >( req->resource );
+    if (mesh == NULL) return NULL;
+
+    UintSize dataSize = mesh->data.size() * mesh->data.elementSize();
+    UintSize indexSize = mesh->indices.size() * sizeof( VertexID );
+    uploadBuffer.clear();
+    uploadBuffer.resize( dataSize + indexSize );
+    memcpy( uploadBuffer.buffer(), mesh->data.buffer(), dataSize );
+    memcpy( uploadBuffer.buffer() + dataSize, mesh->indices.buffer(), indexSize );
+
+    //Take the mesh and the mapping it borrows from
+    packages.pushBack( req->package );
+    req->resource = NULL;
+    req->package = NULL;
+    finishOrder.pushBack( req->priority );
+    return mesh;
+  }
+};
+
+/*
+Loads packages from the working directory instead of the
+engine's mesh folder. Workers can be held back until all
+the requests are queued, so the order they're taken in
+doesn't depend on thread scheduling. */
+
+class BenchLoader : public ResourceLoader
+{
+public:
+  Semaphore gate;
+
+  BenchLoader (ResourceFinalizer *f, Uint numThreads = 0, bool closed = false)
+    : ResourceLoader( f, numThreads )
+  {
+    if (!closed) gate.post();
+  }
+
+  ~BenchLoader ()
+  {
+    stop();
+  }
+
+protected:
+  virtual bool load (LoadRequest *req)
+  {
+    //Let the next worker through too
+    gate.wait();
+    gate.post();
+    return LoadPackage( req, req->name );
+  }
+};
+
+Float getMs (Uint64 start)
+{
+  return (Float) (Time::GetMicroseconds() - start) / 1000.0f;
+}
+
+void releaseMeshes (ArrayList< MeshRef* > &refs, ArrayList< FileMap* > &packages)
+{
+  //Drop the reference before the mesh it counts on
+  for (UintSize r=0; r<refs.size(); ++r) {
+    TriMesh *mesh = *refs[ r ];
+    delete refs[ r ];
+    delete mesh; }
+
+  for (UintSize p=0; p<packages.size(); ++p)
+    delete packages[ p ];
+
+  refs.clear();
+  packages.clear();
+}
+
+/*
+Previous path: every load and upload happens inline, so
+the first frame using the meshes stalls for all of it. */
+
+Float loadBlocking (bool &ok)
+{
+  StubFinalizer finalizer;
+  ArrayList< MeshRef* > refs;
+
+  Uint64 start = Time::GetMicroseconds();
+  for (UintSize m=0; m<numMeshes; ++m)
+  {
+    MeshRef *ref = new MeshRef;
+    *ref = getFileName( m );
+    refs.pushBack( ref );
+
+    LoadRequest req;
+    req.name = ref->name;
+    if (ResourceLoader::LoadPackage( &req, req.name ))
+      ref->set( finalizer.finalize( &req ));
+  }
+  Float ms = getMs( start );
+
+  for (UintSize m=0; m<numMeshes; ++m)
+    ok = ok && meshEqual( originals[ m ], *refs[ m ] );
+
+  releaseMeshes( refs, finalizer.packages );
+  return ms;
+}
+
+/*
+Streaming path: requests return right away and every frame
+spends at most about the budget finishing loaded meshes. */
+
+Float loadStreaming (Float &maxFrameMs, UintSize &numFrames, bool &ok)
+{
+  StubFinalizer finalizer;
+  BenchLoader loader( &finalizer, 0, true );
+  ArrayList< MeshRef* > refs;
+  finishOrder.clear();
+
+  //Every fourth mesh is needed urgently
+  Uint64 start = Time::GetMicroseconds();
+  for (UintSize m=0; m<numMeshes; ++m)
+  {
+    MeshRef *ref = new MeshRef;
+    *ref = getFileName( m );
+    refs.pushBack( ref );
+    loader.request( ref, (m % 4 == 3) ? 10 : 0 );
+  }
+  maxFrameMs = getMs( start );
+
+  //A second reference to the same mesh shares the request
+  MeshRef shared;
+  shared = getFileName( 0 );
+  loader.request( &shared );
+  ok = ok && loader.getNumPending() == numMeshes;
+  loader.gate.post();
+
+  //Frames until everything is in
+  numFrames = 0;
+  while (loader.getNumPending() > 0)
+  {
+    Uint64 frame = Time::GetMicroseconds();
+    loader.finalize( budgetMs );
+    maxFrameMs = Util::Max( maxFrameMs, getMs( frame ));
+    numFrames++;
+  }
+  Float ms = getMs( start );
+
+  for (UintSize m=0; m<numMeshes; ++m) {
+    ok = ok && refs[ m ]->isReady();
+    ok = ok && meshEqual( originals[ m ], *refs[ m ] ); }
+  ok = ok && shared.ptr == refs[ 0 ]->ptr;
+  ok = ok && (*refs[ 0 ])->getRefCount() == 2;
+
+  //Urgent ones finish before all but those taken before the gate opened
+  UintSize lowBeforeHigh = 0, highLeft = numMeshes / 4;
+  for (UintSize f=0; f<finishOrder.size() && highLeft > 0; ++f) {
+    if (finishOrder[ f ] > 0) highLeft--;
+    else lowBeforeHigh++; }
+
+  printf( "Low priority finished before the last high one: %d\n", (int) lowBeforeHigh );
+  ok = ok && lowBeforeHigh <= (UintSize) loader.getNumThreads();
+
+  shared = NULL;
+  releaseMeshes( refs, finalizer.packages );
+  return ms;
+}
+
+bool checkCancel ()
+{
+  StubFinalizer finalizer;
+  BenchLoader loader( &finalizer, 1 );
+  finishOrder.clear();
+
+  //Keep the only worker busy so the second request stays queued
+  MeshRef busy, canceled;
+  busy = getFileName( 0 );
+  canceled = getFileName( 1 );
+  loader.request( &busy );
+  loader.request( &canceled );
+  loader.cancel( &canceled );
+  loader.flush();
+
+  bool ok = busy.isReady() && canceled.ptr == NULL &&
+    canceled.state == ResourceState::Placeholder &&
+    finishOrder.size() == 1;
+
+  ArrayList< MeshRef* > refs;
+  refs.pushBack( new MeshRef );
+  *refs.first() = (TriMesh*) busy;
+  busy = NULL;
+  releaseMeshes( refs, finalizer.packages );
+  return ok;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) numMeshes = (UintSize) atoi( argv[1] );
+  if (argc > 2) numMeshVerts = (UintSize) atoi( argv[2] );
+  if (argc > 3) budgetMs = (Float) atof( argv[3] );
+
+  Serializer::Register< TriMesh >();
+
+  bool ok = true;
+  for (UintSize m=0; m<numMeshes; ++m) {
+    originals.pushBack( createMesh( m ));
+    ok = ok && writePackage( originals.last() ); }
+
+  printf( "Meshes: %d x %d vertices, budget %.1f ms\n",
+          (int) numMeshes, (int) numMeshVerts, budgetMs );
+
+  Float msBlocking = loadBlocking( ok );
+  printf( "Blocking: %.2f ms total, all of it on the main thread\n", msBlocking );
+
+  Float maxFrameMs = 0.0f;
+  UintSize numFrames = 0;
+  Float msStreaming = loadStreaming( maxFrameMs, numFrames, ok );
+  printf( "Streaming: %.2f ms total over %d frames, longest frame %.2f ms\n",
+          msStreaming, (int) numFrames, maxFrameMs );
+
+  bool okCancel = checkCancel();
+  printf( "Cancel check: %s\n", okCancel ? "OK" : "FAILED" );
+  printf( "Data check: %s\n", ok ? "OK" : "FAILED" );
+
+  for (UintSize m=0; m<numMeshes; ++m) {
+    remove( getFileName( m ).buffer() );
+    delete originals[ m ]; }
+
+  return (ok && okCancel) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,243 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of scene package loading. Builds a scene
+with hundreds of mesh resources and loads it as one blob,
+the way Kernel::loadScene did, and as a ScenePackage with
+the resources deserialized on thread pools of growing
+size. The GPU upload isn't part of it. Checks that every
+load ends up with the same objects and mesh data.
+-----------------------------------------------------------*/
+
+UintSize numMeshes = 300;
+UintSize numMeshVerts = 5000;
+UintSize numActors = 3000;
+UintSize numRepeat = 5;
+
+CharString getMeshName (UintSize m)
+{
+  char name[ 64 ];
+  snprintf( name, sizeof( name ), "Mesh%d.pak", (int) m );
+  return name;
+}
+
+TriMesh* createMesh (UintSize m)
+{
+  TriMesh *mesh = new TriMesh;
+  mesh->setResourceName( getMeshName( m ));
+
+  VertexFormat format;
+  format.addMember( ShaderData::TexCoord2 );
+  format.addMember( ShaderData::Normal );
+  format.addMember( ShaderData::Coord3 );
+  mesh->setFormat( format );
+
+  mesh->data.clear();
+  mesh->data.resize( numMeshVerts );
+  Float *v = (Float*) mesh->data.buffer();
+  for (UintSize i=0; i<numMeshVerts * 8; ++i)
+    *v++ = (Float) ((i * 7 + m) % 100) * 0.01f;
+
+  mesh->addFaceGroup( 0 );
+  for (UintSize i=0; i+2<numMeshVerts; i+=3)
+    mesh->addFace( (VertexID) i, (VertexID) i+1, (VertexID) i+2 );
+
+  return mesh;
+}
+
+Scene3D* createScene ()
+{
+  Scene3D *scene = new Scene3D;
+  Actor3D *root = new Actor3D;
+  scene->setRoot( root );
+
+  for (UintSize m=0; m<numMeshes; ++m)
+    scene->resources.pushBack( createMesh( m ));
+
+  for (UintSize a=0; a<numActors; ++a)
+  {
+    TriMeshActor *actor = new TriMeshActor;
+    actor->setMesh( getMeshName( a % numMeshes ));
+    actor->translate( 0.0f, 0.0f, (Float) a );
+    root->addChild( actor );
+  }
+
+  return scene;
+}
+
+/*
+Sum of the resource data, independent of their order. */
+
+Float getChecksum (Scene3D *scene)
+{
+  Float sum = 0.0f;
+  for (UintSize r=0; r<scene->resources.size(); ++r)
+  {
+    TriMesh *mesh = Class::SafeCast< TriMesh >( scene->resources[ r ] );
+    if (mesh == NULL) continue;
+    Float *v = (Float*) mesh->data.buffer();
+    sum += v[0] + v[ mesh->data.size() * 8 - 1 ] + (Float) mesh->indices.size();
+  }
+  return sum;
+}
+
+/*
+Scenes, actors and resources are allocated on their own,
+the rest of the objects are members of them. Members are
+recorded after their owner, so going backwards sees them
+before the owner is deleted. */
+
+bool isAllocated (Object *obj)
+{
+  return Class::SafeCast< Scene >( obj ) != NULL ||
+    Class::SafeCast< Actor >( obj ) != NULL ||
+    Class::SafeCast< Resource >( obj ) != NULL;
+}
+
+UintSize deleteObjects (const ArrayList< Object* > &objects)
+{
+  UintSize count = 0;
+  for (UintSize o=objects.size(); o>0; --o)
+    if (isAllocated( objects[ o-1 ] )) {
+      delete objects[ o-1 ];
+      count++; }
+
+  return count;
+}
+
+Float getMs (Uint64 start)
+{
+  return (Float) (Time::GetMicroseconds() - start) / 1000.0f;
+}
+
+Float loadMonolithic (const void *data, UintSize size, UintSize numObjects, Float checksum, bool &ok)
+{
+  Float best = 0.0f;
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    Serializer s;
+    Uint64 start = Time::GetMicroseconds();
+    Scene3D *scene = Class::SafeCast< Scene3D >( s.deserialize( data, size ));
+    Float ms = getMs( start );
+    best = (r == 0) ? ms : Util::Min( best, ms );
+
+    ok = ok && scene != NULL && s.getObjects().size() == numObjects;
+    ok = ok && scene != NULL && getChecksum( scene ) == checksum;
+    deleteObjects( s.getObjects() );
+  }
+  return best;
+}
+
+Float loadPackage (const void *data, UintSize size, ThreadPool *pool,
+                   UintSize numObjects, Float checksum, bool &ok)
+{
+  Float best = 0.0f;
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    ScenePackage package;
+    Uint64 start = Time::GetMicroseconds();
+    bool read = package.read( data, size, pool );
+    Float ms = getMs( start );
+    best = (r == 0) ? ms : Util::Min( best, ms );
+
+    Scene3D *scene = package.getScene();
+    ok = ok && read && package.getNumBlobs() == numMeshes + 1;
+    ok = ok && package.getObjects().size() == numObjects;
+    ok = ok && scene != NULL && scene->resources.size() == numMeshes;
+    ok = ok && scene != NULL && getChecksum( scene ) == checksum;
+    deleteObjects( package.getObjects() );
+  }
+  return best;
+}
+
+/*
+Packages with the scene blob swapped with a mesh or with
+a broken signature must fail and leave nothing behind. */
+
+bool loadBroken (const void *data, UintSize size)
+{
+  Uint8 *copy = (Uint8*) std::malloc( size );
+  bool ok = true;
+
+  for (int c=0; c<2; ++c)
+  {
+    std::memcpy( copy, data, size );
+    Uint64 *index = (Uint64*) (copy + ScenePackage::GetSignatureSize() + sizeof( Uint64 ));
+
+    if (c == 0) {
+      Uint64 scene[2] = { index[0], index[1] };
+      index[0] = index[2]; index[1] = index[3];
+      index[2] = scene[0]; index[3] = scene[1]; }
+    else copy[ index[0] ] ^= 0xFF;
+
+    ScenePackage package;
+    ok = ok && !package.read( copy, size );
+    ok = ok && package.getScene() == NULL && package.getObjects().empty();
+  }
+
+  std::free( copy );
+  return ok;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) numMeshes = (UintSize) atoi( argv[1] );
+  if (argc > 2) numMeshVerts = (UintSize) atoi( argv[2] );
+
+  Serializer::Register< Scene3D >();
+  Serializer::Register< Actor3D >();
+  Serializer::Register< TriMeshActor >();
+  Serializer::Register< ResourceRef >();
+  Serializer::Register< TriMesh >();
+
+  //Same scene both ways
+  Scene3D *scene = createScene();
+  Float checksum = getChecksum( scene );
+
+  Serializer s;
+  void *blob = NULL;
+  UintSize blobSize = 0;
+  s.serialize( scene, &blob, &blobSize );
+  UintSize numObjects = s.getObjects().size();
+
+  void *package = NULL;
+  UintSize packageSize = 0;
+  ScenePackage::Write( scene, &package, &packageSize );
+  deleteObjects( s.getObjects() );
+
+  printf( "Scene: %d meshes x %d vertices, %d actors, %.1f MB\n",
+          (int) numMeshes, (int) numMeshVerts, (int) numActors,
+          (Float) packageSize / (1024.0f * 1024.0f) );
+
+  bool ok = true;
+  Float msBlob = loadMonolithic( blob, blobSize, numObjects, checksum, ok );
+  printf( "Single blob: %.2f ms\n", msBlob );
+
+  Float msInline = loadPackage( package, packageSize, NULL, numObjects, checksum, ok );
+  printf( "Package, no pool: %.2f ms\n", msInline );
+
+  //Thread counts up to twice the cores
+  Uint numCores = Thread::GetNumCores();
+  for (Uint t=1; t<=numCores * 2; t*=2)
+  {
+    ThreadPool pool( t );
+    Float ms = loadPackage( package, packageSize, &pool, numObjects, checksum, ok );
+    printf( "Package, %d threads: %.2f ms, %.2fx single blob\n",
+            (int) t, ms, (ms > 0.0f) ? msBlob / ms : 0.0f );
+  }
+
+  bool broken = loadBroken( package, packageSize );
+  printf( "Broken packages rejected: %s\n", broken ? "OK" : "FAILED" );
+  ok = ok && broken;
+
+  std::free( blob );
+  std::free( package );
+  printf( "Data check: %s\n", ok ? "OK" : "FAILED" );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
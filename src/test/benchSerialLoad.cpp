@@ -0,0 +1,174 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of TriMesh deserialization. Serializes
+a grid mesh with millions of vertices and loads it with
+the per-element array path the serializer used before,
+with bulk block loads and with arrays borrowed from the
+source buffer. Checks that all of them restore the same
+vertex and index data.
+-----------------------------------------------------------*/
+
+UintSize numVerts = 2000000;
+UintSize numRepeat = 10;
+
+/*
+Same payload as TriMesh but the arrays are loaded one
+element at a time, the way StateLoad::dataArray did. */
+
+class ElementTriMesh : public TriMesh
+{
+  CLASS( ElementTriMesh, TriMesh,
+    3f6d0b2a,9c41,4e75,b8d2e61a07c3f954 );
+
+  void loadElements (Serializer *s, GenericArrayList *a)
+  {
+    UintSize size = 0;
+    s->data( &size, sizeof( UintSize ));
+
+    a->clear();
+    a->resize( size );
+
+    for (UintSize e=0; e<size; ++e)
+      s->data( a->at( e ), a->elementSize() );
+  }
+
+  virtual void serialize( Serializer *s, Uint v )
+  {
+    if (!s->loading()) {
+      TriMesh::serialize( s,v );
+      return; }
+
+    Resource::serialize( s, v );
+    s->object( &format );
+    setFormat( format );
+    loadElements( s, &data );
+    loadElements( s, &indices );
+    loadElements( s, &groups );
+    s->data( &bbox );
+  }
+};
+
+void createMesh (TriMesh *mesh)
+{
+  VertexFormat format;
+  format.addMember( ShaderData::TexCoord2 );
+  format.addMember( ShaderData::Normal );
+  format.addMember( ShaderData::Coord3 );
+  mesh->setFormat( format );
+
+  //Square grid of quads split into two triangles
+  UintSize side = 2;
+  while (side * side < numVerts) side++;
+
+  mesh->data.clear();
+  mesh->data.resize( side * side );
+  Float *v = (Float*) mesh->data.buffer();
+  for (UintSize y=0; y<side; ++y) {
+    for (UintSize x=0; x<side; ++x)
+    {
+      *v++ = (Float) x / side;  *v++ = (Float) y / side;
+      *v++ = 0.0f;  *v++ = 1.0f;  *v++ = 0.0f;
+      *v++ = (Float) x;  *v++ = 0.0f;  *v++ = (Float) y;
+    }}
+
+  mesh->addFaceGroup( 0 );
+  for (UintSize y=0; y+1<side; ++y) {
+    for (UintSize x=0; x+1<side; ++x)
+    {
+      VertexID i = (VertexID) (y * side + x);
+      mesh->addFace( i, i + (VertexID) side, i + 1 );
+      mesh->addFace( i + 1, i + (VertexID) side, i + (VertexID) side + 1 );
+    }}
+
+  mesh->updateBoundingBox();
+}
+
+bool meshEqual (TriMesh *a, TriMesh *b)
+{
+  if (a == NULL || b == NULL) return false;
+  if (a->data.size() != b->data.size()) return false;
+  if (a->data.elementSize() != b->data.elementSize()) return false;
+  if (a->indices.size() != b->indices.size()) return false;
+  if (a->groups.size() != b->groups.size()) return false;
+
+  if (memcmp( a->data.buffer(), b->data.buffer(), a->data.size() * a->data.elementSize() ) != 0) return false;
+  if (memcmp( a->indices.buffer(), b->indices.buffer(), a->indices.size() * sizeof( VertexID )) != 0) return false;
+  return a->groups.first().count == b->groups.first().count;
+}
+
+Float timeLoad (const char *label, void *buffer, UintSize size, bool borrow, TriMesh *original, bool &ok)
+{
+  //Check the result of a first load
+  Serializer check;
+  check.setArrayBorrowing( borrow );
+  TriMesh *mesh = (TriMesh*) check.deserialize( buffer, size );
+  ok = ok && meshEqual( original, mesh );
+  if (borrow && mesh != NULL)
+    printf( "%s: vertex data %s, indices %s\n", label,
+            mesh->data.isBorrowed() ? "borrowed" : "copied",
+            mesh->indices.isBorrowed() ? "borrowed" : "copied" );
+  delete mesh;
+
+  //Releasing the mesh is part of the cost
+  Time::ResetTicks();
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    Serializer s;
+    s.setArrayBorrowing( borrow );
+    delete (TriMesh*) s.deserialize( buffer, size );
+  }
+  Float ms = (Float) Time::GetTicks() / numRepeat;
+
+  Float mbs = (ms > 0.0f) ? (Float) size / (1024.0f * 1024.0f) * 1000.0f / ms : 0.0f;
+  printf( "%s: %.2f ms per load, %.0f MB/s\n", label, ms, mbs );
+  return ms;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) numVerts = (UintSize) atoi( argv[1] );
+  if (argc > 2) numRepeat = (UintSize) atoi( argv[2] );
+
+  Serializer::Register< TriMesh >();
+  Serializer::Register< ElementTriMesh >();
+
+  //Same mesh under both classes
+  TriMesh mesh;
+  ElementTriMesh elementMesh;
+  createMesh( &mesh );
+  createMesh( &elementMesh );
+
+  void *bulkData = NULL, *elementData = NULL;
+  UintSize bulkSize = 0, elementSize = 0;
+  Serializer saver;
+
+  Time::ResetTicks();
+  saver.serialize( &mesh, &bulkData, &bulkSize );
+  Float msSave = (Float) Time::GetTicks();
+  saver.serialize( &elementMesh, &elementData, &elementSize );
+
+  printf( "Vertices: %d, triangles: %d\n",
+          (int) mesh.getVertexCount(), (int) mesh.getFaceCount() );
+  printf( "Serialized: %.1f MB in %.2f ms\n",
+          (Float) bulkSize / (1024.0f * 1024.0f), msSave );
+
+  bool ok = true;
+  Float msElement = timeLoad( "Per element", elementData, elementSize, false, &mesh, ok );
+  Float msBulk = timeLoad( "Bulk", bulkData, bulkSize, false, &mesh, ok );
+  Float msBorrow = timeLoad( "Borrowed", bulkData, bulkSize, true, &mesh, ok );
+
+  if (msBulk > 0.0f) printf( "Bulk speedup: %.1fx\n", msElement / msBulk );
+  if (msBorrow > 0.0f) printf( "Borrowed speedup: %.1fx\n", msElement / msBorrow );
+  printf( "Data check: %s\n", ok ? "OK" : "FAILED" );
+
+  std::free( bulkData );
+  std::free( elementData );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
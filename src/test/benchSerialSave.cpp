@@ -0,0 +1,146 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of scene serialization. Builds a scene
+shaped like an exported level, with grouped mesh actors
+each owning a material and the meshes embedded as scene
+resources. Saves it with the single pass growable writer
+and with the measuring run followed by a write into an
+exact buffer, as serialize did before. Checks the output
+of both is identical.
+-----------------------------------------------------------*/
+
+UintSize numActors = 20000;
+UintSize numGroups = 100;
+UintSize numMeshes = 200;
+UintSize numMeshVerts = 4000;
+UintSize numRepeat = 10;
+
+TriMesh* createMesh (UintSize m)
+{
+  TriMesh *mesh = new TriMesh;
+  mesh->setResourceName( CharString::Format( "Mesh%d", (int) m ));
+
+  VertexFormat format;
+  format.addMember( ShaderData::TexCoord2 );
+  format.addMember( ShaderData::Normal );
+  format.addMember( ShaderData::Coord3 );
+  mesh->setFormat( format );
+
+  mesh->data.clear();
+  mesh->data.resize( numMeshVerts );
+  Float *v = (Float*) mesh->data.buffer();
+  for (UintSize i=0; i<numMeshVerts * 8; ++i)
+    *v++ = (Float) ((i * 7 + m) % 100) * 0.01f;
+
+  mesh->addFaceGroup( 0 );
+  for (UintSize i=0; i+2<numMeshVerts; i+=3)
+    mesh->addFace( (VertexID) i, (VertexID) i+1, (VertexID) i+2 );
+
+  mesh->updateBoundingBox();
+  return mesh;
+}
+
+Scene3D* createScene ()
+{
+  Scene3D *scene = new Scene3D;
+  Actor3D *root = new Actor3D;
+  scene->setRoot( root );
+
+  for (UintSize m=0; m<numMeshes; ++m)
+    scene->resources.pushBack( createMesh( m ));
+
+  for (UintSize g=0; g<numGroups; ++g)
+  {
+    Actor3D *group = new Actor3D;
+    group->setName( CharString::Format( "Group%d", (int) g ));
+    group->translate( (Float) g * 10.0f, 0.0f, 0.0f );
+    root->addChild( group );
+
+    for (UintSize a=g; a<numActors; a+=numGroups)
+    {
+      StandardMaterial *mat = new StandardMaterial;
+      mat->setDiffuseColor( Vector3( (Float) (a % 10) * 0.1f, 0.5f, 0.5f ));
+
+      TriMeshActor *actor = new TriMeshActor;
+      actor->setName( CharString::Format( "Actor%d", (int) a ));
+      actor->setMesh( CharString::Format( "Mesh%d", (int) (a % numMeshes) ));
+      actor->setMaterial( mat );
+      actor->translate( 0.0f, 0.0f, (Float) a );
+      group->addChild( actor );
+    }
+  }
+
+  return scene;
+}
+
+void report (const char *label, Float ms, UintSize size, UintSize numObjects)
+{
+  Float mbs = (ms > 0.0f) ? (Float) size / (1024.0f * 1024.0f) * 1000.0f / ms : 0.0f;
+  Float objs = (ms > 0.0f) ? (Float) numObjects * 1000.0f / ms : 0.0f;
+  printf( "%s: %.2f ms per save, %.0f MB/s, %.0f objects/s\n", label, ms, mbs, objs );
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) numActors = (UintSize) atoi( argv[1] );
+  if (argc > 2) numRepeat = (UintSize) atoi( argv[2] );
+
+  Scene3D *scene = createScene();
+
+  //Single pass into a growable buffer
+  Serializer single;
+  void *singleData = NULL;
+  UintSize singleSize = 0;
+  single.serialize( scene, &singleData, &singleSize );
+  UintSize numObjects = single.getObjects().size();
+
+  //Measuring run, then a write into an exact buffer
+  Serializer twoPass;
+  UintSize twoPassSize = twoPass.measure( scene );
+  void *twoPassData = std::malloc( twoPassSize );
+  bool fit = twoPass.serialize( scene, twoPassData, twoPassSize );
+
+  bool same = fit && singleSize == twoPassSize &&
+    memcmp( singleData, twoPassData, singleSize ) == 0;
+
+  printf( "Actors: %d, objects: %d\n", (int) numActors, (int) numObjects );
+  printf( "Serialized: %.1f MB\n", (Float) singleSize / (1024.0f * 1024.0f) );
+  printf( "Identical output: %s\n", same ? "OK" : "FAILED" );
+
+  std::free( singleData );
+  std::free( twoPassData );
+
+  Time::ResetTicks();
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    Serializer s;
+    UintSize size = s.measure( scene );
+    void *data = std::malloc( size );
+    s.serialize( scene, data, size );
+    std::free( data );
+  }
+  Float msTwoPass = (Float) Time::GetTicks() / numRepeat;
+  report( "Two pass", msTwoPass, singleSize, numObjects );
+
+  Time::ResetTicks();
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    Serializer s;
+    void *data = NULL;
+    UintSize size = 0;
+    s.serialize( scene, &data, &size );
+    std::free( data );
+  }
+  Float msSingle = (Float) Time::GetTicks() / numRepeat;
+  report( "Single pass", msSingle, singleSize, numObjects );
+
+  if (msSingle > 0.0f) printf( "Speedup: %.2fx\n", msTwoPass / msSingle );
+  return same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,85 @@
+#include "util/geUtil.h"
+#include "core/geShaderComposer.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of shader composition. Composes all the
+default permutations without a GL context, reports the
+permutations composed per second and compares that with
+fetching the same sources from the source cache. Also
+checks that composition is deterministic so cached sources
+stay valid between runs.
+-----------------------------------------------------------*/
+
+UintSize numRepeat = 1000;
+
+bool checkDeterministic (ShaderComposer &composer, ShaderSourceCache &cache)
+{
+  ShaderKey key;
+  ShaderSource source;
+
+  for (UintSize p=0; p<composer.getNumPermutations(); ++p)
+  {
+    if (!composer.composePermutation( p, key, source ))
+      return false;
+
+    const ShaderSource *cached = cache.find( source.permutation, source.compose );
+    if (cached == NULL) return false;
+    if (cached->vertex != source.vertex) return false;
+    if (cached->fragment != source.fragment) return false;
+  }
+
+  return true;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) numRepeat = (UintSize) atoi( argv[1] );
+
+  ShaderComposer composer;
+  composer.addDefaults();
+  UintSize numPerms = composer.getNumPermutations();
+
+  //Fill the cache once and check the result is stable
+  ShaderSourceCache cache;
+  UintSize numComposed = composer.composeAll( &cache );
+  bool stableOk = checkDeterministic( composer, cache );
+
+  UintSize numBytes = 0;
+  for (UintSize s=0; s<cache.size(); ++s)
+    numBytes += cache.at( s ).vertex.length() + cache.at( s ).fragment.length();
+
+  printf( "Permutations: %d (%d composed, %d unique)\n",
+          (int) numPerms, (int) numComposed, (int) cache.size() );
+  printf( "Source size: %d bytes\n", (int) numBytes );
+  printf( "Deterministic: %s\n", stableOk ? "OK" : "FAILED" );
+
+  //Composition throughput
+  ShaderSourceCache scratch;
+  Time::ResetTicks();
+  for (UintSize r=0; r<numRepeat; ++r)
+  {
+    scratch.clear();
+    composer.composeAll( &scratch );
+  }
+  Float ms = (Float) Time::GetTicks();
+  Float perSec = (ms > 0.0f) ? (Float) (numPerms * numRepeat) * 1000.0f / ms : 0.0f;
+  printf( "Compose: %.3f ms per permutation, %.0f permutations/sec\n",
+          ms / (numPerms * numRepeat), perSec );
+
+  //Cache lookups of the same permutations
+  UintSize numLookups = 0;
+  Time::ResetTicks();
+  for (UintSize r=0; r<numRepeat * 1000; ++r)
+    for (UintSize s=0; s<cache.size(); ++s)
+      if (cache.find( cache.at( s ).permutation, cache.at( s ).compose ) != NULL)
+        numLookups++;
+  Float msLookup = (Float) Time::GetTicks();
+  printf( "Cache lookup: %.6f ms per permutation\n", msLookup / Util::Max( numLookups, (UintSize) 1 ));
+
+  return stableOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,382 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of TriMesh::buildLods. Simplifies a
+texture mapped sphere with a seam along one meridian and
+a terrain grid with open borders, a hard crease down the
+middle and two materials split across it. Reports the
+faces, vertices and error of every level against the
+deviation measured from the analytic surface, and checks
+that levels shrink with a growing error, no face turns
+over, the borders, crease and material split stay where
+they were and every vertex keeps its texture coordinate.
+Both meshes are simplified once from their PolyMesh and
+once from the TriMesh data alone. A skinned sphere checks
+that every level keeps valid joint indices and weights.
+-----------------------------------------------------------*/
+
+UintSize sphereSegments = 256;
+UintSize terrainSize = 200;
+UintSize numLods = 4;
+Float skinTolerance = 0.05f;
+
+struct PolyInput
+{
+  PolyMesh *mesh;
+  TexMesh *texMesh;
+};
+
+/*
+Rings of quads between two poles closed by triangle fans.
+The seam meridian gets a second texture vertex per ring
+and every fan corner at a pole its own one. A skinned
+sphere blends two joints from the north pole down to the
+south one. */
+
+Float skinWeight (const Vector3 &p)
+{
+  return (1.0f - p.y) * 0.5f;
+}
+
+PolyInput createSphere (UintSize segments, bool skinned = false)
+{
+  PolyInput in;
+  in.mesh = skinned ? new SPolyMesh : new PolyMesh;
+  in.texMesh = new TexMesh;
+  UintSize rings = segments / 2;
+
+  PolyMesh::Vertex *poles[2];
+  for (int p=0; p<2; ++p) {
+    poles[p] = in.mesh->addVertex();
+    poles[p]->point.set( 0.0f, (p == 0) ? 1.0f : -1.0f, 0.0f ); }
+
+  ArrayList< PolyMesh::Vertex* > verts;
+  ArrayList< TexMesh::Vertex* > texVerts;
+  for (UintSize r=1; r<rings; ++r)
+  {
+    Float theta = (Float) r / (Float) rings * PI;
+    for (UintSize s=0; s<segments; ++s) {
+      Float phi = (Float) s / (Float) segments * 2.0f * PI;
+      PolyMesh::Vertex *v = in.mesh->addVertex();
+      v->point.set( std::sin( theta ) * std::cos( phi ), std::cos( theta ), std::sin( theta ) * std::sin( phi ));
+      verts.pushBack( v ); }
+
+    for (UintSize s=0; s<=segments; ++s) {
+      TexMesh::Vertex *t = in.texMesh->addVertex();
+      t->point.set( (Float) s / (Float) segments, (Float) r / (Float) rings );
+      texVerts.pushBack( t ); }
+  }
+
+  for (UintSize s=0; s<segments; ++s)
+  {
+    UintSize s1 = s + 1;
+    UintSize last = (rings - 2) * segments;
+    UintSize lastTex = (rings - 2) * (segments + 1);
+
+    TexMesh::Vertex *north = in.texMesh->addVertex();
+    north->point.set( ((Float) s + 0.5f) / (Float) segments, 0.0f );
+    PolyMesh::Vertex *corners[3] = { poles[0], verts[ s1 % segments ], verts[ s ] };
+    TexMesh::Vertex *texCorners[3] = { north, texVerts[ s1 ], texVerts[ s ] };
+    in.mesh->addFace( corners, 3 )->smoothGroups = 1;
+    in.texMesh->addFace( texCorners, 3 );
+
+    TexMesh::Vertex *south = in.texMesh->addVertex();
+    south->point.set( ((Float) s + 0.5f) / (Float) segments, 1.0f );
+    PolyMesh::Vertex *corners2[3] = { poles[1], verts[ last + s ], verts[ last + s1 % segments ] };
+    TexMesh::Vertex *texCorners2[3] = { south, texVerts[ lastTex + s ], texVerts[ lastTex + s1 ] };
+    in.mesh->addFace( corners2, 3 )->smoothGroups = 1;
+    in.texMesh->addFace( texCorners2, 3 );
+  }
+
+  for (UintSize r=0; r+2<rings; ++r)
+    for (UintSize s=0; s<segments; ++s)
+    {
+      UintSize s1 = s + 1;
+      UintSize i[4] = { r * segments + s, r * segments + s1 % segments,
+        (r+1) * segments + s1 % segments, (r+1) * segments + s };
+      UintSize t[4] = { r * (segments+1) + s, r * (segments+1) + s1,
+        (r+1) * (segments+1) + s1, (r+1) * (segments+1) + s };
+
+      PolyMesh::Vertex *corners[4];
+      TexMesh::Vertex *texCorners[4];
+      for (int k=0; k<4; ++k) {
+        corners[k] = verts[ i[k] ];
+        texCorners[k] = texVerts[ t[k] ]; }
+
+      in.mesh->addFace( corners, 4 )->smoothGroups = 1;
+      in.texMesh->addFace( texCorners, 4 );
+    }
+
+  if (skinned)
+    for (SPolyMesh::VertIter v( (SPolyMesh*) in.mesh ); !v.end(); ++v)
+      for (int i=0; i<4; ++i) {
+        v->boneIndex[i] = (i < 2) ? i : 0;
+        v->boneWeight[i] = (i == 0) ? 1.0f - skinWeight( v->point ) :
+          (i == 1) ? skinWeight( v->point ) : 0.0f; }
+
+  return in;
+}
+
+/*
+Rolling height field with a valley folded down the
+middle column. */
+
+Float terrainHeight (Float x, Float z, UintSize n)
+{
+  Float mid = (Float) (n / 2);
+  return (std::sin( x * 0.1f ) * std::cos( z * 0.08f ) - std::fabs( x - mid ) * 0.1f) * 2.0f;
+}
+
+/*
+Quads of a height field, the edges along the middle
+column are hard and the rows past the middle use the
+second material. */
+
+PolyInput createTerrain (UintSize n)
+{
+  PolyInput in;
+  in.mesh = new PolyMesh;
+  in.texMesh = new TexMesh;
+
+  ArrayList< PolyMesh::Vertex* > verts;
+  ArrayList< TexMesh::Vertex* > texVerts;
+  for (UintSize z=0; z<=n; ++z)
+    for (UintSize x=0; x<=n; ++x) {
+      PolyMesh::Vertex *v = in.mesh->addVertex();
+      v->point.set( (Float) x, terrainHeight( (Float) x, (Float) z, n ), (Float) z );
+      verts.pushBack( v );
+      TexMesh::Vertex *t = in.texMesh->addVertex();
+      t->point.set( (Float) x / (Float) n, (Float) z / (Float) n );
+      texVerts.pushBack( t ); }
+
+  for (UintSize z=0; z<n; ++z)
+    for (UintSize x=0; x<n; ++x)
+    {
+      UintSize a = z * (n+1) + x;
+      UintSize i[4] = { a, a + n + 1, a + n + 2, a + 1 };
+
+      PolyMesh::Vertex *corners[4];
+      TexMesh::Vertex *texCorners[4];
+      for (int k=0; k<4; ++k) {
+        corners[k] = verts[ i[k] ];
+        texCorners[k] = texVerts[ i[k] ]; }
+
+      PolyMesh::Face *face = in.mesh->addFace( corners, 4 );
+      in.texMesh->addFace( texCorners, 4 );
+      face->smoothGroups = 1;
+      in.mesh->setMaterialID( face, (MaterialID) ((z < n/2) ? 0 : 1) );
+    }
+
+  Float mid = (Float) (n / 2);
+  for (PolyMesh::EdgeIter e( in.mesh ); !e.end(); ++e)
+    e->isSmooth = !(e->vertex1()->point.x == mid && e->vertex2()->point.x == mid);
+
+  return in;
+}
+
+Float getMs (Uint64 start)
+{
+  return (Float) (Time::GetMicroseconds() - start) / 1000.0f;
+}
+
+/*
+Checks run on every level of a mesh against its base,
+the deviation is the largest distance of a triangle
+center from the surface it approximates. */
+
+class MeshCheck
+{
+public:
+  bool isTerrain;
+  UintSize size;
+  BoundingBox bounds;
+
+  Vector3 point (TriMesh *m, VertexID i) {
+    return *((Vector3*) Util::PtrOff( m->getVertex( i ), m->getFormat()->getMembers()->at( 0 ).offset )); }
+
+  Vector2 texCoord (TriMesh *m, VertexID i) {
+    return *((Vector2*) Util::PtrOff( m->getVertex( i ), m->getFormat()->getMembers()->at( 1 ).offset )); }
+
+  Float surfaceDistance (const Vector3 &p)
+  {
+    if (isTerrain) return std::fabs( p.y - terrainHeight( p.x, p.z, size ));
+    return std::fabs( 1.0f - p.norm() );
+  }
+
+  //Direction a triangle faces is judged against the surface
+  Float facing (const Vector3 &center, const Vector3 &normal)
+  {
+    if (isTerrain) return normal.y;
+    return Vector::Dot( center, normal );
+  }
+
+  bool hasTexCoord (const Vector3 &p, const Vector2 &uv)
+  {
+    if (isTerrain)
+      return std::fabs( uv.x - p.x / (Float) size ) < 1e-5f &&
+             std::fabs( uv.y - p.z / (Float) size ) < 1e-5f;
+
+    Float v = std::acos( Util::Max( -1.0f, Util::Min( 1.0f, p.y ))) / PI;
+    if (std::fabs( uv.y - v ) > 1e-3f) return false;
+    if (std::fabs( p.y ) > 0.99999f) return true;
+
+    Float u = std::atan2( p.z, p.x ) / (2.0f * PI);
+    if (u < 0.0f) u += 1.0f;
+    return std::fabs( uv.x - u ) < 1e-3f || std::fabs( std::fabs( uv.x - u ) - 1.0f ) < 1e-3f;
+  }
+
+  bool check (TriMesh *m, Float *outDeviation)
+  {
+    bool ok = true;
+    Float deviation = 0.0f;
+    Float mid = (Float) (size / 2);
+
+    for (UintSize i=0; i<m->getVertexCount(); ++i)
+      if (!hasTexCoord( point( m, (VertexID) i ), texCoord( m, (VertexID) i ))) ok = false;
+
+    for (UintSize g=0; g<m->groups.size(); ++g)
+    {
+      TriMesh::IndexGroup &grp = m->groups[ g ];
+      for (UintSize c=0; c+2<grp.count; c+=3)
+      {
+        VertexID *id = m->indices.buffer() + grp.start + c;
+        if (id[0] >= m->getVertexCount() || id[1] >= m->getVertexCount() ||
+            id[2] >= m->getVertexCount()) return false;
+
+        Vector3 p0 = point( m, id[0] ), p1 = point( m, id[1] ), p2 = point( m, id[2] );
+        Vector3 center = (p0 + p1 + p2) / 3.0f;
+        Vector3 normal = Vector::Cross( p1 - p0, p2 - p0 );
+        if (facing( center, normal ) <= 0.0f) ok = false;
+        deviation = Util::Max( deviation, surfaceDistance( center ));
+
+        if (isTerrain)
+        {
+          //Nothing may reach across the crease or the material split
+          Float minX = Util::Min( p0.x, Util::Min( p1.x, p2.x ));
+          Float maxX = Util::Max( p0.x, Util::Max( p1.x, p2.x ));
+          if (minX < mid && maxX > mid) ok = false;
+
+          Float minZ = Util::Min( p0.z, Util::Min( p1.z, p2.z ));
+          Float maxZ = Util::Max( p0.z, Util::Max( p1.z, p2.z ));
+          if (grp.materialID == 0 && maxZ > mid) ok = false;
+          if (grp.materialID == 1 && minZ < mid) ok = false;
+        }
+      }
+    }
+
+    //Borders of the terrain may only slide along themselves
+    BoundingBox box = m->getBoundingBox();
+    if (isTerrain && (box.min.x != bounds.min.x || box.max.x != bounds.max.x ||
+                      box.min.z != bounds.min.z || box.max.z != bounds.max.z)) ok = false;
+
+    *outDeviation = deviation;
+    return ok;
+  }
+
+  //Joints of a vertex stay the two of the sphere blended by height
+  bool checkSkin (SkinTriMesh *m)
+  {
+    for (UintSize i=0; i<m->getVertexCount(); ++i)
+    {
+      SkinVertex v = m->binding( m->getVertex( i ));
+      if (v.jointIndex[0] != 0 || v.jointIndex[1] != 1) return false;
+      if (v.jointWeight[2] != 0.0f || v.jointWeight[3] != 0.0f) return false;
+      if (std::fabs( v.jointWeight[0] + v.jointWeight[1] - 1.0f ) > 1e-5f) return false;
+      if (std::fabs( v.jointWeight[1] - skinWeight( point( m, (VertexID) i ))) > skinTolerance) return false;
+    }
+    return true;
+  }
+};
+
+/*
+Levels are built from the PolyMesh the mesh was made of,
+or from the mesh data alone as for loaded meshes. Meshes
+made of an SPolyMesh are skinned. */
+
+bool run (const char *name, PolyInput in, bool isTerrain, UintSize size,
+          SmoothMetric::Enum metric, bool fromData)
+{
+  bool skinned = ClassOf( in.mesh ) == ClassName( SPolyMesh );
+
+  VertexFormat format;
+  format.addMember( ShaderData::Coord3 );
+  format.addMember( ShaderData::TexCoord2 );
+  format.addMember( ShaderData::Normal );
+  if (skinned) {
+    format.addMember( ShaderData::JointIndex );
+    format.addMember( ShaderData::JointWeight ); }
+
+  in.mesh->triangulate();
+  in.mesh->updateNormals( metric );
+
+  TriMesh *mesh = skinned ? new SkinTriMesh : new TriMesh;
+  mesh->setFormat( format );
+  mesh->fromPoly( in.mesh, in.texMesh );
+  mesh->updateBoundingBox();
+
+  Uint64 start = Time::GetMicroseconds();
+  if (fromData) mesh->buildLods( numLods, 0.5f );
+  else mesh->buildLods( in.mesh, in.texMesh, numLods, 0.5f, metric );
+  Float ms = getMs( start );
+
+  MeshCheck checker;
+  checker.isTerrain = isTerrain;
+  checker.size = size;
+  checker.bounds = mesh->getBoundingBox();
+
+  Float deviation = 0.0f;
+  bool ok = checker.check( mesh, &deviation );
+  if (skinned) ok = ok && checker.checkSkin( (SkinTriMesh*) mesh );
+  printf( "%s: %d faces, %d vertices, deviation %.5f, simplified in %.2f ms\n",
+          name, (int) mesh->getFaceCount(), (int) mesh->getVertexCount(), deviation, ms );
+
+  TriMesh *prev = mesh;
+  for (UintSize l=0; l<mesh->getLodCount(); ++l)
+  {
+    TriMesh *lod = mesh->lods[ l ];
+    bool lodOk = checker.check( lod, &deviation );
+    if (skinned) lodOk = lodOk && ClassOf( lod ) == ClassName( SkinTriMesh ) &&
+      checker.checkSkin( (SkinTriMesh*) lod );
+    lodOk = lodOk && mesh->getLod( lod->lodError )->lodError == lod->lodError;
+    lodOk = lodOk && lod->getFaceCount() < prev->getFaceCount();
+    lodOk = lodOk && lod->lodError >= prev->lodError;
+
+    printf( "  LOD %d: %d faces, %d vertices, error %.5f, deviation %.5f%s\n",
+            (int) l+1, (int) lod->getFaceCount(), (int) lod->getVertexCount(),
+            lod->lodError, deviation, lodOk ? "" : ", BROKEN" );
+
+    ok = ok && lodOk;
+    prev = lod;
+  }
+
+  ok = ok && mesh->getLodCount() > 0 && mesh->getLod( 0.0f ) == mesh;
+  delete mesh;
+  delete in.mesh;
+  delete in.texMesh;
+  return ok;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) sphereSegments = (UintSize) atoi( argv[1] );
+  if (argc > 2) terrainSize = (UintSize) atoi( argv[2] );
+  if (argc > 3) numLods = (UintSize) atoi( argv[3] );
+
+  bool ok = true;
+  ok = run( "Sphere", createSphere( sphereSegments ), false, 0, SmoothMetric::All, false ) && ok;
+  ok = run( "Terrain", createTerrain( terrainSize ), true, terrainSize, SmoothMetric::Edge, false ) && ok;
+  ok = run( "Sphere from data", createSphere( sphereSegments ), false, 0, SmoothMetric::All, true ) && ok;
+  ok = run( "Terrain from data", createTerrain( terrainSize ), true, terrainSize, SmoothMetric::Edge, true ) && ok;
+  ok = run( "Skinned sphere", createSphere( sphereSegments, true ), false, 0, SmoothMetric::All, false ) && ok;
+  ok = run( "Skinned sphere from data", createSphere( sphereSegments, true ), false, 0, SmoothMetric::All, true ) && ok;
+
+  printf( "Data check: %s\n", ok ? "OK" : "FAILED" );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
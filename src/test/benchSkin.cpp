@@ -0,0 +1,103 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of the skinned actor animation stage.
+Ticks a crowd of characters with 1..N worker threads and
+reports the number of characters updated per millisecond.
+-----------------------------------------------------------*/
+
+UintSize numCharacters = 500;
+UintSize numJoints = 64;
+UintSize numKeys = 120;
+UintSize numFrames = 200;
+
+Character* createCharacter ()
+{
+  Character *character = new Character;
+  character->pose = new SkinPose;
+  character->meshes.pushBack( new SkinTriMesh );
+
+  //Joints are stored breadth-first with children in
+  //sequence, which is exactly the layout of a binary heap
+  for (UintSize j=0; j<numJoints; ++j)
+  {
+    SkinJoint joint;
+    joint.numChildren = 0;
+    if (2*j+1 < numJoints) joint.numChildren++;
+    if (2*j+2 < numJoints) joint.numChildren++;
+    joint.localT.set( 0.0f, 1.0f, 0.0f );
+    character->pose->joints.pushBack( joint );
+  }
+
+  //Animation with a rotation and translation track per joint
+  Animation *anim = new Animation;
+  anim->name = "Walk";
+  anim->kps = 30;
+  anim->duration = (Float) (numKeys - 1) / anim->kps;
+
+  for (UintSize j=0; j<numJoints; ++j)
+  {
+    QuatAnimTrack *trackR = new QuatAnimTrack;
+    Vec3AnimTrack *trackT = new Vec3AnimTrack;
+
+    for (UintSize k=0; k<numKeys; ++k)
+    {
+      Quat r; r.fromAxisAngle( 0.0f, 1.0f, 0.0f, (Float) k * 0.05f );
+      trackR->addKey( r );
+      trackT->addKey( Vector3( 0.0f, 1.0f, (Float) k * 0.01f ));
+    }
+
+    anim->addTrack( trackR );
+    anim->addTrack( trackT );
+  }
+
+  character->anims.pushBack( anim );
+  return character;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) numCharacters = (UintSize) atoi( argv[1] );
+  if (argc > 2) numFrames = (UintSize) atoi( argv[2] );
+
+  //Setup a crowd playing the same clip at different times
+  Character *character = createCharacter();
+  ArrayList< SkinMeshActor* > actors;
+
+  for (UintSize c=0; c<numCharacters; ++c)
+  {
+    SkinMeshActor *actor = new SkinMeshActor;
+    actor->setCharacter( character );
+    actor->loadAnimation( "Walk" );
+    actor->getAnimController()->play( -1, 1.0f, (Float) c * 0.01f );
+    actors.pushBack( actor );
+  }
+
+  printf( "Characters: %d, Joints: %d, Frames: %d\n",
+          (int) numCharacters, (int) numJoints, (int) numFrames );
+
+  Uint maxThreads = Thread::GetNumCores();
+  for (Uint t=1; t<=maxThreads; ++t)
+  {
+    ThreadPool pool( t );
+
+    Time::ResetTicks();
+    for (UintSize f=0; f<numFrames; ++f)
+      SkinMeshActor::TickAll( actors, 1.0f / 60.0f, &pool );
+    int ms = Util::Max( Time::GetTicks(), 1 );
+
+    Float charsPerMs = (Float) (numCharacters * numFrames) / (Float) ms;
+    printf( "Threads: %2d  Time: %6d ms  Characters/ms: %8.2f\n", (int) t, ms, charsPerMs );
+  }
+
+  for (UintSize c=0; c<actors.size(); ++c)
+    delete actors[ c ];
+
+  delete character;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,201 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of PolyMesh::triangulate. Builds single
+faces of many corners the way CAD exports produce them: a
+convex disk, a gear with every other corner concave, a
+star of random radii and a comb of deep slots, all tilted
+out of the axis planes, plus a grid of quads for the
+common case. Times the triangulation and checks every face
+is split into n-2 triangles facing the same way that cover
+exactly the area of the polygon.
+-----------------------------------------------------------*/
+
+UintSize numCorners = 20000;
+UintSize gridSize = 300;
+UintSize numRepeat = 3;
+
+Uint32 randState = 12345;
+
+Float random01 ()
+{
+  randState = randState * 1664525 + 1013904223;
+  return (Float) (randState >> 8) / (Float) (1 << 24);
+}
+
+/*
+Points of a polygon in the xy plane are rotated into
+a tilted plane and added as a single face. */
+
+void addPolygon (PolyMesh *mesh, const ArrayList< Vector2 > &points, Float offset)
+{
+  Matrix4x4 tilt;
+  tilt.setRotationX( 0.6f );
+  Matrix4x4 turn;
+  turn.setRotationY( 0.4f );
+  tilt = turn * tilt;
+
+  ArrayList< PolyMesh::Vertex* > corners;
+  for (UintSize p=0; p<points.size(); ++p) {
+    PolyMesh::Vertex *v = mesh->addVertex();
+    v->point = tilt * Vector3( points[p].x + offset, points[p].y, 0.0f );
+    corners.pushBack( v ); }
+
+  mesh->addFace( corners.buffer(), (int) corners.size() );
+}
+
+void makeDisk (ArrayList< Vector2 > *points, UintSize n)
+{
+  for (UintSize i=0; i<n; ++i) {
+    Float a = (Float) i / (Float) n * 2.0f * PI;
+    points->pushBack( Vector2( std::cos( a ), std::sin( a ))); }
+}
+
+void makeGear (ArrayList< Vector2 > *points, UintSize n)
+{
+  for (UintSize i=0; i<n; ++i) {
+    Float a = (Float) i / (Float) n * 2.0f * PI;
+    Float r = (i % 2 == 0) ? 1.0f : 0.9f;
+    points->pushBack( Vector2( r * std::cos( a ), r * std::sin( a ))); }
+}
+
+void makeStar (ArrayList< Vector2 > *points, UintSize n)
+{
+  for (UintSize i=0; i<n; ++i) {
+    Float a = (Float) i / (Float) n * 2.0f * PI;
+    Float r = 0.3f + 0.7f * random01();
+    points->pushBack( Vector2( r * std::cos( a ), r * std::sin( a ))); }
+}
+
+/*
+Slots cut down from the top edge of a rectangle, the
+corners of every slot bottom are concave. */
+
+void makeComb (ArrayList< Vector2 > *points, UintSize n)
+{
+  UintSize numTeeth = Util::Max( n / 4, (UintSize) 2 );
+  Float w = 1.0f / (Float) numTeeth;
+
+  points->pushBack( Vector2( 1.0f, 0.0f ));
+  for (UintSize t=numTeeth; t>0; --t) {
+    Float x = (Float) t * w;
+    points->pushBack( Vector2( x, 1.0f ));
+    points->pushBack( Vector2( x - w * 0.5f, 1.0f ));
+    points->pushBack( Vector2( x - w * 0.5f, 0.1f ));
+    points->pushBack( Vector2( x - w, 0.1f )); }
+  points->pushBack( Vector2( 0.0f, 0.0f ));
+}
+
+void buildGrid (PolyMesh *mesh, UintSize n)
+{
+  ArrayList< PolyMesh::Vertex* > verts;
+  for (UintSize y=0; y<=n; ++y)
+    for (UintSize x=0; x<=n; ++x) {
+      PolyMesh::Vertex *v = mesh->addVertex();
+      v->point.set( (Float) x, std::sin( (Float) x * 0.3f ) * std::cos( (Float) y * 0.2f ), (Float) y );
+      verts.pushBack( v ); }
+
+  for (UintSize y=0; y<n; ++y)
+    for (UintSize x=0; x<n; ++x) {
+      UintSize a = y * (n+1) + x;
+      PolyMesh::Vertex *corners[4] = {
+        verts[ a ], verts[ a + n + 1 ], verts[ a + n + 2 ], verts[ a + 1 ] };
+      mesh->addFace( corners, 4 ); }
+}
+
+/*
+The polygon normal by Newell's method is twice the
+area along the normal. The triangles must add up to
+the same area and none may face the other way. */
+
+bool isCovered (PolyMesh::Face *face)
+{
+  Vector3 normal;
+  int numCorners = 0;
+  for (PolyMesh::FaceVertIter fv( face ); !fv.end(); ++fv, ++numCorners) {
+    Vector3 &a = fv->point;
+    Vector3 &b = fv.hedgeToVertex()->nextHedge()->dstVertex()->point;
+    normal.x += (a.y - b.y) * (a.z + b.z);
+    normal.y += (a.z - b.z) * (a.x + b.x);
+    normal.z += (a.x - b.x) * (a.y + b.y); }
+
+  Float area = normal.norm() * 0.5f;
+  normal.normalize();
+
+  int numTris = 0;
+  Float trisArea = 0.0f;
+  for (PolyMesh::Triangle *t = face->firstTriangle(); t != NULL; t = t->nextTriangle(), ++numTris)
+  {
+    Vector3 &p0 = t->vertex(0)->point;
+    Vector3 &p1 = t->vertex(1)->point;
+    Vector3 &p2 = t->vertex(2)->point;
+    Vector3 cross = Vector::Cross( p1 - p0, p2 - p0 );
+    Float side = Vector::Dot( cross, normal );
+    if (side < -1e-6f * area) return false;
+    trisArea += cross.norm() * 0.5f;
+  }
+
+  return numTris == numCorners - 2 &&
+    std::fabs( trisArea - area ) <= area * 1e-3f;
+}
+
+Float getMs (Uint64 start)
+{
+  return (Float) (Time::GetMicroseconds() - start) / 1000.0f;
+}
+
+bool run (const char *name, PolyMesh *mesh, int numCorners)
+{
+  Float ms = 0.0f;
+  for (UintSize r=0; r<numRepeat; ++r) {
+    Uint64 start = Time::GetMicroseconds();
+    mesh->triangulate();
+    Float t = getMs( start );
+    ms = (r == 0) ? t : Util::Min( ms, t ); }
+
+  bool ok = true;
+  for (PolyMesh::FaceIter f( mesh ); !f.end(); ++f)
+    if (!isCovered( *f )) ok = false;
+
+  printf( "%s: %d faces, %d corners, %.2f ms, %s\n",
+          name, mesh->faceCount(), numCorners, ms, ok ? "covered" : "BROKEN" );
+
+  return ok;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) numCorners = (UintSize) atoi( argv[1] );
+  if (argc > 2) gridSize = (UintSize) atoi( argv[2] );
+
+  const char *names[4] = { "Disk", "Gear", "Star", "Comb" };
+  void (*makers[4]) (ArrayList< Vector2 >*, UintSize) = {
+    makeDisk, makeGear, makeStar, makeComb };
+
+  bool ok = true;
+  for (int s=0; s<4; ++s)
+  {
+    ArrayList< Vector2 > points;
+    makers[s]( &points, numCorners );
+
+    PolyMesh *mesh = new PolyMesh;
+    addPolygon( mesh, points, 0.0f );
+    ok = run( names[s], mesh, (int) points.size() ) && ok;
+    delete mesh;
+  }
+
+  PolyMesh *grid = new PolyMesh;
+  buildGrid( grid, gridSize );
+  ok = run( "Quads", grid, grid->vertexCount() ) && ok;
+  delete grid;
+
+  printf( "Data check: %s\n", ok ? "OK" : "FAILED" );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,322 @@
+#include "core/geEngine.h"
+using namespace GE;
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+
+/*
+-----------------------------------------------------------
+Headless benchmark of TriMesh::optimize. Builds a torus
+with two materials in scan order, like an exporter leaves
+it, and again with the faces and vertices shuffled.
+Reports the simulated vertex cache misses per triangle
+(ACMR) and per vertex (ATVR) for FIFO caches of 16 and 32
+entries before and after, and the overdraw of a software
+rasterizer looking from the six axes with and without the
+overdraw pass. Checks that every group keeps the same
+triangles with the same winding and that vertices come in
+the order they are first used.
+-----------------------------------------------------------*/
+
+UintSize ringSegments = 256;
+UintSize tubeSegments = 128;
+UintSize raster = 256;
+
+/*
+Small generator so shuffles are the same on every run. */
+
+Uint32 seed = 12345;
+Uint32 nextRandom ()
+{
+  seed = seed * 1664525 + 1013904223;
+  return seed >> 8;
+}
+
+/*
+Tube wound twice around the center so it covers itself
+from every side. Faces past the half way point of the
+ring use the second material. */
+
+TriMesh* createTorus (bool shuffle)
+{
+  VertexFormat format;
+  format.addMember( ShaderData::Coord3 );
+  format.addMember( ShaderData::Normal );
+
+  TriMesh *mesh = new TriMesh;
+  mesh->setFormat( format );
+
+  UintSize numVerts = ringSegments * tubeSegments;
+  ArrayList< VertexID > vertOrder;
+  for (UintSize v=0; v<numVerts; ++v)
+    vertOrder.pushBack( (VertexID) v );
+
+  if (shuffle)
+    for (UintSize v=numVerts; v>1; --v) {
+      UintSize r = nextRandom() % v;
+      VertexID t = vertOrder[ v-1 ]; vertOrder[ v-1 ] = vertOrder[ r ]; vertOrder[ r ] = t; }
+
+  ArrayList< Vector3 > points, normals;
+  points.resize( numVerts );
+  normals.resize( numVerts );
+  for (UintSize r=0; r<ringSegments; ++r)
+    for (UintSize t=0; t<tubeSegments; ++t)
+    {
+      Float phi = (Float) r / (Float) ringSegments * 4.0f * PI;
+      Float theta = (Float) t / (Float) tubeSegments * 2.0f * PI;
+      Float radius = 1.0f + 0.3f * std::cos( phi * 0.5f );
+      Vector3 center( radius * std::cos( phi ), 0.3f * std::sin( phi * 0.5f ), radius * std::sin( phi ));
+      Vector3 out( std::cos( phi ), 0.0f, std::sin( phi ));
+      Vector3 up( 0.0f, 1.0f, 0.0f );
+      Vector3 normal = out * std::cos( theta ) + up * std::sin( theta );
+
+      VertexID v = vertOrder[ r * tubeSegments + t ];
+      points[ v ] = center + normal * 0.25f;
+      normals[ v ] = normal;
+    }
+
+  for (UintSize v=0; v<numVerts; ++v)
+  {
+    void *vert = mesh->addVertex();
+    *((Vector3*) Util::PtrOff( vert, mesh->getFormat()->getMembers()->at( 0 ).offset )) = points[ v ];
+    *((Vector3*) Util::PtrOff( vert, mesh->getFormat()->getMembers()->at( 1 ).offset )) = normals[ v ];
+  }
+
+  for (MaterialID m=0; m<2; ++m)
+  {
+    ArrayList< VertexID > tris;
+    UintSize half = ringSegments / 2;
+    for (UintSize r=m*half; r<(m+1)*half; ++r)
+      for (UintSize t=0; t<tubeSegments; ++t)
+      {
+        UintSize r1 = (r + 1) % ringSegments, t1 = (t + 1) % tubeSegments;
+        VertexID a = vertOrder[ r * tubeSegments + t ], b = vertOrder[ r * tubeSegments + t1 ];
+        VertexID c = vertOrder[ r1 * tubeSegments + t1 ], d = vertOrder[ r1 * tubeSegments + t ];
+        VertexID quad[6] = { a, b, c, a, c, d };
+        for (int k=0; k<6; ++k) tris.pushBack( quad[k] );
+      }
+
+    UintSize numTris = tris.size() / 3;
+    if (shuffle)
+      for (UintSize i=numTris; i>1; --i) {
+        UintSize r = nextRandom() % i;
+        for (int k=0; k<3; ++k) {
+          VertexID t = tris[ (i-1)*3+k ]; tris[ (i-1)*3+k ] = tris[ r*3+k ]; tris[ r*3+k ] = t; } }
+
+    mesh->addFaceGroup( m );
+    for (UintSize i=0; i<numTris; ++i)
+      mesh->addFace( tris[ i*3+0 ], tris[ i*3+1 ], tris[ i*3+2 ] );
+  }
+
+  mesh->updateBoundingBox();
+  return mesh;
+}
+
+Float getMs (Uint64 start)
+{
+  return (Float) (Time::GetMicroseconds() - start) / 1000.0f;
+}
+
+Vector3 point (TriMesh *m, VertexID i)
+{
+  return *((Vector3*) Util::PtrOff( m->getVertex( i ), m->getFormat()->getMembers()->at( 0 ).offset ));
+}
+
+/*
+Triangles are keyed by the bytes of their vertices, turned
+so the smallest hash comes first to keep the winding. */
+
+Uint64 hashVertex (TriMesh *m, VertexID i)
+{
+  Uint64 h = 14695981039346656037ULL;
+  const Uint8 *bytes = (const Uint8*) m->getVertex( i );
+  for (UintSize b=0; b<m->data.elementSize(); ++b)
+    h = (h ^ bytes[b]) * 1099511628211ULL;
+  return h;
+}
+
+int compareKeys (const void *a, const void *b)
+{
+  Uint64 ka = *(const Uint64*) a, kb = *(const Uint64*) b;
+  return (ka < kb) ? -1 : (ka > kb) ? 1 : 0;
+}
+
+void triangleKeys (TriMesh *m, UintSize group, ArrayList< Uint64 > &keys)
+{
+  keys.clear();
+  TriMesh::IndexGroup &grp = m->groups[ group ];
+  for (UintSize c=0; c+2<grp.count; c+=3)
+  {
+    VertexID *id = m->indices.buffer() + grp.start + c;
+    Uint64 h[3] = { hashVertex( m, id[0] ), hashVertex( m, id[1] ), hashVertex( m, id[2] ) };
+    int first = (h[1] < h[0]) ? 1 : 0;
+    if (h[2] < h[ first ]) first = 2;
+
+    Uint64 key = 0;
+    for (int k=0; k<3; ++k)
+      key = key * 31 + h[ (first + k) % 3 ];
+    keys.pushBack( key );
+  }
+  qsort( keys.buffer(), keys.size(), sizeof( Uint64 ), compareKeys );
+}
+
+bool sameTriangles (TriMesh *a, TriMesh *b)
+{
+  if (a->groups.size() != b->groups.size()) return false;
+  if (a->getVertexCount() != b->getVertexCount()) return false;
+
+  ArrayList< Uint64 > keysA, keysB;
+  for (UintSize g=0; g<a->groups.size(); ++g)
+  {
+    if (a->groups[ g ].materialID != b->groups[ g ].materialID) return false;
+    if (a->groups[ g ].count != b->groups[ g ].count) return false;
+    triangleKeys( a, g, keysA );
+    triangleKeys( b, g, keysB );
+    for (UintSize i=0; i<keysA.size(); ++i)
+      if (keysA[i] != keysB[i]) return false;
+  }
+  return true;
+}
+
+bool inFetchOrder (TriMesh *m)
+{
+  VertexID next = 0;
+  for (UintSize i=0; i<m->indices.size(); ++i)
+  {
+    if (m->indices[i] > next) return false;
+    if (m->indices[i] == next) next++;
+  }
+  return true;
+}
+
+/*
+Draws the front faces in index order with a depth test
+along every axis both ways and returns the fragments
+that passed over the pixels covered. */
+
+Float overdraw (TriMesh *m)
+{
+  BoundingBox box = m->getBoundingBox();
+  Vector3 size = box.max - box.min;
+  Float scale = (Float) (raster - 1) / Util::Max( size.x, Util::Max( size.y, size.z ));
+
+  ArrayList< Float > depth;
+  depth.resize( raster * raster );
+  UintSize shaded = 0, covered = 0;
+
+  for (int axis=0; axis<3; ++axis)
+    for (int side=0; side<2; ++side)
+    {
+      for (UintSize p=0; p<raster*raster; ++p)
+        depth[p] = 1e30f;
+
+      int ax = (axis + 1) % 3, ay = (axis + 2) % 3;
+      Float flip = (Float) (raster - 1);
+
+      for (UintSize i=0; i+2<m->indices.size(); i+=3)
+      {
+        Float x[3], y[3], z[3];
+        for (int k=0; k<3; ++k) {
+          Vector3 p = (point( m, m->indices[ i+k ] ) - box.min) * scale;
+          Float *c = &p.x;
+          x[k] = side ? flip - c[ ax ] : c[ ax ]; y[k] = c[ ay ];
+          z[k] = side ? c[ axis ] : flip - c[ axis ]; }
+
+        Float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (area <= 0.0f) continue;
+
+        int minX = (int) std::floor( Util::Min( x[0], Util::Min( x[1], x[2] )));
+        int maxX = (int) std::ceil( Util::Max( x[0], Util::Max( x[1], x[2] )));
+        int minY = (int) std::floor( Util::Min( y[0], Util::Min( y[1], y[2] )));
+        int maxY = (int) std::ceil( Util::Max( y[0], Util::Max( y[1], y[2] )));
+
+        for (int py=minY; py<=maxY; ++py)
+          for (int px=minX; px<=maxX; ++px)
+          {
+            Float cx = (Float) px + 0.5f, cy = (Float) py + 0.5f;
+            Float w0 = (x[2] - x[1]) * (cy - y[1]) - (y[2] - y[1]) * (cx - x[1]);
+            Float w1 = (x[0] - x[2]) * (cy - y[2]) - (y[0] - y[2]) * (cx - x[2]);
+            Float w2 = (x[1] - x[0]) * (cy - y[0]) - (y[1] - y[0]) * (cx - x[0]);
+            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+
+            if (px < 0 || py < 0 || px >= (int) raster || py >= (int) raster) continue;
+            Float d = (w0 * z[0] + w1 * z[1] + w2 * z[2]) / area;
+            Float &stored = depth[ py * raster + px ];
+            if (d >= stored) continue;
+
+            if (stored == 1e30f) covered++;
+            stored = d;
+            shaded++;
+          }
+      }
+    }
+
+  return covered ? (Float) shaded / (Float) covered : 0.0f;
+}
+
+void printStats (const char *label, TriMesh *m)
+{
+  VertexCacheStats fifo16, fifo32;
+  fifo16.simulate( m, 16 );
+  fifo32.simulate( m, 32 );
+  printf( "  %s: ACMR %.3f / %.3f, ATVR %.3f / %.3f\n", label,
+          fifo16.getAcmr(), fifo32.getAcmr(), fifo16.getAtvr(), fifo32.getAtvr() );
+}
+
+bool run (const char *name, bool shuffle)
+{
+  Uint32 startSeed = seed;
+  TriMesh *original = createTorus( shuffle );
+  seed = startSeed;
+  TriMesh *cached = createTorus( shuffle );
+  seed = startSeed;
+  TriMesh *clustered = createTorus( shuffle );
+
+  printf( "%s: %d faces, %d vertices\n", name,
+          (int) original->getFaceCount(), (int) original->getVertexCount() );
+  printStats( "before", original );
+
+  Uint64 start = Time::GetMicroseconds();
+  cached->optimize();
+  Float ms = getMs( start );
+  printStats( "cache", cached );
+
+  start = Time::GetMicroseconds();
+  clustered->optimize( true );
+  Float msOverdraw = getMs( start );
+  printStats( "cache+overdraw", clustered );
+
+  printf( "  overdraw %.3f before, %.3f cache, %.3f cache+overdraw\n",
+          overdraw( original ), overdraw( cached ), overdraw( clustered ));
+  printf( "  optimized in %.2f ms, with overdraw in %.2f ms\n", ms, msOverdraw );
+
+  VertexCacheStats before, after, afterOverdraw;
+  before.simulate( original );
+  after.simulate( cached );
+  afterOverdraw.simulate( clustered );
+
+  bool ok = true;
+  ok = ok && sameTriangles( original, cached ) && sameTriangles( original, clustered );
+  ok = ok && inFetchOrder( cached ) && inFetchOrder( clustered );
+  ok = ok && after.numMisses < before.numMisses && afterOverdraw.numMisses < before.numMisses;
+
+  delete original;
+  delete cached;
+  delete clustered;
+  return ok;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc > 1) ringSegments = (UintSize) atoi( argv[1] );
+  if (argc > 2) tubeSegments = (UintSize) atoi( argv[2] );
+
+  bool ok = true;
+  ok = run( "Torus", false ) && ok;
+  ok = run( "Shuffled torus", true ) && ok;
+
+  printf( "Data check: %s\n", ok ? "OK" : "FAILED" );
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}